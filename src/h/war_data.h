@@ -28,6 +28,7 @@
 #include <luajit-2.1/lauxlib.h>
 #include <luajit-2.1/lua.h>
 #include <luajit-2.1/lualib.h>
+#include <pthread.h>
 #include <spa-0.2/spa/param/audio/raw.h>
 #include <spa-0.2/spa/pod/builder.h>
 #include <stdatomic.h>
@@ -81,9 +82,11 @@ enum war_misc {
     max_opcodes = 20,
     max_quads = 20000,
     max_text_quads = 20000,
+    max_hud_text_quads = 4096,
     max_note_quads = 20000,
-    max_frames = 1,
-    max_instances_per_quad = 1,
+    max_frames = 3,
+    max_frame_stats = 64,
+    max_frame_budget_window = 8,
     max_instances_per_sdf_quad = 1,
     max_fds = 50,
     OLED_MODE = 0,
@@ -158,6 +161,41 @@ enum war_undo_commands {
     CMD_SWAP_DELETE_NOTES = 5,
     CMD_ADD_NOTES_SAME = 6,
     CMD_DELETE_NOTES_SAME = 7,
+    CMD_HIDE_NOTES = 8,
+    CMD_SHOW_NOTES = 9,
+    CMD_MUTE_NOTES = 10,
+    CMD_UNMUTE_NOTES = 11,
+    CMD_PASTE_NOTES = 12,
+};
+
+enum war_note_query_flags {
+    NOTE_QUERY_OUTSIDE = 1 << 0,
+    NOTE_QUERY_VISIBLE = 1 << 1,
+    NOTE_QUERY_HIDDEN = 1 << 2,
+    NOTE_QUERY_ALL_LAYERS = 1 << 3,
+};
+
+enum war_note_scopes {
+    NOTE_SCOPE_IN_VIEW = 0,
+    NOTE_SCOPE_OUTSIDE_VIEW = 1,
+    NOTE_SCOPE_IN_WORD = 2,
+    NOTE_SCOPE_ALL = 3,
+    NOTE_SCOPE_CURSOR = 4,
+};
+
+enum war_note_ops {
+    NOTE_OP_DELETE = 0,
+    NOTE_OP_HIDE = 1,
+    NOTE_OP_SHOW = 2,
+    NOTE_OP_MUTE = 3,
+    NOTE_OP_UNMUTE = 4,
+};
+
+// unnamed, 0-9 then a-z
+enum war_note_register_names {
+    NOTE_REGISTER_UNNAMED = 0,
+    NOTE_REGISTER_YANK = 1,
+    NOTE_REGISTER_COUNT = 37,
 };
 
 enum war_control_commands {
@@ -235,6 +273,16 @@ typedef struct war_note_quads {
     uint32_t* mute;
     uint32_t count;
     uint32_t note_quads_max;
+    uint64_t generation;
+    // id -> index + 1, open addressing. entries go stale when a note dies
+    // and are only dropped on rebuild, lookups check alive and id
+    uint32_t* map;
+    uint32_t map_mask;
+    uint32_t map_used;
+    // a bit per WAR_PROJECT_CHUNK_COLS columns holding a note edited since
+    // the last autosave, NULL for stores that are never saved
+    uint64_t* dirty;
+    uint32_t dirty_count;
 } war_note_quads;
 
 typedef struct war_note_quad {
@@ -257,41 +305,142 @@ typedef struct war_note_quad {
     uint32_t mute;
 } war_note_quad;
 
-typedef struct war_payload_add_note {
-    war_note note;
-    war_note_quad note_quad;
-} war_payload_add_note;
-
-typedef struct war_payload_delete_note {
-    war_note note;
-    war_note_quad note_quad;
-} war_payload_delete_note;
+// on-disk layout of a paged out note quad, rows fit in 16 bits (A_NOTE_COUNT)
+typedef struct __attribute__((packed)) war_note_swap_record {
+    uint64_t id;
+    uint64_t layer;
+    double pos_x;
+    double size_x;
+    double navigation_x;
+    uint32_t navigation_x_numerator;
+    uint32_t navigation_x_denominator;
+    uint32_t size_x_numerator;
+    uint32_t size_x_denominator;
+    uint32_t color;
+    uint32_t outline_color;
+    uint32_t voice;
+    float gain;
+    uint16_t pos_y;
+    uint8_t hidden;
+    uint8_t mute;
+} war_note_swap_record;
 
-typedef struct war_payload_add_notes {
-    war_note* note;
-    war_note_quad* note_quad;
-    uint32_t count;
-} war_payload_add_notes;
+typedef struct war_note_key {
+    double pos_x;
+    uint32_t idx;
+} war_note_key;
 
-typedef struct war_payload_delete_notes {
-    war_note* note;
-    war_note_quad* note_quad;
+typedef struct war_note_swap {
+    int fd;
+    war_note_swap_record* records;
+    size_t mapped_size;
+    uint32_t page_notes;
+    uint32_t pages_max;
+    uint32_t pages_used;
+    uint32_t* page_count;
+    double* page_min_col;
+    double* page_max_col;
+    // nonzero until a page mapped in from a project file is first read
+    uint64_t* page_checksum;
+    uint32_t notes_count;
+    double margin_cols;
+    double lookahead_cols;
+    war_note_key* keys;
+} war_note_swap;
+
+// index over note_quads bucketing alive notes by the chunk (bar) they start
+// in, sorted by pos_x inside each chunk. culling fields are gathered into
+// chunk order so a column range scan stays on contiguous memory
+typedef struct war_note_chunks {
+    double chunk_cols;
+    uint32_t chunks_max;
+    uint32_t chunks_count;
+    uint32_t span_chunks_max;
+    uint32_t* offset;
+    uint32_t* fill;
+    uint32_t* min_row;
+    uint32_t* max_row;
+    uint64_t* hash;
+    uint64_t* generation;
+    uint32_t* idx;
+    double* pos_x;
+    double* end_x;
+    double* pos_y;
+    war_note_key* keys;
+    uint32_t notes_count;
+    uint64_t synced_generation;
+} war_note_chunks;
+
+// motion index over the visible notes of the active layers. per row the
+// starts and ends are sorted on their own and touching notes are merged into
+// words, starts and ends across rows are sorted by (col, row). built lazily
+// from the chunk order the first time a motion runs after an edit
+typedef struct war_note_rows {
+    uint32_t rows_count;
+    uint32_t* offset;
+    uint32_t* fill;
+    double* start_x;
+    double* end_x;
+    uint32_t* word_offset;
+    double* word_start_x;
+    double* word_end_x;
+    war_note_key* starts;
+    war_note_key* ends;
+    uint32_t notes_count;
+    uint64_t layer;
+    uint64_t synced_generation;
+} war_note_rows;
+
+// immutable snapshot of yanked notes in the register arena, columns relative
+// to the leftmost note and rows to the cursor row at yank time. registers and
+// paste undo nodes share it by index and it is reclaimed at refs == 0
+typedef struct war_note_block {
+    uint32_t offset;
     uint32_t count;
-} war_payload_delete_notes;
-
-typedef struct war_payload_add_notes_same {
-    war_note note;
-    war_note_quad note_quad;
-    uint64_t* ids;
+    uint32_t refs;
+    double width;
+} war_note_block;
+
+typedef struct war_note_registers {
+    war_note_quads* notes;
+    uint32_t notes_used;
+    war_note_block* blocks;
+    uint32_t blocks_max;
+    uint32_t* slot;
+    uint32_t selected;
+    uint8_t pending;
+} war_note_registers;
+
+// rect is [left_col, right_col) x [bottom_row, top_row], a note matches when
+// it overlaps the rect (or doesn't, with NOTE_QUERY_OUTSIDE) and shares a bit
+// with layer
+typedef struct war_note_query {
+    double left_col;
+    double right_col;
+    double bottom_row;
+    double top_row;
+    uint64_t layer;
+    uint32_t flags;
+    uint32_t* hits;
+    uint32_t hits_count;
+    war_note_key* keys;
+} war_note_query;
+
+// count notes delta encoded at offset in the undo payload ring, see
+// war_note_log_put for the format
+typedef struct war_payload_notes {
+    uint64_t offset;
+    uint32_t bytes;
     uint32_t count;
-} war_payload_add_notes_same;
+} war_payload_notes;
 
-typedef struct war_payload_delete_notes_same {
-    war_note note;
-    war_note_quad note_quad;
-    uint64_t* ids;
-    uint32_t count;
-} war_payload_delete_notes_same;
+// cursor over an encoded run of notes, each note is written relative to
+// prev. data is NULL while only sizing a run
+typedef struct war_note_log {
+    uint8_t* data;
+    size_t bytes;
+    war_note_quad prev;
+} war_note_log;
 
 typedef struct war_payload_swap_add_notes {
     char* fname;
@@ -303,17 +452,53 @@ typedef struct war_payload_swap_delete_notes {
     uint32_t count;
 } war_payload_swap_delete_notes;
 
+// block is the pasted block's notes logged relative to pos, it overlays
+// the notes member of the union. ids run first_id .. first_id + repeat *
+// block count - 1
+typedef struct war_payload_paste_notes {
+    war_payload_notes block;
+    uint32_t repeat;
+    double pos_x;
+    double pos_y;
+    double stride_x;
+    uint64_t first_id;
+} war_payload_paste_notes;
+
 typedef union war_payload_union {
-    war_payload_add_note add_note;
-    war_payload_delete_note delete_note;
-    war_payload_add_notes add_notes;
-    war_payload_delete_notes delete_notes;
-    war_payload_add_notes_same add_notes_same;
-    war_payload_delete_notes_same delete_notes_same;
+    war_payload_notes notes;
     war_payload_swap_add_notes swap_add_notes;
     war_payload_swap_delete_notes swap_delete_notes;
+    war_payload_paste_notes paste_notes;
 } war_payload_union;
 
+// net change of the nodes a checkpoint jumps over, logged at offset in the
+// payload ring: removed notes as they were before, added notes as they were
+// after, then the ids that only had hidden or mute flipped, each followed
+// by a byte of WAR_UNDO_JUMP_* bits
+typedef struct war_undo_jump {
+    uint64_t offset;
+    uint32_t bytes;
+    uint32_t removed;
+    uint32_t added;
+    uint32_t flipped;
+} war_undo_jump;
+
+#define WAR_UNDO_JUMP_HIDDEN 1
+#define WAR_UNDO_JUMP_HIDDEN_BEFORE 2
+#define WAR_UNDO_JUMP_HIDDEN_AFTER 4
+#define WAR_UNDO_JUMP_MUTE 8
+#define WAR_UNDO_JUMP_MUTE_BEFORE 16
+#define WAR_UNDO_JUMP_MUTE_AFTER 32
+
+// scratch entry while folding a span of nodes into a jump, note_quad is the
+// note before it was removed or after it was added
+typedef struct war_undo_jump_note {
+    war_note_quad note_quad;
+    uint8_t removed;
+    uint8_t added;
+    uint8_t flags;
+} war_undo_jump_note;
+
 typedef struct war_undo_node {
     uint64_t id;
     uint64_t seq_num;
@@ -326,12 +511,32 @@ typedef struct war_undo_node {
     uint32_t right_col;
     uint32_t top_row;
     uint32_t bottom_row;
-    char* timestamp;
+    // wall clock microseconds
+    uint64_t timestamp;
+    // id of the node current was when this one was pushed, survives the
+    // parent being evicted
+    uint64_t parent_id;
     struct war_undo_node* parent;
     struct war_undo_node* next;
     struct war_undo_node* prev;
     struct war_undo_node* alt_next;
     struct war_undo_node* alt_prev;
+    // age list for eviction, free list link once recycled
+    struct war_undo_node* older;
+    struct war_undo_node* newer;
+    uint64_t payload_end;
+    // parent depth + 1, kept when the parent is evicted
+    uint32_t depth;
+    // checkpoints are anchors for seeks. jump takes the state after parent
+    // back to the state after anchor, it is stale once anchor_id no longer
+    // matches anchor
+    uint8_t checkpoint;
+    struct war_undo_node* anchor;
+    uint64_t anchor_id;
+    war_undo_jump jump;
+    // index + 1 into note_snapshots, stale once that snapshot's node_id no
+    // longer matches
+    uint32_t snapshot;
 } war_undo_node;
 
 typedef struct war_undo_tree {
@@ -340,8 +545,322 @@ typedef struct war_undo_tree {
     uint64_t next_id;
     uint64_t next_seq_num;
     uint32_t next_branch_id;
+    // nodes are recycled through free, when it runs dry the oldest node is
+    // evicted. payloads live in a byte ring, head and tail only grow and
+    // the tail follows the payload_end of each evicted node
+    war_undo_node* nodes;
+    uint32_t nodes_max;
+    uint32_t nodes_used;
+    war_undo_node* free;
+    war_undo_node* oldest;
+    war_undo_node* newest;
+    uint8_t* payload;
+    uint64_t payload_size;
+    uint64_t payload_head;
+    uint64_t payload_tail;
+    // next is the child redo follows, children and roots are siblings
+    // through alt_next and alt_prev. root is the root redo follows from
+    // current NULL. live seq_nums fit in nodes_max, so
+    // seq_index[seq_num % nodes_max] finds a node without a scan
+    war_undo_node** seq_index;
+    war_undo_node** seek_path;
+    uint32_t checkpoint_nodes;
+    war_undo_jump_note* jump_notes;
+    uint32_t jump_notes_max;
+    uint32_t* jump_map;
+    uint32_t jump_map_mask;
+    // an add or delete joins the one before it when they are less than
+    // join_us apart, joined_us is when the last one was made. 0 never joins
+    uint64_t join_us;
+    uint64_t joined_us;
+    // where encoding the log of join_prev_id left off, so the next join
+    // appends without decoding it again
+    war_note_quad join_prev;
+    uint64_t join_prev_id;
+    uint32_t join_prev_bytes;
 } war_undo_tree;
 
+// run of packed notes in the snapshot arena, one bar of resident notes or
+// one swap page. every snapshot that finds the bar or page unchanged holds
+// a reference and it is reclaimed at refs == 0
+typedef struct war_note_snapshot_chunk {
+    uint32_t offset;
+    uint32_t count;
+    uint32_t refs;
+    // note_chunks generation of the bar it was packed from
+    uint64_t generation;
+} war_note_snapshot_chunk;
+
+// every note as it was after node_id. chunks holds chunk + 1 per bar then
+// per swap page, 0 for an empty one
+typedef struct war_note_snapshot {
+    uint64_t node_id;
+    // note_quads generation the store matched it at
+    uint64_t generation;
+    uint32_t notes_count;
+    uint32_t bars_count;
+    uint32_t pages_count;
+    uint32_t* chunks;
+} war_note_snapshot;
+
+// snapshots are reused in a ring, newest is index + 1 of the one the next
+// snapshot shares chunks with. free is a stack of unreferenced chunks and
+// keys is scratch for sorting chunks by offset. watched_id is the node
+// current has been since watched_since
+typedef struct war_note_snapshots {
+    war_note_swap_record* records;
+    uint32_t records_max;
+    uint32_t records_used;
+    war_note_snapshot_chunk* chunks;
+    uint32_t chunks_max;
+    uint32_t* free;
+    uint32_t free_count;
+    war_note_key* keys;
+    war_note_snapshot* snapshots;
+    uint32_t snapshots_max;
+    uint32_t next;
+    uint32_t newest;
+    uint32_t every_nodes;
+    uint64_t idle_us;
+    uint64_t watched_id;
+    uint64_t watched_since;
+} war_note_snapshots;
+
+enum war_undofile_records {
+    UNDOFILE_NODE = 1,
+    UNDOFILE_CURRENT = 2,
+    UNDOFILE_APPEND = 3,
+};
+
+#define WAR_UNDOFILE_MAGIC "WARUNDO"
+#define WAR_UNDOFILE_VERSION 1
+
+typedef struct __attribute__((packed)) war_undofile_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+} war_undofile_header;
+
+// one per pushed node, current move or run of notes joined into a node
+// already written. the note log, or what the joins added to it, follows
+// the record
+typedef struct __attribute__((packed)) war_undofile_record {
+    uint32_t type;
+    uint32_t command;
+    uint64_t id;
+    uint64_t parent_id;
+    uint64_t seq_num;
+    uint64_t timestamp;
+    uint32_t branch_id;
+    double cursor_pos_x;
+    double cursor_pos_y;
+    uint32_t left_col;
+    uint32_t right_col;
+    uint32_t top_row;
+    uint32_t bottom_row;
+    // notes.offset is meaningless on disk, notes.bytes of log follow. an
+    // append carries the bytes and count it adds
+    war_payload_union payload;
+} war_undofile_record;
+
+// the render thread appends records to queue, the writer thread drains it
+// to fd in batches. head and tail only grow, fd is swapped under mutex
+typedef struct war_undofile {
+    int fd;
+    char* path;
+    uint32_t path_limit;
+    uint8_t* queue;
+    uint64_t queue_size;
+    _Atomic uint64_t queue_head;
+    _Atomic uint64_t queue_tail;
+    _Atomic uint8_t running;
+    uint64_t flush_us;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    // render thread side, what has been queued so far
+    uint64_t synced_seq_num;
+    uint64_t synced_current_id;
+    // the last node queued and how much of its log, joins grow it after
+    uint64_t synced_node_id;
+    uint32_t synced_node_bytes;
+    uint32_t synced_node_count;
+    // a log bigger than the free queue goes out over several frames, the
+    // node is not freed before its last byte is queued
+    war_undo_node* stream_node;
+    uint32_t stream_done;
+    uint32_t stream_bytes;
+} war_undofile;
+
+enum war_project_sections {
+    PROJECT_SONG = 1,
+    PROJECT_LAYERS = 2,
+    PROJECT_VIEWS = 3,
+    PROJECT_SAMPLES = 4,
+    PROJECT_PAGES = 5,
+    PROJECT_RECORDS = 6,
+    PROJECT_SECTIONS_COUNT = 6,
+};
+
+#define WAR_PROJECT_MAGIC "WARPROJ"
+#define WAR_PROJECT_VERSION 2
+// records start and end on a boundary every mmap page size divides
+#define WAR_PROJECT_ALIGN 65536
+#define WAR_CHECKSUM_SEED 0xcbf29ce484222325ull
+// autosave granularity, notes belong to the chunk their start falls in and
+// everything past the last chunk to the last chunk
+#define WAR_PROJECT_CHUNK_COLS 64.0
+#define WAR_PROJECT_CHUNKS_MAX 65536
+#define WAR_PROJECT_SEGMENT_MAGIC "WARSEGM"
+
+typedef struct __attribute__((packed)) war_project_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t sections_count;
+    uint64_t table_offset;
+    uint64_t table_checksum;
+    // newest autosave segment, rewritten in place once it is on disk
+    uint64_t log_offset;
+    uint64_t log_checksum;
+} war_project_header;
+
+// sections are 8 byte aligned and padded so they can be used in place.
+// records carry no checksum of their own, every page in the page table does
+typedef struct __attribute__((packed)) war_project_section {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+} war_project_section;
+
+typedef struct __attribute__((packed)) war_project_song {
+    double bpm;
+    double columns_per_beat;
+    uint64_t note_next_id;
+    uint64_t undo_current_id;
+    double cursor_pos_x;
+    double cursor_pos_y;
+    uint32_t left_col;
+    uint32_t bottom_row;
+    uint32_t note_count;
+    uint32_t views_count;
+    uint32_t samples_count;
+    uint32_t page_notes;
+    uint32_t pages_count;
+    uint32_t reserved;
+} war_project_song;
+
+// one per mapped sample, name_size bytes of file name follow padded to 8
+typedef struct __attribute__((packed)) war_project_sample {
+    uint64_t id;
+    uint32_t note;
+    uint32_t layer;
+    uint32_t name_size;
+    uint32_t reserved;
+} war_project_sample;
+
+// autosaves append segments after the sections, each holding the whole of
+// every chunk dirtied since the one before it. chunks follow the segment
+// header, then their records, padded to 8. a chunk in a newer segment
+// replaces the same chunk in older ones and in the base pages
+typedef struct __attribute__((packed)) war_project_segment {
+    char magic[8];
+    uint64_t prev_offset;
+    uint32_t chunks_count;
+    uint32_t records_count;
+    war_project_song song;
+    // of everything above and everything after the header
+    uint64_t checksum;
+} war_project_segment;
+
+typedef struct __attribute__((packed)) war_project_segment_chunk {
+    uint32_t chunk;
+    uint32_t count;
+    uint64_t reserved;
+} war_project_segment_chunk;
+
+// the open project. its records are mapped copy on write over the front of
+// the note swap so only pages the view faults in are ever read, the page
+// table here is scratch for saving
+typedef struct war_project {
+    char* tmp_path;
+    uint32_t path_limit;
+    uint32_t pages_max;
+    uint32_t* page_count;
+    double* page_min_col;
+    double* page_max_col;
+    uint64_t* page_checksum;
+    war_note_swap_record* page;
+    size_t mapped_size;
+    // log left by autosaves when the file was loaded
+    uint64_t log_offset;
+    uint64_t log_bytes;
+    // a bit per chunk some segment replaced
+    uint64_t* seen;
+} war_project;
+
+// the render thread queues segments of dirty chunks every
+// WR_PROJECT_AUTOSAVE_US, the worker appends them to the project file and
+// points the header at the newest. once the log outgrows
+// WR_PROJECT_COMPACT_BYTES the worker rewrites the file from itself
+typedef struct war_autosave {
+    int fd;
+    char* path;
+    uint32_t path_limit;
+    uint8_t* queue;
+    uint64_t queue_size;
+    _Atomic uint64_t queue_head;
+    _Atomic uint64_t queue_tail;
+    _Atomic uint8_t running;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    // worker side, compaction borrows the project's page table and staging
+    // page, every write of the project file is made with mutex held
+    uint64_t log_offset;
+    uint64_t log_bytes;
+    uint64_t compact_bytes;
+    uint64_t* seen;
+    // render thread side, records per dirty chunk then where they go
+    uint32_t* chunk_at;
+    uint64_t every_us;
+    uint64_t synced_us;
+    // nothing is appended until the file has been written whole once
+    uint8_t base;
+} war_autosave;
+
+// a note as it is written out, sorted without going back to the store
+typedef struct war_note_text_key {
+    double pos_x;
+    double pos_y;
+    double size_x;
+    uint64_t id;
+    uint64_t layer;
+    float gain;
+    uint8_t mute;
+    uint8_t hidden;
+} war_note_text_key;
+
+#define WAR_NOTE_TEXT_DENOMINATOR_MAX 64
+
+// notes as text for diffing and scripts, one per line:
+//   row start length layer gain [mute] [hidden]
+// start and length are columns, whole, n/d or decimal, layer is the layer
+// mask. both ways stream through buffer. export sorts a window of chunks at
+// a time through keys, import hands notes to note_quads batch_max at a time
+typedef struct war_note_text {
+    char* buffer;
+    uint32_t buffer_size;
+    war_note_quad* batch;
+    uint32_t batch_max;
+    war_note_text_key* keys;
+    uint32_t keys_max;
+    uint32_t* chunk_count;
+    // bigger imports clear the undo history instead of becoming one node
+    uint32_t undo_notes_max;
+} war_note_text;
+
 typedef struct war_lua_context {
     // audio
     _Atomic int A_SAMPLE_RATE;
@@ -384,6 +903,20 @@ typedef struct war_lua_context {
     _Atomic int WR_KEYSYM_COUNT;
     _Atomic int WR_MOD_COUNT;
     _Atomic int WR_NOTE_QUADS_MAX;
+    _Atomic int WR_NOTE_MAP_SLOTS;
+    _Atomic int WR_NOTE_SWAP_PAGE_NOTES;
+    _Atomic int WR_NOTE_SWAP_PAGES_MAX;
+    _Atomic double WR_NOTE_SWAP_MARGIN_COLS;
+    _Atomic double WR_NOTE_SWAP_LOOKAHEAD_COLS;
+    _Atomic int WR_NOTE_CHUNKS_MAX;
+    _Atomic double WR_NOTE_CHUNK_BEATS;
+    _Atomic int WR_NOTE_REGISTER_NOTES_MAX;
+    _Atomic int WR_NOTE_BLOCKS_MAX;
+    _Atomic int WR_NOTE_SNAPSHOTS_MAX;
+    _Atomic int WR_NOTE_SNAPSHOT_CHUNKS_MAX;
+    _Atomic int WR_NOTE_SNAPSHOT_NOTES_MAX;
+    _Atomic int WR_NOTE_SNAPSHOT_NODES;
+    _Atomic int WR_NOTE_SNAPSHOT_IDLE_US;
     _Atomic int WR_STATUS_BAR_COLS_MAX;
     _Atomic int WR_TEXT_QUADS_MAX;
     _Atomic int WR_QUADS_MAX;
@@ -398,8 +931,24 @@ typedef struct war_lua_context {
     _Atomic int WR_REPEAT_DELAY_US;
     _Atomic int WR_REPEAT_RATE_US;
     _Atomic int WR_CURSOR_BLINK_DURATION_US;
+    _Atomic int WR_TIMING_OVERLAY;
+    _Atomic int WR_PRESENT_LEAD_US;
+    _Atomic int WR_RENDER_MARGIN_US;
     _Atomic double WR_FPS;
-    _Atomic int WR_UNDO_NOTES_BATCH_MAX;
+    _Atomic int WR_UNDO_PAYLOAD_BYTES;
+    _Atomic int WR_UNDO_CHECKPOINT_NODES;
+    _Atomic int WR_UNDO_JUMP_NOTES_MAX;
+    _Atomic int WR_UNDO_JOIN_US;
+    _Atomic int WR_UNDOFILE_QUEUE_BYTES;
+    _Atomic int WR_UNDOFILE_FLUSH_US;
+    _Atomic int WR_PROJECT_PAGES_MAX;
+    _Atomic int WR_PROJECT_AUTOSAVE_US;
+    _Atomic int WR_PROJECT_COMPACT_BYTES;
+    _Atomic int WR_PROJECT_QUEUE_BYTES;
+    _Atomic int WR_NOTE_TEXT_BUFFER_BYTES;
+    _Atomic int WR_NOTE_TEXT_BATCH;
+    _Atomic int WR_NOTE_TEXT_KEYS_MAX;
+    _Atomic int WR_NOTE_TEXT_UNDO_NOTES_MAX;
     _Atomic int WR_INPUT_SEQUENCE_LENGTH_MAX;
     _Atomic int ROLL_POSITION_X_Y;
     // pool
@@ -665,6 +1214,29 @@ typedef struct war_color_context {
     uint32_t colors_count;
 } war_color_context;
 
+enum war_timestamp {
+    TIMESTAMP_BEGIN = 0,
+    TIMESTAMP_CULL = 1,
+    TIMESTAMP_GRID = 2,
+    TIMESTAMP_QUADS = 3,
+    TIMESTAMP_TEXT = 4,
+    TIMESTAMP_COUNT = 5,
+};
+
+// one recorded frame, microseconds. gpu spans are the gaps between the
+// timestamps written after each part, latency runs from the commit to the
+// compositor's presentation feedback
+typedef struct war_frame_stats {
+    uint64_t seq;
+    float wayland_us;
+    float fence_us;
+    float upload_us;
+    float build_us;
+    float gpu_us[TIMESTAMP_COUNT];
+    float latency_us;
+    float refresh_us;
+} war_frame_stats;
+
 typedef struct war_window_render_context {
     uint64_t now;
     char* layers_active;
@@ -699,7 +1271,7 @@ typedef struct war_window_render_context {
     uint32_t t_cursor_width_whole_number;
     uint32_t t_cursor_width_sub_cells;
     uint32_t t_cursor_width_sub_col;
-    uint32_t gridline_splits[MAX_GRIDLINE_SPLITS];
+    uint32_t gridline_splits[MAX_GRIDLINE_SPLITS]; // largest first, 0 unused
     uint32_t left_col;
     uint32_t bottom_row;
     uint32_t right_col;
@@ -750,6 +1322,23 @@ typedef struct war_window_render_context {
     uint64_t sleep_duration_us;
     bool end_window_render;
     bool trinity;
+    bool redraw;             // something visible changed, record a frame
+    bool present;            // recorded but not committed yet
+    bool frame_pending;      // committed, waiting on wl_callback::done
+    bool frame_callback;     // wl_callback::done came, record at record_at_us
+    uint64_t record_at_us;
+    uint64_t present_at_us;  // predicted vblank of the recorded frame, 0 none
+    uint64_t vblank_us;      // last presentation, monotonic clock
+    uint64_t refresh_us;     // 0 until presentation feedback gave one
+    uint64_t present_lead_us;
+    uint64_t render_margin_us;
+    float damage[4];         // x0, y0, x1, y1 buffer pixels, empty if x0 >= x1
+    float present_damage[4]; // damage of the recorded frame
+    war_frame_stats frame_stats[max_frame_stats]; // ring, seq % max
+    uint64_t frame_seq;                           // the last one recorded
+    bool timing_overlay;
+    uint64_t timing_text_time;
+    char timing_text[96];
     bool fullscreen;
     uint32_t light_gray_hex;
     uint32_t darker_light_gray_hex;
@@ -850,6 +1439,7 @@ typedef struct war_status_context {
     uint32_t bottom_size;
     // misc
     uint32_t capacity;
+    uint64_t drawn_hash; // visible text as of the last damage
 } war_status_context;
 
 typedef struct war_play_context {
@@ -957,33 +1547,43 @@ typedef enum war_quad_flags {
     QUAD_LINE = 1 << 0,
     QUAD_OUTLINE = 1 << 1,
     QUAD_GRID = 1 << 2,
+    QUAD_HIDDEN = 1 << 3,
+    QUAD_MUTE = 1 << 4,
 } war_quad_flags;
 
-typedef struct war_quad_vertex {
-    float corner[2];
-    float pos[3];
+// one per quad, war_quad_vertex.glsl makes the corners from gl_VertexIndex.
+// thicknesses are half floats and depth is a unorm byte, which keeps layers
+// apart and in order while LAYER_COUNT is at most 255
+typedef struct war_quad_instance {
+    float pos[2];
     float span[2];
     uint32_t color;
-    float outline_thickness;
     uint32_t outline_color;
-    float line_thickness[2];
-    uint32_t flags;
-    uint32_t _pad;
-} war_quad_vertex;
-
-typedef struct war_quad_instance {
-    uint32_t x;
-    uint32_t y;
-    uint32_t color;
-    uint32_t flags;
+    uint16_t line_thickness[2];
+    uint16_t outline_thickness;
+    uint8_t depth;
+    uint8_t flags;
 } war_quad_instance;
 
+// the resident notes as the gpu has them, an instance per note_quads slot in
+// a device local buffer. shadow mirrors that buffer so a sync after an edit
+// only copies the runs of slots whose instance changed
+typedef struct war_note_instances {
+    war_quad_instance* shadow;
+    VkBufferCopy* copies;
+    uint32_t copies_count;
+    uint32_t count;
+    // slots the buffer holds an instance for, the rest are garbage
+    uint32_t resident;
+    uint64_t synced_generation;
+} war_note_instances;
+
 typedef struct war_quad_push_constants {
     float bottom_left[2];
     float physical_size[2];
     float cell_size[2];
     float zoom;
-    uint _pad1;
+    float mute_alpha;
     float cell_offsets[2];
     float scroll_margin[2];
     float anchor_cell[2];
@@ -991,32 +1591,92 @@ typedef struct war_quad_push_constants {
     uint32_t _pad2[2];
 } war_quad_push_constants;
 
+enum war_grid_colors {
+    GRID_WHITE = 0,
+    GRID_DARKER_LIGHT_GRAY = 1,
+    GRID_RED = 2,
+    GRID_BLACK = 3,
+    GRID_DARK_GRAY = 4,
+    GRID_FULL_WHITE = 5,
+    GRID_SUPER_LIGHT_GRAY = 6,
+    GRID_COLOR_COUNT = 8,
+};
+
+// everything war_grid_fragment.glsl needs to draw the gridlines, piano, line
+// numbers and status bars without a quad each. splits holds gridline_splits
+// as 16 bit halves, largest first, and their colors are the first four slots
+typedef struct war_grid_push_constants {
+    float bottom_left[2];
+    float physical_size[2];
+    float cell_size[2];
+    float zoom;
+    uint32_t hud_state;
+    float cell_offsets[2];
+    float top_right[2];
+    float viewport[2];
+    float horizontal_thickness;
+    float vertical_thickness;
+    float gutter_thickness;
+    float max_row;
+    float depth[2];
+    uint32_t splits[2];
+    float gutter_inset;
+    uint32_t _pad1;
+    uint32_t colors[GRID_COLOR_COUNT];
+} war_grid_push_constants;
+
+typedef struct war_note_cull_push_constants {
+    float bottom_left[2];
+    float top_right[2];
+    uint32_t count;
+    uint32_t _pad1[3];
+} war_note_cull_push_constants;
+
+// what the HUD text of a frame was built from. the last max_hud_text_quads of
+// every frame's text region keep that text until the key changes
+typedef struct war_hud_key {
+    uint32_t left_col;
+    uint32_t bottom_row;
+    uint32_t top_row;
+    uint32_t status_cols;
+    uint32_t num_rows_for_status_bars;
+    uint32_t hud_state;
+    uint64_t status_hash;
+    float text_thickness;
+    float text_feather;
+    float text_thickness_bold;
+    float text_feather_bold;
+    uint32_t built;
+} war_hud_key;
+
 typedef struct war_vulkan_context {
     //-------------------------------------------------------------------------
     // QUAD PIPELINE
     //-------------------------------------------------------------------------
-    int dmabuf_fd;
     VkInstance instance;
     VkPhysicalDevice physical_device;
     VkDevice device;
     VkQueue queue;
     uint32_t queue_family_index;
-    VkImage image;
-    VkDeviceMemory memory;
     VkCommandPool cmd_pool;
-    VkCommandBuffer cmd_buffer;
     VkRenderPass render_pass;
-    VkFramebuffer frame_buffer;
+    // per frame in flight, each color image is a dmabuf behind a wl_buffer
+    int dmabuf_fds[max_frames];
+    VkImage images[max_frames];
+    VkDeviceMemory memories[max_frames];
+    VkImageView image_views[max_frames];
+    VkImage depth_images[max_frames];
+    VkDeviceMemory depth_image_memories[max_frames];
+    VkImageView depth_image_views[max_frames];
+    VkFramebuffer frame_buffers[max_frames];
+    VkCommandBuffer cmd_buffers[max_frames];
+    VkFence in_flight_fences[max_frames];
+    uint32_t current_frame; // the last one recorded
     VkPipeline quad_pipeline;
     VkPipeline transparent_quad_pipeline;
     VkPipelineLayout pipeline_layout;
-    VkImageView image_view;
     VkSemaphore image_available_semaphore;
     VkSemaphore render_finished_semaphore;
-    VkBuffer quads_vertex_buffer;
-    VkDeviceMemory quads_vertex_buffer_memory;
-    VkBuffer quads_index_buffer;
-    VkDeviceMemory quads_index_buffer_memory;
     VkBuffer quads_instance_buffer;
     VkDeviceMemory quads_instance_buffer_memory;
     VkImage texture_image;
@@ -1025,11 +1685,24 @@ typedef struct war_vulkan_context {
     VkSampler texture_sampler;
     VkDescriptorSet texture_descriptor_set;
     VkDescriptorPool texture_descriptor_pool;
-    VkFence* in_flight_fences;
-    void* quads_vertex_buffer_mapped;
-    void* quads_index_buffer_mapped;
     void* quads_instance_buffer_mapped;
-    uint32_t current_frame;
+    VkPipeline grid_pipeline;
+    VkPipelineLayout grid_pipeline_layout;
+    VkBuffer note_instance_buffer;
+    VkDeviceMemory note_instance_buffer_memory;
+    VkBuffer note_staging_buffer;
+    VkDeviceMemory note_staging_buffer_memory;
+    void* note_staging_buffer_mapped;
+    VkDeviceSize note_staging_frame_size;
+    VkBuffer note_visible_buffer;
+    VkDeviceMemory note_visible_buffer_memory;
+    VkBuffer note_draw_buffer;
+    VkDeviceMemory note_draw_buffer_memory;
+    VkDescriptorSetLayout note_cull_descriptor_set_layout;
+    VkDescriptorPool note_cull_descriptor_pool;
+    VkDescriptorSet note_cull_descriptor_set;
+    VkPipelineLayout note_cull_pipeline_layout;
+    VkPipeline note_cull_pipeline;
 
     //-------------------------------------------------------------------------
     // TEXT PIPELINE
@@ -1068,6 +1741,11 @@ typedef struct war_vulkan_context {
     void* text_vertex_buffer_mapped;
     void* text_instance_buffer_mapped;
     void* text_index_buffer_mapped;
+    VkQueryPool timestamp_query_pool; // VK_NULL_HANDLE without timestamps
+    float timestamp_period;           // nanoseconds per tick
+    uint64_t frame_seq[max_frames];   // stats seq recorded into each frame
+    war_hud_key hud_text_keys[max_frames];
+    uint32_t hud_text_indices_count[max_frames];
 } war_vulkan_context;
 
 typedef struct war_drm_context {
@@ -1169,7 +1847,18 @@ struct war_env {
     war_command_context* ctx_command;
     war_status_context* ctx_status;
     war_undo_tree* undo_tree;
+    war_undofile* undofile;
     war_note_quads* note_quads;
+    war_note_swap* note_swap;
+    war_note_chunks* note_chunks;
+    war_note_query* note_query;
+    war_note_rows* note_rows;
+    war_note_registers* note_registers;
+    war_note_snapshots* note_snapshots;
+    war_project* project;
+    war_autosave* autosave;
+    war_note_text* note_text;
+    war_map_wav* map_wav;
     war_pool* pool_wr;
     war_vulkan_context* ctx_vk;
     war_file* capture_wav;
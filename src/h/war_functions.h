@@ -28,7 +28,12 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <float.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 #include <luajit-2.1/lauxlib.h>
 #include <luajit-2.1/lua.h>
 #include <luajit-2.1/lualib.h>
@@ -37,7 +42,10 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
 #include <xkbcommon/xkbcommon.h>
@@ -117,6 +125,17 @@ static inline int war_load_lua_config(war_lua_context* ctx_lua,
     LOAD_INT(WR_CALLBACK_SIZE)
     LOAD_INT(WR_MOD_COUNT)
     LOAD_INT(WR_NOTE_QUADS_MAX)
+    LOAD_INT(WR_NOTE_MAP_SLOTS)
+    LOAD_INT(WR_NOTE_SWAP_PAGE_NOTES)
+    LOAD_INT(WR_NOTE_SWAP_PAGES_MAX)
+    LOAD_INT(WR_NOTE_CHUNKS_MAX)
+    LOAD_INT(WR_NOTE_REGISTER_NOTES_MAX)
+    LOAD_INT(WR_NOTE_BLOCKS_MAX)
+    LOAD_INT(WR_NOTE_SNAPSHOTS_MAX)
+    LOAD_INT(WR_NOTE_SNAPSHOT_CHUNKS_MAX)
+    LOAD_INT(WR_NOTE_SNAPSHOT_NOTES_MAX)
+    LOAD_INT(WR_NOTE_SNAPSHOT_NODES)
+    LOAD_INT(WR_NOTE_SNAPSHOT_IDLE_US)
     LOAD_INT(WR_STATUS_BAR_COLS_MAX)
     LOAD_INT(WR_TEXT_QUADS_MAX)
     LOAD_INT(WR_QUADS_MAX)
@@ -126,9 +145,25 @@ static inline int war_load_lua_config(war_lua_context* ctx_lua,
     LOAD_INT(WR_UNDO_NODES_MAX)
     LOAD_INT(WR_TIMESTAMP_LENGTH_MAX)
     LOAD_INT(WR_CURSOR_BLINK_DURATION_US)
+    LOAD_INT(WR_TIMING_OVERLAY)
+    LOAD_INT(WR_PRESENT_LEAD_US)
+    LOAD_INT(WR_RENDER_MARGIN_US)
     LOAD_INT(WR_REPEAT_DELAY_US)
     LOAD_INT(WR_REPEAT_RATE_US)
-    LOAD_INT(WR_UNDO_NOTES_BATCH_MAX)
+    LOAD_INT(WR_UNDO_PAYLOAD_BYTES)
+    LOAD_INT(WR_UNDO_CHECKPOINT_NODES)
+    LOAD_INT(WR_UNDO_JUMP_NOTES_MAX)
+    LOAD_INT(WR_UNDO_JOIN_US)
+    LOAD_INT(WR_UNDOFILE_QUEUE_BYTES)
+    LOAD_INT(WR_UNDOFILE_FLUSH_US)
+    LOAD_INT(WR_PROJECT_PAGES_MAX)
+    LOAD_INT(WR_PROJECT_AUTOSAVE_US)
+    LOAD_INT(WR_PROJECT_COMPACT_BYTES)
+    LOAD_INT(WR_PROJECT_QUEUE_BYTES)
+    LOAD_INT(WR_NOTE_TEXT_BUFFER_BYTES)
+    LOAD_INT(WR_NOTE_TEXT_BATCH)
+    LOAD_INT(WR_NOTE_TEXT_KEYS_MAX)
+    LOAD_INT(WR_NOTE_TEXT_UNDO_NOTES_MAX)
     LOAD_INT(WR_INPUT_SEQUENCE_LENGTH_MAX)
     LOAD_INT(VK_ATLAS_HEIGHT)
     LOAD_INT(VK_ATLAS_WIDTH)
@@ -188,6 +223,9 @@ static inline int war_load_lua_config(war_lua_context* ctx_lua,
     LOAD_DOUBLE(WR_FPS)
     LOAD_DOUBLE(WR_PLAY_CALLBACK_FPS)
     LOAD_DOUBLE(WR_CAPTURE_CALLBACK_FPS)
+    LOAD_DOUBLE(WR_NOTE_SWAP_MARGIN_COLS)
+    LOAD_DOUBLE(WR_NOTE_SWAP_LOOKAHEAD_COLS)
+    LOAD_DOUBLE(WR_NOTE_CHUNK_BEATS)
 
 #undef LOAD_DOUBLE
 
@@ -358,10 +396,36 @@ static inline size_t war_get_pool_wr_size(war_pool* pool,
             /* --- WR-specific structs --- */
             else if (strcmp(type, "war_fsm_context") == 0)
                 type_size = sizeof(war_fsm_context);
-            else if (strcmp(type, "war_quad_vertex") == 0)
-                type_size = sizeof(war_quad_vertex);
+            else if (strcmp(type, "war_quad_instance") == 0)
+                type_size = sizeof(war_quad_instance);
+            else if (strcmp(type, "war_note_instances") == 0)
+                type_size = sizeof(war_note_instances);
+            else if (strcmp(type, "VkBufferCopy") == 0)
+                type_size = sizeof(VkBufferCopy);
             else if (strcmp(type, "war_note_quads") == 0)
                 type_size = sizeof(war_note_quads);
+            else if (strcmp(type, "war_note_swap") == 0)
+                type_size = sizeof(war_note_swap);
+            else if (strcmp(type, "war_note_key") == 0)
+                type_size = sizeof(war_note_key);
+            else if (strcmp(type, "war_note_chunks") == 0)
+                type_size = sizeof(war_note_chunks);
+            else if (strcmp(type, "war_note_query") == 0)
+                type_size = sizeof(war_note_query);
+            else if (strcmp(type, "war_note_rows") == 0)
+                type_size = sizeof(war_note_rows);
+            else if (strcmp(type, "war_note_registers") == 0)
+                type_size = sizeof(war_note_registers);
+            else if (strcmp(type, "war_note_block") == 0)
+                type_size = sizeof(war_note_block);
+            else if (strcmp(type, "war_note_snapshots") == 0)
+                type_size = sizeof(war_note_snapshots);
+            else if (strcmp(type, "war_note_snapshot") == 0)
+                type_size = sizeof(war_note_snapshot);
+            else if (strcmp(type, "war_note_snapshot_chunk") == 0)
+                type_size = sizeof(war_note_snapshot_chunk);
+            else if (strcmp(type, "war_note_swap_record") == 0)
+                type_size = sizeof(war_note_swap_record);
             else if (strcmp(type, "war_function_union") == 0)
                 type_size = sizeof(war_function_union);
             else if (strcmp(type, "void (*)(war_env*)") == 0)
@@ -394,6 +458,20 @@ static inline size_t war_get_pool_wr_size(war_pool* pool,
                 type_size = sizeof(war_color_context);
             else if (strcmp(type, "war_undo_tree") == 0)
                 type_size = sizeof(war_undo_tree);
+            else if (strcmp(type, "war_undofile") == 0)
+                type_size = sizeof(war_undofile);
+            else if (strcmp(type, "war_project") == 0)
+                type_size = sizeof(war_project);
+            else if (strcmp(type, "war_autosave") == 0)
+                type_size = sizeof(war_autosave);
+            else if (strcmp(type, "war_note_text") == 0)
+                type_size = sizeof(war_note_text);
+            else if (strcmp(type, "war_note_text_key") == 0)
+                type_size = sizeof(war_note_text_key);
+            else if (strcmp(type, "war_note_quad") == 0)
+                type_size = sizeof(war_note_quad);
+            else if (strcmp(type, "war_undo_jump_note") == 0)
+                type_size = sizeof(war_undo_jump_note);
             else if (strcmp(type, "war_payload_union") == 0)
                 type_size = sizeof(war_payload_union);
 
@@ -436,41 +514,5523 @@ static inline void* war_pool_alloc(war_pool* pool, size_t size) {
     return ptr;
 }
 
-static inline void war_layer_flux(war_window_render_context* ctx_wr,
-                                  war_atomics* atomics,
-                                  war_play_context* ctx_play,
-                                  war_color_context* ctx_color) {
-    uint64_t layer = ctx_play->note_layers[(int)ctx_wr->cursor_pos_y];
-    atomic_store(&atomics->layer, layer);
-    ctx_wr->layers_active_count = __builtin_popcountll(layer);
-    switch (ctx_wr->layers_active_count) {
-    case 0: {
-        ctx_wr->color_cursor = ctx_color->white_hex;
-        ctx_wr->color_cursor_transparent = ctx_color->white_hex;
-        ctx_wr->color_note_outline_default = ctx_color->full_white_hex;
+static inline void war_note_quads_set(war_note_quads* note_quads,
+                                      uint32_t i,
+                                      war_note_quad* note_quad) {
+    note_quads->alive[i] = note_quad->alive;
+    note_quads->id[i] = note_quad->id;
+    note_quads->pos_x[i] = note_quad->pos_x;
+    note_quads->pos_y[i] = note_quad->pos_y;
+    note_quads->layer[i] = note_quad->layer;
+    note_quads->size_x[i] = note_quad->size_x;
+    note_quads->navigation_x[i] = note_quad->navigation_x;
+    note_quads->navigation_x_numerator[i] = note_quad->navigation_x_numerator;
+    note_quads->navigation_x_denominator[i] =
+        note_quad->navigation_x_denominator;
+    note_quads->size_x_numerator[i] = note_quad->size_x_numerator;
+    note_quads->size_x_denominator[i] = note_quad->size_x_denominator;
+    note_quads->color[i] = note_quad->color;
+    note_quads->outline_color[i] = note_quad->outline_color;
+    note_quads->gain[i] = note_quad->gain;
+    note_quads->voice[i] = note_quad->voice;
+    note_quads->hidden[i] = note_quad->hidden;
+    note_quads->mute[i] = note_quad->mute;
+}
+
+static inline void war_note_quads_get(war_note_quads* note_quads,
+                                      uint32_t i,
+                                      war_note_quad* note_quad) {
+    note_quad->alive = note_quads->alive[i];
+    note_quad->id = note_quads->id[i];
+    note_quad->pos_x = note_quads->pos_x[i];
+    note_quad->pos_y = note_quads->pos_y[i];
+    note_quad->layer = note_quads->layer[i];
+    note_quad->size_x = note_quads->size_x[i];
+    note_quad->navigation_x = note_quads->navigation_x[i];
+    note_quad->navigation_x_numerator = note_quads->navigation_x_numerator[i];
+    note_quad->navigation_x_denominator =
+        note_quads->navigation_x_denominator[i];
+    note_quad->size_x_numerator = note_quads->size_x_numerator[i];
+    note_quad->size_x_denominator = note_quads->size_x_denominator[i];
+    note_quad->color = note_quads->color[i];
+    note_quad->outline_color = note_quads->outline_color[i];
+    note_quad->gain = note_quads->gain[i];
+    note_quad->voice = note_quads->voice[i];
+    note_quad->hidden = note_quads->hidden[i];
+    note_quad->mute = note_quads->mute[i];
+}
+
+static inline uint32_t war_note_map_hash(uint64_t id) {
+    return (uint32_t)((id * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+static inline void war_note_map_rebuild(war_note_quads* note_quads) {
+    memset(note_quads->map, 0, sizeof(uint32_t) * (note_quads->map_mask + 1));
+    note_quads->map_used = 0;
+    for (uint32_t i = 0; i < note_quads->count; i++) {
+        if (!note_quads->alive[i]) { continue; }
+        uint32_t slot = war_note_map_hash(note_quads->id[i]);
+        while (note_quads->map[slot & note_quads->map_mask]) { slot++; }
+        note_quads->map[slot & note_quads->map_mask] = i + 1;
+        note_quads->map_used++;
+    }
+}
+
+// i must already be below count. stale entries count towards the load,
+// past 3/4 a rebuild sweeps them out and picks up i with the rest
+static inline void war_note_map_insert(war_note_quads* note_quads,
+                                       uint32_t i) {
+    if (!note_quads->map) { return; }
+    if (note_quads->map_used + 1 > (note_quads->map_mask + 1) / 4 * 3) {
+        war_note_map_rebuild(note_quads);
+        return;
+    }
+    uint32_t slot = war_note_map_hash(note_quads->id[i]);
+    while (note_quads->map[slot & note_quads->map_mask]) { slot++; }
+    note_quads->map[slot & note_quads->map_mask] = i + 1;
+    note_quads->map_used++;
+}
+
+// index of the alive resident note with id, UINT32_MAX when it isn't
+// resident
+static inline uint32_t war_note_quads_find(war_note_quads* note_quads,
+                                           uint64_t id) {
+    uint32_t slot = war_note_map_hash(id);
+    uint32_t entry;
+    while ((entry = note_quads->map[slot & note_quads->map_mask])) {
+        uint32_t i = entry - 1;
+        if (note_quads->id[i] == id && note_quads->alive[i]) { return i; }
+        slot++;
+    }
+    return UINT32_MAX;
+}
+
+static inline uint32_t war_project_chunk(double pos_x) {
+    double chunk = floor(pos_x / WAR_PROJECT_CHUNK_COLS);
+    if (!(chunk > 0.0)) { return 0; }
+    if (chunk >= WAR_PROJECT_CHUNKS_MAX) { return WAR_PROJECT_CHUNKS_MAX - 1; }
+    return (uint32_t)chunk;
+}
+
+static inline void war_note_quads_dirty_chunk(war_note_quads* note_quads,
+                                              uint32_t chunk) {
+    uint64_t bit = 1ull << (chunk & 63);
+    if (note_quads->dirty[chunk >> 6] & bit) { return; }
+    note_quads->dirty[chunk >> 6] |= bit;
+    note_quads->dirty_count++;
+}
+
+// marks the chunk a note starting at pos_x belongs to for the next autosave
+static inline void war_note_quads_dirty(war_note_quads* note_quads,
+                                        double pos_x) {
+    if (!note_quads->dirty) { return; }
+    war_note_quads_dirty_chunk(note_quads, war_project_chunk(pos_x));
+}
+
+static inline void war_note_quads_dirty_range(war_note_quads* note_quads,
+                                              double left,
+                                              double right) {
+    if (!note_quads->dirty) { return; }
+    uint32_t last = war_project_chunk(right);
+    for (uint32_t chunk = war_project_chunk(left); chunk <= last; chunk++) {
+        war_note_quads_dirty_chunk(note_quads, chunk);
+    }
+}
+
+static inline void war_note_quads_clean(war_note_quads* note_quads) {
+    if (!note_quads->dirty) { return; }
+    memset(note_quads->dirty, 0, WAR_PROJECT_CHUNKS_MAX / 8);
+    note_quads->dirty_count = 0;
+}
+
+// puts a note in without it counting as an edit, for paging and loading
+static inline uint32_t war_note_quads_insert(war_note_quads* note_quads,
+                                             war_note_quad* note_quad) {
+    assert(note_quads->count < note_quads->note_quads_max);
+    uint32_t i = note_quads->count++;
+    war_note_quads_set(note_quads, i, note_quad);
+    war_note_map_insert(note_quads, i);
+    note_quads->generation++;
+    return i;
+}
+
+static inline uint32_t war_note_quads_append(war_note_quads* note_quads,
+                                             war_note_quad* note_quad) {
+    war_note_quads_dirty(note_quads, note_quad->pos_x);
+    return war_note_quads_insert(note_quads, note_quad);
+}
+
+static inline uint32_t war_note_quads_compact(war_note_quads* note_quads) {
+    uint32_t write_idx = 0;
+    war_note_quad note_quad;
+    for (uint32_t read_idx = 0; read_idx < note_quads->count; read_idx++) {
+        if (!note_quads->alive[read_idx]) { continue; }
+        if (write_idx != read_idx) {
+            war_note_quads_get(note_quads, read_idx, &note_quad);
+            war_note_quads_set(note_quads, write_idx, &note_quad);
+        }
+        write_idx++;
+    }
+    if (write_idx != note_quads->count) { note_quads->generation++; }
+    note_quads->count = write_idx;
+    if (note_quads->map) { war_note_map_rebuild(note_quads); }
+    return write_idx;
+}
+
+static inline void war_note_from_quad(war_lua_context* ctx_lua,
+                                      war_note_quad* note_quad,
+                                      war_note* note) {
+    double sample_rate = atomic_load(&ctx_lua->A_SAMPLE_RATE);
+    double bpm = atomic_load(&ctx_lua->A_BPM);
+    double frames_per_beat = sample_rate * 60.0 / bpm;
+    double columns_per_beat = atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT);
+    double start_beats = note_quad->pos_x / columns_per_beat;
+    note->note_start_frames = (uint64_t)(start_beats * frames_per_beat + 0.5);
+    double duration_beats = note_quad->size_x / columns_per_beat;
+    note->note_duration_frames =
+        (uint64_t)(duration_beats * frames_per_beat + 0.5);
+    note->note = note_quad->pos_y;
+    note->layer = note_quad->layer;
+    note->note_attack = atomic_load(&ctx_lua->A_DEFAULT_ATTACK);
+    note->note_sustain = atomic_load(&ctx_lua->A_DEFAULT_SUSTAIN);
+    note->note_release = atomic_load(&ctx_lua->A_DEFAULT_RELEASE);
+    note->note_gain = atomic_load(&ctx_lua->A_DEFAULT_GAIN);
+    note->note_phase_increment = 0;
+    note->id = note_quad->id;
+    note->alive = note_quad->alive;
+}
+
+//-----------------------------------------------------------------------------
+// NOTE LOG
+//-----------------------------------------------------------------------------
+// undo payloads keep notes as a byte stream. each note is the zigzag varint
+// delta of its id, then unless ids_only a varint mask of the fields that
+// differ from the previous note and those fields: doubles as a varint
+// n << 5 | absolute << 4 | k meaning (absolute ? 0 : prev) + n / 2^k, with
+// k = 15 for raw 8 bytes, gain as raw 4 bytes and the rest as plain varints
+
+#define WAR_NOTE_LOG_FIELDS(D, U, F)                                           \
+    D(0, pos_x)                                                                \
+    D(1, pos_y)                                                                \
+    D(2, size_x)                                                               \
+    D(3, navigation_x)                                                         \
+    U(4, navigation_x_numerator)                                               \
+    U(5, navigation_x_denominator)                                             \
+    U(6, size_x_numerator)                                                     \
+    U(7, size_x_denominator)                                                   \
+    U(8, color)                                                                \
+    U(9, outline_color)                                                        \
+    F(10, gain)                                                                \
+    U(11, voice)                                                               \
+    U(12, hidden)                                                              \
+    U(13, mute)                                                                \
+    U(14, layer)
+
+static inline uint64_t war_zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t war_unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static inline void war_note_log_byte(war_note_log* log, uint8_t byte) {
+    if (log->data) { log->data[log->bytes] = byte; }
+    log->bytes++;
+}
+
+static inline void war_note_log_varint(war_note_log* log, uint64_t value) {
+    while (value >= 0x80) {
+        war_note_log_byte(log, (uint8_t)value | 0x80);
+        value >>= 7;
+    }
+    war_note_log_byte(log, (uint8_t)value);
+}
+
+static inline uint64_t war_note_log_read_varint(war_note_log* log) {
+    uint64_t value = 0;
+    uint32_t shift = 0;
+    uint8_t byte;
+    do {
+        byte = log->data[log->bytes++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+static inline void war_note_log_raw(war_note_log* log, uint64_t bits, int n) {
+    for (int b = 0; b < n; b++) { war_note_log_byte(log, bits >> (8 * b)); }
+}
+
+static inline uint64_t war_note_log_read_raw(war_note_log* log, int n) {
+    uint64_t bits = 0;
+    for (int b = 0; b < n; b++) {
+        bits |= (uint64_t)log->data[log->bytes++] << (8 * b);
+    }
+    return bits;
+}
+
+// grid positions are dyadic fractions of a column, so the delta to prev
+// or failing that the value itself usually scales to a small integer
+static inline uint8_t war_note_log_dyadic(war_note_log* log,
+                                          double value,
+                                          double base,
+                                          uint64_t absolute) {
+    double delta = value - base;
+    for (int k = 0; k < 15; k++) {
+        double scaled = ldexp(delta, k);
+        if (!(fabs(scaled) < 0x1p52)) { return 0; }
+        if (scaled != floor(scaled)) { continue; }
+        int64_t n = (int64_t)scaled;
+        if (base + ldexp((double)n, -k) != value) { return 0; }
+        war_note_log_varint(log,
+                            war_zigzag(n) << 5 | absolute << 4 | (uint64_t)k);
+        return 1;
+    }
+    return 0;
+}
+
+static inline void
+war_note_log_double(war_note_log* log, double value, double prev) {
+    if (war_note_log_dyadic(log, value, prev, 0)) { return; }
+    if (war_note_log_dyadic(log, value, 0.0, 1)) { return; }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    war_note_log_varint(log, 15);
+    war_note_log_raw(log, bits, 8);
+}
+
+static inline double war_note_log_read_double(war_note_log* log,
+                                              double prev) {
+    uint64_t value = war_note_log_read_varint(log);
+    int k = value & 15;
+    if (k == 15) {
+        uint64_t bits = war_note_log_read_raw(log, 8);
+        double raw;
+        memcpy(&raw, &bits, sizeof(raw));
+        return raw;
+    }
+    double base = (value & 16) ? 0.0 : prev;
+    return base + ldexp((double)war_unzigzag(value >> 5), -k);
+}
+
+static inline void war_note_log_put(war_note_log* log,
+                                    war_note_quad* note_quad,
+                                    uint8_t ids_only) {
+    war_note_quad* prev = &log->prev;
+    war_note_log_varint(log, war_zigzag((int64_t)(note_quad->id - prev->id)));
+    prev->id = note_quad->id;
+    if (ids_only) { return; }
+    uint32_t mask = 0;
+#define WAR_NOTE_LOG_MASK(bit, field)                                          \
+    if (note_quad->field != prev->field) { mask |= 1u << (bit); }
+    WAR_NOTE_LOG_FIELDS(WAR_NOTE_LOG_MASK, WAR_NOTE_LOG_MASK, WAR_NOTE_LOG_MASK)
+#undef WAR_NOTE_LOG_MASK
+    war_note_log_varint(log, mask);
+#define WAR_NOTE_LOG_D(bit, field)                                             \
+    if (mask & (1u << (bit))) {                                                \
+        war_note_log_double(log, note_quad->field, prev->field);               \
+    }
+#define WAR_NOTE_LOG_U(bit, field)                                             \
+    if (mask & (1u << (bit))) { war_note_log_varint(log, note_quad->field); }
+#define WAR_NOTE_LOG_F(bit, field)                                             \
+    if (mask & (1u << (bit))) {                                                \
+        uint32_t bits;                                                         \
+        memcpy(&bits, &note_quad->field, sizeof(bits));                        \
+        war_note_log_raw(log, bits, 4);                                        \
+    }
+    WAR_NOTE_LOG_FIELDS(WAR_NOTE_LOG_D, WAR_NOTE_LOG_U, WAR_NOTE_LOG_F)
+#undef WAR_NOTE_LOG_D
+#undef WAR_NOTE_LOG_U
+#undef WAR_NOTE_LOG_F
+    *prev = *note_quad;
+}
+
+static inline void war_note_log_get(war_note_log* log,
+                                    war_note_quad* note_quad,
+                                    uint8_t ids_only) {
+    war_note_quad* prev = &log->prev;
+    prev->id += (uint64_t)war_unzigzag(war_note_log_read_varint(log));
+    if (!ids_only) {
+        uint32_t mask = (uint32_t)war_note_log_read_varint(log);
+#define WAR_NOTE_LOG_D(bit, field)                                             \
+    if (mask & (1u << (bit))) {                                                \
+        prev->field = war_note_log_read_double(log, prev->field);              \
+    }
+#define WAR_NOTE_LOG_U(bit, field)                                             \
+    if (mask & (1u << (bit))) { prev->field = war_note_log_read_varint(log); }
+#define WAR_NOTE_LOG_F(bit, field)                                             \
+    if (mask & (1u << (bit))) {                                                \
+        uint32_t bits = (uint32_t)war_note_log_read_raw(log, 4);               \
+        memcpy(&prev->field, &bits, sizeof(bits));                             \
+    }
+        WAR_NOTE_LOG_FIELDS(WAR_NOTE_LOG_D, WAR_NOTE_LOG_U, WAR_NOTE_LOG_F)
+#undef WAR_NOTE_LOG_D
+#undef WAR_NOTE_LOG_U
+#undef WAR_NOTE_LOG_F
+    }
+    *note_quad = *prev;
+    note_quad->alive = 1;
+}
+
+#undef WAR_NOTE_LOG_FIELDS
+
+//-----------------------------------------------------------------------------
+// UNDO NODES
+//-----------------------------------------------------------------------------
+
+// detaches node from the tree. a parent is always older than its children,
+// so only the oldest node, which is a root by then, has children to hand
+// over to the roots
+static inline void war_undo_node_unlink(war_undo_tree* undo_tree,
+                                        war_undo_node* node) {
+    war_undo_node** slot = node->prev ? &node->prev->next : &undo_tree->root;
+    uint8_t followed = *slot == node;
+    if (followed) { *slot = node->alt_prev ? node->alt_prev : node->alt_next; }
+    if (node->alt_prev) { node->alt_prev->alt_next = node->alt_next; }
+    if (node->alt_next) { node->alt_next->alt_prev = node->alt_prev; }
+    node->alt_prev = NULL;
+    node->alt_next = NULL;
+    war_undo_node* first = node->next;
+    if (first) {
+        while (first->alt_prev) { first = first->alt_prev; }
+        for (war_undo_node* child = first; child; child = child->alt_next) {
+            child->prev = NULL;
+            child->parent = NULL;
+        }
+        war_undo_node* tail = undo_tree->root;
+        if (!tail) {
+            undo_tree->root = first;
+        } else {
+            while (tail->alt_next) { tail = tail->alt_next; }
+            tail->alt_next = first;
+            first->alt_prev = tail;
+        }
+        // redo from the top carries on down the child node followed
+        if (followed && !node->prev) { undo_tree->root = node->next; }
+    }
+    if (undo_tree->current == node) { undo_tree->current = node->prev; }
+    node->next = NULL;
+}
+
+static inline void war_note_snapshot_release(war_note_snapshots* snapshots,
+                                             uint32_t snapshot);
+static inline uint8_t war_undofile_stream(war_env* env, uint8_t wait);
+
+static inline void war_undo_node_free(war_env* env, war_undo_node* node) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    war_note_snapshots* snapshots = env->note_snapshots;
+    // the rest of its log still has to reach the undofile
+    if (env->undofile->stream_node == node) { war_undofile_stream(env, 1); }
+    war_undo_node_unlink(undo_tree, node);
+    if (node->snapshot &&
+        snapshots->snapshots[node->snapshot - 1].node_id == node->id) {
+        war_note_snapshot_release(snapshots, node->snapshot - 1);
+    }
+    if (node->older) {
+        node->older->newer = node->newer;
+    } else {
+        undo_tree->oldest = node->newer;
+    }
+    if (node->newer) {
+        node->newer->older = node->older;
+    } else {
+        undo_tree->newest = node->older;
+    }
+    war_undo_node** seq_slot =
+        &undo_tree->seq_index[node->seq_num % undo_tree->nodes_max];
+    if (*seq_slot == node) { *seq_slot = NULL; }
+    // anchors are checked by id, a recycled node must not match
+    node->id = 0;
+    node->older = NULL;
+    node->newer = undo_tree->free;
+    undo_tree->free = node;
+    undo_tree->nodes_used--;
+}
+
+// drops the oldest history, keep is a node still being filled in
+static inline uint8_t war_undo_node_evict(war_env* env, war_undo_node* keep) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    war_undo_node* node = undo_tree->oldest;
+    if (!node || node == keep) { return 0; }
+    if (node->payload_end > undo_tree->payload_tail) {
+        undo_tree->payload_tail = node->payload_end;
+    }
+    war_undo_node_free(env, node);
+    return 1;
+}
+
+// payloads are carved from the ring in node order, a request that would
+// straddle the end of the ring skips to its start instead
+static inline void*
+war_undo_payload_alloc(war_env* env, war_undo_node* node, size_t size) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    size = ALIGN_UP(size, 64);
+    if (!size) { return NULL; }
+    if (size > undo_tree->payload_size) {
+        call_terry_davis("undo payload too big: %zu bytes", size);
+        return NULL;
+    }
+    for (;;) {
+        uint64_t head = undo_tree->payload_head;
+        uint64_t offset = head % undo_tree->payload_size;
+        uint64_t skip = offset + size > undo_tree->payload_size ?
+                            undo_tree->payload_size - offset :
+                            0;
+        if (head + skip + size - undo_tree->payload_tail <=
+            undo_tree->payload_size) {
+            undo_tree->payload_head = head + skip + size;
+            node->payload_end = undo_tree->payload_head;
+            return undo_tree->payload + (offset + skip) % undo_tree->payload_size;
+        }
+        if (!war_undo_node_evict(env, node)) {
+            call_terry_davis("undo payload ring full: %zu bytes", size);
+            return NULL;
+        }
+    }
+}
+
+// grows the note log of node by bytes in place and returns where they go.
+// NULL unless the log is the last thing carved from the ring and the ring
+// has room past it without evicting
+static inline uint8_t*
+war_undo_payload_extend(war_env* env, war_undo_node* node, size_t bytes) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    uint64_t offset = node->payload.notes.offset;
+    uint64_t old_bytes = node->payload.notes.bytes;
+    uint64_t start = node->payload_end - ALIGN_UP(old_bytes, 64);
+    uint64_t head = start + ALIGN_UP(old_bytes + bytes, 64);
+    if (node->payload_end != undo_tree->payload_head ||
+        start % undo_tree->payload_size != offset ||
+        offset + old_bytes + bytes > undo_tree->payload_size ||
+        head - undo_tree->payload_tail > undo_tree->payload_size) {
+        return NULL;
+    }
+    undo_tree->payload_head = head;
+    node->payload_end = head;
+    node->payload.notes.bytes = (uint32_t)(old_bytes + bytes);
+    return undo_tree->payload + offset + old_bytes;
+}
+
+// takes a node off the free list, evicting the oldest history when it is
+// dry. the node is the newest in the age list but not in the tree yet
+static inline war_undo_node* war_undo_node_alloc(war_env* env) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    if (!undo_tree->free) { war_undo_node_evict(env, NULL); }
+    war_undo_node* node = undo_tree->free;
+    undo_tree->free = node->newer;
+    undo_tree->nodes_used++;
+    node->older = undo_tree->newest;
+    node->newer = NULL;
+    if (undo_tree->newest) {
+        undo_tree->newest->newer = node;
+    } else {
+        undo_tree->oldest = node;
+    }
+    undo_tree->newest = node;
+    node->payload_end = undo_tree->payload_head;
+    node->parent = NULL;
+    node->next = NULL;
+    node->prev = NULL;
+    node->alt_next = NULL;
+    node->alt_prev = NULL;
+    node->depth = 0;
+    node->checkpoint = 0;
+    node->anchor = NULL;
+    node->anchor_id = 0;
+    node->jump = (war_undo_jump){0};
+    node->snapshot = 0;
+    return node;
+}
+
+// hangs node under parent, or among the roots, as the branch redo follows
+// and moves current to it. seq_num must already be set
+static inline void war_undo_node_attach(war_undo_tree* undo_tree,
+                                        war_undo_node* node,
+                                        war_undo_node* parent) {
+    war_undo_node** slot = parent ? &parent->next : &undo_tree->root;
+    undo_tree->current = node;
+    node->parent = parent;
+    node->prev = parent;
+    node->depth = parent ? parent->depth + 1 : 0;
+    if (*slot) {
+        war_undo_node* last = *slot;
+        while (last->alt_next) { last = last->alt_next; }
+        last->alt_next = node;
+        node->alt_prev = last;
+        node->branch_id = undo_tree->next_branch_id++;
+    } else {
+        node->branch_id =
+            parent ? parent->branch_id : undo_tree->next_branch_id++;
+    }
+    *slot = node;
+    undo_tree->seq_index[node->seq_num % undo_tree->nodes_max] = node;
+}
+
+// hide, show, mute and unmute only need to know which notes they touched
+static inline uint8_t war_undo_command_ids_only(uint32_t command) {
+    return command >= CMD_HIDE_NOTES && command <= CMD_UNMUTE_NOTES;
+}
+
+// log holds the size of a run measured with data NULL, this carves it from
+// the payload ring and rewinds log to write the same run for real
+static inline uint8_t war_undo_node_log_open(war_env* env,
+                                             war_undo_node* node,
+                                             war_note_log* log,
+                                             uint32_t count) {
+    size_t bytes = log->bytes;
+    uint8_t* data = war_undo_payload_alloc(env, node, bytes);
+    if (!data) { return 0; }
+    node->payload.notes.offset = (uint64_t)(data - env->undo_tree->payload);
+    node->payload.notes.bytes = (uint32_t)bytes;
+    node->payload.notes.count = count;
+    *log = (war_note_log){.data = data};
+    return 1;
+}
+
+static inline void war_undo_node_log_read(war_env* env,
+                                          war_undo_node* node,
+                                          war_note_log* log) {
+    *log = (war_note_log){
+        .data = env->undo_tree->payload + node->payload.notes.offset};
+}
+
+static inline uint8_t war_undo_node_log_quads(war_env* env,
+                                              war_undo_node* node,
+                                              war_note_quad* quads,
+                                              uint32_t count) {
+    war_note_log log = {0};
+    for (uint32_t k = 0; k < count; k++) {
+        war_note_log_put(&log, &quads[k], 0);
+    }
+    if (!war_undo_node_log_open(env, node, &log, count)) { return 0; }
+    for (uint32_t k = 0; k < count; k++) {
+        war_note_log_put(&log, &quads[k], 0);
+    }
+    return 1;
+}
+
+//-----------------------------------------------------------------------------
+// UNDO CHECKPOINTS
+//-----------------------------------------------------------------------------
+// every checkpoint_nodes deep a node becomes a checkpoint and folds the nodes
+// between the checkpoint or root above it and its parent into one jump. a
+// seek crosses a checkpoint with its own delta and the jump, so it applies at
+// most checkpoint_nodes single deltas at either end and net changes between
+
+static inline war_undo_jump_note* war_undo_jump_note_get(war_undo_tree* undo_tree,
+                                                         uint32_t* count,
+                                                         uint64_t id) {
+    uint32_t slot = war_note_map_hash(id);
+    uint32_t entry;
+    while ((entry = undo_tree->jump_map[slot & undo_tree->jump_map_mask])) {
+        if (undo_tree->jump_notes[entry - 1].note_quad.id == id) {
+            return &undo_tree->jump_notes[entry - 1];
+        }
+        slot++;
+    }
+    if (*count == undo_tree->jump_notes_max) { return NULL; }
+    war_undo_jump_note* jump_note = &undo_tree->jump_notes[*count];
+    *jump_note = (war_undo_jump_note){.note_quad.id = id};
+    undo_tree->jump_map[slot & undo_tree->jump_map_mask] = ++*count;
+    return jump_note;
+}
+
+// folds node into the scratch. nodes come newest first, so the last flip
+// seen of a field is the earliest and gives its before, the first the after
+static inline uint8_t war_undo_jump_fold(war_env* env,
+                                         war_undo_node* node,
+                                         uint32_t* count) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    war_note_log log;
+    war_note_quad note_quad;
+    war_undo_node_log_read(env, node, &log);
+    switch (node->command) {
+    case CMD_ADD_NOTE:
+    case CMD_ADD_NOTES:
+    case CMD_ADD_NOTES_SAME:
+    case CMD_DELETE_NOTE:
+    case CMD_DELETE_NOTES:
+    case CMD_DELETE_NOTES_SAME: {
+        uint8_t add = node->command == CMD_ADD_NOTE ||
+                      node->command == CMD_ADD_NOTES ||
+                      node->command == CMD_ADD_NOTES_SAME;
+        for (uint32_t k = 0; k < node->payload.notes.count; k++) {
+            war_note_log_get(&log, &note_quad, 0);
+            war_undo_jump_note* jump_note =
+                war_undo_jump_note_get(undo_tree, count, note_quad.id);
+            if (!jump_note) { return 0; }
+            // a note is added before it is removed, never after
+            if (add) {
+                jump_note->added = 1;
+                if (!jump_note->removed) { jump_note->note_quad = note_quad; }
+            } else {
+                jump_note->removed = 1;
+                jump_note->note_quad = note_quad;
+            }
+        }
+        break;
+    }
+    case CMD_HIDE_NOTES:
+    case CMD_SHOW_NOTES:
+    case CMD_MUTE_NOTES:
+    case CMD_UNMUTE_NOTES: {
+        uint8_t hidden = node->command <= CMD_SHOW_NOTES;
+        uint8_t value = node->command == CMD_HIDE_NOTES ||
+                        node->command == CMD_MUTE_NOTES;
+        uint8_t touched = hidden ? WAR_UNDO_JUMP_HIDDEN : WAR_UNDO_JUMP_MUTE;
+        uint8_t before = hidden ? WAR_UNDO_JUMP_HIDDEN_BEFORE :
+                                  WAR_UNDO_JUMP_MUTE_BEFORE;
+        uint8_t after =
+            hidden ? WAR_UNDO_JUMP_HIDDEN_AFTER : WAR_UNDO_JUMP_MUTE_AFTER;
+        for (uint32_t k = 0; k < node->payload.notes.count; k++) {
+            war_note_log_get(&log, &note_quad, 1);
+            war_undo_jump_note* jump_note =
+                war_undo_jump_note_get(undo_tree, count, note_quad.id);
+            if (!jump_note) { return 0; }
+            if (!(jump_note->flags & touched)) {
+                jump_note->flags |= touched | (value ? after : 0);
+            }
+            jump_note->flags = (jump_note->flags & ~before) |
+                               (value ? 0 : before);
+        }
+        break;
+    }
+    case CMD_PASTE_NOTES: {
+        war_payload_paste_notes* paste = &node->payload.paste_notes;
+        double max_row = env->ctx_wr->max_row;
+        for (uint32_t r = 0; r < paste->repeat; r++) {
+            double offset_x = paste->pos_x + r * paste->stride_x;
+            uint64_t id = paste->first_id + (uint64_t)r * paste->block.count;
+            war_undo_node_log_read(env, node, &log);
+            for (uint32_t k = 0; k < paste->block.count; k++) {
+                war_note_log_get(&log, &note_quad, 0);
+                note_quad.pos_x += offset_x;
+                note_quad.pos_y += paste->pos_y;
+                note_quad.id = id + k;
+                // copies off the grid are appended dead, as if never added
+                if (note_quad.pos_x < 0.0 || note_quad.pos_y < 0.0 ||
+                    note_quad.pos_y > max_row) {
+                    continue;
+                }
+                war_undo_jump_note* jump_note =
+                    war_undo_jump_note_get(undo_tree, count, note_quad.id);
+                if (!jump_note) { return 0; }
+                jump_note->added = 1;
+                if (!jump_note->removed) { jump_note->note_quad = note_quad; }
+            }
+        }
         break;
     }
-    case 1: {
-        int active = __builtin_ctzll(layer);
-        ctx_wr->color_cursor = ctx_color->colors[active];
-        ctx_wr->color_cursor_transparent = ctx_color->colors[active];
-        ctx_wr->color_note_outline_default = ctx_color->white_hex;
-        ctx_wr->layers_active[0] = (active + 1) + '0';
-        break;
     }
-    default: {
-        int count = 0;
-        while (layer) {
-            int active = __builtin_ctzll(layer);
-            ctx_wr->layers_active[count++] = (active + 1) + '0';
-            layer &= layer - 1;
+    return 1;
+}
+
+// removed notes get the flags they had before the span, added ones the
+// flags they ended with
+static inline void war_undo_jump_put(war_note_log* log,
+                                     war_undo_jump_note* jump_notes,
+                                     uint32_t count,
+                                     uint8_t section) {
+    for (uint32_t k = 0; k < count; k++) {
+        war_undo_jump_note* jump_note = &jump_notes[k];
+        uint8_t flags = jump_note->flags;
+        war_note_quad note_quad = jump_note->note_quad;
+        if (jump_note->removed && jump_note->added) { continue; }
+        if (section == 0 && jump_note->removed) {
+            if (flags & WAR_UNDO_JUMP_HIDDEN) {
+                note_quad.hidden = !!(flags & WAR_UNDO_JUMP_HIDDEN_BEFORE);
+            }
+            if (flags & WAR_UNDO_JUMP_MUTE) {
+                note_quad.mute = !!(flags & WAR_UNDO_JUMP_MUTE_BEFORE);
+            }
+            war_note_log_put(log, &note_quad, 0);
+        } else if (section == 1 && jump_note->added) {
+            if (flags & WAR_UNDO_JUMP_HIDDEN) {
+                note_quad.hidden = !!(flags & WAR_UNDO_JUMP_HIDDEN_AFTER);
+            }
+            if (flags & WAR_UNDO_JUMP_MUTE) {
+                note_quad.mute = !!(flags & WAR_UNDO_JUMP_MUTE_AFTER);
+            }
+            war_note_log_put(log, &note_quad, 0);
+        } else if (section == 2 && !jump_note->removed && !jump_note->added &&
+                   flags) {
+            war_note_log_put(log, &note_quad, 1);
+            war_note_log_byte(log, flags);
+        }
+    }
+}
+
+// called right after node is attached, before its own payload is logged,
+// so the jump sits in the ring with the rest of node
+static inline void war_undo_node_checkpoint(war_env* env,
+                                            war_undo_node* node) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    war_undo_node* anchor = node->prev;
+    if (!anchor) {
+        node->checkpoint = 1;
+        return;
+    }
+    while (!anchor->checkpoint && anchor->prev) { anchor = anchor->prev; }
+    if (node->depth - anchor->depth < undo_tree->checkpoint_nodes) { return; }
+    node->checkpoint = 1;
+    uint32_t count = 0;
+    memset(undo_tree->jump_map,
+           0,
+           sizeof(uint32_t) * (undo_tree->jump_map_mask + 1));
+    for (war_undo_node* span = node->prev; span != anchor; span = span->prev) {
+        // too much changed to fold, seeks step through this span one by one
+        if (!war_undo_jump_fold(env, span, &count)) { return; }
+    }
+    war_undo_jump jump = {0};
+    for (uint32_t k = 0; k < count; k++) {
+        war_undo_jump_note* jump_note = &undo_tree->jump_notes[k];
+        if (jump_note->removed && jump_note->added) { continue; }
+        if (jump_note->removed) {
+            jump.removed++;
+        } else if (jump_note->added) {
+            jump.added++;
+        } else if (jump_note->flags) {
+            jump.flipped++;
+        }
+    }
+    war_note_log log = {0};
+    for (uint8_t section = 0; section < 3; section++) {
+        war_undo_jump_put(&log, undo_tree->jump_notes, count, section);
+    }
+    jump.bytes = (uint32_t)log.bytes;
+    if (log.bytes) {
+        uint8_t* data = war_undo_payload_alloc(env, node, log.bytes);
+        if (!data) { return; }
+        jump.offset = (uint64_t)(data - undo_tree->payload);
+        log = (war_note_log){.data = data};
+        for (uint8_t section = 0; section < 3; section++) {
+            war_undo_jump_put(&log, undo_tree->jump_notes, count, section);
+        }
+    }
+    // making room may have evicted anchor, then the jump is stale already
+    node->anchor = anchor;
+    node->anchor_id = anchor->id;
+    node->jump = jump;
+}
+
+static inline war_undo_node* war_undo_node_push(war_env* env,
+                                                uint32_t command) {
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_undo_tree* undo_tree = env->undo_tree;
+    war_undo_node* node = war_undo_node_alloc(env);
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    node->timestamp = (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+    // :earlier and :later search by time, keep it in seq_num order
+    if (node->older && node->timestamp < node->older->timestamp) {
+        node->timestamp = node->older->timestamp;
+    }
+    node->id = undo_tree->next_id++;
+    node->seq_num = undo_tree->next_seq_num++;
+    node->command = command;
+    node->cursor_pos_x = ctx_wr->cursor_pos_x;
+    node->cursor_pos_y = ctx_wr->cursor_pos_y;
+    node->left_col = ctx_wr->left_col;
+    node->right_col = ctx_wr->right_col;
+    node->top_row = ctx_wr->top_row;
+    node->bottom_row = ctx_wr->bottom_row;
+    node->parent_id = undo_tree->current ? undo_tree->current->id : 0;
+    // a new edit starts a branch, whatever could be redone stays reachable
+    war_undo_node_attach(undo_tree, node, undo_tree->current);
+    war_undo_node_checkpoint(env, node);
+    return node;
+}
+
+// adds and deletes join into CMD_ADD_NOTES and CMD_DELETE_NOTES, anything
+// else never joins and gets UINT32_MAX
+static inline uint32_t war_undo_command_joined(uint32_t command) {
+    switch (command) {
+    case CMD_ADD_NOTE:
+    case CMD_ADD_NOTES:
+    case CMD_ADD_NOTES_SAME:
+        return CMD_ADD_NOTES;
+    case CMD_DELETE_NOTE:
+    case CMD_DELETE_NOTES:
+    case CMD_DELETE_NOTES_SAME:
+        return CMD_DELETE_NOTES;
+    }
+    return UINT32_MAX;
+}
+
+// folds node, just pushed and logged, into its parent when the parent is
+// the same kind of edit made less than join_us before and nothing has
+// branched off it since, like vim's undojoin. holding a key or repeating a
+// counted edit then grows one node instead of one per repeat tick. node's
+// log is appended to the parent's, which grows in place at the head of the
+// ring. only its first note is encoded again, the rest is relative to that
+// one already. returns the node that holds the edit now
+static inline war_undo_node* war_undo_node_join(war_env* env,
+                                                war_undo_node* node) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    war_note_snapshots* snapshots = env->note_snapshots;
+    war_undo_node* parent = node->prev;
+    uint64_t now = env->ctx_wr->now;
+    uint64_t joined_us = undo_tree->joined_us;
+    undo_tree->joined_us = now;
+    uint32_t command = war_undo_command_joined(node->command);
+    if (!undo_tree->join_us || !parent || command == UINT32_MAX ||
+        war_undo_command_joined(parent->command) != command ||
+        now - joined_us > undo_tree->join_us || node->older != parent ||
+        node->alt_prev) {
+        return node;
+    }
+    // a snapshot of parent would no longer match it
+    if (parent->snapshot &&
+        snapshots->snapshots[parent->snapshot - 1].node_id == parent->id) {
+        return node;
+    }
+    war_note_log read;
+    war_note_quad note_quad;
+    if (undo_tree->join_prev_id != parent->id ||
+        undo_tree->join_prev_bytes != parent->payload.notes.bytes) {
+        war_undo_node_log_read(env, parent, &read);
+        for (uint32_t k = 0; k < parent->payload.notes.count; k++) {
+            war_note_log_get(&read, &note_quad, 0);
+        }
+        undo_tree->join_prev = read.prev;
+    }
+    // one note encodes to well under 256 bytes
+    uint8_t first[256];
+    war_note_log log = {.data = first, .prev = undo_tree->join_prev};
+    war_undo_node_log_read(env, node, &read);
+    war_note_log_get(&read, &note_quad, 0);
+    war_note_log_put(&log, &note_quad, 0);
+    uint8_t* rest = read.data + read.bytes;
+    size_t rest_bytes = node->payload.notes.bytes - read.bytes;
+    for (uint32_t k = 1; k < node->payload.notes.count; k++) {
+        war_note_log_get(&read, &note_quad, 0);
+    }
+    size_t bytes = log.bytes + rest_bytes;
+    // node is the newest, handing its room back leaves parent at the head
+    uint64_t node_head = undo_tree->payload_head;
+    uint8_t* data = NULL;
+    if (node->payload_end == node_head) {
+        undo_tree->payload_head = parent->payload_end;
+        data = war_undo_payload_extend(env, parent, bytes);
+        if (!data) { undo_tree->payload_head = node_head; }
+    }
+    if (data) {
+        memmove(data + log.bytes, rest, rest_bytes);
+        memcpy(data, first, log.bytes);
+    } else {
+        // parent moves to the head whole once and grows in place after.
+        // only older history is evicted, node and parent stay
+        uint32_t old_bytes = parent->payload.notes.bytes;
+        data = war_undo_payload_alloc(env, parent, old_bytes + bytes);
+        if (!data) { return node; }
+        memcpy(data,
+               undo_tree->payload + parent->payload.notes.offset,
+               old_bytes);
+        memcpy(data + old_bytes, first, log.bytes);
+        memcpy(data + old_bytes + log.bytes, rest, rest_bytes);
+        parent->payload.notes.offset = (uint64_t)(data - undo_tree->payload);
+        parent->payload.notes.bytes = (uint32_t)(old_bytes + bytes);
+    }
+    parent->command = command;
+    parent->payload.notes.count += node->payload.notes.count;
+    undo_tree->join_prev = read.prev;
+    undo_tree->join_prev_id = parent->id;
+    undo_tree->join_prev_bytes = parent->payload.notes.bytes;
+    // nothing was handed out after node, so its id and seq_num go back
+    if (node->id + 1 == undo_tree->next_id) { undo_tree->next_id--; }
+    if (node->seq_num + 1 == undo_tree->next_seq_num) {
+        undo_tree->next_seq_num--;
+    }
+    war_undo_node_free(env, node);
+    return parent;
+}
+
+//-----------------------------------------------------------------------------
+// NOTE CHUNKS
+//-----------------------------------------------------------------------------
+
+static inline int war_note_key_compare(const void* a, const void* b) {
+    double pa = ((const war_note_key*)a)->pos_x;
+    double pb = ((const war_note_key*)b)->pos_x;
+    return (pa > pb) - (pa < pb);
+}
+
+static inline uint32_t war_note_chunks_of(war_note_chunks* chunks, double col) {
+    if (col <= 0.0) { return 0; }
+    double chunk = col / chunks->chunk_cols;
+    if (chunk >= (double)(chunks->chunks_max - 1)) {
+        return chunks->chunks_max - 1;
+    }
+    return (uint32_t)chunk;
+}
+
+// rebuilds the index when note_quads changed since the last sync. chunks
+// whose contents hash differently get their generation bumped, which is
+// what paging, snapshots and autosave key off of
+static inline void war_note_chunks_sync(war_note_chunks* chunks,
+                                        war_note_quads* note_quads,
+                                        double chunk_cols) {
+    if (chunks->synced_generation == note_quads->generation &&
+        chunks->chunk_cols == chunk_cols) {
+        return;
+    }
+    chunks->chunk_cols = chunk_cols;
+    uint32_t chunks_count_previous = chunks->chunks_count;
+    uint32_t chunks_count = 0;
+    uint32_t span_chunks_max = 0;
+    memset(chunks->fill, 0, sizeof(uint32_t) * chunks->chunks_max);
+    for (uint32_t i = 0; i < note_quads->count; i++) {
+        if (!note_quads->alive[i]) { continue; }
+        double pos_x = note_quads->pos_x[i];
+        uint32_t chunk = war_note_chunks_of(chunks, pos_x);
+        uint32_t chunk_end =
+            war_note_chunks_of(chunks, pos_x + note_quads->size_x[i]);
+        if (chunk_end - chunk > span_chunks_max) {
+            span_chunks_max = chunk_end - chunk;
+        }
+        if (chunk + 1 > chunks_count) { chunks_count = chunk + 1; }
+        chunks->fill[chunk]++;
+    }
+    uint32_t notes_count = 0;
+    for (uint32_t c = 0; c < chunks_count; c++) {
+        chunks->offset[c] = notes_count;
+        notes_count += chunks->fill[c];
+        chunks->fill[c] = chunks->offset[c];
+    }
+    chunks->offset[chunks_count] = notes_count;
+    for (uint32_t i = 0; i < note_quads->count; i++) {
+        if (!note_quads->alive[i]) { continue; }
+        double pos_x = note_quads->pos_x[i];
+        uint32_t k = chunks->fill[war_note_chunks_of(chunks, pos_x)]++;
+        chunks->keys[k].pos_x = pos_x;
+        chunks->keys[k].idx = i;
+    }
+    for (uint32_t c = 0; c < chunks_count; c++) {
+        uint32_t begin = chunks->offset[c];
+        uint32_t end = chunks->offset[c + 1];
+        war_note_key* keys = chunks->keys + begin;
+        uint32_t n = end - begin;
+        if (n > 32) {
+            qsort(keys, n, sizeof(war_note_key), war_note_key_compare);
+        } else {
+            for (uint32_t a = 1; a < n; a++) {
+                war_note_key key = keys[a];
+                uint32_t b = a;
+                while (b > 0 && keys[b - 1].pos_x > key.pos_x) {
+                    keys[b] = keys[b - 1];
+                    b--;
+                }
+                keys[b] = key;
+            }
+        }
+        uint32_t min_row = UINT32_MAX;
+        uint32_t max_row = 0;
+        uint64_t hash = 14695981039346656037ULL;
+        for (uint32_t k = begin; k < end; k++) {
+            uint32_t i = chunks->keys[k].idx;
+            chunks->idx[k] = i;
+            chunks->pos_x[k] = note_quads->pos_x[i];
+            chunks->end_x[k] = note_quads->pos_x[i] + note_quads->size_x[i];
+            chunks->pos_y[k] = note_quads->pos_y[i];
+            uint32_t row = (uint32_t)note_quads->pos_y[i];
+            if (row < min_row) { min_row = row; }
+            if (row > max_row) { max_row = row; }
+            uint32_t gain_bits;
+            memcpy(&gain_bits, &note_quads->gain[i], sizeof(float));
+            uint64_t fields[8] = {
+                note_quads->id[i],
+                note_quads->layer[i],
+                (uint64_t)note_quads->hidden[i] << 32 | note_quads->mute[i],
+                (uint64_t)note_quads->color[i] << 32 | note_quads->voice[i],
+                (uint64_t)note_quads->outline_color[i] << 32 | gain_bits,
+            };
+            memcpy(&fields[5], &chunks->pos_x[k], sizeof(double));
+            memcpy(&fields[6], &chunks->end_x[k], sizeof(double));
+            memcpy(&fields[7], &chunks->pos_y[k], sizeof(double));
+            for (uint32_t f = 0; f < 8; f++) {
+                hash ^= fields[f];
+                hash *= 1099511628211ULL;
+            }
+        }
+        chunks->min_row[c] = min_row;
+        chunks->max_row[c] = max_row;
+        if (chunks->hash[c] != hash) {
+            chunks->hash[c] = hash;
+            chunks->generation[c] = note_quads->generation;
+        }
+    }
+    for (uint32_t c = chunks_count; c < chunks_count_previous; c++) {
+        chunks->offset[c + 1] = notes_count;
+        chunks->min_row[c] = UINT32_MAX;
+        chunks->max_row[c] = 0;
+        if (chunks->hash[c] != 0) {
+            chunks->hash[c] = 0;
+            chunks->generation[c] = note_quads->generation;
+        }
+    }
+    chunks->chunks_count = chunks_count;
+    chunks->span_chunks_max = span_chunks_max;
+    chunks->notes_count = notes_count;
+    chunks->synced_generation = note_quads->generation;
+}
+
+// [*begin, *end) into chunks->idx covering every note that can overlap the
+// column range, notes are bucketed by start so the front is widened by the
+// longest span seen
+static inline void war_note_chunks_range(war_note_chunks* chunks,
+                                         double left_col,
+                                         double right_col,
+                                         uint32_t* begin,
+                                         uint32_t* end) {
+    *begin = 0;
+    *end = 0;
+    if (!chunks->chunks_count || right_col < left_col) { return; }
+    uint32_t first = war_note_chunks_of(chunks, left_col);
+    uint32_t last = war_note_chunks_of(chunks, right_col);
+    first = first > chunks->span_chunks_max ? first - chunks->span_chunks_max
+                                            : 0;
+    if (first >= chunks->chunks_count) { return; }
+    if (last >= chunks->chunks_count) { last = chunks->chunks_count - 1; }
+    *begin = chunks->offset[first];
+    *end = chunks->offset[last + 1];
+}
+
+//-----------------------------------------------------------------------------
+// NOTE ROWS
+//-----------------------------------------------------------------------------
+
+static inline int war_double_compare(const void* a, const void* b) {
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+// orders by column then row, idx holds the row
+static inline int war_note_key_row_compare(const void* a, const void* b) {
+    const war_note_key* ka = a;
+    const war_note_key* kb = b;
+    if (ka->pos_x != kb->pos_x) { return (ka->pos_x > kb->pos_x) ? 1 : -1; }
+    return (ka->idx > kb->idx) - (ka->idx < kb->idx);
+}
+
+static inline void war_note_rows_sort_x(double* x, uint32_t n) {
+    if (n > 32) {
+        qsort(x, n, sizeof(double), war_double_compare);
+        return;
+    }
+    for (uint32_t a = 1; a < n; a++) {
+        double value = x[a];
+        uint32_t b = a;
+        while (b > 0 && x[b - 1] > value) {
+            x[b] = x[b - 1];
+            b--;
+        }
+        x[b] = value;
+    }
+}
+
+// first index in the sorted x[0, n) greater than col
+static inline uint32_t
+war_note_rows_upper(const double* x, uint32_t n, double col) {
+    uint32_t lo = 0;
+    while (n) {
+        uint32_t half = n >> 1;
+        if (x[lo + half] <= col) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+// first index in the sorted x[0, n) not less than col
+static inline uint32_t
+war_note_rows_lower(const double* x, uint32_t n, double col) {
+    uint32_t lo = 0;
+    while (n) {
+        uint32_t half = n >> 1;
+        if (x[lo + half] < col) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+// first key in the (col, row) sorted keys[0, n) after (col, row), columns
+// within 1e-9 count as equal so a cursor parked on an end_x - size_x round
+// trip doesn't find the same note again
+static inline uint32_t war_note_rows_key_upper(const war_note_key* keys,
+                                               uint32_t n,
+                                               double col,
+                                               uint32_t row) {
+    uint32_t lo = 0;
+    while (n) {
+        uint32_t half = n >> 1;
+        const war_note_key* key = &keys[lo + half];
+        if (key->pos_x < col - 1e-9 ||
+            (key->pos_x <= col + 1e-9 && key->idx <= row)) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+// count-th column after col in the sorted x[0, n), or before it when
+// backward, stopping at the last one there is. returns 0 when there is none
+static inline uint8_t war_note_rows_step(const double* x,
+                                         uint32_t n,
+                                         double col,
+                                         uint32_t count,
+                                         uint8_t backward,
+                                         double* target) {
+    if (backward) {
+        uint32_t k = war_note_rows_lower(x, n, col - 1e-9);
+        if (!k) { return 0; }
+        *target = x[k > count ? k - count : 0];
+        return 1;
+    }
+    uint32_t k = war_note_rows_upper(x, n, col + 1e-9);
+    if (k >= n) { return 0; }
+    k = (n - k > count - 1) ? k + count - 1 : n - 1;
+    *target = x[k];
+    return 1;
+}
+
+// rebuilds from the chunk order, which is already sorted by pos_x, so the
+// per row starts come out sorted from a counting pass and only the ends
+// need sorting. chunks must be synced first
+static inline void war_note_rows_sync(war_note_rows* rows,
+                                      war_note_chunks* chunks,
+                                      war_note_quads* note_quads,
+                                      uint64_t layer) {
+    if (rows->synced_generation == chunks->synced_generation &&
+        rows->layer == layer) {
+        return;
+    }
+    uint32_t rows_count = rows->rows_count;
+    memset(rows->fill, 0, sizeof(uint32_t) * rows_count);
+    uint32_t notes_count = 0;
+    for (uint32_t k = 0; k < chunks->notes_count; k++) {
+        uint32_t i = chunks->idx[k];
+        if (note_quads->hidden[i]) { continue; }
+        if (!(note_quads->layer[i] & layer) && note_quads->layer[i] != layer) {
+            continue;
+        }
+        uint32_t row = (uint32_t)chunks->pos_y[k];
+        if (row >= rows_count) { row = rows_count - 1; }
+        rows->starts[notes_count].pos_x = chunks->pos_x[k];
+        rows->starts[notes_count].idx = row;
+        rows->ends[notes_count].pos_x = chunks->end_x[k];
+        rows->ends[notes_count].idx = row;
+        rows->fill[row]++;
+        notes_count++;
+    }
+    uint32_t offset = 0;
+    for (uint32_t r = 0; r < rows_count; r++) {
+        rows->offset[r] = offset;
+        offset += rows->fill[r];
+        rows->fill[r] = rows->offset[r];
+    }
+    rows->offset[rows_count] = offset;
+    for (uint32_t k = 0; k < notes_count; k++) {
+        uint32_t slot = rows->fill[rows->starts[k].idx]++;
+        rows->start_x[slot] = rows->starts[k].pos_x;
+        rows->end_x[slot] = rows->ends[k].pos_x;
+    }
+    // words are runs of touching or overlapping notes, walked in start order
+    // before the ends get sorted away from their starts
+    uint32_t words_count = 0;
+    for (uint32_t r = 0; r < rows_count; r++) {
+        rows->word_offset[r] = words_count;
+        uint32_t end = rows->offset[r + 1];
+        for (uint32_t k = rows->offset[r]; k < end;) {
+            double run_start = rows->start_x[k];
+            double run_end = rows->end_x[k];
+            for (k++; k < end && rows->start_x[k] <= run_end; k++) {
+                if (rows->end_x[k] > run_end) { run_end = rows->end_x[k]; }
+            }
+            rows->word_start_x[words_count] = run_start;
+            rows->word_end_x[words_count] = run_end;
+            words_count++;
+        }
+        war_note_rows_sort_x(rows->end_x + rows->offset[r],
+                             end - rows->offset[r]);
+    }
+    rows->word_offset[rows_count] = words_count;
+    // equal columns keep chunk order, settle them by row. runs of equal
+    // starts are chords so this stays close to linear
+    war_note_key* starts = rows->starts;
+    for (uint32_t a = 1; a < notes_count; a++) {
+        war_note_key key = starts[a];
+        uint32_t b = a;
+        while (b > 0 && war_note_key_row_compare(&starts[b - 1], &key) > 0) {
+            starts[b] = starts[b - 1];
+            b--;
+        }
+        starts[b] = key;
+    }
+    qsort(rows->ends,
+          notes_count,
+          sizeof(war_note_key),
+          war_note_key_row_compare);
+    rows->notes_count = notes_count;
+    rows->layer = layer;
+    rows->synced_generation = chunks->synced_generation;
+}
+
+//-----------------------------------------------------------------------------
+// NOTE SWAP
+//-----------------------------------------------------------------------------
+// notes far from the viewport and the play head are paged out to a sparse
+// tmpfile in fixed size pages of packed records. pages are sorted by column
+// when written so each page covers a narrow [min_col, max_col] range and
+// faulting a region back in only touches the pages that intersect it.
+
+// word at a time fnv style checksum, sizes that are multiples of 8 can be
+// fed in pieces
+static inline uint64_t
+war_checksum(uint64_t checksum, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        checksum = (checksum ^ word) * 0x100000001b3ull;
+        checksum ^= checksum >> 29;
+    }
+    for (; i < size; i++) {
+        checksum = (checksum ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return checksum;
+}
+
+static inline int war_note_swap_init(war_note_swap* swap) {
+    size_t size = (size_t)swap->page_notes * swap->pages_max *
+                  sizeof(war_note_swap_record);
+    swap->records = NULL;
+    swap->mapped_size = 0;
+    swap->pages_used = 0;
+    swap->notes_count = 0;
+    memset(swap->page_count, 0, sizeof(uint32_t) * swap->pages_max);
+    memset(swap->page_checksum, 0, sizeof(uint64_t) * swap->pages_max);
+    swap->fd = open("/tmp", O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (swap->fd < 0) {
+        call_terry_davis("note swap: O_TMPFILE failed, falling back to memfd");
+        swap->fd = memfd_create("war_note_swap", MFD_CLOEXEC);
+    }
+    if (swap->fd < 0) {
+        call_terry_davis("note swap: failed to open backing file");
+        return -1;
+    }
+    // sparse, blocks are only allocated for pages that get written
+    if (ftruncate(swap->fd, size) == -1) {
+        call_terry_davis("note swap: ftruncate failed");
+        close(swap->fd);
+        swap->fd = -1;
+        return -1;
+    }
+    void* records =
+        mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, swap->fd, 0);
+    if (records == MAP_FAILED) {
+        call_terry_davis("note swap: mmap failed");
+        close(swap->fd);
+        swap->fd = -1;
+        return -1;
+    }
+    swap->records = records;
+    swap->mapped_size = size;
+    return 0;
+}
+
+static inline void war_note_swap_pack(war_note_quads* note_quads,
+                                      uint32_t i,
+                                      war_note_swap_record* record) {
+    record->id = note_quads->id[i];
+    record->layer = note_quads->layer[i];
+    record->pos_x = note_quads->pos_x[i];
+    record->size_x = note_quads->size_x[i];
+    record->navigation_x = note_quads->navigation_x[i];
+    record->navigation_x_numerator = note_quads->navigation_x_numerator[i];
+    record->navigation_x_denominator = note_quads->navigation_x_denominator[i];
+    record->size_x_numerator = note_quads->size_x_numerator[i];
+    record->size_x_denominator = note_quads->size_x_denominator[i];
+    record->color = note_quads->color[i];
+    record->outline_color = note_quads->outline_color[i];
+    record->voice = note_quads->voice[i];
+    record->gain = note_quads->gain[i];
+    record->pos_y = (uint16_t)note_quads->pos_y[i];
+    record->hidden = (uint8_t)note_quads->hidden[i];
+    record->mute = (uint8_t)note_quads->mute[i];
+}
+
+static inline void war_note_swap_unpack(war_note_swap_record* record,
+                                        war_note_quad* note_quad) {
+    note_quad->alive = 1;
+    note_quad->id = record->id;
+    note_quad->layer = record->layer;
+    note_quad->pos_x = record->pos_x;
+    note_quad->pos_y = record->pos_y;
+    note_quad->size_x = record->size_x;
+    note_quad->navigation_x = record->navigation_x;
+    note_quad->navigation_x_numerator = record->navigation_x_numerator;
+    note_quad->navigation_x_denominator = record->navigation_x_denominator;
+    note_quad->size_x_numerator = record->size_x_numerator;
+    note_quad->size_x_denominator = record->size_x_denominator;
+    note_quad->color = record->color;
+    note_quad->outline_color = record->outline_color;
+    note_quad->voice = record->voice;
+    note_quad->gain = record->gain;
+    note_quad->hidden = record->hidden;
+    note_quad->mute = record->mute;
+}
+
+// a page mapped in from a project file is checked the first time anything
+// reads it, one that no longer matches is dropped
+static inline uint8_t war_note_swap_page_check(war_note_swap* swap,
+                                               uint32_t page) {
+    uint64_t checksum = swap->page_checksum[page];
+    if (!checksum) { return 1; }
+    swap->page_checksum[page] = 0;
+    uint32_t n = swap->page_count[page];
+    war_note_swap_record* records =
+        swap->records + (size_t)page * swap->page_notes;
+    if (war_checksum(WAR_CHECKSUM_SEED,
+                     records,
+                     sizeof(war_note_swap_record) * n) == checksum) {
+        return 1;
+    }
+    call_terry_davis("note swap: page %u failed its checksum, %u notes lost",
+                     page,
+                     n);
+    swap->page_count[page] = 0;
+    swap->notes_count -= n;
+    return 0;
+}
+
+// keep windows are the viewport plus margin and the play head plus
+// lookahead, everything outside both of them is cold
+static inline void war_note_swap_window(war_env* env,
+                                        double* view_left,
+                                        double* view_right,
+                                        double* play_left,
+                                        double* play_right) {
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_lua_context* ctx_lua = env->ctx_lua;
+    war_note_swap* swap = env->note_swap;
+    double play_col =
+        ((double)atomic_load(&env->atomics->play_frames) /
+         atomic_load(&ctx_lua->A_SAMPLE_RATE)) /
+        ((60.0 / atomic_load(&ctx_lua->A_BPM)) /
+         atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT));
+    *view_left = (double)ctx_wr->left_col - swap->margin_cols;
+    *view_right = (double)ctx_wr->right_col + 1 + swap->margin_cols;
+    *play_left = play_col - swap->margin_cols;
+    *play_right = play_col + swap->lookahead_cols;
+}
+
+static inline uint32_t war_note_swap_evict(war_note_swap* swap,
+                                           war_note_quads* note_quads,
+                                           double view_left,
+                                           double view_right,
+                                           double play_left,
+                                           double play_right) {
+    if (!swap->records) { return 0; }
+    uint32_t keys_count = 0;
+    for (uint32_t i = 0; i < note_quads->count; i++) {
+        if (!note_quads->alive[i]) { continue; }
+        double start = note_quads->pos_x[i];
+        double end = start + note_quads->size_x[i];
+        if (end >= view_left && start <= view_right) { continue; }
+        if (end >= play_left && start <= play_right) { continue; }
+        swap->keys[keys_count].pos_x = start;
+        swap->keys[keys_count].idx = i;
+        keys_count++;
+    }
+    if (!keys_count) { return 0; }
+    qsort(swap->keys,
+          keys_count,
+          sizeof(war_note_key),
+          war_note_key_compare);
+    uint32_t evicted = 0;
+    uint32_t page = 0;
+    while (evicted < keys_count) {
+        while (page < swap->pages_max && swap->page_count[page]) { page++; }
+        if (page >= swap->pages_max) {
+            call_terry_davis("note swap: out of pages");
+            break;
+        }
+        war_note_swap_record* records =
+            swap->records + (size_t)page * swap->page_notes;
+        uint32_t n = keys_count - evicted;
+        if (n > swap->page_notes) { n = swap->page_notes; }
+        double max_col = 0.0;
+        for (uint32_t j = 0; j < n; j++) {
+            uint32_t idx = swap->keys[evicted + j].idx;
+            war_note_swap_pack(note_quads, idx, &records[j]);
+            double end = note_quads->pos_x[idx] + note_quads->size_x[idx];
+            if (end > max_col) { max_col = end; }
+            note_quads->alive[idx] = 0;
+        }
+        swap->page_min_col[page] = swap->keys[evicted].pos_x;
+        swap->page_max_col[page] = max_col;
+        swap->page_count[page] = n;
+        swap->page_checksum[page] = 0;
+        if (page >= swap->pages_used) { swap->pages_used = page + 1; }
+        evicted += n;
+    }
+    swap->notes_count += evicted;
+    war_note_quads_compact(note_quads);
+    call_terry_davis("note swap: evicted %u notes", evicted);
+    return evicted;
+}
+
+static inline uint32_t war_note_swap_fault(war_note_swap* swap,
+                                           war_note_quads* note_quads,
+                                           double left,
+                                           double right) {
+    if (!swap->notes_count) { return 0; }
+    uint32_t restored = 0;
+    war_note_quad note_quad;
+    for (uint32_t page = 0; page < swap->pages_used; page++) {
+        uint32_t n = swap->page_count[page];
+        if (!n || swap->page_max_col[page] < left ||
+            swap->page_min_col[page] > right) {
+            continue;
+        }
+        if (!war_note_swap_page_check(swap, page)) { continue; }
+        if (note_quads->count + n > note_quads->note_quads_max) {
+            war_note_quads_compact(note_quads);
+            if (note_quads->count + n > note_quads->note_quads_max) { break; }
+        }
+        war_note_swap_record* records =
+            swap->records + (size_t)page * swap->page_notes;
+        for (uint32_t j = 0; j < n; j++) {
+            war_note_swap_unpack(&records[j], &note_quad);
+            war_note_quads_insert(note_quads, &note_quad);
+        }
+        swap->page_count[page] = 0;
+        swap->notes_count -= n;
+        restored += n;
+    }
+    while (swap->pages_used && !swap->page_count[swap->pages_used - 1]) {
+        swap->pages_used--;
+    }
+    if (restored) { call_terry_davis("note swap: faulted %u notes", restored); }
+    return restored;
+}
+
+static inline void war_note_swap_clear(war_note_swap* swap) {
+    memset(swap->page_count, 0, sizeof(uint32_t) * swap->pages_used);
+    memset(swap->page_checksum, 0, sizeof(uint64_t) * swap->pages_used);
+    swap->pages_used = 0;
+    swap->notes_count = 0;
+}
+
+// called once per frame, pages in whatever the viewport or play head is
+// about to need and makes room for it by paging out cold notes first
+static inline void war_note_swap_sync(war_env* env) {
+    war_note_swap* swap = env->note_swap;
+    if (!swap->notes_count) { return; }
+    double view_left, view_right, play_left, play_right;
+    war_note_swap_window(env, &view_left, &view_right, &play_left, &play_right);
+    war_note_quads* note_quads = env->note_quads;
+    war_note_swap_fault(swap, note_quads, view_left, view_right);
+    war_note_swap_fault(swap, note_quads, play_left, play_right);
+    if (!swap->notes_count) { return; }
+    uint32_t pages_pending = 0;
+    for (uint32_t page = 0; page < swap->pages_used; page++) {
+        if (!swap->page_count[page]) { continue; }
+        double min_col = swap->page_min_col[page];
+        double max_col = swap->page_max_col[page];
+        if ((max_col >= view_left && min_col <= view_right) ||
+            (max_col >= play_left && min_col <= play_right)) {
+            pages_pending++;
+        }
+    }
+    if (!pages_pending) { return; }
+    war_note_swap_evict(
+        swap, note_quads, view_left, view_right, play_left, play_right);
+    war_note_swap_fault(swap, note_quads, view_left, view_right);
+    war_note_swap_fault(swap, note_quads, play_left, play_right);
+}
+
+// returns 1 once there is room for needed more resident notes
+static inline uint8_t war_note_quads_reserve(war_env* env, uint32_t needed) {
+    war_note_quads* note_quads = env->note_quads;
+    if (note_quads->count + needed <= note_quads->note_quads_max) { return 1; }
+    war_note_quads_compact(note_quads);
+    if (note_quads->count + needed <= note_quads->note_quads_max) { return 1; }
+    double view_left, view_right, play_left, play_right;
+    war_note_swap_window(env, &view_left, &view_right, &play_left, &play_right);
+    war_note_swap_evict(env->note_swap,
+                        note_quads,
+                        view_left,
+                        view_right,
+                        play_left,
+                        play_right);
+    return note_quads->count + needed <= note_quads->note_quads_max;
+}
+
+//-----------------------------------------------------------------------------
+// NOTE SNAPSHOTS
+//-----------------------------------------------------------------------------
+// every so many undo nodes, once editing pauses, the whole note store is
+// packed into a snapshot hung off the current node, bar by bar for resident
+// notes and page by page for swapped out ones. bars whose note_chunks
+// generation hasn't moved and pages with the same records are shared with
+// the previous snapshot instead of copied. a seek far through history
+// restores the nearest snapshot and only replays the nodes below it, and
+// autosave writes out the snapshot of current while the store matches it
+
+static inline war_note_snapshot* war_note_snapshot_of(war_env* env,
+                                                      war_undo_node* node) {
+    if (!node || !node->snapshot) { return NULL; }
+    war_note_snapshot* snapshot =
+        &env->note_snapshots->snapshots[node->snapshot - 1];
+    return snapshot->node_id == node->id ? snapshot : NULL;
+}
+
+static inline void
+war_note_snapshot_chunk_release(war_note_snapshots* snapshots,
+                                uint32_t chunk) {
+    war_note_snapshot_chunk* c = &snapshots->chunks[chunk];
+    if (c->refs && !--c->refs) {
+        c->count = 0;
+        snapshots->free[snapshots->free_count++] = chunk;
+    }
+}
+
+static inline void war_note_snapshot_release(war_note_snapshots* snapshots,
+                                             uint32_t snapshot) {
+    war_note_snapshot* s = &snapshots->snapshots[snapshot];
+    for (uint32_t k = 0; k < s->bars_count + s->pages_count; k++) {
+        if (s->chunks[k]) {
+            war_note_snapshot_chunk_release(snapshots, s->chunks[k] - 1);
+        }
+    }
+    s->node_id = 0;
+    s->notes_count = 0;
+    s->bars_count = 0;
+    s->pages_count = 0;
+    if (snapshots->newest == snapshot + 1) { snapshots->newest = 0; }
+}
+
+// slides live chunks down over released ones in offset order. chunks are
+// only ever held by index so nothing else needs patching
+static inline void war_note_snapshots_compact(war_note_snapshots* snapshots) {
+    uint32_t keys_count = 0;
+    for (uint32_t c = 0; c < snapshots->chunks_max; c++) {
+        if (!snapshots->chunks[c].refs) { continue; }
+        snapshots->keys[keys_count].pos_x = snapshots->chunks[c].offset;
+        snapshots->keys[keys_count].idx = c;
+        keys_count++;
+    }
+    qsort(snapshots->keys,
+          keys_count,
+          sizeof(war_note_key),
+          war_note_key_compare);
+    uint32_t used = 0;
+    for (uint32_t k = 0; k < keys_count; k++) {
+        war_note_snapshot_chunk* chunk =
+            &snapshots->chunks[snapshots->keys[k].idx];
+        if (chunk->offset != used) {
+            memmove(snapshots->records + used,
+                    snapshots->records + chunk->offset,
+                    sizeof(war_note_swap_record) * chunk->count);
+            chunk->offset = used;
+        }
+        used += chunk->count;
+    }
+    snapshots->records_used = used;
+}
+
+// a chunk with room for count records and one reference, UINT32_MAX when
+// the chunk table or the arena is full
+static inline uint32_t
+war_note_snapshot_chunk_alloc(war_note_snapshots* snapshots, uint32_t count) {
+    if (!snapshots->free_count) { return UINT32_MAX; }
+    if (snapshots->records_used + count > snapshots->records_max) {
+        war_note_snapshots_compact(snapshots);
+        if (snapshots->records_used + count > snapshots->records_max) {
+            return UINT32_MAX;
+        }
+    }
+    uint32_t chunk = snapshots->free[--snapshots->free_count];
+    war_note_snapshot_chunk* c = &snapshots->chunks[chunk];
+    c->offset = snapshots->records_used;
+    c->count = count;
+    c->refs = 1;
+    c->generation = 0;
+    snapshots->records_used += count;
+    return chunk;
+}
+
+// releases the oldest snapshot other than keep, 0 when there is none
+static inline uint8_t war_note_snapshots_drop(war_note_snapshots* snapshots,
+                                              uint32_t keep) {
+    for (uint32_t k = 0; k < snapshots->snapshots_max; k++) {
+        uint32_t s = (snapshots->next + k) % snapshots->snapshots_max;
+        if (s == keep || !snapshots->snapshots[s].node_id) { continue; }
+        war_note_snapshot_release(snapshots, s);
+        return 1;
+    }
+    return 0;
+}
+
+// packs the note store as it is after node into the next snapshot in the
+// ring. older snapshots are dropped while the arena is short, returns 0
+// when even that doesn't make room
+static inline uint8_t war_note_snapshot_take(war_env* env,
+                                             war_undo_node* node) {
+    war_lua_context* ctx_lua = env->ctx_lua;
+    war_note_snapshots* snapshots = env->note_snapshots;
+    war_note_quads* note_quads = env->note_quads;
+    war_note_chunks* note_chunks = env->note_chunks;
+    war_note_swap* swap = env->note_swap;
+    double chunk_cols = atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT) *
+                        atomic_load(&ctx_lua->WR_NOTE_CHUNK_BEATS);
+    war_note_chunks_sync(note_chunks, note_quads, chunk_cols);
+    uint32_t index = snapshots->next;
+    snapshots->next = (index + 1) % snapshots->snapshots_max;
+    war_note_snapshot_release(snapshots, index);
+    war_note_snapshot* snapshot = &snapshots->snapshots[index];
+    snapshot->bars_count = note_chunks->chunks_count;
+    snapshot->pages_count = swap->records ? swap->pages_used : 0;
+    uint32_t chunks_count = snapshot->bars_count + snapshot->pages_count;
+    memset(snapshot->chunks, 0, sizeof(uint32_t) * chunks_count);
+    uint32_t copied = 0;
+    for (uint32_t k = 0; k < chunks_count; k++) {
+        uint8_t page = k >= snapshot->bars_count;
+        uint32_t p = k - snapshot->bars_count;
+        uint32_t count;
+        war_note_swap_record* records = NULL;
+        if (page) {
+            war_note_swap_page_check(swap, p);
+            count = swap->page_count[p];
+            records = swap->records + (size_t)p * swap->page_notes;
+        } else {
+            count = note_chunks->offset[k + 1] - note_chunks->offset[k];
+        }
+        if (!count) { continue; }
+        war_note_snapshot* newest =
+            snapshots->newest ? &snapshots->snapshots[snapshots->newest - 1] :
+                                NULL;
+        uint32_t shared = 0;
+        if (newest && !page && k < newest->bars_count) {
+            shared = newest->chunks[k];
+        } else if (newest && page && p < newest->pages_count) {
+            shared = newest->chunks[newest->bars_count + p];
+        }
+        if (shared) {
+            war_note_snapshot_chunk* c = &snapshots->chunks[shared - 1];
+            uint8_t same =
+                c->count == count &&
+                (page ? !memcmp(snapshots->records + c->offset,
+                                records,
+                                sizeof(war_note_swap_record) * count) :
+                        c->generation == note_chunks->generation[k]);
+            if (same) {
+                c->refs++;
+                snapshot->chunks[k] = shared;
+                snapshot->notes_count += count;
+                continue;
+            }
+        }
+        uint32_t chunk;
+        while ((chunk = war_note_snapshot_chunk_alloc(snapshots, count)) ==
+               UINT32_MAX) {
+            if (!war_note_snapshots_drop(snapshots, index)) {
+                call_terry_davis("note snapshot: no room for %u notes",
+                                 note_quads->count + swap->notes_count);
+                war_note_snapshot_release(snapshots, index);
+                return 0;
+            }
+        }
+        war_note_snapshot_chunk* c = &snapshots->chunks[chunk];
+        if (page) {
+            memcpy(snapshots->records + c->offset,
+                   records,
+                   sizeof(war_note_swap_record) * count);
+        } else {
+            c->generation = note_chunks->generation[k];
+            uint32_t* idx = note_chunks->idx + note_chunks->offset[k];
+            for (uint32_t j = 0; j < count; j++) {
+                war_note_swap_pack(
+                    note_quads, idx[j], &snapshots->records[c->offset + j]);
+            }
+        }
+        snapshot->chunks[k] = chunk + 1;
+        snapshot->notes_count += count;
+        copied += count;
+    }
+    snapshot->node_id = node->id;
+    snapshot->generation = note_quads->generation;
+    node->snapshot = index + 1;
+    snapshots->newest = index + 1;
+    call_terry_davis("note snapshot: %u notes, %u copied",
+                     snapshot->notes_count,
+                     copied);
+    return 1;
+}
+
+// puts back every note as it was when snapshot was taken, pages straight
+// back into swap and bars into note_quads. 0 with nothing touched when its
+// bars would not all be resident at once
+static inline uint8_t war_note_snapshot_restore(war_env* env,
+                                                war_note_snapshot* snapshot) {
+    war_note_snapshots* snapshots = env->note_snapshots;
+    war_note_quads* note_quads = env->note_quads;
+    war_note_swap* swap = env->note_swap;
+    uint32_t bars_notes = 0;
+    for (uint32_t k = 0; k < snapshot->bars_count; k++) {
+        if (snapshot->chunks[k]) {
+            bars_notes += snapshots->chunks[snapshot->chunks[k] - 1].count;
+        }
+    }
+    if (bars_notes > note_quads->note_quads_max) {
+        call_terry_davis("note snapshot: no room to restore %u notes",
+                         bars_notes);
+        return 0;
+    }
+    // whatever is there now and whatever comes back is an edit
+    for (uint32_t i = 0; i < note_quads->count; i++) {
+        if (note_quads->alive[i]) {
+            war_note_quads_dirty(note_quads, note_quads->pos_x[i]);
+        }
+    }
+    for (uint32_t p = 0; p < swap->pages_used; p++) {
+        if (!swap->page_count[p]) { continue; }
+        war_note_quads_dirty_range(
+            note_quads, swap->page_min_col[p], swap->page_max_col[p]);
+    }
+    war_note_swap_clear(swap);
+    note_quads->count = 0;
+    war_note_map_rebuild(note_quads);
+    note_quads->generation++;
+    for (uint32_t p = 0; p < snapshot->pages_count; p++) {
+        uint32_t chunk = snapshot->chunks[snapshot->bars_count + p];
+        if (!chunk) { continue; }
+        war_note_snapshot_chunk* c = &snapshots->chunks[chunk - 1];
+        war_note_swap_record* records =
+            swap->records + (size_t)p * swap->page_notes;
+        memcpy(records,
+               snapshots->records + c->offset,
+               sizeof(war_note_swap_record) * c->count);
+        double min_col = DBL_MAX;
+        double max_col = -DBL_MAX;
+        for (uint32_t j = 0; j < c->count; j++) {
+            if (records[j].pos_x < min_col) { min_col = records[j].pos_x; }
+            double end = records[j].pos_x + records[j].size_x;
+            if (end > max_col) { max_col = end; }
+        }
+        swap->page_min_col[p] = min_col;
+        swap->page_max_col[p] = max_col;
+        swap->page_count[p] = c->count;
+        swap->page_checksum[p] = 0;
+        war_note_quads_dirty_range(note_quads, min_col, max_col);
+        swap->pages_used = p + 1;
+        swap->notes_count += c->count;
+    }
+    // the store is empty, so this fits without paging anything out
+    war_note_quads_reserve(env, bars_notes);
+    war_note_quad note_quad;
+    for (uint32_t k = 0; k < snapshot->bars_count; k++) {
+        if (!snapshot->chunks[k]) { continue; }
+        war_note_snapshot_chunk* c =
+            &snapshots->chunks[snapshot->chunks[k] - 1];
+        for (uint32_t j = 0; j < c->count; j++) {
+            war_note_swap_unpack(&snapshots->records[c->offset + j],
+                                 &note_quad);
+            war_note_quads_append(note_quads, &note_quad);
+        }
+    }
+    note_quads->generation++;
+    snapshot->generation = note_quads->generation;
+    return 1;
+}
+
+// called once per frame, snapshots current once it has held still for
+// idle_us and is every_nodes below the last snapshot on its path
+static inline void war_note_snapshot_sync(war_env* env) {
+    war_note_snapshots* snapshots = env->note_snapshots;
+    war_undo_node* current = env->undo_tree->current;
+    uint64_t now = env->ctx_wr->now;
+    uint64_t id = current ? current->id : 0;
+    if (id != snapshots->watched_id) {
+        snapshots->watched_id = id;
+        snapshots->watched_since = now;
+        return;
+    }
+    if (!current || snapshots->watched_since == UINT64_MAX ||
+        now - snapshots->watched_since < snapshots->idle_us) {
+        return;
+    }
+    snapshots->watched_since = UINT64_MAX;
+    war_undo_node* node = current;
+    war_undo_node* top = current;
+    for (uint32_t k = 0; k < snapshots->every_nodes; k++) {
+        // above a root that was pushed from nothing is the empty song
+        if (!node) {
+            if (!top->parent_id) { return; }
+            break;
+        }
+        if (war_note_snapshot_of(env, node)) { return; }
+        top = node;
+        node = node->prev;
+    }
+    war_note_snapshot_take(env, current);
+}
+
+//-----------------------------------------------------------------------------
+// NOTE QUERY
+//-----------------------------------------------------------------------------
+
+static inline uint8_t war_note_query_match_fields(war_note_query* query,
+                                                  double pos_x,
+                                                  double end_x,
+                                                  double pos_y,
+                                                  uint64_t layer,
+                                                  uint32_t hidden) {
+    uint8_t in_rect = end_x > query->left_col && pos_x < query->right_col &&
+                      pos_y >= query->bottom_row && pos_y <= query->top_row;
+    if (in_rect == ((query->flags & NOTE_QUERY_OUTSIDE) != 0)) { return 0; }
+    if (!(query->flags & NOTE_QUERY_ALL_LAYERS) && !(layer & query->layer) &&
+        layer != query->layer) {
+        return 0;
+    }
+    if ((query->flags & NOTE_QUERY_VISIBLE) && hidden) { return 0; }
+    if ((query->flags & NOTE_QUERY_HIDDEN) && !hidden) { return 0; }
+    return 1;
+}
+
+// fills query->hits with the indices of resident notes matching the query,
+// four notes per step with AVX2
+static inline uint32_t war_note_query_run(war_note_quads* note_quads,
+                                          war_note_query* query) {
+    uint32_t* hits = query->hits;
+    uint32_t hits_count = 0;
+    uint32_t count = note_quads->count;
+    uint32_t i = 0;
+#if defined(__AVX2__)
+    __m256d left = _mm256_set1_pd(query->left_col);
+    __m256d right = _mm256_set1_pd(query->right_col);
+    __m256d bottom = _mm256_set1_pd(query->bottom_row);
+    __m256d top = _mm256_set1_pd(query->top_row);
+    __m256i layer_mask = _mm256_set1_epi64x((long long)query->layer);
+    __m256i zero = _mm256_setzero_si256();
+    int outside = (query->flags & NOTE_QUERY_OUTSIDE) ? 0xF : 0;
+    int all_layers = (query->flags & NOTE_QUERY_ALL_LAYERS) ? 0xF : 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d pos_x = _mm256_loadu_pd(note_quads->pos_x + i);
+        __m256d end_x =
+            _mm256_add_pd(pos_x, _mm256_loadu_pd(note_quads->size_x + i));
+        __m256d pos_y = _mm256_loadu_pd(note_quads->pos_y + i);
+        __m256d rect = _mm256_and_pd(_mm256_cmp_pd(end_x, left, _CMP_GT_OQ),
+                                     _mm256_cmp_pd(pos_x, right, _CMP_LT_OQ));
+        rect = _mm256_and_pd(rect, _mm256_cmp_pd(pos_y, bottom, _CMP_GE_OQ));
+        rect = _mm256_and_pd(rect, _mm256_cmp_pd(pos_y, top, _CMP_LE_OQ));
+        int mask = _mm256_movemask_pd(rect) ^ outside;
+        __m256i layer =
+            _mm256_loadu_si256((const __m256i*)(note_quads->layer + i));
+        __m256i layer_none =
+            _mm256_cmpeq_epi64(_mm256_and_si256(layer, layer_mask), zero);
+        __m256i layer_same = _mm256_cmpeq_epi64(layer, layer_mask);
+        int layer_miss = _mm256_movemask_pd(
+            _mm256_castsi256_pd(_mm256_andnot_si256(layer_same, layer_none)));
+        mask &= ~layer_miss | all_layers;
+        uint32_t alive_bytes;
+        memcpy(&alive_bytes, note_quads->alive + i, sizeof(uint32_t));
+        __m256i alive =
+            _mm256_cvtepu8_epi64(_mm_cvtsi32_si128((int)alive_bytes));
+        mask &= ~_mm256_movemask_pd(
+            _mm256_castsi256_pd(_mm256_cmpeq_epi64(alive, zero)));
+        __m256i hidden = _mm256_cvtepu32_epi64(
+            _mm_loadu_si128((const __m128i*)(note_quads->hidden + i)));
+        int visible = _mm256_movemask_pd(
+            _mm256_castsi256_pd(_mm256_cmpeq_epi64(hidden, zero)));
+        if (query->flags & NOTE_QUERY_VISIBLE) { mask &= visible; }
+        if (query->flags & NOTE_QUERY_HIDDEN) { mask &= ~visible; }
+        mask &= 0xF;
+        while (mask) {
+            hits[hits_count++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        if (!note_quads->alive[i]) { continue; }
+        double pos_x = note_quads->pos_x[i];
+        if (!war_note_query_match_fields(query,
+                                         pos_x,
+                                         pos_x + note_quads->size_x[i],
+                                         note_quads->pos_y[i],
+                                         note_quads->layer[i],
+                                         note_quads->hidden[i])) {
+            continue;
+        }
+        hits[hits_count++] = i;
+    }
+    query->hits_count = hits_count;
+    return hits_count;
+}
+
+static inline uint8_t war_note_query_record(war_note_query* query,
+                                            war_note_swap_record* record) {
+    return war_note_query_match_fields(query,
+                                       record->pos_x,
+                                       record->pos_x + record->size_x,
+                                       record->pos_y,
+                                       record->layer,
+                                       record->hidden);
+}
+
+// narrows the query to the run of touching or overlapping notes on the
+// cursor row that contains the cursor, returns 0 when the cursor isn't on
+// a note
+static inline uint8_t war_note_query_word(war_env* env,
+                                          war_note_query* query) {
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_quads* note_quads = env->note_quads;
+    war_note_key* keys = query->keys;
+    query->bottom_row = ctx_wr->cursor_pos_y;
+    query->top_row = ctx_wr->cursor_pos_y;
+    query->left_col = -DBL_MAX;
+    query->right_col = DBL_MAX;
+    query->flags &= ~NOTE_QUERY_OUTSIDE;
+    uint32_t n = war_note_query_run(note_quads, query);
+    for (uint32_t k = 0; k < n; k++) {
+        keys[k].pos_x = note_quads->pos_x[query->hits[k]];
+        keys[k].idx = query->hits[k];
+    }
+    qsort(keys, n, sizeof(war_note_key), war_note_key_compare);
+    double cursor_start = ctx_wr->cursor_pos_x;
+    double cursor_end = cursor_start + ctx_wr->cursor_size_x;
+    uint32_t k = 0;
+    while (k < n) {
+        double run_start = keys[k].pos_x;
+        double run_end = run_start + note_quads->size_x[keys[k].idx];
+        uint8_t under_cursor = 0;
+        for (; k < n && keys[k].pos_x <= run_end; k++) {
+            double end_x = keys[k].pos_x + note_quads->size_x[keys[k].idx];
+            if (end_x > cursor_start && keys[k].pos_x < cursor_end) {
+                under_cursor = 1;
+            }
+            if (end_x > run_end) { run_end = end_x; }
+        }
+        if (!under_cursor) { continue; }
+        query->left_col = run_start;
+        query->right_col = run_end;
+        return 1;
+    }
+    return 0;
+}
+
+// runs the query over resident and swapped notes, applies op and records
+// every note it actually changed in one undo node
+static inline uint32_t war_note_query_apply(war_env* env,
+                                            war_note_query* query,
+                                            uint32_t op) {
+    war_note_quads* note_quads = env->note_quads;
+    war_note_swap* swap = env->note_swap;
+    switch (op) {
+    case NOTE_OP_HIDE:
+        query->flags = (query->flags & ~NOTE_QUERY_HIDDEN) | NOTE_QUERY_VISIBLE;
+        break;
+    case NOTE_OP_SHOW:
+        query->flags = (query->flags & ~NOTE_QUERY_VISIBLE) | NOTE_QUERY_HIDDEN;
+        break;
+    }
+    uint32_t mute = op == NOTE_OP_MUTE;
+    uint8_t check_mute = op == NOTE_OP_MUTE || op == NOTE_OP_UNMUTE;
+    uint8_t ids_only = op != NOTE_OP_DELETE;
+    war_note_quad note_quad;
+    // first pass sizes the undo payload, the second writes the same notes
+    // in the same order
+    war_note_log log = {0};
+    war_note_query_run(note_quads, query);
+    uint32_t hits_count = 0;
+    for (uint32_t k = 0; k < query->hits_count; k++) {
+        uint32_t i = query->hits[k];
+        if (check_mute && (note_quads->mute[i] != 0) == mute) { continue; }
+        query->hits[hits_count++] = i;
+        war_note_quads_get(note_quads, i, &note_quad);
+        war_note_log_put(&log, &note_quad, ids_only);
+    }
+    query->hits_count = hits_count;
+    uint8_t prune = !(query->flags & NOTE_QUERY_OUTSIDE);
+    uint32_t swap_count = 0;
+    for (uint32_t page = 0; page < swap->pages_used && swap->notes_count;
+         page++) {
+        if (!swap->page_count[page]) { continue; }
+        if (prune && (swap->page_max_col[page] <= query->left_col ||
+                      swap->page_min_col[page] >= query->right_col)) {
+            continue;
+        }
+        if (!war_note_swap_page_check(swap, page)) { continue; }
+        war_note_swap_record* records =
+            swap->records + (size_t)page * swap->page_notes;
+        for (uint32_t j = 0; j < swap->page_count[page]; j++) {
+            if (!war_note_query_record(query, &records[j])) { continue; }
+            if (check_mute && (records[j].mute != 0) == mute) { continue; }
+            war_note_swap_unpack(&records[j], &note_quad);
+            war_note_log_put(&log, &note_quad, ids_only);
+            swap_count++;
+        }
+    }
+    uint32_t count = hits_count + swap_count;
+    if (!count) { return 0; }
+    static const uint32_t commands[] = {
+        [NOTE_OP_DELETE] = CMD_DELETE_NOTES,
+        [NOTE_OP_HIDE] = CMD_HIDE_NOTES,
+        [NOTE_OP_SHOW] = CMD_SHOW_NOTES,
+        [NOTE_OP_MUTE] = CMD_MUTE_NOTES,
+        [NOTE_OP_UNMUTE] = CMD_UNMUTE_NOTES,
+    };
+    war_undo_node* node = war_undo_node_push(env, commands[op]);
+    if (!war_undo_node_log_open(env, node, &log, count)) {
+        war_undo_node_free(env, node);
+        return 0;
+    }
+    for (uint32_t k = 0; k < hits_count; k++) {
+        uint32_t i = query->hits[k];
+        war_note_quads_get(note_quads, i, &note_quad);
+        war_note_log_put(&log, &note_quad, ids_only);
+        war_note_quads_dirty(note_quads, note_quad.pos_x);
+        switch (op) {
+        case NOTE_OP_DELETE:
+            note_quads->alive[i] = 0;
+            break;
+        case NOTE_OP_HIDE:
+        case NOTE_OP_SHOW:
+            note_quads->hidden[i] = op == NOTE_OP_HIDE;
+            break;
+        default:
+            note_quads->mute[i] = mute;
+            break;
+        }
+    }
+    // deletes filter each page in place so the order matches the first pass
+    uint32_t k = hits_count;
+    for (uint32_t page = 0; page < swap->pages_used && k < count; page++) {
+        if (!swap->page_count[page] || !war_note_swap_page_check(swap, page)) {
+            continue;
+        }
+        war_note_swap_record* records =
+            swap->records + (size_t)page * swap->page_notes;
+        uint32_t kept = 0;
+        for (uint32_t j = 0; j < swap->page_count[page]; j++) {
+            war_note_swap_record* record = &records[j];
+            if (k >= count || !war_note_query_record(query, record) ||
+                (check_mute && (record->mute != 0) == mute)) {
+                records[kept++] = *record;
+                continue;
+            }
+            war_note_swap_unpack(record, &note_quad);
+            war_note_log_put(&log, &note_quad, ids_only);
+            war_note_quads_dirty(note_quads, record->pos_x);
+            k++;
+            switch (op) {
+            case NOTE_OP_DELETE:
+                swap->notes_count--;
+                continue;
+            case NOTE_OP_HIDE:
+            case NOTE_OP_SHOW:
+                record->hidden = op == NOTE_OP_HIDE;
+                break;
+            default:
+                record->mute = mute;
+                break;
+            }
+            records[kept++] = *record;
+        }
+        swap->page_count[page] = kept;
+    }
+    assert(log.bytes == node->payload.notes.bytes);
+    note_quads->generation++;
+    call_terry_davis("note query: op %u on %u notes", op, count);
+    return count;
+}
+
+// fills the query for one of the roll mode scopes: visible notes in the
+// active layers, hidden ones for show. returns 0 when the scope is empty
+static inline uint8_t war_note_query_scope(war_env* env,
+                                           war_note_query* query,
+                                           uint32_t op,
+                                           uint32_t scope) {
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    query->layer = atomic_load(&env->atomics->layer);
+    query->flags = op == NOTE_OP_SHOW ? NOTE_QUERY_HIDDEN : NOTE_QUERY_VISIBLE;
+    query->left_col = ctx_wr->left_col;
+    query->right_col = (double)ctx_wr->right_col + 1;
+    query->bottom_row = ctx_wr->bottom_row;
+    query->top_row = ctx_wr->top_row;
+    switch (scope) {
+    case NOTE_SCOPE_OUTSIDE_VIEW:
+        query->flags |= NOTE_QUERY_OUTSIDE;
+        break;
+    case NOTE_SCOPE_IN_WORD:
+        return war_note_query_word(env, query);
+    case NOTE_SCOPE_ALL:
+        query->left_col = -DBL_MAX;
+        query->right_col = DBL_MAX;
+        query->bottom_row = -DBL_MAX;
+        query->top_row = DBL_MAX;
+        break;
+    case NOTE_SCOPE_CURSOR:
+        query->left_col = ctx_wr->cursor_pos_x;
+        query->right_col = ctx_wr->cursor_pos_x + ctx_wr->cursor_size_x;
+        query->bottom_row = ctx_wr->cursor_pos_y;
+        query->top_row = ctx_wr->cursor_pos_y;
+        break;
+    }
+    return 1;
+}
+
+static inline uint32_t war_note_registers_store_notes(war_env* env,
+                                                      war_undo_node* node);
+
+// the roll mode range commands, deletes also fill the selected register
+static inline uint32_t war_note_query_scoped(war_env* env,
+                                             uint32_t op,
+                                             uint32_t scope) {
+    war_note_query* query = env->note_query;
+    if (!war_note_query_scope(env, query, op, scope)) { return 0; }
+    uint32_t count = war_note_query_apply(env, query, op);
+    if (count && op == NOTE_OP_DELETE) {
+        war_note_registers_store_notes(env, env->undo_tree->current);
+    }
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+// NOTE REGISTERS
+//-----------------------------------------------------------------------------
+// registers hold blocks, immutable SoA snapshots in one arena. a register or
+// a paste undo node holds a reference, not a copy, so yanking into several
+// registers and pasting a block any number of times never duplicates it
+
+// NOTE_REGISTER_COUNT when name isn't a register
+static inline uint32_t war_note_register_of(uint32_t name) {
+    if (name == '"') { return NOTE_REGISTER_UNNAMED; }
+    if (name >= '0' && name <= '9') { return NOTE_REGISTER_YANK + name - '0'; }
+    if (name >= 'a' && name <= 'z') { return 11 + name - 'a'; }
+    return NOTE_REGISTER_COUNT;
+}
+
+static inline void war_note_block_release(war_note_registers* registers,
+                                          uint32_t block) {
+    war_note_block* b = &registers->blocks[block];
+    if (b->refs && !--b->refs) { b->count = 0; }
+}
+
+// slides live blocks down over released ones in offset order. blocks are
+// only ever held by index so nothing else needs patching
+static inline void war_note_registers_compact(war_note_registers* registers) {
+    war_note_quads* notes = registers->notes;
+    war_note_quad note_quad;
+    uint32_t used = 0;
+    uint32_t floor = 0;
+    for (;;) {
+        uint32_t next = UINT32_MAX;
+        for (uint32_t b = 0; b < registers->blocks_max; b++) {
+            war_note_block* block = &registers->blocks[b];
+            if (!block->refs || block->offset < floor) { continue; }
+            if (next == UINT32_MAX ||
+                block->offset < registers->blocks[next].offset) {
+                next = b;
+            }
+        }
+        if (next == UINT32_MAX) { break; }
+        war_note_block* block = &registers->blocks[next];
+        floor = block->offset + block->count;
+        if (block->offset != used) {
+            for (uint32_t k = 0; k < block->count; k++) {
+                war_note_quads_get(notes, block->offset + k, &note_quad);
+                war_note_quads_set(notes, used + k, &note_quad);
+            }
+            block->offset = used;
+        }
+        used += block->count;
+    }
+    registers->notes_used = used;
+}
+
+// a block with room for count notes and one reference, UINT32_MAX when the
+// block table or the arena is full
+static inline uint32_t war_note_block_alloc(war_note_registers* registers,
+                                            uint32_t count) {
+    uint32_t block = UINT32_MAX;
+    for (uint32_t b = 0; b < registers->blocks_max; b++) {
+        if (!registers->blocks[b].refs) {
+            block = b;
+            break;
+        }
+    }
+    if (block == UINT32_MAX) { return UINT32_MAX; }
+    uint32_t notes_max = registers->notes->note_quads_max;
+    if (registers->notes_used + count > notes_max) {
+        war_note_registers_compact(registers);
+        if (registers->notes_used + count > notes_max) { return UINT32_MAX; }
+    }
+    war_note_block* b = &registers->blocks[block];
+    b->offset = registers->notes_used;
+    b->count = count;
+    b->refs = 1;
+    b->width = 0.0;
+    registers->notes_used += count;
+    return block;
+}
+
+// hands the allocation reference of block to the selected register, the
+// unnamed register and on yanks "0 follow along like in vim
+static inline void war_note_registers_store(war_note_registers* registers,
+                                            uint32_t block,
+                                            uint8_t yank) {
+    uint32_t targets[3] = {registers->selected, NOTE_REGISTER_UNNAMED};
+    uint32_t targets_count = 2;
+    if (yank && registers->selected == NOTE_REGISTER_UNNAMED) {
+        targets[targets_count++] = NOTE_REGISTER_YANK;
+    }
+    registers->blocks[block].refs += targets_count - 1;
+    for (uint32_t t = 0; t < targets_count; t++) {
+        uint32_t slot = targets[t];
+        if (t && slot == targets[0]) {
+            war_note_block_release(registers, block);
+            continue;
+        }
+        if (registers->slot[slot]) {
+            war_note_block_release(registers, registers->slot[slot] - 1);
+        }
+        registers->slot[slot] = block + 1;
+    }
+    registers->selected = NOTE_REGISTER_UNNAMED;
+}
+
+// patterns longer than a bar repeat on the bar grid, shorter ones back to
+// back
+static inline double war_note_block_width(war_env* env, double extent) {
+    war_lua_context* ctx_lua = env->ctx_lua;
+    double bar_cols = atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT) *
+                      atomic_load(&ctx_lua->WR_NOTE_CHUNK_BEATS);
+    if (bar_cols <= 0.0 || extent <= bar_cols) { return extent; }
+    return ceil(extent / bar_cols - 1e-9) * bar_cols;
+}
+
+// decodes the notes a delete logged in node into a new block
+static inline uint32_t war_note_registers_store_notes(war_env* env,
+                                                      war_undo_node* node) {
+    war_note_registers* registers = env->note_registers;
+    uint32_t count = node->payload.notes.count;
+    uint32_t block = war_note_block_alloc(registers, count);
+    if (block == UINT32_MAX) {
+        call_terry_davis("note registers: no room for %u notes", count);
+        registers->selected = NOTE_REGISTER_UNNAMED;
+        return 0;
+    }
+    war_note_log log;
+    war_note_quad note_quad;
+    double min_x = DBL_MAX;
+    double max_x = -DBL_MAX;
+    war_undo_node_log_read(env, node, &log);
+    for (uint32_t k = 0; k < count; k++) {
+        war_note_log_get(&log, &note_quad, 0);
+        if (note_quad.pos_x < min_x) { min_x = note_quad.pos_x; }
+        double end_x = note_quad.pos_x + note_quad.size_x;
+        if (end_x > max_x) { max_x = end_x; }
+    }
+    double row = floor(env->ctx_wr->cursor_pos_y);
+    war_note_block* b = &registers->blocks[block];
+    war_undo_node_log_read(env, node, &log);
+    for (uint32_t k = 0; k < count; k++) {
+        war_note_log_get(&log, &note_quad, 0);
+        note_quad.pos_x -= min_x;
+        note_quad.pos_y -= row;
+        war_note_quads_set(registers->notes, b->offset + k, &note_quad);
+    }
+    b->width = war_note_block_width(env, max_x - min_x);
+    war_note_registers_store(registers, block, 0);
+    return count;
+}
+
+// snapshots every resident and swapped note in scope into a new block,
+// nothing in the song changes. the selected register is spent either way
+static inline uint32_t war_note_registers_yank(war_env* env, uint32_t scope) {
+    war_note_registers* registers = env->note_registers;
+    war_note_quads* note_quads = env->note_quads;
+    war_note_swap* swap = env->note_swap;
+    war_note_query* query = env->note_query;
+    if (!war_note_query_scope(env, query, NOTE_OP_DELETE, scope)) {
+        registers->selected = NOTE_REGISTER_UNNAMED;
+        return 0;
+    }
+    uint32_t hits_count = war_note_query_run(note_quads, query);
+    double min_x = DBL_MAX;
+    double max_x = -DBL_MAX;
+    for (uint32_t k = 0; k < hits_count; k++) {
+        uint32_t i = query->hits[k];
+        double end_x = note_quads->pos_x[i] + note_quads->size_x[i];
+        if (note_quads->pos_x[i] < min_x) { min_x = note_quads->pos_x[i]; }
+        if (end_x > max_x) { max_x = end_x; }
+    }
+    uint8_t prune = !(query->flags & NOTE_QUERY_OUTSIDE);
+    uint32_t count = hits_count;
+    for (uint32_t page = 0; page < swap->pages_used && swap->notes_count;
+         page++) {
+        if (!swap->page_count[page]) { continue; }
+        if (prune && (swap->page_max_col[page] <= query->left_col ||
+                      swap->page_min_col[page] >= query->right_col)) {
+            continue;
+        }
+        if (!war_note_swap_page_check(swap, page)) { continue; }
+        war_note_swap_record* records =
+            swap->records + (size_t)page * swap->page_notes;
+        for (uint32_t j = 0; j < swap->page_count[page]; j++) {
+            if (!war_note_query_record(query, &records[j])) { continue; }
+            double end_x = records[j].pos_x + records[j].size_x;
+            if (records[j].pos_x < min_x) { min_x = records[j].pos_x; }
+            if (end_x > max_x) { max_x = end_x; }
+            count++;
+        }
+    }
+    if (!count) {
+        registers->selected = NOTE_REGISTER_UNNAMED;
+        return 0;
+    }
+    uint32_t block = war_note_block_alloc(registers, count);
+    if (block == UINT32_MAX) {
+        call_terry_davis("note registers: no room for %u notes", count);
+        registers->selected = NOTE_REGISTER_UNNAMED;
+        return 0;
+    }
+    war_note_block* b = &registers->blocks[block];
+    double row = floor(env->ctx_wr->cursor_pos_y);
+    war_note_quad note_quad;
+    uint32_t k = 0;
+    for (; k < hits_count; k++) {
+        war_note_quads_get(note_quads, query->hits[k], &note_quad);
+        note_quad.pos_x -= min_x;
+        note_quad.pos_y -= row;
+        war_note_quads_set(registers->notes, b->offset + k, &note_quad);
+    }
+    for (uint32_t page = 0; page < swap->pages_used && k < count; page++) {
+        if (!swap->page_count[page] || !war_note_swap_page_check(swap, page)) {
+            continue;
+        }
+        war_note_swap_record* records =
+            swap->records + (size_t)page * swap->page_notes;
+        for (uint32_t j = 0; j < swap->page_count[page] && k < count; j++) {
+            if (!war_note_query_record(query, &records[j])) { continue; }
+            war_note_swap_unpack(&records[j], &note_quad);
+            note_quad.pos_x -= min_x;
+            note_quad.pos_y -= row;
+            war_note_quads_set(registers->notes, b->offset + k++, &note_quad);
+        }
+    }
+    b->width = war_note_block_width(env, max_x - min_x);
+    war_note_registers_store(registers, block, 1);
+    call_terry_davis("note registers: yanked %u notes", count);
+    return count;
+}
+
+// bulk appends repeat copies of block, the r-th at pos_x + r * stride_x,
+// with ids first_id onwards. copies that fall off the roll come in dead
+static inline uint32_t war_note_block_paste(war_env* env,
+                                            uint32_t block,
+                                            double pos_x,
+                                            double pos_y,
+                                            double stride_x,
+                                            uint32_t repeat,
+                                            uint64_t first_id) {
+    war_note_registers* registers = env->note_registers;
+    war_note_quads* src = registers->notes;
+    war_note_quads* dst = env->note_quads;
+    war_note_block* b = &registers->blocks[block];
+    uint32_t count = b->count;
+    double max_row = env->ctx_wr->max_row;
+    uint32_t pasted = 0;
+    for (uint32_t r = 0; r < repeat; r++) {
+        if (!war_note_quads_reserve(env, count)) {
+            call_terry_davis("note registers: paste stopped at copy %u", r);
+            break;
+        }
+        uint32_t base = dst->count;
+        uint32_t from = b->offset;
+#define WAR_BLOCK_COPY(field)                                                  \
+    memcpy(dst->field + base, src->field + from, sizeof(*dst->field) * count)
+        WAR_BLOCK_COPY(layer);
+        WAR_BLOCK_COPY(size_x);
+        WAR_BLOCK_COPY(navigation_x);
+        WAR_BLOCK_COPY(navigation_x_numerator);
+        WAR_BLOCK_COPY(navigation_x_denominator);
+        WAR_BLOCK_COPY(size_x_numerator);
+        WAR_BLOCK_COPY(size_x_denominator);
+        WAR_BLOCK_COPY(color);
+        WAR_BLOCK_COPY(outline_color);
+        WAR_BLOCK_COPY(gain);
+        WAR_BLOCK_COPY(voice);
+        WAR_BLOCK_COPY(hidden);
+        WAR_BLOCK_COPY(mute);
+#undef WAR_BLOCK_COPY
+        double offset_x = pos_x + r * stride_x;
+        uint64_t id = first_id + (uint64_t)r * count;
+        for (uint32_t k = 0; k < count; k++) {
+            double x = src->pos_x[from + k] + offset_x;
+            double y = src->pos_y[from + k] + pos_y;
+            dst->pos_x[base + k] = x;
+            dst->pos_y[base + k] = y;
+            dst->id[base + k] = id + k;
+            dst->alive[base + k] = x >= 0.0 && y >= 0.0 && y <= max_row;
+        }
+        dst->count += count;
+        for (uint32_t k = 0; k < count; k++) {
+            if (!dst->alive[base + k]) { continue; }
+            war_note_map_insert(dst, base + k);
+            war_note_quads_dirty(dst, dst->pos_x[base + k]);
+        }
+        pasted += count;
+    }
+    dst->generation++;
+    return pasted;
+}
+
+// numeric_prefix copies of the selected register back to back from the
+// cursor, or ending at it when before. one bulk append and one undo node
+// however many copies there are
+static inline uint32_t war_note_registers_put(war_env* env, uint8_t before) {
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_registers* registers = env->note_registers;
+    uint32_t slot = registers->slot[registers->selected];
+    registers->selected = NOTE_REGISTER_UNNAMED;
+    if (!slot) { return 0; }
+    uint32_t block = slot - 1;
+    war_note_block* b = &registers->blocks[block];
+    uint32_t repeat = ctx_wr->numeric_prefix ? ctx_wr->numeric_prefix : 1;
+    double pos_x = ctx_wr->cursor_pos_x;
+    if (before) {
+        pos_x -= repeat * b->width;
+        if (pos_x < ctx_wr->min_col) { pos_x = ctx_wr->min_col; }
+    }
+    uint64_t first_id = atomic_fetch_add(&env->atomics->note_next_id,
+                                         (uint64_t)repeat * b->count);
+    war_undo_node* node = war_undo_node_push(env, CMD_PASTE_NOTES);
+    // the node keeps its own copy of the block so it outlives the register
+    war_note_log log = {0};
+    war_note_quad note_quad;
+    for (uint32_t k = 0; k < b->count; k++) {
+        war_note_quads_get(registers->notes, b->offset + k, &note_quad);
+        war_note_log_put(&log, &note_quad, 0);
+    }
+    if (!war_undo_node_log_open(env, node, &log, b->count)) {
+        war_undo_node_free(env, node);
+        return 0;
+    }
+    for (uint32_t k = 0; k < b->count; k++) {
+        war_note_quads_get(registers->notes, b->offset + k, &note_quad);
+        war_note_log_put(&log, &note_quad, 0);
+    }
+    war_payload_paste_notes* paste = &node->payload.paste_notes;
+    paste->repeat = repeat;
+    paste->pos_x = pos_x;
+    paste->pos_y = floor(ctx_wr->cursor_pos_y);
+    paste->stride_x = b->width;
+    paste->first_id = first_id;
+    uint32_t count = war_note_block_paste(env,
+                                          block,
+                                          paste->pos_x,
+                                          paste->pos_y,
+                                          paste->stride_x,
+                                          paste->repeat,
+                                          paste->first_id);
+    // nothing pasted is no edit, same as a log that did not fit
+    if (!count) {
+        war_undo_node_free(env, node);
+        return 0;
+    }
+    // a reserve that failed partway leaves fewer copies than asked for,
+    // undo and redo only walk the ones that exist
+    paste->repeat = count / b->count;
+    call_terry_davis("note registers: put %u notes", count);
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+// UNDO
+//-----------------------------------------------------------------------------
+// payloads are replayed against the note store by id. the column range a
+// payload covers is faulted in first so the id map resolves nearly all of
+// them, the swap is only scanned for what is still paged out after that
+
+static inline uint8_t war_note_swap_find(war_note_swap* swap,
+                                         uint64_t id,
+                                         uint32_t* page_out,
+                                         uint32_t* j_out) {
+    for (uint32_t page = 0; page < swap->pages_used && swap->notes_count;
+         page++) {
+        if (!war_note_swap_page_check(swap, page)) { continue; }
+        war_note_swap_record* records =
+            swap->records + (size_t)page * swap->page_notes;
+        for (uint32_t j = 0; j < swap->page_count[page]; j++) {
+            if (records[j].id != id) { continue; }
+            *page_out = page;
+            *j_out = j;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// field 0 kills the note with id, 1 sets its hidden and 2 its mute
+static inline uint8_t
+war_undo_note_set(war_env* env, uint64_t id, uint8_t field, uint32_t value) {
+    war_note_quads* note_quads = env->note_quads;
+    war_note_swap* swap = env->note_swap;
+    uint32_t i = war_note_quads_find(note_quads, id);
+    if (i != UINT32_MAX) {
+        war_note_quads_dirty(note_quads, note_quads->pos_x[i]);
+        switch (field) {
+        case 0:
+            note_quads->alive[i] = 0;
+            break;
+        case 1:
+            note_quads->hidden[i] = value;
+            break;
+        default:
+            note_quads->mute[i] = value;
+            break;
+        }
+        return 1;
+    }
+    uint32_t page, j;
+    if (!war_note_swap_find(swap, id, &page, &j)) { return 0; }
+    war_note_swap_record* records =
+        swap->records + (size_t)page * swap->page_notes;
+    war_note_quads_dirty(note_quads, records[j].pos_x);
+    switch (field) {
+    case 0:
+        records[j] = records[--swap->page_count[page]];
+        swap->notes_count--;
+        break;
+    case 1:
+        records[j].hidden = value;
+        break;
+    default:
+        records[j].mute = value;
+        break;
+    }
+    return 1;
+}
+
+// faults in the columns the notes logged in node span
+static inline void war_undo_fault_notes(war_env* env, war_undo_node* node) {
+    uint32_t count = node->payload.notes.count;
+    if (!env->note_swap->notes_count || !count) { return; }
+    war_note_log log;
+    war_note_quad note_quad;
+    double left = DBL_MAX;
+    double right = -DBL_MAX;
+    war_undo_node_log_read(env, node, &log);
+    for (uint32_t k = 0; k < count; k++) {
+        war_note_log_get(&log, &note_quad, 0);
+        if (note_quad.pos_x < left) { left = note_quad.pos_x; }
+        double end_x = note_quad.pos_x + note_quad.size_x;
+        if (end_x > right) { right = end_x; }
+    }
+    war_note_swap_fault(env->note_swap, env->note_quads, left, right);
+}
+
+static inline void war_undo_kill_notes(war_env* env, war_undo_node* node) {
+    war_note_log log;
+    war_note_quad note_quad;
+    war_undo_fault_notes(env, node);
+    war_undo_node_log_read(env, node, &log);
+    for (uint32_t k = 0; k < node->payload.notes.count; k++) {
+        war_note_log_get(&log, &note_quad, 0);
+        war_undo_note_set(env, note_quad.id, 0, 0);
+    }
+}
+
+// one reserve then one append pass over the decoded notes
+static inline void war_undo_revive_notes(war_env* env, war_undo_node* node) {
+    war_note_quads* note_quads = env->note_quads;
+    uint32_t count = node->payload.notes.count;
+    if (!war_note_quads_reserve(env, count)) {
+        call_terry_davis("undo: no room to bring back %u notes", count);
+        return;
+    }
+    war_note_log log;
+    war_note_quad note_quad;
+    war_undo_node_log_read(env, node, &log);
+    for (uint32_t k = 0; k < count; k++) {
+        war_note_log_get(&log, &note_quad, 0);
+        war_note_quads_append(note_quads, &note_quad);
+    }
+}
+
+// the columns every copy of a paste spans
+static inline void war_undo_paste_extent(war_env* env,
+                                         war_undo_node* node,
+                                         double* left,
+                                         double* right) {
+    war_payload_paste_notes* paste = &node->payload.paste_notes;
+    war_note_log log;
+    war_note_quad note_quad;
+    double width = 0.0;
+    war_undo_node_log_read(env, node, &log);
+    for (uint32_t k = 0; k < paste->block.count; k++) {
+        war_note_log_get(&log, &note_quad, 0);
+        double end_x = note_quad.pos_x + note_quad.size_x;
+        if (end_x > width) { width = end_x; }
+    }
+    *left = paste->pos_x;
+    *right = paste->pos_x + (paste->repeat - 1) * paste->stride_x + width;
+}
+
+static inline void war_undo_kill_paste(war_env* env, war_undo_node* node) {
+    war_payload_paste_notes* paste = &node->payload.paste_notes;
+    if (env->note_swap->notes_count) {
+        double left, right;
+        war_undo_paste_extent(env, node, &left, &right);
+        war_note_swap_fault(env->note_swap, env->note_quads, left, right);
+    }
+    uint64_t total = (uint64_t)paste->repeat * paste->block.count;
+    for (uint64_t k = 0; k < total; k++) {
+        war_undo_note_set(env, paste->first_id + k, 0, 0);
+    }
+}
+
+// same placement as war_note_block_paste, from the logged block
+static inline void war_undo_revive_paste(war_env* env, war_undo_node* node) {
+    war_payload_paste_notes* paste = &node->payload.paste_notes;
+    war_note_quads* note_quads = env->note_quads;
+    uint32_t count = paste->block.count;
+    double max_row = env->ctx_wr->max_row;
+    war_note_log log;
+    war_note_quad note_quad;
+    for (uint32_t r = 0; r < paste->repeat; r++) {
+        if (!war_note_quads_reserve(env, count)) {
+            call_terry_davis("undo: paste stopped at copy %u", r);
+            break;
+        }
+        double offset_x = paste->pos_x + r * paste->stride_x;
+        uint64_t id = paste->first_id + (uint64_t)r * count;
+        war_undo_node_log_read(env, node, &log);
+        for (uint32_t k = 0; k < count; k++) {
+            war_note_log_get(&log, &note_quad, 0);
+            note_quad.pos_x += offset_x;
+            note_quad.pos_y += paste->pos_y;
+            note_quad.id = id + k;
+            note_quad.alive = note_quad.pos_x >= 0.0 &&
+                              note_quad.pos_y >= 0.0 &&
+                              note_quad.pos_y <= max_row;
+            war_note_quads_append(note_quads, &note_quad);
+        }
+    }
+}
+
+// undoes node, or replays it when redo
+static inline void
+war_undo_node_apply(war_env* env, war_undo_node* node, uint8_t redo) {
+    switch (node->command) {
+    case CMD_ADD_NOTE:
+    case CMD_ADD_NOTES:
+    case CMD_ADD_NOTES_SAME:
+        if (redo) {
+            war_undo_revive_notes(env, node);
+        } else {
+            war_undo_kill_notes(env, node);
+        }
+        break;
+    case CMD_DELETE_NOTE:
+    case CMD_DELETE_NOTES:
+    case CMD_DELETE_NOTES_SAME:
+        if (redo) {
+            war_undo_kill_notes(env, node);
+        } else {
+            war_undo_revive_notes(env, node);
+        }
+        break;
+    case CMD_HIDE_NOTES:
+    case CMD_SHOW_NOTES:
+    case CMD_MUTE_NOTES:
+    case CMD_UNMUTE_NOTES: {
+        uint8_t field = node->command <= CMD_SHOW_NOTES ? 1 : 2;
+        uint32_t value = node->command == CMD_HIDE_NOTES ||
+                         node->command == CMD_MUTE_NOTES;
+        if (!redo) { value = !value; }
+        war_note_log log;
+        war_note_quad note_quad;
+        war_undo_node_log_read(env, node, &log);
+        for (uint32_t k = 0; k < node->payload.notes.count; k++) {
+            war_note_log_get(&log, &note_quad, 1);
+            war_undo_note_set(env, note_quad.id, field, value);
+        }
+        break;
+    }
+    case CMD_PASTE_NOTES:
+        if (redo) {
+            war_undo_revive_paste(env, node);
+        } else {
+            war_undo_kill_paste(env, node);
+        }
+        break;
+    }
+    env->note_quads->generation++;
+}
+
+// puts the cursor and view back where they were when node was recorded
+static inline void war_undo_node_restore_view(war_env* env,
+                                              war_undo_node* node) {
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    ctx_wr->cursor_pos_x = node->cursor_pos_x;
+    ctx_wr->cursor_pos_y = node->cursor_pos_y;
+    ctx_wr->left_col = node->left_col;
+    ctx_wr->right_col = node->right_col;
+    ctx_wr->bottom_row = node->bottom_row;
+    ctx_wr->top_row = node->top_row;
+}
+
+// faults in the columns the notes a jump removes or adds span
+static inline void war_undo_jump_fault(war_env* env, war_undo_node* node) {
+    war_undo_jump* jump = &node->jump;
+    uint32_t count = jump->removed + jump->added;
+    if (!env->note_swap->notes_count || !count) { return; }
+    war_note_log log = {.data = env->undo_tree->payload + jump->offset};
+    war_note_quad note_quad;
+    double left = DBL_MAX;
+    double right = -DBL_MAX;
+    for (uint32_t k = 0; k < count; k++) {
+        war_note_log_get(&log, &note_quad, 0);
+        if (note_quad.pos_x < left) { left = note_quad.pos_x; }
+        double end_x = note_quad.pos_x + note_quad.size_x;
+        if (end_x > right) { right = end_x; }
+    }
+    war_note_swap_fault(env->note_swap, env->note_quads, left, right);
+}
+
+// undo takes the state after node's parent back to the state after its
+// anchor, redo the other way round
+static inline void
+war_undo_jump_apply(war_env* env, war_undo_node* node, uint8_t redo) {
+    war_note_quads* note_quads = env->note_quads;
+    war_undo_jump* jump = &node->jump;
+    uint32_t revive = redo ? jump->added : jump->removed;
+    war_undo_jump_fault(env, node);
+    uint8_t room = war_note_quads_reserve(env, revive);
+    if (!room) {
+        call_terry_davis("undo: no room to bring back %u notes", revive);
+    }
+    war_note_log log = {.data = env->undo_tree->payload + jump->offset};
+    war_note_quad note_quad;
+    for (uint32_t k = 0; k < jump->removed + jump->added; k++) {
+        war_note_log_get(&log, &note_quad, 0);
+        if ((k < jump->removed) == redo) {
+            war_undo_note_set(env, note_quad.id, 0, 0);
+        } else if (room) {
+            war_note_quads_append(note_quads, &note_quad);
+        }
+    }
+    for (uint32_t k = 0; k < jump->flipped; k++) {
+        war_note_log_get(&log, &note_quad, 1);
+        uint8_t flags = log.data[log.bytes++];
+        if (flags & WAR_UNDO_JUMP_HIDDEN) {
+            uint8_t bit = redo ? WAR_UNDO_JUMP_HIDDEN_AFTER :
+                                 WAR_UNDO_JUMP_HIDDEN_BEFORE;
+            war_undo_note_set(env, note_quad.id, 1, !!(flags & bit));
+        }
+        if (flags & WAR_UNDO_JUMP_MUTE) {
+            uint8_t bit =
+                redo ? WAR_UNDO_JUMP_MUTE_AFTER : WAR_UNDO_JUMP_MUTE_BEFORE;
+            war_undo_note_set(env, note_quad.id, 2, !!(flags & bit));
+        }
+    }
+    note_quads->generation++;
+}
+
+// the anchor node's jump lands on when that is still at or below lca, a
+// NULL lca being above every root
+static inline war_undo_node* war_undo_node_jump_to(war_undo_node* node,
+                                                   war_undo_node* lca) {
+    war_undo_node* anchor = node->anchor;
+    if (!anchor || anchor->id != node->anchor_id) { return NULL; }
+    if (lca && anchor->depth < lca->depth) { return NULL; }
+    return anchor;
+}
+
+// points redo from the top down to node
+static inline void war_undo_node_follow(war_undo_tree* undo_tree,
+                                        war_undo_node* node) {
+    for (; node; node = node->prev) {
+        if (node->prev) {
+            node->prev->next = node;
+        } else {
+            undo_tree->root = node;
+        }
+    }
+}
+
+// rough count of notes replaying node touches, its jump included when a
+// seek bounded by lca takes it
+static inline uint64_t war_undo_node_cost(war_undo_node* node,
+                                          war_undo_node* lca) {
+    uint64_t cost = node->command == CMD_PASTE_NOTES ?
+                        (uint64_t)node->payload.paste_notes.block.count *
+                            node->payload.paste_notes.repeat :
+                        node->payload.notes.count;
+    if (war_undo_node_jump_to(node, lca)) {
+        cost += node->jump.removed + node->jump.added + node->jump.flipped;
+    }
+    return cost + 1;
+}
+
+static inline uint64_t war_undo_path_cost(war_undo_node* node,
+                                          war_undo_node* lca) {
+    uint64_t cost = 0;
+    while (node != lca) {
+        cost += war_undo_node_cost(node, lca);
+        war_undo_node* anchor = war_undo_node_jump_to(node, lca);
+        node = anchor ? anchor : node->prev;
+    }
+    return cost;
+}
+
+// the node at or above target whose snapshot plus the nodes below it
+// undercut cost, NULL when replaying is cheaper
+static inline war_undo_node*
+war_note_snapshot_find(war_env* env, war_undo_node* target, uint64_t cost) {
+    uint64_t below = 0;
+    for (war_undo_node* node = target; node && below < cost;
+         node = node->prev) {
+        war_note_snapshot* snapshot = war_note_snapshot_of(env, node);
+        if (snapshot && snapshot->notes_count + below < cost) { return node; }
+        // bounded by itself, so no jump
+        below += war_undo_node_cost(node, node);
+    }
+    return NULL;
+}
+
+// closest common ancestor of current and target, NULL being above every
+// root. top and other_top are the roots the two paths left by. returns 0
+// when the two only met in evicted history
+static inline uint8_t war_undo_seek_lca(war_undo_tree* undo_tree,
+                                        war_undo_node* target,
+                                        war_undo_node** lca_out,
+                                        war_undo_node** top_out) {
+    war_undo_node* current = undo_tree->current;
+    war_undo_node* lca = current;
+    war_undo_node* other = target;
+    war_undo_node* top = current ? NULL : undo_tree->root;
+    war_undo_node* other_top = NULL;
+    while (lca != other) {
+        if (!lca || (other && other->depth > lca->depth)) {
+            other_top = other;
+            other = other->prev;
+        } else {
+            top = lca;
+            lca = lca->prev;
+        }
+    }
+    *lca_out = lca;
+    *top_out = top;
+    return lca || top == other_top || ((!top || !top->parent_id) &&
+                                       (!other_top || !other_top->parent_id));
+}
+
+// moves current to target, NULL being the state before the roots pushed
+// from it. undoes up to the closest common ancestor and redoes down to
+// target, crossing checkpoints with their jumps, or restores a snapshot
+// above target when that is cheaper. returns 0 when the two only met in
+// evicted history and no snapshot bridges them
+static inline uint8_t war_undo_seek(war_env* env, war_undo_node* target) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    war_undo_node* lca;
+    war_undo_node* top;
+    uint8_t reachable = war_undo_seek_lca(undo_tree, target, &lca, &top);
+    uint64_t cost = reachable ?
+                        war_undo_path_cost(undo_tree->current, lca) +
+                            war_undo_path_cost(target, lca) :
+                        UINT64_MAX;
+    war_undo_node* last = NULL;
+    war_undo_node* from = war_note_snapshot_find(env, target, cost);
+    // a snapshot that doesn't fit leaves the seek to replay from current
+    if (from &&
+        war_note_snapshot_restore(env, war_note_snapshot_of(env, from))) {
+        undo_tree->current = from;
+        last = from;
+        reachable = war_undo_seek_lca(undo_tree, target, &lca, &top);
+    }
+    if (!reachable) { return 0; }
+    war_undo_node* node = undo_tree->current;
+    while (node != lca) {
+        war_undo_node_apply(env, node, 0);
+        last = node;
+        war_undo_node* anchor = war_undo_node_jump_to(node, lca);
+        if (anchor) { war_undo_jump_apply(env, node, 0); }
+        node = anchor ? anchor : node->prev;
+    }
+    uint32_t hops = 0;
+    for (node = target; node != lca; hops++) {
+        undo_tree->seek_path[hops] = node;
+        war_undo_node* anchor = war_undo_node_jump_to(node, lca);
+        node = anchor ? anchor : node->prev;
+    }
+    while (hops) {
+        node = undo_tree->seek_path[--hops];
+        if (war_undo_node_jump_to(node, lca)) {
+            war_undo_jump_apply(env, node, 1);
+        }
+        war_undo_node_apply(env, node, 1);
+        last = node;
+    }
+    war_undo_node_follow(undo_tree, target);
+    if (!target && top) { undo_tree->root = top; }
+    undo_tree->current = target;
+    if (last) { war_undo_node_restore_view(env, last); }
+    return 1;
+}
+
+// the live node with seq_num, NULL once it is evicted
+static inline war_undo_node* war_undo_node_seq(war_undo_tree* undo_tree,
+                                               int64_t seq_num) {
+    if (seq_num <= 0) { return NULL; }
+    war_undo_node* node =
+        undo_tree->seq_index[(uint64_t)seq_num % undo_tree->nodes_max];
+    return node && node->seq_num == (uint64_t)seq_num ? node : NULL;
+}
+
+// moves steps changes back or forth in the order they were made, across
+// branches, like g- and g+
+static inline void war_undo_step(war_env* env, int64_t steps) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    if (!undo_tree->newest || !steps) { return; }
+    int64_t oldest = (int64_t)undo_tree->oldest->seq_num;
+    int64_t newest = (int64_t)undo_tree->newest->seq_num;
+    int64_t seq_num =
+        undo_tree->current ? (int64_t)undo_tree->current->seq_num : 0;
+    int64_t target_seq = seq_num + steps;
+    if (target_seq > newest) { target_seq = newest; }
+    if (target_seq < oldest - 1) { target_seq = oldest - 1; }
+    war_undo_node* target = NULL;
+    if (steps < 0) {
+        while (target_seq >= oldest &&
+               !(target = war_undo_node_seq(undo_tree, target_seq))) {
+            target_seq--;
+        }
+    } else {
+        while (target_seq <= newest &&
+               !(target = war_undo_node_seq(undo_tree, target_seq))) {
+            target_seq++;
+        }
+        if (!target) { return; }
+    }
+    if (target == undo_tree->current) { return; }
+    if (!war_undo_seek(env, target)) {
+        call_terry_davis("undo: change %lld is cut off by evicted history",
+                         (long long)target_seq);
+    }
+}
+
+// newest live node made at or before time, NULL when every one is later.
+// timestamps rise with seq_num so this bisects seq_index
+static inline war_undo_node* war_undo_node_at(war_undo_tree* undo_tree,
+                                              uint64_t time) {
+    if (!undo_tree->newest) { return NULL; }
+    int64_t low = (int64_t)undo_tree->oldest->seq_num;
+    int64_t high = (int64_t)undo_tree->newest->seq_num;
+    war_undo_node* found = NULL;
+    while (low <= high) {
+        int64_t mid = low + (high - low) / 2;
+        int64_t probe = mid;
+        war_undo_node* node = NULL;
+        while (probe >= low && !(node = war_undo_node_seq(undo_tree, probe))) {
+            probe--;
+        }
+        if (!node) {
+            low = mid + 1;
+        } else if (node->timestamp <= time) {
+            found = node;
+            low = mid + 1;
+        } else {
+            high = probe - 1;
+        }
+    }
+    return found;
+}
+
+// moves to the state as it was us microseconds before or after current
+// was made, at least one change
+static inline void war_undo_travel(war_env* env, int64_t us) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    war_undo_node* current = undo_tree->current;
+    if (!undo_tree->newest || !us || (!current && us < 0)) { return; }
+    uint64_t base =
+        current ? current->timestamp : undo_tree->oldest->timestamp;
+    uint64_t time = us < 0 && (uint64_t)-us > base ? 0 : base + us;
+    war_undo_node* target = war_undo_node_at(undo_tree, time);
+    uint64_t seq_num = current ? current->seq_num : 0;
+    uint64_t target_seq = target ? target->seq_num : 0;
+    if ((us < 0 && target_seq >= seq_num) ||
+        (us > 0 && target_seq <= seq_num)) {
+        war_undo_step(env, us < 0 ? -1 : 1);
+        return;
+    }
+    if (!war_undo_seek(env, target)) {
+        call_terry_davis("undo: that state is cut off by evicted history");
+    }
+}
+
+// :earlier and :later take a count of changes, or a time ending in s, m, h
+// or d. direction is -1 for earlier
+static inline void
+war_undo_travel_command(war_env* env, const char* arg, int8_t direction) {
+    char* end = (char*)arg;
+    uint64_t amount = 1;
+    if (*arg) { amount = strtoull(arg, &end, 10); }
+    uint64_t unit = 0;
+    switch (*end) {
+    case 's':
+        unit = 1000000ULL;
+        break;
+    case 'm':
+        unit = 60ULL * 1000000ULL;
+        break;
+    case 'h':
+        unit = 3600ULL * 1000000ULL;
+        break;
+    case 'd':
+        unit = 86400ULL * 1000000ULL;
+        break;
+    }
+    if ((*arg && end == arg) || end[unit ? 1 : 0] != '\0') {
+        call_terry_davis("undo: bad count or time: %s", arg);
+        return;
+    }
+    if (unit) {
+        war_undo_travel(env, direction * (int64_t)(amount * unit));
+    } else {
+        war_undo_step(env, direction * (int64_t)amount);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// UNDOFILE
+//-----------------------------------------------------------------------------
+// history is appended to .<name>.un~ next to the project, like vim's
+// undofile. the render thread only copies records into the queue once a
+// frame, the writer thread batches them out every WR_UNDOFILE_FLUSH_US. on
+// open the file is mmapped and its records replayed into the undo tree
+
+static inline uint64_t war_undofile_space(war_undofile* undofile) {
+    return undofile->queue_size -
+           (atomic_load_explicit(&undofile->queue_head, memory_order_relaxed) -
+            atomic_load_explicit(&undofile->queue_tail, memory_order_acquire));
+}
+
+// the caller checked war_undofile_space
+static inline void
+war_undofile_queue(war_undofile* undofile, const void* data, size_t size) {
+    uint64_t head =
+        atomic_load_explicit(&undofile->queue_head, memory_order_relaxed);
+    uint64_t offset = head % undofile->queue_size;
+    size_t first = undofile->queue_size - offset;
+    if (first > size) { first = size; }
+    memcpy(undofile->queue + offset, data, first);
+    memcpy(undofile->queue, (const uint8_t*)data + first, size - first);
+    atomic_store_explicit(
+        &undofile->queue_head, head + size, memory_order_release);
+}
+
+// writer side, called with mutex held
+static inline void war_undofile_drain(war_undofile* undofile) {
+    uint64_t head =
+        atomic_load_explicit(&undofile->queue_head, memory_order_acquire);
+    uint64_t tail =
+        atomic_load_explicit(&undofile->queue_tail, memory_order_relaxed);
+    while (tail < head) {
+        uint64_t offset = tail % undofile->queue_size;
+        size_t run = undofile->queue_size - offset;
+        if (run > head - tail) { run = head - tail; }
+        ssize_t written = (ssize_t)run;
+        if (undofile->fd >= 0) {
+            written = write(undofile->fd, undofile->queue + offset, run);
+        }
+        if (written < 0) {
+            if (errno == EINTR) { continue; }
+            call_terry_davis("undofile: write failed, dropping %zu bytes", run);
+            written = (ssize_t)run;
+        }
+        tail += (uint64_t)written;
+    }
+    atomic_store_explicit(&undofile->queue_tail, tail, memory_order_release);
+    pthread_cond_broadcast(&undofile->cond);
+}
+
+static void* war_undofile_writer(void* arg) {
+    war_undofile* undofile = arg;
+    pthread_mutex_lock(&undofile->mutex);
+    while (atomic_load(&undofile->running)) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        uint64_t nsec = deadline.tv_nsec + undofile->flush_us * 1000ULL;
+        deadline.tv_sec += nsec / 1000000000ULL;
+        deadline.tv_nsec = nsec % 1000000000ULL;
+        pthread_cond_timedwait(&undofile->cond, &undofile->mutex, &deadline);
+        war_undofile_drain(undofile);
+    }
+    war_undofile_drain(undofile);
+    pthread_mutex_unlock(&undofile->mutex);
+    return NULL;
+}
+
+// blocks until everything queued is on disk
+static inline void war_undofile_flush(war_undofile* undofile) {
+    pthread_mutex_lock(&undofile->mutex);
+    if (!atomic_load(&undofile->running)) { war_undofile_drain(undofile); }
+    while (atomic_load(&undofile->queue_tail) !=
+           atomic_load(&undofile->queue_head)) {
+        pthread_cond_signal(&undofile->cond);
+        pthread_cond_wait(&undofile->cond, &undofile->mutex);
+    }
+    if (undofile->fd >= 0) { fdatasync(undofile->fd); }
+    pthread_mutex_unlock(&undofile->mutex);
+}
+
+// queues what is left of the streamed log, as much as fits or, when wait,
+// all of it by blocking on the writer. 1 once nothing is left
+static inline uint8_t war_undofile_stream(war_env* env, uint8_t wait) {
+    war_undofile* undofile = env->undofile;
+    war_undo_node* node = undofile->stream_node;
+    while (undofile->stream_done < undofile->stream_bytes) {
+        uint64_t space = war_undofile_space(undofile);
+        if (!space) {
+            pthread_cond_signal(&undofile->cond);
+            if (!wait) { return 0; }
+            pthread_mutex_lock(&undofile->mutex);
+            if (!atomic_load(&undofile->running)) {
+                war_undofile_drain(undofile);
+            } else if (!war_undofile_space(undofile)) {
+                pthread_cond_wait(&undofile->cond, &undofile->mutex);
+            }
+            pthread_mutex_unlock(&undofile->mutex);
+            continue;
+        }
+        uint32_t run = undofile->stream_bytes - undofile->stream_done;
+        if (run > space) { run = (uint32_t)space; }
+        war_undofile_queue(undofile,
+                           env->undo_tree->payload +
+                               node->payload.notes.offset +
+                               undofile->stream_done,
+                           run);
+        undofile->stream_done += run;
+    }
+    undofile->stream_node = NULL;
+    return 1;
+}
+
+static inline void war_undofile_close(war_env* env) {
+    war_undofile* undofile = env->undofile;
+    if (undofile->fd < 0) { return; }
+    war_undofile_stream(env, 1);
+    war_undofile_flush(undofile);
+    pthread_mutex_lock(&undofile->mutex);
+    close(undofile->fd);
+    undofile->fd = -1;
+    pthread_mutex_unlock(&undofile->mutex);
+}
+
+// queues the record of node, its log follows through war_undofile_stream
+static inline uint8_t war_undofile_queue_node(war_env* env,
+                                              war_undo_node* node) {
+    war_undofile* undofile = env->undofile;
+    uint32_t bytes = node->payload.notes.bytes;
+    if (war_undofile_space(undofile) < sizeof(war_undofile_record)) {
+        return 0;
+    }
+    if (bytes > undofile->queue_size) {
+        call_terry_davis("undofile: streaming %u bytes over several frames",
+                         bytes);
+    }
+    war_undofile_record record = {
+        .type = UNDOFILE_NODE,
+        .command = node->command,
+        .id = node->id,
+        .parent_id = node->parent_id,
+        .seq_num = node->seq_num,
+        .timestamp = node->timestamp,
+        .branch_id = node->branch_id,
+        .cursor_pos_x = node->cursor_pos_x,
+        .cursor_pos_y = node->cursor_pos_y,
+        .left_col = node->left_col,
+        .right_col = node->right_col,
+        .top_row = node->top_row,
+        .bottom_row = node->bottom_row,
+        .payload = node->payload,
+    };
+    war_undofile_queue(undofile, &record, sizeof(record));
+    undofile->stream_node = node;
+    undofile->stream_done = 0;
+    undofile->stream_bytes = bytes;
+    undofile->synced_node_id = node->id;
+    undofile->synced_node_bytes = bytes;
+    undofile->synced_node_count = node->payload.notes.count;
+    return 1;
+}
+
+// queues what joins added to the last node queued since it was
+static inline uint8_t war_undofile_queue_append(war_env* env) {
+    war_undofile* undofile = env->undofile;
+    war_undo_node* node = env->undo_tree->newest;
+    while (node && node->id > undofile->synced_node_id) { node = node->older; }
+    if (!node || node->id != undofile->synced_node_id ||
+        node->payload.notes.bytes <= undofile->synced_node_bytes) {
+        return 1;
+    }
+    if (war_undofile_space(undofile) < sizeof(war_undofile_record)) {
+        return 0;
+    }
+    war_undofile_record record = {
+        .type = UNDOFILE_APPEND,
+        .command = node->command,
+        .id = node->id,
+        .payload = node->payload,
+    };
+    record.payload.notes.bytes =
+        node->payload.notes.bytes - undofile->synced_node_bytes;
+    record.payload.notes.count =
+        node->payload.notes.count - undofile->synced_node_count;
+    war_undofile_queue(undofile, &record, sizeof(record));
+    undofile->stream_node = node;
+    undofile->stream_done = undofile->synced_node_bytes;
+    undofile->stream_bytes = node->payload.notes.bytes;
+    undofile->synced_node_bytes = node->payload.notes.bytes;
+    undofile->synced_node_count = node->payload.notes.count;
+    return 1;
+}
+
+// queues every node pushed since the last call and where current ended up.
+// a full queue just leaves the rest for the next frame
+static inline void war_undofile_sync(war_env* env) {
+    war_undofile* undofile = env->undofile;
+    war_undo_tree* undo_tree = env->undo_tree;
+    if (undofile->fd < 0) { return; }
+    if (!war_undofile_stream(env, 0)) { return; }
+    if (!war_undofile_queue_append(env) || !war_undofile_stream(env, 0)) {
+        return;
+    }
+    war_undo_node* node = undo_tree->newest;
+    if (node && node->seq_num > undofile->synced_seq_num) {
+        while (node->older &&
+               node->older->seq_num > undofile->synced_seq_num) {
+            node = node->older;
+        }
+        for (; node; node = node->newer) {
+            if (!war_undofile_queue_node(env, node)) { return; }
+            undofile->synced_seq_num = node->seq_num;
+            undofile->synced_current_id = node->id;
+            if (!war_undofile_stream(env, 0)) { return; }
+        }
+    }
+    uint64_t current_id = undo_tree->current ? undo_tree->current->id : 0;
+    if (current_id == undofile->synced_current_id ||
+        war_undofile_space(undofile) < sizeof(war_undofile_record)) {
+        return;
+    }
+    war_undofile_record record = {.type = UNDOFILE_CURRENT, .id = current_id};
+    war_undofile_queue(undofile, &record, sizeof(record));
+    undofile->synced_current_id = current_id;
+}
+
+// ids grow with age, so the scan back from the newest stops early
+static inline war_undo_node* war_undo_node_find(war_undo_tree* undo_tree,
+                                                uint64_t id) {
+    war_undo_node* current = undo_tree->current;
+    if (current && current->id == id) { return current; }
+    if (current && current->prev && current->prev->id == id) {
+        return current->prev;
+    }
+    if (current && current->next && current->next->id == id) {
+        return current->next;
+    }
+    for (war_undo_node* node = undo_tree->newest; node && node->id >= id;
+         node = node->older) {
+        if (node->id == id) { return node; }
+    }
+    return NULL;
+}
+
+static inline void war_undo_tree_clear(war_env* env) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    while (undo_tree->oldest) { war_undo_node_free(env, undo_tree->oldest); }
+    undo_tree->root = NULL;
+    undo_tree->current = NULL;
+    undo_tree->payload_tail = undo_tree->payload_head;
+    undo_tree->join_prev_id = 0;
+}
+
+// pushes a node back the way war_undo_node_push did when it was recorded
+static inline void war_undofile_replay_node(war_env* env,
+                                            war_undofile_record* record,
+                                            uint8_t* log) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    // undofiles from before UNDOFILE_APPEND wrote a joined node again whole
+    war_undo_node* joined = war_undo_node_find(undo_tree, record->id);
+    if (joined) {
+        uint32_t bytes = record->payload.notes.bytes;
+        uint8_t* data = war_undo_payload_alloc(env, joined, bytes);
+        if (!data) { return; }
+        memcpy(data, log, bytes);
+        joined->command = record->command;
+        joined->payload = record->payload;
+        joined->payload.notes.offset = (uint64_t)(data - undo_tree->payload);
+        return;
+    }
+    // an evicted parent leaves the node as a new root
+    war_undo_node* parent =
+        record->parent_id ? war_undo_node_find(undo_tree, record->parent_id) :
+                            NULL;
+    war_undo_node* node = war_undo_node_alloc(env);
+    node->seq_num = record->seq_num;
+    war_undo_node_attach(undo_tree, node, parent);
+    node->id = record->id;
+    node->parent_id = record->parent_id;
+    node->timestamp = record->timestamp;
+    node->branch_id = record->branch_id;
+    node->command = record->command;
+    node->cursor_pos_x = record->cursor_pos_x;
+    node->cursor_pos_y = record->cursor_pos_y;
+    node->left_col = record->left_col;
+    node->right_col = record->right_col;
+    node->top_row = record->top_row;
+    node->bottom_row = record->bottom_row;
+    node->payload = record->payload;
+    war_undo_node_checkpoint(env, node);
+    uint32_t bytes = record->payload.notes.bytes;
+    if (bytes) {
+        uint8_t* data = war_undo_payload_alloc(env, node, bytes);
+        if (!data) {
+            war_undo_node_free(env, node);
+            return;
+        }
+        memcpy(data, log, bytes);
+        node->payload.notes.offset = (uint64_t)(data - undo_tree->payload);
+    }
+    if (node->id >= undo_tree->next_id) { undo_tree->next_id = node->id + 1; }
+    if (node->seq_num >= undo_tree->next_seq_num) {
+        undo_tree->next_seq_num = node->seq_num + 1;
+    }
+    if (node->branch_id >= undo_tree->next_branch_id) {
+        undo_tree->next_branch_id = node->branch_id + 1;
+    }
+}
+
+// grows a node by the notes later edits joined into it
+static inline void war_undofile_replay_append(war_env* env,
+                                              war_undofile_record* record,
+                                              uint8_t* log) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    war_undo_node* node = war_undo_node_find(undo_tree, record->id);
+    if (!node) { return; }
+    uint32_t bytes = record->payload.notes.bytes;
+    uint32_t old_bytes = node->payload.notes.bytes;
+    uint8_t* data = war_undo_payload_extend(env, node, bytes);
+    if (!data) {
+        data = war_undo_payload_alloc(env, node, old_bytes + bytes);
+        if (!data) { return; }
+        memcpy(data,
+               undo_tree->payload + node->payload.notes.offset,
+               old_bytes);
+        node->payload.notes.offset = (uint64_t)(data - undo_tree->payload);
+        node->payload.notes.bytes = old_bytes + bytes;
+        data += old_bytes;
+    }
+    memcpy(data, log, bytes);
+    node->command = record->command;
+    node->payload.notes.count += record->payload.notes.count;
+}
+
+// returns the end of the last whole record, a torn tail from a crash is
+// left for the caller to cut
+static inline uint64_t war_undofile_replay(war_env* env,
+                                          uint8_t* data,
+                                          uint64_t size,
+                                          uint32_t* records_count) {
+    war_undo_tree* undo_tree = env->undo_tree;
+    uint64_t at = sizeof(war_undofile_header);
+    *records_count = 0;
+    while (at + sizeof(war_undofile_record) <= size) {
+        war_undofile_record record;
+        memcpy(&record, data + at, sizeof(record));
+        uint64_t end = at + sizeof(record);
+        if (record.type == UNDOFILE_NODE) {
+            end += record.payload.notes.bytes;
+            if (end > size) { break; }
+            war_undofile_replay_node(env, &record, data + at + sizeof(record));
+        } else if (record.type == UNDOFILE_APPEND) {
+            end += record.payload.notes.bytes;
+            if (end > size) { break; }
+            war_undofile_replay_append(
+                env, &record, data + at + sizeof(record));
+        } else if (record.type == UNDOFILE_CURRENT) {
+            war_undo_node* node =
+                record.id ? war_undo_node_find(undo_tree, record.id) : NULL;
+            if (node || !record.id) {
+                war_undo_node_follow(undo_tree, node);
+                undo_tree->current = node;
+            }
+        } else {
+            break;
+        }
+        at = end;
+        (*records_count)++;
+    }
+    return at;
+}
+
+// cuts fd back to a bare header
+static inline int war_undofile_header_write(int fd) {
+    war_undofile_header header = {.version = WAR_UNDOFILE_VERSION};
+    memcpy(header.magic, WAR_UNDOFILE_MAGIC, 8);
+    if (ftruncate(fd, 0) == -1 ||
+        write(fd, &header, sizeof(header)) != sizeof(header)) {
+        return -1;
+    }
+    return 0;
+}
+
+// loads the history saved next to project_path and keeps appending to it
+static inline int war_undofile_open(war_env* env, const char* project_path) {
+    war_undofile* undofile = env->undofile;
+    war_undo_tree* undo_tree = env->undo_tree;
+    war_undofile_close(env);
+    const char* slash = strrchr(project_path, '/');
+    int dir_len = slash ? (int)(slash - project_path) + 1 : 0;
+    int len = snprintf(undofile->path,
+                       undofile->path_limit,
+                       "%.*s.%s.un~",
+                       dir_len,
+                       project_path,
+                       project_path + dir_len);
+    if (len < 0 || (uint32_t)len >= undofile->path_limit) {
+        call_terry_davis("undofile: path too long");
+        return -1;
+    }
+    int fd = open(undofile->path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        call_terry_davis("undofile: failed to open %s", undofile->path);
+        return -1;
+    }
+    struct stat st;
+    uint64_t size = fstat(fd, &st) == 0 ? (uint64_t)st.st_size : 0;
+    uint64_t valid = 0;
+    uint32_t records_count = 0;
+    if (size >= sizeof(war_undofile_header)) {
+        uint8_t* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            war_undofile_header* header = (war_undofile_header*)data;
+            if (memcmp(header->magic, WAR_UNDOFILE_MAGIC, 8) == 0 &&
+                header->version == WAR_UNDOFILE_VERSION) {
+                war_undo_tree_clear(env);
+                valid = war_undofile_replay(env, data, size, &records_count);
+            }
+            munmap(data, size);
+        }
+    }
+    // a new file takes over the history so far. one mostly made of history
+    // that has since been dropped or evicted starts over too, either way
+    // sync writes the live tree back out
+    uint8_t rewrite = !valid || records_count > 2 * undo_tree->nodes_used + 64;
+    if (rewrite) {
+        if (war_undofile_header_write(fd) == -1) {
+            call_terry_davis("undofile: failed to reset %s", undofile->path);
+            close(fd);
+            return -1;
+        }
+        undofile->synced_seq_num = 0;
+        undofile->synced_current_id = 0;
+        undofile->synced_node_id = 0;
+    } else {
+        if (valid < size && ftruncate(fd, valid) == -1) {
+            call_terry_davis("undofile: failed to cut torn tail");
+        }
+        undofile->synced_seq_num = undo_tree->next_seq_num - 1;
+        undofile->synced_current_id =
+            undo_tree->current ? undo_tree->current->id : 0;
+        war_undo_node* newest = undo_tree->newest;
+        undofile->synced_node_id = newest ? newest->id : 0;
+        undofile->synced_node_bytes = newest ? newest->payload.notes.bytes : 0;
+        undofile->synced_node_count = newest ? newest->payload.notes.count : 0;
+    }
+    pthread_mutex_lock(&undofile->mutex);
+    undofile->fd = fd;
+    pthread_mutex_unlock(&undofile->mutex);
+    call_terry_davis("undofile: %s, %u records, %u nodes",
+                     undofile->path,
+                     records_count,
+                     undo_tree->nodes_used);
+    return 0;
+}
+
+// drops the whole history, the undofile too so the next open does not
+// bring the cleared nodes back
+static inline void war_undo_history_clear(war_env* env) {
+    war_undofile* undofile = env->undofile;
+    war_undo_tree_clear(env);
+    undofile->synced_seq_num = 0;
+    undofile->synced_current_id = 0;
+    undofile->synced_node_id = 0;
+    if (undofile->fd < 0) { return; }
+    war_undofile_flush(undofile);
+    pthread_mutex_lock(&undofile->mutex);
+    if (war_undofile_header_write(undofile->fd) == -1) {
+        call_terry_davis("undofile: failed to reset %s", undofile->path);
+    }
+    pthread_mutex_unlock(&undofile->mutex);
+}
+
+static inline void war_layer_flux(war_window_render_context* ctx_wr,
+                                  war_atomics* atomics,
+                                  war_play_context* ctx_play,
+                                  war_color_context* ctx_color) {
+    uint64_t layer = ctx_play->note_layers[(int)ctx_wr->cursor_pos_y];
+    atomic_store(&atomics->layer, layer);
+    ctx_wr->layers_active_count = __builtin_popcountll(layer);
+    switch (ctx_wr->layers_active_count) {
+    case 0: {
+        ctx_wr->color_cursor = ctx_color->white_hex;
+        ctx_wr->color_cursor_transparent = ctx_color->white_hex;
+        ctx_wr->color_note_outline_default = ctx_color->full_white_hex;
+        break;
+    }
+    case 1: {
+        int active = __builtin_ctzll(layer);
+        ctx_wr->color_cursor = ctx_color->colors[active];
+        ctx_wr->color_cursor_transparent = ctx_color->colors[active];
+        ctx_wr->color_note_outline_default = ctx_color->white_hex;
+        ctx_wr->layers_active[0] = (active + 1) + '0';
+        break;
+    }
+    default: {
+        int count = 0;
+        while (layer) {
+            int active = __builtin_ctzll(layer);
+            ctx_wr->layers_active[count++] = (active + 1) + '0';
+            layer &= layer - 1;
+        }
+        ctx_wr->color_cursor = ctx_color->full_white_hex;
+        ctx_wr->color_cursor_transparent = ctx_color->white_hex;
+        ctx_wr->color_note_outline_default = ctx_color->white_hex;
+        break;
+    }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// PROJECT FILE
+//-----------------------------------------------------------------------------
+// a .war file is a header, a section table and sections laid out to be used
+// straight from a mapping. note records are written in swap page layout on a
+// WAR_PROJECT_ALIGN boundary, so loading maps them copy on write over the
+// front of the swap and war_note_swap_sync faults in what the view needs.
+// small sections are checked on load, record pages when first read.
+
+static inline int war_project_write(int fd, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+    while (size) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) { continue; }
+            return -1;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return 0;
+}
+
+// appends data zero padded to 8 bytes to section and its checksum
+static inline int war_project_put(int fd,
+                                  war_project_section* section,
+                                  const void* data,
+                                  size_t size) {
+    size_t whole = size & ~(size_t)7;
+    uint8_t tail[8] = {0};
+    memcpy(tail, (const uint8_t*)data + whole, size - whole);
+    section->checksum = war_checksum(section->checksum, data, whole);
+    if (war_project_write(fd, data, whole) == -1) { return -1; }
+    section->size += whole;
+    if (whole == size) { return 0; }
+    section->checksum = war_checksum(section->checksum, tail, 8);
+    section->size += 8;
+    return war_project_write(fd, tail, 8);
+}
+
+static inline uint64_t war_project_pad(uint64_t size) {
+    return (size + 7) & ~(uint64_t)7;
+}
+
+static inline uint64_t war_project_align(uint64_t offset) {
+    uint64_t mask = WAR_PROJECT_ALIGN - 1;
+    return (offset + mask) & ~mask;
+}
+
+// puts the swap's own backing back under the pages a project file was
+// mapped over
+static inline void war_project_unmap(war_env* env) {
+    war_project* project = env->project;
+    war_note_swap* swap = env->note_swap;
+    if (!project->mapped_size) { return; }
+    if (mmap(swap->records,
+             project->mapped_size,
+             PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_FIXED,
+             swap->fd,
+             0) == MAP_FAILED) {
+        call_terry_davis("project: failed to remap note swap");
+    }
+    project->mapped_size = 0;
+}
+
+static inline uint64_t war_project_log_checksum(uint64_t log_offset) {
+    return war_checksum(WAR_CHECKSUM_SEED, &log_offset, sizeof(log_offset));
+}
+
+static inline uint64_t war_project_segment_size(war_project_segment* segment) {
+    return war_project_pad(
+        sizeof(war_project_segment) +
+        sizeof(war_project_segment_chunk) * segment->chunks_count +
+        sizeof(war_note_swap_record) * segment->records_count);
+}
+
+static inline uint8_t war_project_seen(uint64_t* seen, uint32_t chunk) {
+    return (seen[chunk >> 6] >> (chunk & 63)) & 1;
+}
+
+static inline uint8_t
+war_project_seen_range(uint64_t* seen, double left, double right) {
+    uint32_t last = war_project_chunk(right);
+    for (uint32_t chunk = war_project_chunk(left); chunk <= last; chunk++) {
+        if (war_project_seen(seen, chunk)) { return 1; }
+    }
+    return 0;
+}
+
+// the autosave segment at offset when it is whole and checks out, else NULL
+static inline war_project_segment*
+war_project_segment_at(uint8_t* data, uint64_t size, uint64_t offset) {
+    if (!offset || offset % 8 || offset > size ||
+        size - offset < sizeof(war_project_segment)) {
+        return NULL;
+    }
+    war_project_segment* segment = (war_project_segment*)(data + offset);
+    if (memcmp(segment->magic, WAR_PROJECT_SEGMENT_MAGIC, 8) != 0) {
+        return NULL;
+    }
+    uint64_t body = war_project_segment_size(segment) - sizeof(*segment);
+    if (size - offset - sizeof(*segment) < body) { return NULL; }
+    uint64_t checksum = war_checksum(WAR_CHECKSUM_SEED,
+                                     segment,
+                                     offsetof(war_project_segment, checksum));
+    if (war_checksum(checksum, segment + 1, body) != segment->checksum) {
+        return NULL;
+    }
+    uint8_t* at = (uint8_t*)(segment + 1);
+    uint64_t records_count = 0;
+    for (uint32_t c = 0; c < segment->chunks_count; c++) {
+        war_project_segment_chunk* chunk = (war_project_segment_chunk*)at;
+        records_count += chunk->count;
+        if (chunk->chunk >= WAR_PROJECT_CHUNKS_MAX ||
+            records_count > segment->records_count) {
+            return NULL;
+        }
+        at += sizeof(*chunk) + sizeof(war_note_swap_record) * chunk->count;
+    }
+    return records_count == segment->records_count ? segment : NULL;
+}
+
+// the log starts past every section
+static inline uint64_t war_project_log_floor(war_project_section* table) {
+    uint64_t floor = 0;
+    for (uint32_t i = 0; i < PROJECT_SECTIONS_COUNT; i++) {
+        uint64_t end = table[i].offset + table[i].size;
+        if (end > floor) { floor = end; }
+    }
+    return floor;
+}
+
+// the newest whole segment at or before offset. one that doesn't check out
+// but still reads as a segment is stepped over and counted in damaged
+static inline war_project_segment* war_project_log_next(uint8_t* data,
+                                                        uint64_t size,
+                                                        uint64_t floor,
+                                                        uint64_t offset,
+                                                        uint32_t* damaged) {
+    while (offset && offset >= floor) {
+        war_project_segment* segment =
+            war_project_segment_at(data, size, offset);
+        if (segment) { return segment; }
+        if (offset % 8 || size - offset < sizeof(war_project_segment)) {
+            return NULL;
+        }
+        segment = (war_project_segment*)(data + offset);
+        if (memcmp(segment->magic, WAR_PROJECT_SEGMENT_MAGIC, 8) != 0 ||
+            segment->prev_offset >= offset) {
+            return NULL;
+        }
+        if (damaged) { (*damaged)++; }
+        offset = segment->prev_offset;
+    }
+    return NULL;
+}
+
+static inline war_project_segment*
+war_project_log_prev(uint8_t* data,
+                     uint64_t size,
+                     uint64_t floor,
+                     war_project_segment* segment) {
+    uint64_t offset = (uint8_t*)segment - data;
+    if (segment->prev_offset >= offset) { return NULL; }
+    return war_project_log_next(data, size, floor, segment->prev_offset, NULL);
+}
+
+// marks in seen every chunk the autosave log replaced and returns its newest
+// whole segment. a damaged segment only loses its own chunks, the ones
+// before it still count
+static inline war_project_segment*
+war_project_log_walk(uint8_t* data,
+                     uint64_t size,
+                     uint64_t floor,
+                     uint64_t* seen,
+                     uint32_t* segments_count,
+                     uint64_t* log_bytes) {
+    war_project_header* header = (war_project_header*)data;
+    memset(seen, 0, WAR_PROJECT_CHUNKS_MAX / 8);
+    *segments_count = 0;
+    *log_bytes = 0;
+    if (header->log_checksum != war_project_log_checksum(header->log_offset)) {
+        return NULL;
+    }
+    uint32_t damaged = 0;
+    war_project_segment* newest =
+        war_project_log_next(data, size, floor, header->log_offset, &damaged);
+    war_project_segment* segment = newest;
+    while (segment) {
+        uint8_t* at = (uint8_t*)(segment + 1);
+        for (uint32_t c = 0; c < segment->chunks_count; c++) {
+            war_project_segment_chunk* chunk = (war_project_segment_chunk*)at;
+            seen[chunk->chunk >> 6] |= 1ull << (chunk->chunk & 63);
+            at += sizeof(*chunk) + sizeof(war_note_swap_record) * chunk->count;
+        }
+        (*segments_count)++;
+        *log_bytes += war_project_segment_size(segment);
+        uint64_t offset = (uint8_t*)segment - data;
+        segment = segment->prev_offset < offset ?
+                      war_project_log_next(data,
+                                           size,
+                                           floor,
+                                           segment->prev_offset,
+                                           &damaged) :
+                      NULL;
+    }
+    if (damaged) {
+        call_terry_davis("project: %u damaged autosaves skipped", damaged);
+    }
+    return newest;
+}
+
+static inline void war_project_song_fill(war_env* env,
+                                         war_project_song* song) {
+    war_lua_context* ctx_lua = env->ctx_lua;
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_undo_node* current = env->undo_tree->current;
+    memset(song, 0, sizeof(*song));
+    song->bpm = atomic_load(&ctx_lua->A_BPM);
+    song->columns_per_beat = atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT);
+    song->note_next_id = atomic_load(&env->atomics->note_next_id);
+    song->undo_current_id = current ? current->id : 0;
+    song->cursor_pos_x = ctx_wr->cursor_pos_x;
+    song->cursor_pos_y = ctx_wr->cursor_pos_y;
+    song->left_col = ctx_wr->left_col;
+    song->bottom_row = ctx_wr->bottom_row;
+    song->note_count = atomic_load(&ctx_lua->A_NOTE_COUNT);
+    song->views_count = env->views->views_count;
+    song->page_notes = env->note_swap->page_notes;
+}
+
+// opens path.tmp past the header and table, war_project_finish writes them
+static inline int war_project_begin(war_project* project,
+                                    const char* path,
+                                    war_project_header* header,
+                                    war_project_section* table,
+                                    uint64_t* offset) {
+    int len =
+        snprintf(project->tmp_path, project->path_limit, "%s.tmp", path);
+    if (len < 0 || (uint32_t)len >= project->path_limit) {
+        call_terry_davis("project: path too long");
+        return -1;
+    }
+    int fd = open(project->tmp_path,
+                  O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0644);
+    if (fd < 0) {
+        call_terry_davis("project: failed to open %s", project->tmp_path);
+        return -1;
+    }
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, WAR_PROJECT_MAGIC, 8);
+    header->version = WAR_PROJECT_VERSION;
+    header->sections_count = PROJECT_SECTIONS_COUNT;
+    header->table_offset = sizeof(war_project_header);
+    header->log_checksum = war_project_log_checksum(0);
+    memset(table, 0, sizeof(war_project_section) * PROJECT_SECTIONS_COUNT);
+    for (uint32_t i = 0; i < PROJECT_SECTIONS_COUNT; i++) {
+        table[i].type = i + 1;
+        table[i].checksum = WAR_CHECKSUM_SEED;
+    }
+    *offset = sizeof(war_project_header) +
+              sizeof(war_project_section) * PROJECT_SECTIONS_COUNT;
+    if (lseek(fd, *offset, SEEK_SET) == -1) {
+        close(fd);
+        unlink(project->tmp_path);
+        return -1;
+    }
+    return fd;
+}
+
+// writes n records as the next page of the records section and notes it in
+// the page table, the unused tail of a page is left a hole
+static inline int war_project_page_put(int fd,
+                                       war_project* project,
+                                       uint32_t page_notes,
+                                       uint32_t* pages_count,
+                                       war_note_swap_record* records,
+                                       uint32_t n) {
+    if (*pages_count >= project->pages_max) {
+        call_terry_davis("project: out of pages");
+        return -1;
+    }
+    double min_col = DBL_MAX;
+    double max_col = -DBL_MAX;
+    for (uint32_t j = 0; j < n; j++) {
+        if (records[j].pos_x < min_col) { min_col = records[j].pos_x; }
+        double end = records[j].pos_x + records[j].size_x;
+        if (end > max_col) { max_col = end; }
+    }
+    size_t bytes = sizeof(war_note_swap_record) * n;
+    uint32_t page = (*pages_count)++;
+    project->page_count[page] = n;
+    project->page_min_col[page] = min_col;
+    project->page_max_col[page] = max_col;
+    project->page_checksum[page] =
+        war_checksum(WAR_CHECKSUM_SEED, records, bytes);
+    if (war_project_write(fd, records, bytes) == -1 ||
+        lseek(fd,
+              sizeof(war_note_swap_record) * (page_notes - n),
+              SEEK_CUR) == -1) {
+        return -1;
+    }
+    return 0;
+}
+
+// stages record in project->page, putting the page out once it is full
+static inline int war_project_page_add(int fd,
+                                       war_project* project,
+                                       uint32_t page_notes,
+                                       uint32_t* pages_count,
+                                       uint32_t* fill,
+                                       war_note_swap_record* record) {
+    project->page[(*fill)++] = *record;
+    if (*fill < page_notes) { return 0; }
+    *fill = 0;
+    return war_project_page_put(
+        fd, project, page_notes, pages_count, project->page, page_notes);
+}
+
+// everything after the records, then the header and table, then renames
+// path.tmp over path. closes fd either way
+static inline int war_project_finish(int fd,
+                                     war_project* project,
+                                     const char* path,
+                                     war_project_header* header,
+                                     war_project_section* table,
+                                     war_project_song* song) {
+    uint32_t pages_count = song->pages_count;
+    war_project_section* section = &table[PROJECT_RECORDS - 1];
+    section->size = (uint64_t)pages_count * song->page_notes *
+                    sizeof(war_note_swap_record);
+    uint64_t offset = war_project_align(section->offset + section->size);
+    if (lseek(fd, offset, SEEK_SET) == -1) { goto war_label_failed; }
+    section = &table[PROJECT_PAGES - 1];
+    section->offset = offset;
+    if (war_project_put(fd,
+                        section,
+                        project->page_count,
+                        sizeof(uint32_t) * pages_count) == -1 ||
+        war_project_put(fd,
+                        section,
+                        project->page_min_col,
+                        sizeof(double) * pages_count) == -1 ||
+        war_project_put(fd,
+                        section,
+                        project->page_max_col,
+                        sizeof(double) * pages_count) == -1 ||
+        war_project_put(fd,
+                        section,
+                        project->page_checksum,
+                        sizeof(uint64_t) * pages_count) == -1) {
+        goto war_label_failed;
+    }
+    offset += section->size;
+    section = &table[PROJECT_SONG - 1];
+    section->offset = offset;
+    if (war_project_put(fd, section, song, sizeof(*song)) == -1) {
+        goto war_label_failed;
+    }
+    size_t table_size = sizeof(war_project_section) * PROJECT_SECTIONS_COUNT;
+    header->table_checksum = war_checksum(WAR_CHECKSUM_SEED, table, table_size);
+    if (lseek(fd, 0, SEEK_SET) == -1 ||
+        war_project_write(fd, header, sizeof(*header)) == -1 ||
+        war_project_write(fd, table, table_size) == -1 || fsync(fd) == -1) {
+        goto war_label_failed;
+    }
+    close(fd);
+    if (rename(project->tmp_path, path) == -1) {
+        call_terry_davis("project: failed to rename over %s", path);
+        unlink(project->tmp_path);
+        return -1;
+    }
+    return 0;
+war_label_failed:
+    call_terry_davis("project: failed to write %s", project->tmp_path);
+    close(fd);
+    unlink(project->tmp_path);
+    return -1;
+}
+
+// writes everything to path.tmp and renames it over path. swapped out pages
+// go out as they are, resident notes sorted into full pages after them
+static inline int war_project_save(war_env* env, const char* path) {
+    war_project* project = env->project;
+    war_note_swap* swap = env->note_swap;
+    war_note_quads* note_quads = env->note_quads;
+    war_views* views = env->views;
+    war_map_wav* map_wav = env->map_wav;
+    war_lua_context* ctx_lua = env->ctx_lua;
+    war_project_header header;
+    war_project_section table[PROJECT_SECTIONS_COUNT];
+    uint64_t offset;
+    int fd = war_project_begin(project, path, &header, table, &offset);
+    if (fd < 0) { return -1; }
+    war_project_section* section;
+    uint32_t note_count = atomic_load(&ctx_lua->A_NOTE_COUNT);
+    section = &table[PROJECT_LAYERS - 1];
+    section->offset = offset;
+    if (war_project_put(fd,
+                        section,
+                        env->ctx_play->note_layers,
+                        sizeof(uint64_t) * note_count) == -1) {
+        goto war_label_failed;
+    }
+    offset += section->size;
+    section = &table[PROJECT_VIEWS - 1];
+    section->offset = offset;
+    uint32_t* view_fields[] = {views->col,
+                               views->row,
+                               views->left_col,
+                               views->right_col,
+                               views->bottom_row,
+                               views->top_row};
+    for (uint32_t i = 0; i < 6; i++) {
+        if (war_project_put(fd,
+                            section,
+                            view_fields[i],
+                            sizeof(uint32_t) * views->views_count) == -1) {
+            goto war_label_failed;
+        }
+    }
+    offset += section->size;
+    section = &table[PROJECT_SAMPLES - 1];
+    section->offset = offset;
+    uint32_t samples_count = 0;
+    uint32_t slots = map_wav->note_count * map_wav->layer_count;
+    for (uint32_t slot = 0; slot < slots; slot++) {
+        if (!map_wav->fname_size[slot]) { continue; }
+        war_project_sample sample = {
+            .id = map_wav->id[slot],
+            .note = map_wav->note[slot],
+            .layer = map_wav->layer[slot],
+            .name_size = map_wav->fname_size[slot],
+        };
+        if (war_project_put(fd, section, &sample, sizeof(sample)) == -1 ||
+            war_project_put(fd,
+                            section,
+                            map_wav->fname + (size_t)slot * map_wav->name_limit,
+                            sample.name_size) == -1) {
+            goto war_label_failed;
+        }
+        samples_count++;
+    }
+    offset += section->size;
+    uint32_t keys_count = 0;
+    for (uint32_t i = 0; i < note_quads->count; i++) {
+        if (!note_quads->alive[i]) { continue; }
+        swap->keys[keys_count].pos_x = note_quads->pos_x[i];
+        swap->keys[keys_count].idx = i;
+        keys_count++;
+    }
+    qsort(swap->keys, keys_count, sizeof(war_note_key), war_note_key_compare);
+    section = &table[PROJECT_RECORDS - 1];
+    section->offset = war_project_align(offset);
+    section->checksum = 0;
+    if (lseek(fd, section->offset, SEEK_SET) == -1) { goto war_label_failed; }
+    uint32_t pages_count = 0;
+    uint32_t notes_count = 0;
+    uint32_t fill = 0;
+    for (uint32_t page = 0; page < swap->pages_used; page++) {
+        uint32_t n = swap->page_count[page];
+        if (!n || !war_note_swap_page_check(swap, page)) { continue; }
+        if (war_project_page_put(fd,
+                                 project,
+                                 swap->page_notes,
+                                 &pages_count,
+                                 swap->records +
+                                     (size_t)page * swap->page_notes,
+                                 n) == -1) {
+            goto war_label_failed;
+        }
+        notes_count += n;
+    }
+    war_note_swap_record record;
+    for (uint32_t k = 0; k < keys_count; k++) {
+        war_note_swap_pack(note_quads, swap->keys[k].idx, &record);
+        if (war_project_page_add(fd,
+                                 project,
+                                 swap->page_notes,
+                                 &pages_count,
+                                 &fill,
+                                 &record) == -1) {
+            goto war_label_failed;
+        }
+    }
+    if (fill && war_project_page_put(fd,
+                                     project,
+                                     swap->page_notes,
+                                     &pages_count,
+                                     project->page,
+                                     fill) == -1) {
+        goto war_label_failed;
+    }
+    notes_count += keys_count;
+    war_project_song song;
+    war_project_song_fill(env, &song);
+    song.samples_count = samples_count;
+    song.pages_count = pages_count;
+    if (war_project_finish(fd, project, path, &header, table, &song) == -1) {
+        return -1;
+    }
+    call_terry_davis("project: saved %u notes in %u pages to %s",
+                     notes_count,
+                     pages_count,
+                     path);
+    return 0;
+war_label_failed:
+    call_terry_davis("project: failed to write %s", project->tmp_path);
+    close(fd);
+    unlink(project->tmp_path);
+    return -1;
+}
+
+// returns the section table of a mapped project file once the header, the
+// table, every small section and the page table all check out, else NULL
+static inline war_project_section* war_project_sections(uint8_t* data,
+                                                         uint64_t size) {
+    if (size < sizeof(war_project_header)) { return NULL; }
+    war_project_header* header = (war_project_header*)data;
+    if (memcmp(header->magic, WAR_PROJECT_MAGIC, 8) != 0 ||
+        header->version != WAR_PROJECT_VERSION ||
+        header->sections_count != PROJECT_SECTIONS_COUNT) {
+        return NULL;
+    }
+    size_t table_size = sizeof(war_project_section) * PROJECT_SECTIONS_COUNT;
+    if (header->table_offset > size ||
+        size - header->table_offset < table_size ||
+        war_checksum(WAR_CHECKSUM_SEED,
+                     data + header->table_offset,
+                     table_size) != header->table_checksum) {
+        return NULL;
+    }
+    war_project_section* table =
+        (war_project_section*)(data + header->table_offset);
+    for (uint32_t i = 0; i < PROJECT_SECTIONS_COUNT; i++) {
+        war_project_section* section = &table[i];
+        if (section->type != i + 1 || section->offset > size ||
+            section->size > size - section->offset || section->offset % 8) {
+            return NULL;
+        }
+        if (section->type == PROJECT_RECORDS) {
+            if (section->offset % WAR_PROJECT_ALIGN) { return NULL; }
+            continue;
+        }
+        if (war_checksum(WAR_CHECKSUM_SEED,
+                         data + section->offset,
+                         section->size) != section->checksum) {
+            return NULL;
+        }
+    }
+    war_project_section* song_section = &table[PROJECT_SONG - 1];
+    if (song_section->size < sizeof(war_project_song)) { return NULL; }
+    war_project_song* song =
+        (war_project_song*)(data + song_section->offset);
+    uint64_t pages_count = song->pages_count;
+    if (!song->page_notes ||
+        table[PROJECT_LAYERS - 1].size < sizeof(uint64_t) * song->note_count ||
+        table[PROJECT_VIEWS - 1].size <
+            6 * war_project_pad(sizeof(uint32_t) * song->views_count) ||
+        table[PROJECT_PAGES - 1].size <
+            war_project_pad(sizeof(uint32_t) * pages_count) +
+                pages_count * (sizeof(double) * 2 + sizeof(uint64_t)) ||
+        table[PROJECT_RECORDS - 1].size < pages_count * song->page_notes *
+                                              sizeof(war_note_swap_record)) {
+        return NULL;
+    }
+    uint32_t* page_count =
+        (uint32_t*)(data + table[PROJECT_PAGES - 1].offset);
+    for (uint32_t p = 0; p < pages_count; p++) {
+        if (page_count[p] > song->page_notes) { return NULL; }
+    }
+    return table;
+}
+
+
+// fills the note store from a project file, a missing file is a new empty
+// project. undo_current_id is the undo node the file was saved at. chunks
+// the autosave log replaced are taken out of the base pages and put back
+// from the newest segment holding them
+static inline int war_project_load(war_env* env,
+                                   const char* path,
+                                   uint64_t* undo_current_id) {
+    war_project* project = env->project;
+    war_note_swap* swap = env->note_swap;
+    war_note_quads* note_quads = env->note_quads;
+    war_views* views = env->views;
+    war_map_wav* map_wav = env->map_wav;
+    war_lua_context* ctx_lua = env->ctx_lua;
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    *undo_current_id = 0;
+    project->log_offset = 0;
+    project->log_bytes = 0;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0 && errno != ENOENT) {
+        call_terry_davis("project: failed to open %s", path);
+        return -1;
+    }
+    uint8_t* data = NULL;
+    uint64_t size = 0;
+    war_project_section* table = NULL;
+    if (fd >= 0) {
+        struct stat st;
+        size = fstat(fd, &st) == 0 ? (uint64_t)st.st_size : 0;
+        if (size) {
+            data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) { data = NULL; }
+        }
+        if (data) { table = war_project_sections(data, size); }
+        if (!table) {
+            call_terry_davis("project: %s is damaged, not loaded", path);
+            if (data) { munmap(data, size); }
+            close(fd);
+            return -1;
+        }
+    }
+    war_undo_tree_clear(env);
+    war_note_swap_clear(swap);
+    war_project_unmap(env);
+    note_quads->count = 0;
+    war_note_map_rebuild(note_quads);
+    note_quads->generation++;
+    if (!table) {
+        call_terry_davis("project: new file %s", path);
+        return 0;
+    }
+    war_project_song* song =
+        (war_project_song*)(data + table[PROJECT_SONG - 1].offset);
+    uint64_t* seen = project->seen;
+    uint64_t floor = war_project_log_floor(table);
+    uint32_t segments_count;
+    war_project_segment* newest = war_project_log_walk(
+        data, size, floor, seen, &segments_count, &project->log_bytes);
+    if (newest) { project->log_offset = (uint8_t*)newest - data; }
+    // where the song was left comes from the newest autosave
+    war_project_song* state = newest ? &newest->song : song;
+    *undo_current_id = state->undo_current_id;
+    atomic_store(&ctx_lua->A_BPM, state->bpm);
+    atomic_store(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT,
+                 state->columns_per_beat);
+    atomic_store(&env->atomics->note_next_id, state->note_next_id);
+    ctx_wr->cursor_pos_x = state->cursor_pos_x;
+    ctx_wr->cursor_pos_y = state->cursor_pos_y;
+    ctx_wr->right_col =
+        state->left_col + (ctx_wr->right_col - ctx_wr->left_col);
+    ctx_wr->left_col = state->left_col;
+    ctx_wr->top_row =
+        state->bottom_row + (ctx_wr->top_row - ctx_wr->bottom_row);
+    ctx_wr->bottom_row = state->bottom_row;
+    uint32_t note_count = atomic_load(&ctx_lua->A_NOTE_COUNT);
+    if (note_count > song->note_count) { note_count = song->note_count; }
+    memcpy(env->ctx_play->note_layers,
+           data + table[PROJECT_LAYERS - 1].offset,
+           sizeof(uint64_t) * note_count);
+    uint32_t views_count = song->views_count;
+    if (views_count > views->views_saved_max) {
+        views_count = views->views_saved_max;
+    }
+    uint32_t* view_fields[] = {views->col,
+                               views->row,
+                               views->left_col,
+                               views->right_col,
+                               views->bottom_row,
+                               views->top_row};
+    uint8_t* view_data = data + table[PROJECT_VIEWS - 1].offset;
+    for (uint32_t i = 0; i < 6; i++) {
+        memcpy(view_fields[i], view_data, sizeof(uint32_t) * views_count);
+        view_data += war_project_pad(sizeof(uint32_t) * song->views_count);
+    }
+    views->views_count = views_count;
+    uint32_t slots = map_wav->note_count * map_wav->layer_count;
+    memset(map_wav->fname_size, 0, sizeof(uint32_t) * slots);
+    war_project_section* samples = &table[PROJECT_SAMPLES - 1];
+    uint64_t at = 0;
+    for (uint32_t i = 0; i < song->samples_count; i++) {
+        if (samples->size - at < sizeof(war_project_sample)) { break; }
+        war_project_sample* sample =
+            (war_project_sample*)(data + samples->offset + at);
+        at += sizeof(war_project_sample);
+        if (samples->size - at < war_project_pad(sample->name_size)) {
+            break;
+        }
+        char* name = (char*)(data + samples->offset + at);
+        at += war_project_pad(sample->name_size);
+        if (sample->note >= map_wav->note_count ||
+            sample->layer >= map_wav->layer_count ||
+            sample->name_size >= map_wav->name_limit) {
+            continue;
+        }
+        uint32_t slot = sample->note * map_wav->layer_count + sample->layer;
+        map_wav->id[slot] = sample->id;
+        map_wav->note[slot] = sample->note;
+        map_wav->layer[slot] = sample->layer;
+        map_wav->fname_size[slot] = sample->name_size;
+        memcpy(map_wav->fname + (size_t)slot * map_wav->name_limit,
+               name,
+               sample->name_size);
+        map_wav->fname[(size_t)slot * map_wav->name_limit + sample->name_size] =
+            '\0';
+    }
+    uint32_t pages_count = song->pages_count;
+    uint8_t* pages = data + table[PROJECT_PAGES - 1].offset;
+    uint32_t* page_count = (uint32_t*)pages;
+    double* page_min_col =
+        (double*)(pages + war_project_pad(sizeof(uint32_t) * pages_count));
+    double* page_max_col = page_min_col + pages_count;
+    uint64_t* page_checksum = (uint64_t*)(page_max_col + pages_count);
+    uint64_t records_offset = table[PROJECT_RECORDS - 1].offset;
+    size_t page_size = sizeof(war_note_swap_record) * song->page_notes;
+    size_t map_size = war_project_align((uint64_t)pages_count * page_size);
+    uint32_t dropped = 0;
+    if (swap->records && song->page_notes == swap->page_notes &&
+        pages_count <= swap->pages_max && map_size <= swap->mapped_size &&
+        map_size <= size - records_offset) {
+        project->mapped_size = map_size;
+        if (mmap(swap->records,
+                 map_size,
+                 PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_FIXED,
+                 fd,
+                 records_offset) == MAP_FAILED) {
+            call_terry_davis("project: mmap failed, copying instead");
+            war_project_unmap(env);
+        }
+    }
+    war_note_quad note_quad;
+    if (project->mapped_size) {
+        for (uint32_t p = 0; p < pages_count; p++) {
+            swap->page_count[p] = page_count[p];
+            swap->page_min_col[p] = page_min_col[p];
+            swap->page_max_col[p] = page_max_col[p];
+            swap->page_checksum[p] = page_checksum[p];
+            swap->notes_count += page_count[p];
+        }
+        swap->pages_used = pages_count;
+        // pages holding replaced chunks are checked and thinned now, the
+        // copy on write mapping keeps that off the file
+        for (uint32_t p = 0; p < pages_count && newest; p++) {
+            if (!swap->page_count[p] ||
+                !war_project_seen_range(
+                    seen, swap->page_min_col[p], swap->page_max_col[p]) ||
+                !war_note_swap_page_check(swap, p)) {
+                continue;
+            }
+            war_note_swap_record* records =
+                swap->records + (size_t)p * swap->page_notes;
+            uint32_t n = 0;
+            double min_col = DBL_MAX;
+            double max_col = -DBL_MAX;
+            for (uint32_t j = 0; j < swap->page_count[p]; j++) {
+                if (war_project_seen(seen,
+                                     war_project_chunk(records[j].pos_x))) {
+                    continue;
+                }
+                records[n] = records[j];
+                if (records[n].pos_x < min_col) {
+                    min_col = records[n].pos_x;
+                }
+                double end = records[n].pos_x + records[n].size_x;
+                if (end > max_col) { max_col = end; }
+                n++;
+            }
+            swap->notes_count -= swap->page_count[p] - n;
+            swap->page_count[p] = n;
+            swap->page_min_col[p] = min_col;
+            swap->page_max_col[p] = max_col;
+        }
+    } else {
+        // pages of another size or no swap to map them into, the notes are
+        // copied over and whatever doesn't fit resident is evicted
+        for (uint32_t p = 0; p < pages_count; p++) {
+            uint32_t n = page_count[p];
+            war_note_swap_record* records =
+                (war_note_swap_record*)(data + records_offset + p * page_size);
+            if (war_checksum(WAR_CHECKSUM_SEED,
+                             records,
+                             sizeof(war_note_swap_record) * n) !=
+                    page_checksum[p] ||
+                !war_note_quads_reserve(env, n)) {
+                dropped += n;
+                continue;
+            }
+            for (uint32_t j = 0; j < n; j++) {
+                if (newest &&
+                    war_project_seen(seen,
+                                     war_project_chunk(records[j].pos_x))) {
+                    continue;
+                }
+                war_note_swap_unpack(&records[j], &note_quad);
+                war_note_quads_insert(note_quads, &note_quad);
+            }
+        }
+    }
+    // newest first, the first segment holding a chunk has the last word on it
+    for (war_project_segment* segment = newest; segment;
+         segment = war_project_log_prev(data, size, floor, segment)) {
+        uint8_t* chunk_at = (uint8_t*)(segment + 1);
+        for (uint32_t c = 0; c < segment->chunks_count; c++) {
+            war_project_segment_chunk* chunk =
+                (war_project_segment_chunk*)chunk_at;
+            war_note_swap_record* records =
+                (war_note_swap_record*)(chunk + 1);
+            chunk_at += sizeof(*chunk) + sizeof(*records) * chunk->count;
+            if (!war_project_seen(seen, chunk->chunk)) { continue; }
+            seen[chunk->chunk >> 6] &= ~(1ull << (chunk->chunk & 63));
+            if (!war_note_quads_reserve(env, chunk->count)) {
+                dropped += chunk->count;
+                continue;
+            }
+            for (uint32_t j = 0; j < chunk->count; j++) {
+                war_note_swap_unpack(&records[j], &note_quad);
+                war_note_quads_insert(note_quads, &note_quad);
+            }
+        }
+    }
+    munmap(data, size);
+    close(fd);
+    war_note_quads_clean(note_quads);
+    if (dropped) {
+        call_terry_davis("project: %u notes in damaged or overfull pages lost",
+                         dropped);
+    }
+    call_terry_davis("project: loaded %u notes in %u pages and %u autosaves "
+                     "from %s",
+                     swap->notes_count + note_quads->count,
+                     pages_count,
+                     segments_count,
+                     path);
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// AUTOSAVE
+//-----------------------------------------------------------------------------
+// edits mark the WAR_PROJECT_CHUNK_COLS wide chunk a note starts in. every
+// WR_PROJECT_AUTOSAVE_US the render thread queues a segment holding all of
+// the notes in every dirty chunk, the worker appends it to the project file,
+// syncs it and then points the header at it. a crash loses at most the
+// segment being written, the header still points at the one before
+
+static inline uint64_t war_autosave_space(war_autosave* autosave) {
+    return autosave->queue_size -
+           (atomic_load_explicit(&autosave->queue_head, memory_order_relaxed) -
+            atomic_load_explicit(&autosave->queue_tail, memory_order_acquire));
+}
+
+// copies data in at queue position at, the caller checked the space
+static inline void war_autosave_put(war_autosave* autosave,
+                                    uint64_t at,
+                                    const void* data,
+                                    size_t size) {
+    uint64_t offset = at % autosave->queue_size;
+    size_t first = autosave->queue_size - offset;
+    if (first > size) { first = size; }
+    memcpy(autosave->queue + offset, data, first);
+    memcpy(autosave->queue, (const uint8_t*)data + first, size - first);
+}
+
+static inline void war_autosave_get(war_autosave* autosave,
+                                    uint64_t at,
+                                    void* data,
+                                    size_t size) {
+    uint64_t offset = at % autosave->queue_size;
+    size_t first = autosave->queue_size - offset;
+    if (first > size) { first = size; }
+    memcpy(data, autosave->queue + offset, first);
+    memcpy((uint8_t*)data + first, autosave->queue, size - first);
+}
+
+// queues a segment of as many dirty chunks as fit, lowest first, the rest
+// stay dirty for the next call. force skips the WR_PROJECT_AUTOSAVE_US wait
+static inline void war_autosave_sync(war_env* env, uint8_t force) {
+    war_autosave* autosave = env->autosave;
+    war_note_quads* note_quads = env->note_quads;
+    war_note_swap* swap = env->note_swap;
+    if (!autosave->base || !note_quads->dirty_count) { return; }
+    uint64_t now = env->ctx_wr->now;
+    if (!force && now - autosave->synced_us < autosave->every_us) { return; }
+    autosave->synced_us = now;
+    uint64_t* dirty = note_quads->dirty;
+    uint32_t* chunk_at = autosave->chunk_at;
+    for (uint32_t w = 0; w < WAR_PROJECT_CHUNKS_MAX / 64; w++) {
+        for (uint64_t bits = dirty[w]; bits; bits &= bits - 1) {
+            chunk_at[w * 64 + __builtin_ctzll(bits)] = 0;
+        }
+    }
+    // a snapshot of current the store still matches has every note packed
+    // already, its records are written instead of packing the store again
+    war_note_snapshots* snapshots = env->note_snapshots;
+    war_note_snapshot* snapshot =
+        war_note_snapshot_of(env, env->undo_tree->current);
+    if (snapshot && snapshot->generation != note_quads->generation) {
+        snapshot = NULL;
+    }
+    uint32_t snapshot_chunks =
+        snapshot ? snapshot->bars_count + snapshot->pages_count : 0;
+    for (uint32_t k = 0; k < snapshot_chunks; k++) {
+        if (!snapshot->chunks[k]) { continue; }
+        war_note_snapshot_chunk* c =
+            &snapshots->chunks[snapshot->chunks[k] - 1];
+        war_note_swap_record* records = snapshots->records + c->offset;
+        for (uint32_t j = 0; j < c->count; j++) {
+            uint32_t chunk = war_project_chunk(records[j].pos_x);
+            if (war_project_seen(dirty, chunk)) { chunk_at[chunk]++; }
+        }
+    }
+    for (uint32_t i = 0; i < note_quads->count && !snapshot; i++) {
+        if (!note_quads->alive[i]) { continue; }
+        uint32_t chunk = war_project_chunk(note_quads->pos_x[i]);
+        if (war_project_seen(dirty, chunk)) { chunk_at[chunk]++; }
+    }
+    for (uint32_t p = 0; p < swap->pages_used && !snapshot; p++) {
+        if (!swap->page_count[p] ||
+            !war_project_seen_range(
+                dirty, swap->page_min_col[p], swap->page_max_col[p]) ||
+            !war_note_swap_page_check(swap, p)) {
+            continue;
+        }
+        war_note_swap_record* records =
+            swap->records + (size_t)p * swap->page_notes;
+        for (uint32_t j = 0; j < swap->page_count[p]; j++) {
+            uint32_t chunk = war_project_chunk(records[j].pos_x);
+            if (war_project_seen(dirty, chunk)) { chunk_at[chunk]++; }
+        }
+    }
+    // chunk entries go in as chunks are taken, their counts turning into
+    // where in the segment their next record goes
+    uint64_t head =
+        atomic_load_explicit(&autosave->queue_head, memory_order_relaxed);
+    uint64_t space = war_autosave_space(autosave);
+    war_project_segment segment;
+    memset(&segment, 0, sizeof(segment));
+    memcpy(segment.magic, WAR_PROJECT_SEGMENT_MAGIC, 8);
+    uint64_t size = sizeof(segment);
+    uint32_t end = WAR_PROJECT_CHUNKS_MAX;
+    for (uint32_t w = 0; w < WAR_PROJECT_CHUNKS_MAX / 64 &&
+                         end == WAR_PROJECT_CHUNKS_MAX;
+         w++) {
+        for (uint64_t bits = dirty[w]; bits; bits &= bits - 1) {
+            uint32_t chunk = w * 64 + __builtin_ctzll(bits);
+            war_project_segment_chunk entry = {
+                .chunk = chunk,
+                .count = chunk_at[chunk],
+            };
+            uint64_t bytes =
+                sizeof(entry) + sizeof(war_note_swap_record) * entry.count;
+            if (war_project_pad(size + bytes) > space) {
+                end = chunk;
+                break;
+            }
+            war_autosave_put(autosave, head + size, &entry, sizeof(entry));
+            chunk_at[chunk] = size + sizeof(entry);
+            size += bytes;
+            segment.chunks_count++;
+            segment.records_count += entry.count;
+        }
+    }
+    if (!segment.chunks_count) {
+        if (space == autosave->queue_size) {
+            call_terry_davis("autosave: a chunk outgrew the queue, :w saves");
+            autosave->base = 0;
+        }
+        return;
+    }
+    for (uint32_t k = 0; k < snapshot_chunks; k++) {
+        if (!snapshot->chunks[k]) { continue; }
+        war_note_snapshot_chunk* c =
+            &snapshots->chunks[snapshot->chunks[k] - 1];
+        war_note_swap_record* records = snapshots->records + c->offset;
+        for (uint32_t j = 0; j < c->count; j++) {
+            uint32_t chunk = war_project_chunk(records[j].pos_x);
+            if (chunk >= end || !war_project_seen(dirty, chunk)) { continue; }
+            war_autosave_put(autosave,
+                             head + chunk_at[chunk],
+                             &records[j],
+                             sizeof(records[j]));
+            chunk_at[chunk] += sizeof(records[j]);
+        }
+    }
+    war_note_swap_record record;
+    for (uint32_t i = 0; i < note_quads->count && !snapshot; i++) {
+        if (!note_quads->alive[i]) { continue; }
+        uint32_t chunk = war_project_chunk(note_quads->pos_x[i]);
+        if (chunk >= end || !war_project_seen(dirty, chunk)) { continue; }
+        war_note_swap_pack(note_quads, i, &record);
+        war_autosave_put(
+            autosave, head + chunk_at[chunk], &record, sizeof(record));
+        chunk_at[chunk] += sizeof(record);
+    }
+    for (uint32_t p = 0; p < swap->pages_used && !snapshot; p++) {
+        if (!swap->page_count[p] ||
+            !war_project_seen_range(
+                dirty, swap->page_min_col[p], swap->page_max_col[p])) {
+            continue;
+        }
+        war_note_swap_record* records =
+            swap->records + (size_t)p * swap->page_notes;
+        for (uint32_t j = 0; j < swap->page_count[p]; j++) {
+            uint32_t chunk = war_project_chunk(records[j].pos_x);
+            if (chunk >= end || !war_project_seen(dirty, chunk)) { continue; }
+            war_autosave_put(autosave,
+                             head + chunk_at[chunk],
+                             &records[j],
+                             sizeof(records[j]));
+            chunk_at[chunk] += sizeof(records[j]);
+        }
+    }
+    uint8_t pad[8] = {0};
+    war_autosave_put(
+        autosave, head + size, pad, war_project_pad(size) - size);
+    war_project_song_fill(env, &segment.song);
+    war_autosave_put(autosave, head, &segment, sizeof(segment));
+    for (uint32_t w = 0; w < WAR_PROJECT_CHUNKS_MAX / 64; w++) {
+        for (uint64_t bits = dirty[w]; bits; bits &= bits - 1) {
+            uint32_t chunk = w * 64 + __builtin_ctzll(bits);
+            if (chunk >= end) { break; }
+            dirty[w] &= ~(1ull << (chunk & 63));
+            note_quads->dirty_count--;
+        }
+    }
+    atomic_store_explicit(&autosave->queue_head,
+                          head + war_project_pad(size),
+                          memory_order_release);
+}
+
+// writes the segment queued at at past the end of the file, makes it
+// durable and only then points the header at it
+static inline int war_autosave_append(war_autosave* autosave,
+                                      war_project_segment* segment,
+                                      uint64_t at,
+                                      uint64_t size) {
+    int fd = autosave->fd;
+    off_t end = lseek(fd, 0, SEEK_END);
+    if (end == -1) { return -1; }
+    uint64_t offset = war_project_pad(end);
+    segment->prev_offset = autosave->log_offset;
+    uint64_t checksum = war_checksum(WAR_CHECKSUM_SEED,
+                                     segment,
+                                     offsetof(war_project_segment, checksum));
+    // segments are padded to 8 and so is the queue, the body checksums the
+    // same in the pieces the wrap cuts it into
+    uint64_t body = at + sizeof(*segment);
+    uint64_t left = size - sizeof(*segment);
+    while (left) {
+        uint64_t piece = body % autosave->queue_size;
+        uint64_t run = autosave->queue_size - piece;
+        if (run > left) { run = left; }
+        checksum = war_checksum(checksum, autosave->queue + piece, run);
+        body += run;
+        left -= run;
+    }
+    segment->checksum = checksum;
+    if (lseek(fd, offset, SEEK_SET) == -1 ||
+        war_project_write(fd, segment, sizeof(*segment)) == -1) {
+        return -1;
+    }
+    body = at + sizeof(*segment);
+    left = size - sizeof(*segment);
+    while (left) {
+        uint64_t piece = body % autosave->queue_size;
+        uint64_t run = autosave->queue_size - piece;
+        if (run > left) { run = left; }
+        if (war_project_write(fd, autosave->queue + piece, run) == -1) {
+            return -1;
+        }
+        body += run;
+        left -= run;
+    }
+    if (fdatasync(fd) == -1) { return -1; }
+    uint64_t log[2] = {offset, war_project_log_checksum(offset)};
+    off_t log_at = offsetof(war_project_header, log_offset);
+    if (pwrite(fd, log, sizeof(log), log_at) != (ssize_t)sizeof(log)) {
+        return -1;
+    }
+    autosave->log_offset = offset;
+    autosave->log_bytes += size;
+    return 0;
+}
+
+// rewrites the file from itself with every chunk the log replaced folded
+// into the pages, laid out as war_project_save would. called with mutex held
+static inline void war_autosave_compact(war_env* env) {
+    war_autosave* autosave = env->autosave;
+    war_project* project = env->project;
+    uint32_t page_notes = env->note_swap->page_notes;
+    // a failed attempt waits for another WR_PROJECT_COMPACT_BYTES of log
+    autosave->log_bytes = 0;
+    struct stat st;
+    if (fstat(autosave->fd, &st) == -1 || !st.st_size) { return; }
+    uint64_t size = st.st_size;
+    uint8_t* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, autosave->fd, 0);
+    if (data == MAP_FAILED) {
+        call_terry_davis("autosave: failed to map %s", autosave->path);
+        return;
+    }
+    uint64_t* seen = autosave->seen;
+    war_project_section* base = war_project_sections(data, size);
+    uint64_t floor = base ? war_project_log_floor(base) : 0;
+    uint32_t segments_count = 0;
+    uint64_t log_bytes;
+    war_project_segment* newest =
+        base ? war_project_log_walk(
+                   data, size, floor, seen, &segments_count, &log_bytes) :
+               NULL;
+    if (!newest) {
+        call_terry_davis("autosave: %s won't compact", autosave->path);
+        munmap(data, size);
+        return;
+    }
+    war_project_song* base_song =
+        (war_project_song*)(data + base[PROJECT_SONG - 1].offset);
+    war_project_header header;
+    war_project_section table[PROJECT_SECTIONS_COUNT];
+    uint64_t offset;
+    int fd =
+        war_project_begin(project, autosave->path, &header, table, &offset);
+    if (fd < 0) {
+        munmap(data, size);
+        return;
+    }
+    war_project_section* section;
+    uint32_t copied[] = {PROJECT_LAYERS, PROJECT_VIEWS, PROJECT_SAMPLES};
+    for (uint32_t i = 0; i < 3; i++) {
+        section = &table[copied[i] - 1];
+        section->offset = offset;
+        if (war_project_put(fd,
+                            section,
+                            data + base[copied[i] - 1].offset,
+                            base[copied[i] - 1].size) == -1) {
+            goto war_label_failed;
+        }
+        offset += section->size;
+    }
+    section = &table[PROJECT_RECORDS - 1];
+    section->offset = war_project_align(offset);
+    section->checksum = 0;
+    if (lseek(fd, section->offset, SEEK_SET) == -1) { goto war_label_failed; }
+    uint32_t base_pages = base_song->pages_count;
+    uint8_t* pages = data + base[PROJECT_PAGES - 1].offset;
+    uint32_t* page_count = (uint32_t*)pages;
+    double* page_min_col =
+        (double*)(pages + war_project_pad(sizeof(uint32_t) * base_pages));
+    uint64_t* page_checksum = (uint64_t*)(page_min_col + 2 * base_pages);
+    war_note_swap_record* base_records =
+        (war_note_swap_record*)(data + base[PROJECT_RECORDS - 1].offset);
+    uint32_t pages_count = 0;
+    uint32_t fill = 0;
+    uint32_t dropped = 0;
+    for (uint32_t p = 0; p < base_pages; p++) {
+        war_note_swap_record* records =
+            base_records + (size_t)p * base_song->page_notes;
+        uint32_t n = page_count[p];
+        if (war_checksum(WAR_CHECKSUM_SEED,
+                         records,
+                         sizeof(war_note_swap_record) * n) !=
+            page_checksum[p]) {
+            dropped += n;
+            continue;
+        }
+        for (uint32_t j = 0; j < n; j++) {
+            if (war_project_seen(seen, war_project_chunk(records[j].pos_x))) {
+                continue;
+            }
+            if (war_project_page_add(fd,
+                                     project,
+                                     page_notes,
+                                     &pages_count,
+                                     &fill,
+                                     &records[j]) == -1) {
+                goto war_label_failed;
+            }
+        }
+    }
+    for (war_project_segment* segment = newest; segment;
+         segment = war_project_log_prev(data, size, floor, segment)) {
+        uint8_t* chunk_at = (uint8_t*)(segment + 1);
+        for (uint32_t c = 0; c < segment->chunks_count; c++) {
+            war_project_segment_chunk* chunk =
+                (war_project_segment_chunk*)chunk_at;
+            war_note_swap_record* records =
+                (war_note_swap_record*)(chunk + 1);
+            chunk_at += sizeof(*chunk) + sizeof(*records) * chunk->count;
+            if (!war_project_seen(seen, chunk->chunk)) { continue; }
+            seen[chunk->chunk >> 6] &= ~(1ull << (chunk->chunk & 63));
+            for (uint32_t j = 0; j < chunk->count; j++) {
+                if (war_project_page_add(fd,
+                                         project,
+                                         page_notes,
+                                         &pages_count,
+                                         &fill,
+                                         &records[j]) == -1) {
+                    goto war_label_failed;
+                }
+            }
+        }
+    }
+    if (fill && war_project_page_put(fd,
+                                     project,
+                                     page_notes,
+                                     &pages_count,
+                                     project->page,
+                                     fill) == -1) {
+        goto war_label_failed;
+    }
+    war_project_song song = newest->song;
+    song.note_count = base_song->note_count;
+    song.views_count = base_song->views_count;
+    song.samples_count = base_song->samples_count;
+    song.page_notes = page_notes;
+    song.pages_count = pages_count;
+    munmap(data, size);
+    if (war_project_finish(
+            fd, project, autosave->path, &header, table, &song) == -1) {
+        return;
+    }
+    close(autosave->fd);
+    autosave->fd = open(autosave->path, O_RDWR | O_CLOEXEC);
+    if (autosave->fd < 0) {
+        call_terry_davis("autosave: failed to reopen %s", autosave->path);
+    }
+    autosave->log_offset = 0;
+    if (dropped) {
+        call_terry_davis("autosave: %u notes in damaged pages lost", dropped);
+    }
+    call_terry_davis("autosave: compacted %u autosaves into %u pages",
+                     segments_count,
+                     pages_count);
+    return;
+war_label_failed:
+    call_terry_davis("project: failed to write %s", project->tmp_path);
+    munmap(data, size);
+    close(fd);
+    unlink(project->tmp_path);
+}
+
+// worker side, called with mutex held
+static inline void war_autosave_drain(war_env* env) {
+    war_autosave* autosave = env->autosave;
+    uint64_t head =
+        atomic_load_explicit(&autosave->queue_head, memory_order_acquire);
+    uint64_t tail =
+        atomic_load_explicit(&autosave->queue_tail, memory_order_relaxed);
+    while (tail < head) {
+        war_project_segment segment;
+        war_autosave_get(autosave, tail, &segment, sizeof(segment));
+        uint64_t size = war_project_segment_size(&segment);
+        if (autosave->fd >= 0 &&
+            war_autosave_append(autosave, &segment, tail, size) == -1) {
+            call_terry_davis("autosave: failed to append to %s",
+                             autosave->path);
+        }
+        tail += size;
+    }
+    atomic_store_explicit(&autosave->queue_tail, tail, memory_order_release);
+    pthread_cond_broadcast(&autosave->cond);
+    if (autosave->fd >= 0 && autosave->log_bytes >= autosave->compact_bytes) {
+        war_autosave_compact(env);
+    }
+}
+
+static void* war_autosave_writer(void* arg) {
+    war_env* env = arg;
+    war_autosave* autosave = env->autosave;
+    pthread_mutex_lock(&autosave->mutex);
+    while (atomic_load(&autosave->running)) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        uint64_t nsec = deadline.tv_nsec + autosave->every_us * 1000ULL;
+        deadline.tv_sec += nsec / 1000000000ULL;
+        deadline.tv_nsec = nsec % 1000000000ULL;
+        pthread_cond_timedwait(&autosave->cond, &autosave->mutex, &deadline);
+        war_autosave_drain(env);
+    }
+    war_autosave_drain(env);
+    pthread_mutex_unlock(&autosave->mutex);
+    return NULL;
+}
+
+// blocks until everything queued is in the file
+static inline void war_autosave_flush(war_env* env) {
+    war_autosave* autosave = env->autosave;
+    pthread_mutex_lock(&autosave->mutex);
+    if (!atomic_load(&autosave->running)) { war_autosave_drain(env); }
+    while (atomic_load(&autosave->queue_tail) !=
+           atomic_load(&autosave->queue_head)) {
+        pthread_cond_signal(&autosave->cond);
+        pthread_cond_wait(&autosave->cond, &autosave->mutex);
+    }
+    pthread_mutex_unlock(&autosave->mutex);
+}
+
+static inline void war_autosave_close(war_env* env) {
+    war_autosave* autosave = env->autosave;
+    autosave->base = 0;
+    if (autosave->fd < 0) { return; }
+    war_autosave_flush(env);
+    pthread_mutex_lock(&autosave->mutex);
+    close(autosave->fd);
+    autosave->fd = -1;
+    pthread_mutex_unlock(&autosave->mutex);
+}
+
+// points autosaves at path, which must hold a whole project for the log to
+// grow on. the log left there by earlier sessions is carried on
+static inline void war_autosave_open(war_env* env, const char* path) {
+    war_autosave* autosave = env->autosave;
+    war_project* project = env->project;
+    war_autosave_close(env);
+    if (strlen(path) >= autosave->path_limit) { return; }
+    pthread_mutex_lock(&autosave->mutex);
+    autosave->fd = open(path, O_RDWR | O_CLOEXEC);
+    if (autosave->fd >= 0) {
+        memcpy(autosave->path, path, strlen(path) + 1);
+        autosave->log_offset = project->log_offset;
+        autosave->log_bytes = project->log_bytes;
+        autosave->base = 1;
+    }
+    pthread_mutex_unlock(&autosave->mutex);
+    autosave->synced_us = env->ctx_wr->now;
+}
+
+// :w. path gets the whole project, the project moves there when adopt is
+// set and its log starts over, whatever was queued for it being in the file
+// now. saving goes through the autosave mutex since compaction shares the
+// project's scratch
+static inline int
+war_project_commit(war_env* env, const char* path, uint8_t adopt) {
+    war_autosave* autosave = env->autosave;
+    pthread_mutex_lock(&autosave->mutex);
+    int result = war_project_save(env, path);
+    if (result == 0 && adopt) {
+        atomic_store(&autosave->queue_tail, atomic_load(&autosave->queue_head));
+        if (autosave->fd >= 0) { close(autosave->fd); }
+        autosave->fd = -1;
+        autosave->base = 0;
+        if (strlen(path) < autosave->path_limit) {
+            autosave->fd = open(path, O_RDWR | O_CLOEXEC);
+        }
+        if (autosave->fd >= 0) {
+            memcpy(autosave->path, path, strlen(path) + 1);
+            autosave->base = 1;
+        }
+        autosave->log_offset = 0;
+        autosave->log_bytes = 0;
+        war_note_quads_clean(env->note_quads);
+        autosave->synced_us = env->ctx_wr->now;
+    }
+    pthread_mutex_unlock(&autosave->mutex);
+    return result;
+}
+
+// loads path and its undofile. the history carries over only when the file
+// was saved at one of its nodes, otherwise it would undo into another state.
+// what is open now gets its last autosave in first
+static inline int war_project_open(war_env* env, const char* path) {
+    war_autosave_sync(env, 1);
+    war_autosave_flush(env);
+    uint64_t undo_current_id;
+    if (war_project_load(env, path, &undo_current_id) == -1) { return -1; }
+    war_undofile_open(env, path);
+    war_autosave_open(env, path);
+    war_undo_tree* undo_tree = env->undo_tree;
+    war_undo_node* current = NULL;
+    if (undo_current_id) {
+        current = war_undo_node_find(undo_tree, undo_current_id);
+        if (!current) { war_undo_history_clear(env); }
+    }
+    undo_tree->current = current;
+    war_layer_flux(env->ctx_wr, env->atomics, env->ctx_play, env->ctx_color);
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// NOTE TEXT
+//-----------------------------------------------------------------------------
+
+// the n/d with the smallest d up to WAR_NOTE_TEXT_DENOMINATOR_MAX, or any
+// power of two up to 2^20, that divides out to exactly cols. 0 when cols has
+// to stay a decimal
+static inline uint8_t
+war_note_text_rational(double cols, int64_t* numerator, uint64_t* denominator) {
+    if (!(fabs(cols) < 9007199254740992.0)) { return 0; }
+    for (uint64_t d = 1; d <= WAR_NOTE_TEXT_DENOMINATOR_MAX; d++) {
+        double n = nearbyint(cols * (double)d);
+        if (n / (double)d == cols) {
+            *numerator = (int64_t)n;
+            *denominator = d;
+            return 1;
+        }
+    }
+    double scaled = cols;
+    for (uint64_t d = 1; d <= (1ull << 20); d <<= 1, scaled *= 2.0) {
+        if (scaled == floor(scaled)) {
+            *numerator = (int64_t)scaled;
+            *denominator = d;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static inline char* war_note_text_u64(char* at, uint64_t value) {
+    char digits[20];
+    uint32_t n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    while (n) { *at++ = digits[--n]; }
+    return at;
+}
+
+static inline char* war_note_text_cols(char* at, double cols) {
+    int64_t numerator;
+    uint64_t denominator;
+    if (!war_note_text_rational(cols, &numerator, &denominator)) {
+        return at + sprintf(at, "%.17g", cols);
+    }
+    if (numerator < 0) {
+        *at++ = '-';
+        numerator = -numerator;
+    }
+    at = war_note_text_u64(at, (uint64_t)numerator);
+    if (denominator == 1) { return at; }
+    *at++ = '/';
+    return war_note_text_u64(at, denominator);
+}
+
+// shortest decimal that reads back as the same float
+static inline char* war_note_text_gain(char* at, float gain) {
+    if (gain == floorf(gain) && fabsf(gain) < 1e6f) {
+        if (gain < 0) { *at++ = '-'; }
+        return war_note_text_u64(at, (uint64_t)fabsf(gain));
+    }
+    int len = sprintf(at, "%.6g", gain);
+    if (strtof(at, NULL) != gain) { len = sprintf(at, "%.9g", gain); }
+    return at + len;
+}
+
+static inline char* war_note_text_line(char* at, war_note_text_key* key) {
+    at = war_note_text_u64(at, (uint64_t)key->pos_y);
+    *at++ = ' ';
+    at = war_note_text_cols(at, key->pos_x);
+    *at++ = ' ';
+    at = war_note_text_cols(at, key->size_x);
+    *at++ = ' ';
+    at = war_note_text_u64(at, key->layer);
+    *at++ = ' ';
+    at = war_note_text_gain(at, key->gain);
+    if (key->mute) {
+        memcpy(at, " mute", 5);
+        at += 5;
+    }
+    if (key->hidden) {
+        memcpy(at, " hidden", 7);
+        at += 7;
+    }
+    *at++ = '\n';
+    return at;
+}
+
+// appends key's line to the buffer, writing the buffer out once it is
+// nearly full
+static inline int war_note_text_put(int fd,
+                                    war_note_text* note_text,
+                                    uint32_t* used,
+                                    war_note_text_key* key) {
+    char* buffer = note_text->buffer;
+    *used = war_note_text_line(buffer + *used, key) - buffer;
+    // room for a line of two %.17g columns and every other field
+    if (*used <= note_text->buffer_size - 160) { return 0; }
+    if (war_project_write(fd, buffer, *used) == -1) { return -1; }
+    *used = 0;
+    return 0;
+}
+
+static inline int war_note_text_key_compare(const void* a, const void* b) {
+    const war_note_text_key* ka = a;
+    const war_note_text_key* kb = b;
+    if (ka->pos_x != kb->pos_x) { return ka->pos_x < kb->pos_x ? -1 : 1; }
+    if (ka->pos_y != kb->pos_y) { return ka->pos_y < kb->pos_y ? -1 : 1; }
+    return (ka->id > kb->id) - (ka->id < kb->id);
+}
+
+// writes every note to path sorted by start, row and id. chunks are taken a
+// window at a time as many as fit in keys, so memory stays bounded however
+// many notes there are and the order only depends on the notes
+static inline int war_note_text_export(war_env* env, const char* path) {
+    war_note_text* note_text = env->note_text;
+    war_note_quads* note_quads = env->note_quads;
+    war_note_swap* swap = env->note_swap;
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        call_terry_davis("text: failed to open %s", path);
+        return -1;
+    }
+    uint32_t* chunk_count = note_text->chunk_count;
+    memset(chunk_count, 0, sizeof(uint32_t) * WAR_PROJECT_CHUNKS_MAX);
+    for (uint32_t i = 0; i < note_quads->count; i++) {
+        if (!note_quads->alive[i]) { continue; }
+        chunk_count[war_project_chunk(note_quads->pos_x[i])]++;
+    }
+    for (uint32_t p = 0; p < swap->pages_used; p++) {
+        if (!swap->page_count[p] || !war_note_swap_page_check(swap, p)) {
+            continue;
+        }
+        war_note_swap_record* records =
+            swap->records + (size_t)p * swap->page_notes;
+        for (uint32_t j = 0; j < swap->page_count[p]; j++) {
+            chunk_count[war_project_chunk(records[j].pos_x)]++;
+        }
+    }
+    const char* title = "# row start length layer gain [mute] [hidden]\n";
+    uint32_t used = strlen(title);
+    memcpy(note_text->buffer, title, used);
+    uint32_t notes_count = 0;
+    war_note_text_key key;
+    uint32_t chunk = 0;
+    while (chunk < WAR_PROJECT_CHUNKS_MAX) {
+        while (chunk < WAR_PROJECT_CHUNKS_MAX && !chunk_count[chunk]) {
+            chunk++;
+        }
+        if (chunk == WAR_PROJECT_CHUNKS_MAX) { break; }
+        uint32_t first = chunk;
+        uint32_t window_count = chunk_count[chunk++];
+        while (chunk < WAR_PROJECT_CHUNKS_MAX &&
+               window_count + chunk_count[chunk] <= note_text->keys_max) {
+            window_count += chunk_count[chunk++];
+        }
+        // a single chunk past keys_max goes out in store order
+        uint8_t sorted = window_count <= note_text->keys_max;
+        uint32_t keys_count = 0;
+        for (uint32_t i = 0; i < note_quads->count; i++) {
+            if (!note_quads->alive[i]) { continue; }
+            uint32_t c = war_project_chunk(note_quads->pos_x[i]);
+            if (c < first || c >= chunk) { continue; }
+            war_note_text_key* to =
+                sorted ? &note_text->keys[keys_count++] : &key;
+            *to = (war_note_text_key){
+                .pos_x = note_quads->pos_x[i],
+                .pos_y = note_quads->pos_y[i],
+                .size_x = note_quads->size_x[i],
+                .id = note_quads->id[i],
+                .layer = note_quads->layer[i],
+                .gain = note_quads->gain[i],
+                .mute = note_quads->mute[i],
+                .hidden = note_quads->hidden[i],
+            };
+            if (!sorted && war_note_text_put(fd, note_text, &used, to) == -1) {
+                goto war_label_failed;
+            }
+        }
+        for (uint32_t p = 0; p < swap->pages_used; p++) {
+            if (!swap->page_count[p] ||
+                war_project_chunk(swap->page_max_col[p]) < first ||
+                war_project_chunk(swap->page_min_col[p]) >= chunk) {
+                continue;
+            }
+            war_note_swap_record* records =
+                swap->records + (size_t)p * swap->page_notes;
+            for (uint32_t j = 0; j < swap->page_count[p]; j++) {
+                uint32_t c = war_project_chunk(records[j].pos_x);
+                if (c < first || c >= chunk) { continue; }
+                war_note_text_key* to =
+                    sorted ? &note_text->keys[keys_count++] : &key;
+                *to = (war_note_text_key){
+                    .pos_x = records[j].pos_x,
+                    .pos_y = records[j].pos_y,
+                    .size_x = records[j].size_x,
+                    .id = records[j].id,
+                    .layer = records[j].layer,
+                    .gain = records[j].gain,
+                    .mute = records[j].mute,
+                    .hidden = records[j].hidden,
+                };
+                if (!sorted &&
+                    war_note_text_put(fd, note_text, &used, to) == -1) {
+                    goto war_label_failed;
+                }
+            }
+        }
+        qsort(note_text->keys,
+              keys_count,
+              sizeof(war_note_text_key),
+              war_note_text_key_compare);
+        for (uint32_t k = 0; k < keys_count; k++) {
+            if (war_note_text_put(fd, note_text, &used, &note_text->keys[k]) ==
+                -1) {
+                goto war_label_failed;
+            }
+        }
+        notes_count += window_count;
+    }
+    if (war_project_write(fd, note_text->buffer, used) == -1) {
+        goto war_label_failed;
+    }
+    close(fd);
+    call_terry_davis("text: wrote %u notes to %s", notes_count, path);
+    return 0;
+war_label_failed:
+    call_terry_davis("text: failed to write %s", path);
+    close(fd);
+    return -1;
+}
+
+static inline char* war_note_text_skip(char* at) {
+    while (*at == ' ' || *at == '\t') { at++; }
+    return at;
+}
+
+static inline uint8_t war_note_text_read_u64(char** at, uint64_t* value) {
+    char* c = *at;
+    if (*c < '0' || *c > '9') { return 0; }
+    uint64_t v = 0;
+    while (*c >= '0' && *c <= '9') {
+        if (v > (UINT64_MAX - 9) / 10) { return 0; }
+        v = v * 10 + (uint64_t)(*c++ - '0');
+    }
+    *at = c;
+    *value = v;
+    return 1;
+}
+
+// plain digits with a fraction are read here, anything with an exponent or
+// too many digits to be exact goes to strtod
+static inline uint8_t war_note_text_read_decimal(char** at, double* value) {
+    char* c = *at;
+    uint8_t negative = *c == '-';
+    if (negative) { c++; }
+    uint64_t mantissa = 0;
+    uint32_t digits = 0;
+    int32_t scale = 0;
+    for (; *c >= '0' && *c <= '9'; c++, digits++) {
+        mantissa = mantissa * 10 + (uint64_t)(*c - '0');
+    }
+    if (*c == '.') {
+        for (c++; *c >= '0' && *c <= '9'; c++, digits++, scale++) {
+            mantissa = mantissa * 10 + (uint64_t)(*c - '0');
         }
-        ctx_wr->color_cursor = ctx_color->full_white_hex;
-        ctx_wr->color_cursor_transparent = ctx_color->white_hex;
-        ctx_wr->color_note_outline_default = ctx_color->white_hex;
-        break;
     }
+    if (!digits) { return 0; }
+    if (*c == 'e' || *c == 'E' || digits > 15) {
+        char* end;
+        *value = strtod(*at, &end);
+        if (end == *at) { return 0; }
+        *at = end;
+        return 1;
+    }
+    static const double powers[] = {1e0,
+                                    1e1,
+                                    1e2,
+                                    1e3,
+                                    1e4,
+                                    1e5,
+                                    1e6,
+                                    1e7,
+                                    1e8,
+                                    1e9,
+                                    1e10,
+                                    1e11,
+                                    1e12,
+                                    1e13,
+                                    1e14,
+                                    1e15};
+    // both exact below 10^15, so the one division rounds correctly
+    double v = (double)mantissa / powers[scale];
+    *value = negative ? -v : v;
+    *at = c;
+    return 1;
+}
+
+// columns as n/d, whole or decimal. numerator and denominator are the
+// rational when there is one, the way note lengths keep them
+static inline uint8_t war_note_text_read_cols(char** at,
+                                              double* cols,
+                                              uint32_t* numerator,
+                                              uint32_t* denominator) {
+    char* c = *at;
+    uint64_t n, d;
+    if (war_note_text_read_u64(&c, &n) && *c == '/') {
+        c++;
+        if (!war_note_text_read_u64(&c, &d) || !d || n > UINT32_MAX ||
+            d > UINT32_MAX) {
+            return 0;
+        }
+        *cols = (double)n / (double)d;
+        *numerator = (uint32_t)n;
+        *denominator = (uint32_t)d;
+        *at = c;
+        return 1;
+    }
+    if (!war_note_text_read_decimal(at, cols)) { return 0; }
+    int64_t rn;
+    uint64_t rd;
+    if (*cols >= 0 && war_note_text_rational(*cols, &rn, &rd) &&
+        rn <= UINT32_MAX) {
+        *numerator = (uint32_t)rn;
+        *denominator = (uint32_t)rd;
+    } else {
+        *numerator = 0;
+        *denominator = 1;
+    }
+    return 1;
+}
+
+// parses one line into note_quad, 0 for a comment or blank line and -1 when
+// the line doesn't read as a note
+static inline int war_note_text_parse(war_env* env,
+                                      char* line,
+                                      war_note_quad* note_quad) {
+    char* at = war_note_text_skip(line);
+    if (*at == '#' || *at == '\0') { return 0; }
+    uint64_t row, layer;
+    double gain;
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    memset(note_quad, 0, sizeof(*note_quad));
+    if (!war_note_text_read_u64(&at, &row) ||
+        row >= (uint64_t)atomic_load(&env->ctx_lua->A_NOTE_COUNT)) {
+        return -1;
+    }
+    at = war_note_text_skip(at);
+    uint32_t numerator, denominator;
+    if (!war_note_text_read_cols(
+            &at, &note_quad->pos_x, &numerator, &denominator) ||
+        note_quad->pos_x < 0) {
+        return -1;
+    }
+    at = war_note_text_skip(at);
+    if (!war_note_text_read_cols(&at,
+                                 &note_quad->size_x,
+                                 &note_quad->size_x_numerator,
+                                 &note_quad->size_x_denominator) ||
+        !(note_quad->size_x > 0)) {
+        return -1;
+    }
+    at = war_note_text_skip(at);
+    if (!war_note_text_read_u64(&at, &layer) || !layer) { return -1; }
+    at = war_note_text_skip(at);
+    if (!war_note_text_read_decimal(&at, &gain)) { return -1; }
+    for (;;) {
+        at = war_note_text_skip(at);
+        if (*at == '\0' || *at == '#') { break; }
+        if (strncmp(at, "mute", 4) == 0) {
+            note_quad->mute = 1;
+            at += 4;
+        } else if (strncmp(at, "hidden", 6) == 0) {
+            note_quad->hidden = 1;
+            at += 6;
+        } else {
+            return -1;
+        }
+        if (*at != ' ' && *at != '\t' && *at != '\0') { return -1; }
+    }
+    note_quad->alive = 1;
+    note_quad->pos_y = (double)row;
+    note_quad->layer = layer;
+    note_quad->gain = (float)gain;
+    note_quad->navigation_x = 1.0;
+    note_quad->navigation_x_numerator = 1;
+    note_quad->navigation_x_denominator = 1;
+    note_quad->color = ctx_wr->color_cursor;
+    note_quad->outline_color = ctx_wr->color_note_outline_default;
+    return 1;
+}
+
+static inline uint8_t war_note_text_flush(war_env* env, uint32_t count) {
+    war_note_text* note_text = env->note_text;
+    if (!count) { return 1; }
+    if (!war_note_quads_reserve(env, count)) {
+        call_terry_davis("text: note quads full, nothing cold to swap out");
+        return 0;
+    }
+    for (uint32_t k = 0; k < count; k++) {
+        war_note_quads_append(env->note_quads, &note_text->batch[k]);
+    }
+    return 1;
+}
+
+// reads notes from fd until limit of them were read, the file ends or a
+// line doesn't parse. ids run on from first_id. with insert set the notes
+// go into note_quads in batches, log gets the first undo_notes_max either
+// way (a log with no data just counts bytes). returns how many were read
+static inline uint32_t war_note_text_stream(war_env* env,
+                                            int fd,
+                                            uint64_t first_id,
+                                            uint32_t limit,
+                                            uint8_t insert,
+                                            war_note_log* log,
+                                            uint32_t* bad_line) {
+    war_note_text* note_text = env->note_text;
+    char* buffer = note_text->buffer;
+    uint32_t filled = 0;
+    uint32_t count = 0;
+    uint32_t batched = 0;
+    uint32_t line_number = 0;
+    uint8_t eof = 0;
+    *bad_line = 0;
+    while (count < limit) {
+        char* line = buffer;
+        char* end = buffer + filled;
+        char* newline;
+        while (count < limit &&
+               ((newline = memchr(line, '\n', end - line)) ||
+                (eof && line < end))) {
+            if (!newline) { newline = end; }
+            *newline = '\0';
+            if (newline > line && newline[-1] == '\r') { newline[-1] = '\0'; }
+            line_number++;
+            war_note_quad* note_quad = &note_text->batch[batched];
+            int parsed = war_note_text_parse(env, line, note_quad);
+            line = newline + (newline < end);
+            if (parsed == 0) { continue; }
+            if (parsed < 0) {
+                *bad_line = line_number;
+                limit = count;
+                break;
+            }
+            note_quad->id = first_id + count++;
+            // past undo_notes_max the log is never used
+            if (count <= note_text->undo_notes_max) {
+                war_note_log_put(log, note_quad, 0);
+            }
+            if (insert && ++batched == note_text->batch_max) {
+                if (!war_note_text_flush(env, batched)) {
+                    return count - batched;
+                }
+                batched = 0;
+            }
+        }
+        if (count >= limit || (eof && line >= end)) { break; }
+        filled = end - line;
+        memmove(buffer, line, filled);
+        // the terminator written over the newline needs the last byte
+        if (filled >= note_text->buffer_size - 1) {
+            *bad_line = line_number + 1;
+            break;
+        }
+        ssize_t got =
+            read(fd, buffer + filled, note_text->buffer_size - 1 - filled);
+        if (got < 0) {
+            if (errno == EINTR) { continue; }
+            *bad_line = line_number + 1;
+            break;
+        }
+        if (got == 0) { eof = 1; }
+        filled += (uint32_t)got;
+    }
+    if (insert && !war_note_text_flush(env, batched)) {
+        return count - batched;
+    }
+    return count;
+}
+
+// reads the notes in path into the project like vim's :r. the lines before
+// a bad one are kept. the import is one undo node when it has at most
+// undo_notes_max notes and its log fits, otherwise the history is cleared
+// since undoing past it could no longer be redone
+static inline int war_note_text_import(war_env* env, const char* path) {
+    war_note_text* note_text = env->note_text;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        call_terry_davis("text: failed to open %s", path);
+        return -1;
+    }
+    uint64_t first_id = atomic_load(&env->atomics->note_next_id);
+    war_note_log log = {0};
+    uint32_t bad_line;
+    uint32_t count = war_note_text_stream(
+        env, fd, first_id, UINT32_MAX, 1, &log, &bad_line);
+    atomic_store(&env->atomics->note_next_id, first_id + count);
+    if (bad_line) {
+        call_terry_davis("text: %s line %u doesn't read, stopped there",
+                         path,
+                         bad_line);
     }
+    if (!count) {
+        close(fd);
+        return bad_line ? -1 : 0;
+    }
+    uint8_t undoable = count <= note_text->undo_notes_max;
+    war_undo_node* node =
+        undoable ? war_undo_node_push(env, CMD_ADD_NOTES) : NULL;
+    if (node && war_undo_node_log_open(env, node, &log, count) &&
+        lseek(fd, 0, SEEK_SET) == 0 &&
+        war_note_text_stream(env, fd, first_id, count, 0, &log, &bad_line) ==
+            count) {
+        call_terry_davis("text: read %u notes from %s", count, path);
+    } else {
+        if (node) { war_undo_node_free(env, node); }
+        war_undo_history_clear(env);
+        call_terry_davis("text: read %u notes from %s, too many to undo so "
+                         "the history is cleared",
+                         count,
+                         path);
+    }
+    close(fd);
+    return 0;
 }
 
 static inline void war_get_warpoon_text(war_views* views) {
@@ -834,10 +6394,132 @@ war_clamp_uint32(uint32_t a, uint32_t min_value, uint32_t max_value) {
     return a;
 }
 
+// moves the cursor to col and pans the view only as far as needed to keep it
+// inside the scroll margins
+static inline void war_cursor_goto_col(war_window_render_context* ctx_wr,
+                                       double col) {
+    if (col < ctx_wr->min_col) { col = ctx_wr->min_col; }
+    if (col > ctx_wr->max_col) { col = ctx_wr->max_col; }
+    ctx_wr->cursor_pos_x = col;
+    ctx_wr->sub_col = 0;
+    uint32_t viewport_width = ctx_wr->right_col - ctx_wr->left_col;
+    double left_margin = (double)ctx_wr->left_col + ctx_wr->scroll_margin_cols;
+    double right_margin =
+        (double)ctx_wr->right_col - ctx_wr->scroll_margin_cols;
+    if (col < left_margin) {
+        uint32_t pan = (uint32_t)ceil(left_margin - col);
+        ctx_wr->left_col =
+            war_clamp_subtract_uint32(ctx_wr->left_col, pan, ctx_wr->min_col);
+        ctx_wr->right_col =
+            war_clamp_subtract_uint32(ctx_wr->right_col, pan, ctx_wr->min_col);
+        uint32_t new_viewport_width = ctx_wr->right_col - ctx_wr->left_col;
+        if (new_viewport_width < viewport_width) {
+            uint32_t diff = viewport_width - new_viewport_width;
+            ctx_wr->right_col =
+                war_clamp_add_uint32(ctx_wr->right_col, diff, ctx_wr->max_col);
+        }
+    } else if (col > right_margin) {
+        uint32_t pan = (uint32_t)ceil(col - right_margin);
+        ctx_wr->left_col =
+            war_clamp_add_uint32(ctx_wr->left_col, pan, ctx_wr->max_col);
+        ctx_wr->right_col =
+            war_clamp_add_uint32(ctx_wr->right_col, pan, ctx_wr->max_col);
+        uint32_t new_viewport_width = ctx_wr->right_col - ctx_wr->left_col;
+        if (new_viewport_width < viewport_width) {
+            uint32_t diff = viewport_width - new_viewport_width;
+            ctx_wr->left_col = war_clamp_subtract_uint32(
+                ctx_wr->left_col, diff, ctx_wr->min_col);
+        }
+    }
+}
+
+static inline void war_cursor_goto_row(war_env* env, uint32_t row) {
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    row = war_clamp_uint32(row, ctx_wr->min_row, ctx_wr->max_row);
+    ctx_wr->cursor_pos_y = row;
+    ctx_wr->sub_row = 0;
+    uint32_t viewport_height = ctx_wr->top_row - ctx_wr->bottom_row;
+    if (row < ctx_wr->bottom_row + ctx_wr->scroll_margin_rows) {
+        uint32_t pan = ctx_wr->bottom_row + ctx_wr->scroll_margin_rows - row;
+        ctx_wr->bottom_row = war_clamp_subtract_uint32(
+            ctx_wr->bottom_row, pan, ctx_wr->min_row);
+        ctx_wr->top_row =
+            war_clamp_subtract_uint32(ctx_wr->top_row, pan, ctx_wr->min_row);
+        uint32_t new_viewport_height = ctx_wr->top_row - ctx_wr->bottom_row;
+        if (new_viewport_height < viewport_height) {
+            uint32_t diff = viewport_height - new_viewport_height;
+            ctx_wr->top_row =
+                war_clamp_add_uint32(ctx_wr->top_row, diff, ctx_wr->max_row);
+        }
+    } else if (row + ctx_wr->scroll_margin_rows > ctx_wr->top_row) {
+        uint32_t pan = row + ctx_wr->scroll_margin_rows - ctx_wr->top_row;
+        ctx_wr->bottom_row =
+            war_clamp_add_uint32(ctx_wr->bottom_row, pan, ctx_wr->max_row);
+        ctx_wr->top_row =
+            war_clamp_add_uint32(ctx_wr->top_row, pan, ctx_wr->max_row);
+        uint32_t new_viewport_height = ctx_wr->top_row - ctx_wr->bottom_row;
+        if (new_viewport_height < viewport_height) {
+            uint32_t diff = viewport_height - new_viewport_height;
+            ctx_wr->bottom_row = war_clamp_subtract_uint32(
+                ctx_wr->bottom_row, diff, ctx_wr->min_row);
+        }
+    }
+    if (ctx_wr->layer_flux) {
+        war_layer_flux(ctx_wr, env->atomics, env->ctx_play, env->ctx_color);
+    }
+}
+
+// faults in the notes a motion can land on and brings the motion index up
+// to date, a count can carry the cursor well past the per frame swap window
+static inline war_note_rows*
+war_note_rows_prepare(war_env* env, double left_col, double right_col) {
+    war_lua_context* ctx_lua = env->ctx_lua;
+    war_note_quads* note_quads = env->note_quads;
+    war_note_swap_fault(env->note_swap, note_quads, left_col, right_col);
+    double chunk_cols = atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT) *
+                        atomic_load(&ctx_lua->WR_NOTE_CHUNK_BEATS);
+    war_note_chunks_sync(env->note_chunks, note_quads, chunk_cols);
+    war_note_rows_sync(env->note_rows,
+                       env->note_chunks,
+                       note_quads,
+                       atomic_load(&env->atomics->layer));
+    return env->note_rows;
+}
+
+// w e b and W E B. words are runs of touching notes, e and E park the cursor
+// so it ends where the note or word ends
+static inline void war_note_rows_motion(war_env* env,
+                                        uint8_t words,
+                                        uint8_t end,
+                                        uint8_t backward) {
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    double lookahead = env->note_swap->lookahead_cols;
+    double col = ctx_wr->cursor_pos_x;
+    war_note_rows* rows = war_note_rows_prepare(
+        env, backward ? col - lookahead : col, backward ? col : col + lookahead);
+    uint32_t count = ctx_wr->numeric_prefix ? ctx_wr->numeric_prefix : 1;
+    uint32_t row = (uint32_t)ctx_wr->cursor_pos_y;
+    if (row >= rows->rows_count) { return; }
+    uint32_t* offset = words ? rows->word_offset : rows->offset;
+    double* x = words ? (end ? rows->word_end_x : rows->word_start_x)
+                      : (end ? rows->end_x : rows->start_x);
+    x += offset[row];
+    uint32_t n = offset[row + 1] - offset[row];
+    if (end) { col += ctx_wr->cursor_size_x; }
+    double target;
+    if (!war_note_rows_step(x, n, col, count, backward, &target)) { return; }
+    if (end) { target -= ctx_wr->cursor_size_x; }
+    war_cursor_goto_col(ctx_wr, target);
+}
+
 static inline uint64_t war_align64(uint64_t value) {
     return (value + 63) & ~63ULL;
 }
 
+static inline uint64_t war_align_down64(uint64_t value) {
+    return value & ~63ULL;
+}
+
 static inline void war_command_reset(war_command_context* ctx_command,
                                      war_status_context* ctx_status) {
     memset(ctx_status->middle, 0, ctx_status->capacity);
@@ -896,10 +6578,12 @@ static inline void war_wl_surface_set_opaque_region(int fd,
     assert(set_opaque_region_written == 12);
 }
 
+// full batches drop further quads rather than write past their buffers
 static inline void war_make_text_quad(war_text_vertex* text_vertices,
-                                      uint16_t* text_indices,
+                                      uint32_t* text_indices,
                                       uint32_t* text_vertices_count,
                                       uint32_t* text_indices_count,
+                                      uint32_t text_quads_max,
                                       float bottom_left_pos[3],
                                       float span[2],
                                       uint32_t color,
@@ -907,6 +6591,7 @@ static inline void war_make_text_quad(war_text_vertex* text_vertices,
                                       float thickness,
                                       float feather,
                                       uint32_t flags) {
+    if (*text_vertices_count / 4 >= text_quads_max) { return; }
     text_vertices[*text_vertices_count] = (war_text_vertex){
         .corner = {0, 0},
         .pos = {bottom_left_pos[0], bottom_left_pos[1], bottom_left_pos[2]},
@@ -976,9 +6661,11 @@ static inline void war_make_text_quad(war_text_vertex* text_vertices,
 }
 
 static inline void war_make_blank_text_quad(war_text_vertex* text_vertices,
-                                            uint16_t* text_indices,
+                                            uint32_t* text_indices,
                                             uint32_t* text_vertices_count,
-                                            uint32_t* text_indices_count) {
+                                            uint32_t* text_indices_count,
+                                            uint32_t text_quads_max) {
+    if (*text_vertices_count / 4 >= text_quads_max) { return; }
     text_vertices[*text_vertices_count] = (war_text_vertex){
         .corner = {0, 0},
         .pos = {0, 0, 0},
@@ -1041,10 +6728,36 @@ static inline void war_make_blank_text_quad(war_text_vertex* text_vertices,
     (*text_indices_count) += 6;
 }
 
-static inline void war_make_quad(war_quad_vertex* quad_vertices,
-                                 uint16_t* quad_indices,
-                                 uint32_t* vertices_count,
-                                 uint32_t* indices_count,
+// float to IEEE half, rounding to nearest even
+static inline uint16_t war_half(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (bits >> 16) & 0x8000;
+    uint32_t magnitude = bits & 0x7FFFFFFF;
+    // 65536 and past, inf and nan
+    if (magnitude >= 0x47800000) {
+        return sign | (magnitude > 0x7F800000 ? 0x7E00 : 0x7C00);
+    }
+    if (magnitude >= 0x38800000) {
+        uint32_t half = (magnitude - 0x38000000) >> 13;
+        uint32_t rest = magnitude & 0x1FFF;
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) { half++; }
+        return sign | half;
+    }
+    // subnormal, anything under 2^-25 rounds to zero
+    if (magnitude < 0x33000000) { return sign; }
+    uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+    uint32_t shift = 126 - (magnitude >> 23);
+    uint32_t half = mantissa >> shift;
+    uint32_t rest = mantissa & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (half & 1))) { half++; }
+    return sign | half;
+}
+
+static inline void war_make_quad(war_quad_instance* quad_instances,
+                                 uint32_t* instances_count,
+                                 uint32_t instances_max,
                                  float bottom_left_pos[3],
                                  float span[2],
                                  uint32_t color,
@@ -1052,182 +6765,373 @@ static inline void war_make_quad(war_quad_vertex* quad_vertices,
                                  uint32_t outline_color,
                                  float line_thickness[2],
                                  uint32_t flags) {
-    quad_vertices[*vertices_count] = (war_quad_vertex){
-        .corner = {0, 0},
-        .pos = {bottom_left_pos[0], bottom_left_pos[1], bottom_left_pos[2]},
-        .span = {span[0], span[1]},
-        .color = color,
-        .outline_thickness = outline_thickness,
-        .outline_color = outline_color,
-        .line_thickness = {line_thickness[0], line_thickness[1]},
-        .flags = flags,
-    };
-    quad_vertices[*vertices_count + 1] = (war_quad_vertex){
-        .corner = {1, 0},
-        .pos = {bottom_left_pos[0] + span[0],
-                bottom_left_pos[1],
-                bottom_left_pos[2]},
-        .span = {span[0], span[1]},
-        .color = color,
-        .outline_thickness = outline_thickness,
-        .outline_color = outline_color,
-        .line_thickness = {line_thickness[0], line_thickness[1]},
-        .flags = flags,
-    };
-    quad_vertices[*vertices_count + 2] = (war_quad_vertex){
-        .corner = {1, 1},
-        .pos = {bottom_left_pos[0] + span[0],
-                bottom_left_pos[1] + span[1],
-                bottom_left_pos[2]},
-        .span = {span[0], span[1]},
-        .color = color,
-        .outline_thickness = outline_thickness,
-        .outline_color = outline_color,
-        .line_thickness = {line_thickness[0], line_thickness[1]},
-        .flags = flags,
-    };
-    quad_vertices[*vertices_count + 3] = (war_quad_vertex){
-        .corner = {0, 1},
-        .pos = {bottom_left_pos[0],
-                bottom_left_pos[1] + span[1],
-                bottom_left_pos[2]},
+    if (*instances_count >= instances_max) { return; }
+    quad_instances[(*instances_count)++] = (war_quad_instance){
+        .pos = {bottom_left_pos[0], bottom_left_pos[1]},
         .span = {span[0], span[1]},
         .color = color,
-        .outline_thickness = outline_thickness,
         .outline_color = outline_color,
-        .line_thickness = {line_thickness[0], line_thickness[1]},
+        .line_thickness = {war_half(line_thickness[0]),
+                           war_half(line_thickness[1])},
+        .outline_thickness = war_half(outline_thickness),
+        .depth = (uint8_t)(bottom_left_pos[2] * 255.0f + 0.5f),
         .flags = flags,
     };
-    quad_indices[*indices_count] = *vertices_count;
-    quad_indices[*indices_count + 1] = *vertices_count + 1;
-    quad_indices[*indices_count + 2] = *vertices_count + 2;
-    quad_indices[*indices_count + 3] = *vertices_count + 2;
-    quad_indices[*indices_count + 4] = *vertices_count + 3;
-    quad_indices[*indices_count + 5] = *vertices_count;
-    (*vertices_count) += 4;
-    (*indices_count) += 6;
 }
 
-static inline void
-war_make_transparent_quad(war_quad_vertex* transparent_quad_vertices,
-                          uint16_t* transparent_quad_indices,
-                          uint32_t* vertices_count,
-                          uint32_t* indices_count,
-                          float bottom_left_pos[3],
-                          float span[2],
-                          uint32_t color,
-                          float outline_thickness,
-                          uint32_t outline_color,
-                          float line_thickness[2],
-                          uint32_t flags) {
-    transparent_quad_vertices[*vertices_count] = (war_quad_vertex){
-        .corner = {0, 0},
-        .pos = {bottom_left_pos[0], bottom_left_pos[1], bottom_left_pos[2]},
-        .span = {span[0], span[1]},
-        .color = color,
-        .outline_thickness = outline_thickness,
-        .outline_color = outline_color,
-        .line_thickness = {line_thickness[0], line_thickness[1]},
-        .flags = flags,
-    };
-    transparent_quad_vertices[*vertices_count + 1] = (war_quad_vertex){
-        .corner = {1, 0},
-        .pos = {bottom_left_pos[0] + span[0],
-                bottom_left_pos[1],
-                bottom_left_pos[2]},
-        .span = {span[0], span[1]},
-        .color = color,
-        .outline_thickness = outline_thickness,
-        .outline_color = outline_color,
-        .line_thickness = {line_thickness[0], line_thickness[1]},
-        .flags = flags,
-    };
-    transparent_quad_vertices[*vertices_count + 2] = (war_quad_vertex){
-        .corner = {1, 1},
-        .pos = {bottom_left_pos[0] + span[0],
-                bottom_left_pos[1] + span[1],
-                bottom_left_pos[2]},
-        .span = {span[0], span[1]},
-        .color = color,
-        .outline_thickness = outline_thickness,
-        .outline_color = outline_color,
-        .line_thickness = {line_thickness[0], line_thickness[1]},
-        .flags = flags,
-    };
-    transparent_quad_vertices[*vertices_count + 3] = (war_quad_vertex){
-        .corner = {0, 1},
-        .pos = {bottom_left_pos[0],
-                bottom_left_pos[1] + span[1],
-                bottom_left_pos[2]},
-        .span = {span[0], span[1]},
-        .color = color,
+//-----------------------------------------------------------------------------
+// DAMAGE
+//-----------------------------------------------------------------------------
+
+// grows the damage of the next frame by a rect of buffer pixels, top-left
+// origin like wl_surface::damage_buffer
+static inline void war_damage_rect(war_window_render_context* ctx_wr,
+                                   float x0,
+                                   float y0,
+                                   float x1,
+                                   float y1) {
+    x0 = fmaxf(x0, 0.0f);
+    y0 = fmaxf(y0, 0.0f);
+    x1 = fminf(x1, ctx_wr->physical_width);
+    y1 = fminf(y1, ctx_wr->physical_height);
+    if (x0 >= x1 || y0 >= y1) { return; }
+    ctx_wr->redraw = 1;
+    if (ctx_wr->damage[0] >= ctx_wr->damage[2]) {
+        ctx_wr->damage[0] = x0;
+        ctx_wr->damage[1] = y0;
+        ctx_wr->damage[2] = x1;
+        ctx_wr->damage[3] = y1;
+        return;
+    }
+    ctx_wr->damage[0] = fminf(ctx_wr->damage[0], x0);
+    ctx_wr->damage[1] = fminf(ctx_wr->damage[1], y0);
+    ctx_wr->damage[2] = fmaxf(ctx_wr->damage[2], x1);
+    ctx_wr->damage[3] = fmaxf(ctx_wr->damage[3], y1);
+}
+
+static inline void war_damage_full(war_window_render_context* ctx_wr) {
+    war_damage_rect(
+        ctx_wr, 0.0f, 0.0f, ctx_wr->physical_width, ctx_wr->physical_height);
+}
+
+// cells as QUAD_GRID places them, pad in pixels covers outlines and feather
+static inline void war_damage_cells(war_window_render_context* ctx_wr,
+                                    float col,
+                                    float row,
+                                    float cols,
+                                    float rows,
+                                    float pad) {
+    float cell_x = ctx_wr->cell_width * ctx_wr->zoom_scale;
+    float cell_y = ctx_wr->cell_height * ctx_wr->zoom_scale;
+    float x = (col + ctx_wr->num_cols_for_line_numbers - ctx_wr->left_col) *
+              cell_x;
+    float y = ctx_wr->physical_height -
+              (row + rows + ctx_wr->num_rows_for_status_bars -
+               ctx_wr->bottom_row) *
+                  cell_y;
+    war_damage_rect(ctx_wr,
+                    x - pad,
+                    y - pad,
+                    x + cols * cell_x + pad,
+                    y + rows * cell_y + pad);
+}
+
+// hands the damage so far to the frame being recorded, whatever changes while
+// it waits for its commit lands in the next one
+static inline void war_damage_record(war_window_render_context* ctx_wr) {
+    ctx_wr->redraw = 0;
+    if (ctx_wr->damage[0] >= ctx_wr->damage[2]) { return; }
+    if (ctx_wr->present_damage[0] >= ctx_wr->present_damage[2]) {
+        memcpy(ctx_wr->present_damage, ctx_wr->damage, sizeof(ctx_wr->damage));
+    } else {
+        ctx_wr->present_damage[0] =
+            fminf(ctx_wr->present_damage[0], ctx_wr->damage[0]);
+        ctx_wr->present_damage[1] =
+            fminf(ctx_wr->present_damage[1], ctx_wr->damage[1]);
+        ctx_wr->present_damage[2] =
+            fmaxf(ctx_wr->present_damage[2], ctx_wr->damage[2]);
+        ctx_wr->present_damage[3] =
+            fmaxf(ctx_wr->present_damage[3], ctx_wr->damage[3]);
+    }
+    memset(ctx_wr->damage, 0, sizeof(ctx_wr->damage));
+}
+
+// fnv-1a over the part of the status text that fits the viewport
+static inline uint64_t war_status_hash(war_window_render_context* ctx_wr,
+                                       war_status_context* ctx_status) {
+    uint32_t cols = ctx_wr->viewport_cols < ctx_status->capacity ?
+                        ctx_wr->viewport_cols :
+                        ctx_status->capacity;
+    const char* lines[3] = {
+        ctx_status->top, ctx_status->middle, ctx_status->bottom};
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint32_t l = 0; l < 3; l++) {
+        for (uint32_t i = 0; i < cols; i++) {
+            hash ^= (uint8_t)lines[l][i];
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+// the status rows redraw only when the visible part of their text changed
+static inline void war_damage_status(war_window_render_context* ctx_wr,
+                                     war_status_context* ctx_status) {
+    uint64_t hash = war_status_hash(ctx_wr, ctx_status);
+    if (hash == ctx_status->drawn_hash) { return; }
+    ctx_status->drawn_hash = hash;
+    war_damage_rect(ctx_wr,
+                    0.0f,
+                    ctx_wr->physical_height -
+                        ctx_wr->num_rows_for_status_bars *
+                            ctx_wr->cell_height *
+                            fmaxf(ctx_wr->zoom_scale, 1.0f),
+                    ctx_wr->physical_width,
+                    ctx_wr->physical_height);
+}
+
+//-----------------------------------------------------------------------------
+// FRAME STATS
+//-----------------------------------------------------------------------------
+
+static inline uint64_t war_get_clock_time_us(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// claims the ring slot of the next recorded frame
+static inline war_frame_stats*
+war_frame_stats_begin(war_window_render_context* ctx_wr) {
+    ctx_wr->frame_seq++;
+    war_frame_stats* stats =
+        &ctx_wr->frame_stats[ctx_wr->frame_seq % max_frame_stats];
+    memset(stats, 0, sizeof(war_frame_stats));
+    stats->seq = ctx_wr->frame_seq;
+    return stats;
+}
+
+// NULL once the ring lapped it
+static inline war_frame_stats*
+war_frame_stats_find(war_window_render_context* ctx_wr, uint64_t seq) {
+    war_frame_stats* stats = &ctx_wr->frame_stats[seq % max_frame_stats];
+    return (seq && stats->seq == seq) ? stats : NULL;
+}
+
+// gpu_us[TIMESTAMP_BEGIN] gets the whole frame, every other entry the span
+// since the timestamp before it
+static inline void war_frame_stats_gpu(war_frame_stats* stats,
+                                       uint64_t ticks[TIMESTAMP_COUNT],
+                                       float period) {
+    stats->gpu_us[TIMESTAMP_BEGIN] =
+        (float)(ticks[TIMESTAMP_COUNT - 1] - ticks[TIMESTAMP_BEGIN]) *
+        period / 1000.0f;
+    for (uint32_t i = TIMESTAMP_BEGIN + 1; i < TIMESTAMP_COUNT; i++) {
+        stats->gpu_us[i] = (float)(ticks[i] - ticks[i - 1]) * period / 1000.0f;
+    }
+}
+
+// marks the end of a part of the frame, TIMESTAMP_BEGIN its start
+static inline void war_frame_timestamp(war_vulkan_context* ctx_vk,
+                                       VkCommandBuffer cmd_buffer,
+                                       uint32_t frame,
+                                       uint32_t timestamp) {
+    if (!ctx_vk->timestamp_query_pool) { return; }
+    vkCmdWriteTimestamp(cmd_buffer,
+                        timestamp == TIMESTAMP_BEGIN ?
+                            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT :
+                            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        ctx_vk->timestamp_query_pool,
+                        TIMESTAMP_COUNT * frame + timestamp);
+}
+
+// averages over the ring in milliseconds, worst is the slowest cpu + gpu
+// frame so a single miss of the refresh budget still shows
+static inline void war_frame_stats_text(war_window_render_context* ctx_wr,
+                                        char* text,
+                                        size_t size) {
+    float sum[8] = {0};
+    uint32_t count = 0;
+    uint32_t presented = 0;
+    float worst = 0.0f;
+    for (uint32_t i = 0; i < max_frame_stats; i++) {
+        war_frame_stats* stats = &ctx_wr->frame_stats[i];
+        if (!stats->seq || stats->seq + max_frame_stats <= ctx_wr->frame_seq) {
+            continue;
+        }
+        float cpu = stats->fence_us + stats->upload_us + stats->build_us;
+        sum[0] += stats->wayland_us;
+        sum[1] += cpu;
+        sum[2] += stats->gpu_us[TIMESTAMP_CULL];
+        sum[3] += stats->gpu_us[TIMESTAMP_GRID];
+        sum[4] += stats->gpu_us[TIMESTAMP_QUADS];
+        sum[5] += stats->gpu_us[TIMESTAMP_TEXT];
+        if (stats->latency_us > 0.0f) {
+            sum[6] += stats->latency_us;
+            sum[7] += stats->refresh_us;
+            presented++;
+        }
+        if (cpu + stats->gpu_us[TIMESTAMP_BEGIN] > worst) {
+            worst = cpu + stats->gpu_us[TIMESTAMP_BEGIN];
+        }
+        count++;
+    }
+    if (!count) {
+        text[0] = '\0';
+        return;
+    }
+    float frames_ms = (float)count * 1000.0f;
+    float presented_ms = presented ? (float)presented * 1000.0f : 1.0f;
+    snprintf(text,
+             size,
+             "wl %.2f cpu %.2f gpu %.2f %.2f %.2f %.2f max %.2f lat %.2f/%.2f",
+             sum[0] / frames_ms,
+             sum[1] / frames_ms,
+             sum[2] / frames_ms,
+             sum[3] / frames_ms,
+             sum[4] / frames_ms,
+             sum[5] / frames_ms,
+             worst / 1000.0f,
+             sum[6] / presented_ms,
+             sum[7] / presented_ms);
+}
+
+//-----------------------------------------------------------------------------
+// FRAME PACING
+//-----------------------------------------------------------------------------
+
+// slowest upload, build and gpu time of the last few frames plus the margin,
+// what recording a frame has to fit in before its commit, so one old spike
+// stops padding the budget after max_frame_budget_window frames
+static inline uint64_t war_frame_budget_us(war_window_render_context* ctx_wr) {
+    float worst = 0.0f;
+    for (uint32_t i = 0; i < max_frame_budget_window; i++) {
+        if (ctx_wr->frame_seq < i) { break; }
+        war_frame_stats* stats =
+            war_frame_stats_find(ctx_wr, ctx_wr->frame_seq - i);
+        if (!stats) { continue; }
+        float us = stats->upload_us + stats->build_us +
+                   stats->gpu_us[TIMESTAMP_BEGIN];
+        if (us > worst) { worst = us; }
+    }
+    return (uint64_t)worst + ctx_wr->render_margin_us;
+}
+
+// first predicted vblank at or after us
+static inline uint64_t war_next_vblank_us(war_window_render_context* ctx_wr,
+                                          uint64_t us) {
+    if (us <= ctx_wr->vblank_us) { return ctx_wr->vblank_us; }
+    uint64_t refreshes =
+        (us - ctx_wr->vblank_us + ctx_wr->refresh_us - 1) / ctx_wr->refresh_us;
+    return ctx_wr->vblank_us + refreshes * ctx_wr->refresh_us;
+}
+
+// picks the vblank a frame armed at now can still make and returns when to
+// start recording it, now itself until presentation feedback gave a refresh
+static inline uint64_t war_present_schedule(war_window_render_context* ctx_wr,
+                                            uint64_t now) {
+    if (!ctx_wr->refresh_us) {
+        ctx_wr->present_at_us = 0;
+        return now;
+    }
+    uint64_t budget = war_frame_budget_us(ctx_wr);
+    ctx_wr->present_at_us =
+        war_next_vblank_us(ctx_wr, now + budget + ctx_wr->present_lead_us);
+    return ctx_wr->present_at_us - ctx_wr->present_lead_us - budget;
+}
+
+// moves the playback bar to where the play head is ahead_us from now and
+// damages the cells it swept. a stopped play head stays where it is
+static inline void war_playback_bar_update(war_window_render_context* ctx_wr,
+                                           war_lua_context* ctx_lua,
+                                           war_atomics* atomics,
+                                           uint64_t ahead_us) {
+    if (!atomic_load(&atomics->play)) { ahead_us = 0; }
+    float pos_x = ((float)atomic_load(&atomics->play_frames) /
+                       atomic_load(&ctx_lua->A_SAMPLE_RATE) +
+                   (float)ahead_us / 1000000.0f) /
+                  ((60.0f / atomic_load(&ctx_lua->A_BPM)) /
+                   atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT));
+    if (pos_x == ctx_wr->playback_bar_pos_x) { return; }
+    war_damage_cells(ctx_wr,
+                     fminf(pos_x, ctx_wr->playback_bar_pos_x),
+                     ctx_wr->bottom_row,
+                     fabsf(pos_x - ctx_wr->playback_bar_pos_x),
+                     ctx_wr->viewport_rows,
+                     ctx_wr->playback_bar_thickness + 1.0f);
+    ctx_wr->playback_bar_pos_x = pos_x;
+}
+
+//-----------------------------------------------------------------------------
+// NOTE INSTANCES
+//-----------------------------------------------------------------------------
+
+// what slot i draws as. dead and hidden notes keep their slot and are culled
+// by war_note_cull_compute.glsl, war_quad_vertex.glsl fades muted ones by
+// mute_alpha
+static inline war_quad_instance war_note_instance(war_note_quads* note_quads,
+                                                  uint32_t i,
+                                                  uint8_t depth,
+                                                  uint16_t outline_thickness) {
+    uint8_t flags = QUAD_GRID;
+    if (!note_quads->alive[i] || note_quads->hidden[i]) {
+        flags |= QUAD_HIDDEN;
+    }
+    if (note_quads->mute[i]) { flags |= QUAD_MUTE; }
+    return (war_quad_instance){
+        .pos = {(float)note_quads->pos_x[i], (float)note_quads->pos_y[i]},
+        .span = {(float)note_quads->size_x[i], 1},
+        .color = note_quads->color[i],
+        .outline_color = note_quads->outline_color[i],
+        .line_thickness = {0, 0},
         .outline_thickness = outline_thickness,
-        .outline_color = outline_color,
-        .line_thickness = {line_thickness[0], line_thickness[1]},
+        .depth = depth,
         .flags = flags,
     };
-    transparent_quad_indices[*indices_count] = *vertices_count;
-    transparent_quad_indices[*indices_count + 1] = *vertices_count + 1;
-    transparent_quad_indices[*indices_count + 2] = *vertices_count + 2;
-    transparent_quad_indices[*indices_count + 3] = *vertices_count + 2;
-    transparent_quad_indices[*indices_count + 4] = *vertices_count + 3;
-    transparent_quad_indices[*indices_count + 5] = *vertices_count;
-    (*vertices_count) += 4;
-    (*indices_count) += 6;
-}
-
-static inline void war_make_blank_quad(war_quad_vertex* quad_vertices,
-                                       uint16_t* quad_indices,
-                                       uint32_t* vertices_count,
-                                       uint32_t* indices_count) {
-    quad_vertices[*vertices_count] = (war_quad_vertex){
-        .corner = {0, 0},
-        .pos = {0, 0, 0},
-        .span = {0, 0},
-        .color = 0,
-        .outline_thickness = 0,
-        .outline_color = 0,
-        .line_thickness = {0, 0},
-        .flags = 0,
-    };
-    quad_vertices[*vertices_count + 1] = (war_quad_vertex){
-        .corner = {0, 0},
-        .pos = {0, 0, 0},
-        .span = {0, 0},
-        .color = 0,
-        .outline_thickness = 0,
-        .outline_color = 0,
-        .line_thickness = {0, 0},
-        .flags = 0,
-    };
-    quad_vertices[*vertices_count + 2] = (war_quad_vertex){
-        .corner = {0, 0},
-        .pos = {0, 0, 0},
-        .span = {0, 0},
-        .color = 0,
-        .outline_thickness = 0,
-        .outline_color = 0,
-        .line_thickness = {0, 0},
-        .flags = 0,
-    };
-    quad_vertices[*vertices_count + 3] = (war_quad_vertex){
-        .corner = {0, 0},
-        .pos = {0, 0, 0},
-        .span = {0, 0},
-        .color = 0,
-        .outline_thickness = 0,
-        .outline_color = 0,
-        .line_thickness = {0, 0},
-        .flags = 0,
-    };
-    quad_indices[*indices_count] = *vertices_count;
-    quad_indices[*indices_count + 1] = *vertices_count + 1;
-    quad_indices[*indices_count + 2] = *vertices_count + 2;
-    quad_indices[*indices_count + 3] = *vertices_count + 2;
-    quad_indices[*indices_count + 4] = *vertices_count + 3;
-    quad_indices[*indices_count + 5] = *vertices_count;
-    (*vertices_count) += 4;
-    (*indices_count) += 6;
+}
+
+// rebuilds the instances when note_quads changed since the last sync, writes
+// the ones that differ from shadow to the same slot of staging, the frame's
+// region staging_offset bytes into the staging buffer, and returns how many
+// copies into the note buffer that takes, 0 on idle frames
+static inline uint32_t war_note_instances_sync(war_note_instances* instances,
+                                               war_note_quads* note_quads,
+                                               war_quad_instance* staging,
+                                               VkDeviceSize staging_offset,
+                                               float depth,
+                                               float outline_thickness) {
+    instances->copies_count = 0;
+    if (instances->synced_generation == note_quads->generation) { return 0; }
+    uint8_t depth_unorm = (uint8_t)(depth * 255.0f + 0.5f);
+    uint16_t outline_half = war_half(outline_thickness);
+    VkBufferCopy* copy = NULL;
+    for (uint32_t i = 0; i < note_quads->count; i++) {
+        war_quad_instance instance =
+            war_note_instance(note_quads, i, depth_unorm, outline_half);
+        if (i < instances->resident &&
+            memcmp(&instance, &instances->shadow[i], sizeof(instance)) == 0) {
+            copy = NULL;
+            continue;
+        }
+        instances->shadow[i] = instance;
+        staging[i] = instance;
+        if (copy) {
+            copy->size += sizeof(war_quad_instance);
+            continue;
+        }
+        copy = &instances->copies[instances->copies_count++];
+        *copy = (VkBufferCopy){
+            .srcOffset = staging_offset + sizeof(war_quad_instance) * i,
+            .dstOffset = sizeof(war_quad_instance) * i,
+            .size = sizeof(war_quad_instance),
+        };
+    }
+    if (note_quads->count > instances->resident) {
+        instances->resident = note_quads->count;
+    }
+    instances->count = note_quads->count;
+    instances->synced_generation = note_quads->generation;
+    return instances->copies_count;
 }
 
 static inline uint32_t war_gcd(uint32_t a, uint32_t b) {
@@ -1604,6 +7508,10 @@ static inline uint8_t war_parse_token_to_keysym_mod(const char* token,
         case ',':
             ks = XKB_KEY_comma;
             break;
+        case '"':
+            ks = XKB_KEY_apostrophe;
+            *mod_out |= MOD_SHIFT;
+            break;
         default:
             ks = xkb_keysym_from_name(key_str, XKB_KEYSYM_NO_FLAGS);
             break;
@@ -1060,10 +1060,10 @@ static inline void war_roll_note_draw(war_env* env) {
     war_window_render_context* ctx_wr = env->ctx_wr;
     war_atomics* atomics = env->atomics;
     war_lua_context* ctx_lua = env->ctx_lua;
-    war_undo_tree* undo_tree = env->undo_tree;
     war_note_quads* note_quads = env->note_quads;
-    war_pool* pool_wr = env->pool_wr;
-    uint64_t id = atomic_fetch_add(&atomics->note_next_id, 1);
+    // counted draws take one contiguous run of ids
+    uint32_t count = ctx_wr->numeric_prefix ? ctx_wr->numeric_prefix : 1;
+    uint64_t id = atomic_fetch_add(&atomics->note_next_id, count);
     war_note_quad note_quad = {
         .alive = 1,
         .id = id,
@@ -1081,245 +1081,50 @@ static inline void war_roll_note_draw(war_env* env) {
         .gain = atomic_load(&ctx_lua->A_DEFAULT_GAIN),
         .voice = 0,
     };
-    double sample_rate = atomic_load(&ctx_lua->A_SAMPLE_RATE);
-    double bpm = atomic_load(&ctx_lua->A_BPM);
-    double frames_per_beat = sample_rate * 60.0 / bpm;
-    double columns_per_beat = atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT);
-    war_note note;
-    double start_beats = note_quad.pos_x / columns_per_beat;
-    note.note_start_frames = (uint64_t)(start_beats * frames_per_beat + 0.5);
-    double duration_beats = note_quad.size_x / columns_per_beat;
-    note.note_duration_frames =
-        (uint64_t)(duration_beats * frames_per_beat + 0.5);
-    note.note = note_quad.pos_y;
-    note.layer = note_quad.layer;
-    note.note_attack = atomic_load(&ctx_lua->A_DEFAULT_ATTACK);
-    note.note_sustain = atomic_load(&ctx_lua->A_DEFAULT_SUSTAIN);
-    note.note_release = atomic_load(&ctx_lua->A_DEFAULT_RELEASE);
-    note.note_gain = atomic_load(&ctx_lua->A_DEFAULT_GAIN);
-    note.note_phase_increment = 0;
-    note.alive = note_quad.alive;
-    note.id = note_quad.id;
-    uint32_t note_quads_max = atomic_load(&ctx_lua->WR_NOTE_QUADS_MAX);
-    uint32_t undo_notes_batch_max =
-        atomic_load(&ctx_lua->WR_UNDO_NOTES_BATCH_MAX);
     if (ctx_wr->numeric_prefix) {
         // add notes
-        if (ctx_wr->numeric_prefix >= undo_notes_batch_max) {
-            // swapfile logic (memmove probably)
+        if (!war_note_quads_reserve(env, count)) {
+            call_terry_davis("note quads full, nothing cold to swap out");
             ctx_wr->numeric_prefix = 0;
+            return;
         }
-        // --- Compaction if needed ---
-        if (note_quads->count + ctx_wr->numeric_prefix >= note_quads_max) {
-            uint32_t write_idx = 0;
-            for (uint32_t read_idx = 0; read_idx < note_quads->count;
-                 read_idx++) {
-                if (note_quads->alive[read_idx]) {
-                    if (write_idx != read_idx) {
-                        // Copy all fields
-                        note_quads->pos_x[write_idx] =
-                            note_quads->pos_x[read_idx];
-                        note_quads->pos_y[write_idx] =
-                            note_quads->pos_y[read_idx];
-                        note_quads->layer[write_idx] =
-                            note_quads->layer[read_idx];
-                        note_quads->size_x[write_idx] =
-                            note_quads->size_x[read_idx];
-                        note_quads->size_x_numerator[write_idx] =
-                            note_quads->size_x_numerator[read_idx];
-                        note_quads->size_x_denominator[write_idx] =
-                            note_quads->size_x_denominator[read_idx];
-                        note_quads->navigation_x[write_idx] =
-                            note_quads->navigation_x[read_idx];
-                        note_quads->navigation_x_numerator[write_idx] =
-                            note_quads->navigation_x_numerator[read_idx];
-                        note_quads->navigation_x_denominator[write_idx] =
-                            note_quads->navigation_x_denominator[read_idx];
-                        note_quads->color[write_idx] =
-                            note_quads->color[read_idx];
-                        note_quads->outline_color[write_idx] =
-                            note_quads->outline_color[read_idx];
-                        note_quads->gain[write_idx] =
-                            note_quads->gain[read_idx];
-                        note_quads->voice[write_idx] =
-                            note_quads->voice[read_idx];
-                        note_quads->alive[write_idx] =
-                            note_quads->alive[read_idx];
-                        note_quads->id[write_idx] = note_quads->id[read_idx];
-                    }
-                    write_idx++;
-                }
-            }
-            if (write_idx >= note_quads_max) {
-                call_terry_davis("TODO: implement spillover swapfile");
-                ctx_wr->numeric_prefix = 0;
-                return;
-            };
-            note_quads->count = write_idx;
+        war_undo_node* node = war_undo_node_push(env, CMD_ADD_NOTES_SAME);
+        war_note_log log = {0};
+        for (uint32_t i = 0; i < count; i++) {
+            note_quad.id = id + i;
+            war_note_log_put(&log, &note_quad, 0);
         }
-        war_undo_node* node = war_pool_alloc(pool_wr, sizeof(war_undo_node));
-        node->id = undo_tree->next_id++;
-        node->seq_num = undo_tree->next_seq_num++;
-        node->command = CMD_ADD_NOTES_SAME;
-        node->payload.delete_notes_same.note = note;
-        node->payload.delete_notes_same.note_quad = note_quad;
-        node->payload.delete_notes_same.ids =
-            war_pool_alloc(pool_wr, sizeof(uint64_t) * ctx_wr->numeric_prefix);
-        node->payload.delete_notes_same.count = ctx_wr->numeric_prefix;
-        node->cursor_pos_x = ctx_wr->cursor_pos_x;
-        node->cursor_pos_y = ctx_wr->cursor_pos_y;
-        node->left_col = ctx_wr->left_col;
-        node->right_col = ctx_wr->right_col;
-        node->top_row = ctx_wr->top_row;
-        node->bottom_row = ctx_wr->bottom_row;
-        node->parent = NULL;
-        node->next = NULL;
-        node->prev = NULL;
-        node->alt_next = NULL;
-        node->alt_prev = NULL;
-        if (!undo_tree->root) {
-            node->branch_id = undo_tree->next_branch_id++;
-            undo_tree->root = node;
-            undo_tree->current = node;
-        } else if (!undo_tree->current) {
-            node->branch_id = undo_tree->next_branch_id++;
-            node->parent = NULL;
-            undo_tree->root = node;
-            undo_tree->current = node;
-        } else {
-            war_undo_node* cur = undo_tree->current;
-            if (cur->next) { cur->next = NULL; }
-            node->parent = cur;
-            node->branch_id = cur->branch_id;
-            cur->next = node;
-            node->prev = cur;
-            undo_tree->current = node;
+        if (!war_undo_node_log_open(env, node, &log, count)) {
+            war_undo_node_free(env, node);
+            ctx_wr->numeric_prefix = 0;
+            return;
         }
         // batch add
-        for (uint32_t i = 0; i < ctx_wr->numeric_prefix; i++) {
-            note_quads->pos_x[note_quads->count + i] = note_quad.pos_x;
-            note_quads->pos_y[note_quads->count + i] = note_quad.pos_y;
-            note_quads->layer[note_quads->count + i] = note_quad.layer;
-            note_quads->size_x[note_quads->count + i] = note_quad.size_x;
-            note_quads->size_x_numerator[note_quads->count + i] =
-                note_quad.size_x_numerator;
-            note_quads->size_x_denominator[note_quads->count + i] =
-                note_quad.size_x_denominator;
-            note_quads->navigation_x[note_quads->count + i] =
-                note_quad.navigation_x;
-            note_quads->navigation_x_numerator[note_quads->count + i] =
-                note_quad.navigation_x_numerator;
-            note_quads->navigation_x_denominator[note_quads->count + i] =
-                note_quad.navigation_x_denominator;
-            note_quads->color[note_quads->count + i] = note_quad.color;
-            note_quads->outline_color[note_quads->count + i] =
-                note_quad.outline_color;
-            note_quads->gain[note_quads->count + i] = note_quad.gain;
-            note_quads->voice[note_quads->count + i] = note_quad.voice;
-            note_quads->alive[note_quads->count + i] = note_quad.alive;
-            note_quads->id[note_quads->count + i] = id;
-            node->payload.delete_notes_same.ids[i] = id;
-            id = atomic_fetch_add(&atomics->note_next_id, 1);
+        for (uint32_t i = 0; i < count; i++) {
+            note_quad.id = id + i;
+            war_note_quads_append(note_quads, &note_quad);
+            war_note_log_put(&log, &note_quad, 0);
         }
-        note_quads->count += ctx_wr->numeric_prefix;
-        // note, count, ids
+        war_undo_node_join(env, node);
         ctx_wr->numeric_prefix = 0;
         return;
     }
     //-------------------------------------------------------------
     // ADD SINGLE NOTE
     //-------------------------------------------------------------
-    // --- Compaction if needed ---
-    if (note_quads->count + 1 >= note_quads_max) {
-        uint32_t write_idx = 0;
-        for (uint32_t read_idx = 0; read_idx < note_quads->count; read_idx++) {
-            if (note_quads->alive[read_idx]) {
-                if (write_idx != read_idx) {
-                    // Copy all fields
-                    note_quads->pos_x[write_idx] = note_quads->pos_x[read_idx];
-                    note_quads->pos_y[write_idx] = note_quads->pos_y[read_idx];
-                    note_quads->layer[write_idx] = note_quads->layer[read_idx];
-                    note_quads->size_x[write_idx] =
-                        note_quads->size_x[read_idx];
-                    note_quads->size_x_numerator[write_idx] =
-                        note_quads->size_x_numerator[read_idx];
-                    note_quads->size_x_denominator[write_idx] =
-                        note_quads->size_x_denominator[read_idx];
-                    note_quads->navigation_x[write_idx] =
-                        note_quads->navigation_x[read_idx];
-                    note_quads->navigation_x_numerator[write_idx] =
-                        note_quads->navigation_x_numerator[read_idx];
-                    note_quads->navigation_x_denominator[write_idx] =
-                        note_quads->navigation_x_denominator[read_idx];
-                    note_quads->color[write_idx] = note_quads->color[read_idx];
-                    note_quads->outline_color[write_idx] =
-                        note_quads->outline_color[read_idx];
-                    note_quads->gain[write_idx] = note_quads->gain[read_idx];
-                    note_quads->voice[write_idx] = note_quads->voice[read_idx];
-                    note_quads->alive[write_idx] = note_quads->alive[read_idx];
-                    note_quads->id[write_idx] = note_quads->id[read_idx];
-                }
-                write_idx++;
-            }
-        }
-        assert(write_idx < note_quads_max);
-        note_quads->count = write_idx;
-    }
-    note_quads->pos_x[note_quads->count] = note_quad.pos_x;
-    note_quads->pos_y[note_quads->count] = note_quad.pos_y;
-    note_quads->layer[note_quads->count] = note_quad.layer;
-    note_quads->size_x[note_quads->count] = note_quad.size_x;
-    note_quads->size_x_numerator[note_quads->count] =
-        note_quad.size_x_numerator;
-    note_quads->size_x_denominator[note_quads->count] =
-        note_quad.size_x_denominator;
-    note_quads->navigation_x[note_quads->count] = note_quad.navigation_x;
-    note_quads->navigation_x_numerator[note_quads->count] =
-        note_quad.navigation_x_numerator;
-    note_quads->navigation_x_denominator[note_quads->count] =
-        note_quad.navigation_x_denominator;
-    note_quads->color[note_quads->count] = note_quad.color;
-    note_quads->outline_color[note_quads->count] = note_quad.outline_color;
-    note_quads->gain[note_quads->count] = note_quad.gain;
-    note_quads->voice[note_quads->count] = note_quad.voice;
-    note_quads->alive[note_quads->count] = note_quad.alive;
-    note_quads->id[note_quads->count] = note_quad.id;
-    note_quads->count++;
-    war_undo_node* node = war_pool_alloc(pool_wr, sizeof(war_undo_node));
-    node->id = undo_tree->next_id++;
-    node->seq_num = undo_tree->next_seq_num++;
-    node->command = CMD_ADD_NOTE;
-    node->payload.delete_note.note = note;
-    node->payload.delete_note.note_quad = note_quad;
-    node->cursor_pos_x = ctx_wr->cursor_pos_x;
-    node->cursor_pos_y = ctx_wr->cursor_pos_y;
-    node->left_col = ctx_wr->left_col;
-    node->right_col = ctx_wr->right_col;
-    node->top_row = ctx_wr->top_row;
-    node->bottom_row = ctx_wr->bottom_row;
-    node->parent = NULL;
-    node->next = NULL;
-    node->prev = NULL;
-    node->alt_next = NULL;
-    node->alt_prev = NULL;
-    if (!undo_tree->root) {
-        node->branch_id = undo_tree->next_branch_id++;
-        undo_tree->root = node;
-        undo_tree->current = node;
-    } else if (!undo_tree->current) {
-        node->branch_id = undo_tree->next_branch_id++;
-        node->parent = NULL;
-        undo_tree->root = node;
-        undo_tree->current = node;
-    } else {
-        war_undo_node* cur = undo_tree->current;
-        if (cur->next) { cur->next = NULL; }
-        node->parent = cur;
-        node->branch_id = cur->branch_id;
-        cur->next = node;
-        node->prev = cur;
-        undo_tree->current = node;
+    if (!war_note_quads_reserve(env, 1)) {
+        call_terry_davis("note quads full, nothing cold to swap out");
+        ctx_wr->numeric_prefix = 0;
+        return;
     }
+    war_undo_node* node = war_undo_node_push(env, CMD_ADD_NOTE);
+    if (!war_undo_node_log_quads(env, node, &note_quad, 1)) {
+        war_undo_node_free(env, node);
+        ctx_wr->numeric_prefix = 0;
+        return;
+    }
+    war_note_quads_append(note_quads, &note_quad);
+    war_undo_node_join(env, node);
     ctx_wr->numeric_prefix = 0;
     return;
 }
@@ -1337,136 +1142,75 @@ static inline void war_roll_shift_x(war_env* env) {
 }
 
 static inline void war_roll_note_delete(war_env* env) {
-    // TODO: spillover swapfile
     war_window_render_context* ctx_wr = env->ctx_wr;
     war_atomics* atomics = env->atomics;
-    war_lua_context* ctx_lua = env->ctx_lua;
-    war_undo_tree* undo_tree = env->undo_tree;
     war_note_quads* note_quads = env->note_quads;
-    war_pool* pool_wr = env->pool_wr;
     call_terry_davis("war_roll_note_delete");
+    // the cursor can outrun the per frame sync, make sure its notes are in
+    war_note_swap_fault(env->note_swap,
+                        note_quads,
+                        ctx_wr->cursor_pos_x,
+                        ctx_wr->cursor_pos_x + ctx_wr->cursor_size_x);
     if (note_quads->count == 0) {
         ctx_wr->numeric_prefix = 0;
         return;
     }
     uint64_t layer = atomic_load(&atomics->layer);
     if (ctx_wr->numeric_prefix) {
-        // TODO: spillover swapfile
-        // TODO batch delete
+        // count first so the payload is sized to the notes actually deleted
+        double cursor_pos_x = ctx_wr->cursor_pos_x;
+        double cursor_pos_y = ctx_wr->cursor_pos_y;
+        double cursor_end_x = cursor_pos_x + ctx_wr->cursor_size_x;
         uint32_t delete_count = 0;
-        uint32_t undo_notes_batch_max =
-            atomic_load(&ctx_lua->WR_UNDO_NOTES_BATCH_MAX);
-        war_undo_node* node;
-        for (int32_t i = note_quads->count - 1; i >= 0; i--) {
+        int32_t first = note_quads->count - 1;
+        int32_t last = -1;
+        war_note_quad note_quad;
+        war_note_log log = {0};
+        for (int32_t i = first; i >= 0; i--) {
             if (note_quads->alive[i] == 0 || note_quads->hidden[i] ||
                 note_quads->layer[i] != layer) {
                 continue;
             }
-            double cursor_pos_x = ctx_wr->cursor_pos_x;
-            double cursor_pos_y = ctx_wr->cursor_pos_y;
-            double cursor_end_x = cursor_pos_x + ctx_wr->cursor_size_x;
             double note_pos_x = note_quads->pos_x[i];
-            double note_pos_y = note_quads->pos_y[i];
             double note_end_x = note_pos_x + note_quads->size_x[i];
-            if (cursor_pos_y != note_pos_y || cursor_pos_x >= note_end_x ||
-                cursor_end_x <= note_pos_x) {
+            if (cursor_pos_y != note_quads->pos_y[i] ||
+                cursor_pos_x >= note_end_x || cursor_end_x <= note_pos_x) {
                 continue;
             }
-            if (delete_count == 0) {
-                node = war_pool_alloc(pool_wr, sizeof(war_undo_node));
-                node->id = undo_tree->next_id++;
-                node->seq_num = undo_tree->next_seq_num++;
-                node->command = CMD_DELETE_NOTES;
-                node->payload.add_notes.note = war_pool_alloc(
-                    pool_wr, sizeof(war_note) * undo_notes_batch_max);
-                node->payload.add_notes.note_quad = war_pool_alloc(
-                    pool_wr, sizeof(war_note_quad) * undo_notes_batch_max);
-                node->cursor_pos_x = ctx_wr->cursor_pos_x;
-                node->cursor_pos_y = ctx_wr->cursor_pos_y;
-                node->left_col = ctx_wr->left_col;
-                node->right_col = ctx_wr->right_col;
-                node->top_row = ctx_wr->top_row;
-                node->bottom_row = ctx_wr->bottom_row;
-                node->parent = NULL;
-                node->next = NULL;
-                node->prev = NULL;
-                node->alt_next = NULL;
-                node->alt_prev = NULL;
-                if (!undo_tree->root) {
-                    node->branch_id = undo_tree->next_branch_id++;
-                    undo_tree->root = node;
-                    undo_tree->current = node;
-                } else if (!undo_tree->current) {
-                    node->branch_id = undo_tree->next_branch_id++;
-                    node->parent = NULL;
-                    undo_tree->root = node;
-                    undo_tree->current = node;
-                } else {
-                    war_undo_node* cur = undo_tree->current;
-                    if (cur->next) { cur->next = NULL; }
-                    node->parent = cur;
-                    node->branch_id = cur->branch_id;
-                    cur->next = node;
-                    node->prev = cur;
-                    undo_tree->current = node;
-                }
-            }
-            war_note_quad note_quad;
-            note_quad.alive = note_quads->alive[i];
-            note_quad.id = note_quads->id[i];
-            note_quad.pos_x = note_quads->pos_x[i];
-            note_quad.pos_y = note_quads->pos_y[i];
-            note_quad.layer = note_quads->layer[i];
-            note_quad.size_x = note_quads->size_x[i];
-            note_quad.navigation_x = note_quads->navigation_x[i];
-            note_quad.navigation_x_numerator =
-                note_quads->navigation_x_numerator[i];
-            note_quad.navigation_x_denominator =
-                note_quads->navigation_x_denominator[i];
-            note_quad.size_x_numerator = note_quads->size_x_numerator[i];
-            note_quad.size_x_denominator = note_quads->size_x_denominator[i];
-            note_quad.color = note_quads->color[i];
-            note_quad.outline_color = note_quads->outline_color[i];
-            note_quad.gain = note_quads->gain[i];
-            note_quad.voice = note_quads->voice[i];
-            note_quad.hidden = note_quads->hidden[i];
-            note_quad.mute = note_quads->mute[i];
-            double sample_rate = atomic_load(&ctx_lua->A_SAMPLE_RATE);
-            double bpm = atomic_load(&ctx_lua->A_BPM);
-            double frames_per_beat = sample_rate * 60.0 / bpm;
-            double columns_per_beat =
-                atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT);
-            war_note note;
-            double start_beats = note_quad.pos_x / columns_per_beat;
-            note.note_start_frames =
-                (uint64_t)(start_beats * frames_per_beat + 0.5);
-            double duration_beats = note_quad.size_x / columns_per_beat;
-            note.note_duration_frames =
-                (uint64_t)(duration_beats * frames_per_beat + 0.5);
-            note.note = note_quad.pos_y;
-            note.layer = note_quad.layer;
-            note.note_attack = atomic_load(&ctx_lua->A_DEFAULT_ATTACK);
-            note.note_sustain = atomic_load(&ctx_lua->A_DEFAULT_SUSTAIN);
-            note.note_release = atomic_load(&ctx_lua->A_DEFAULT_RELEASE);
-            note.note_gain = atomic_load(&ctx_lua->A_DEFAULT_GAIN);
-            note.note_phase_increment = 0;
-            note.id = note_quad.id;
-            note.alive = note_quad.alive;
-            node->payload.add_notes.note[delete_count] = note;
-            node->payload.add_notes.note_quad[delete_count] = note_quad;
-            note_quads->alive[i] = 0;
-            delete_count++;
-            if (delete_count >= undo_notes_batch_max) {
-                // spillover
-                ctx_wr->numeric_prefix = 0;
-                return;
-            }
-            if (delete_count >= ctx_wr->numeric_prefix) { break; }
+            last = i;
+            war_note_quads_get(note_quads, i, &note_quad);
+            war_note_log_put(&log, &note_quad, 0);
+            if (++delete_count >= ctx_wr->numeric_prefix) { break; }
         }
         if (delete_count == 0) {
             ctx_wr->numeric_prefix = 0;
             return;
         }
+        war_undo_node* node = war_undo_node_push(env, CMD_DELETE_NOTES);
+        if (!war_undo_node_log_open(env, node, &log, delete_count)) {
+            war_undo_node_free(env, node);
+            ctx_wr->numeric_prefix = 0;
+            return;
+        }
+        for (int32_t i = first; i >= last; i--) {
+            if (note_quads->alive[i] == 0 || note_quads->hidden[i] ||
+                note_quads->layer[i] != layer) {
+                continue;
+            }
+            double note_pos_x = note_quads->pos_x[i];
+            double note_end_x = note_pos_x + note_quads->size_x[i];
+            if (cursor_pos_y != note_quads->pos_y[i] ||
+                cursor_pos_x >= note_end_x || cursor_end_x <= note_pos_x) {
+                continue;
+            }
+            war_note_quads_get(note_quads, i, &note_quad);
+            war_note_log_put(&log, &note_quad, 0);
+            war_note_quads_dirty(note_quads, note_quad.pos_x);
+            note_quads->alive[i] = 0;
+        }
+        note_quads->generation++;
+        war_note_registers_store_notes(env, node);
+        war_undo_node_join(env, node);
         ctx_wr->numeric_prefix = 0;
         return;
     }
@@ -1493,178 +1237,193 @@ static inline void war_roll_note_delete(war_env* env) {
         return;
     }
     war_note_quad note_quad;
-    note_quad.alive = note_quads->alive[delete_idx];
-    note_quad.id = note_quads->id[delete_idx];
-    note_quad.pos_x = note_quads->pos_x[delete_idx];
-    note_quad.pos_y = note_quads->pos_y[delete_idx];
-    note_quad.layer = note_quads->layer[delete_idx];
-    note_quad.size_x = note_quads->size_x[delete_idx];
-    note_quad.navigation_x = note_quads->navigation_x[delete_idx];
-    note_quad.navigation_x_numerator =
-        note_quads->navigation_x_numerator[delete_idx];
-    note_quad.navigation_x_denominator =
-        note_quads->navigation_x_denominator[delete_idx];
-    note_quad.size_x_numerator = note_quads->size_x_numerator[delete_idx];
-    note_quad.size_x_denominator = note_quads->size_x_denominator[delete_idx];
-    note_quad.color = note_quads->color[delete_idx];
-    note_quad.outline_color = note_quads->outline_color[delete_idx];
-    note_quad.gain = note_quads->gain[delete_idx];
-    note_quad.voice = note_quads->voice[delete_idx];
-    note_quad.hidden = note_quads->hidden[delete_idx];
-    note_quad.mute = note_quads->mute[delete_idx];
-    double sample_rate = atomic_load(&ctx_lua->A_SAMPLE_RATE);
-    double bpm = atomic_load(&ctx_lua->A_BPM);
-    double frames_per_beat = sample_rate * 60.0 / bpm;
-    double columns_per_beat = atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT);
-    war_note note;
-    double start_beats = note_quad.pos_x / columns_per_beat;
-    note.note_start_frames = (uint64_t)(start_beats * frames_per_beat + 0.5);
-    double duration_beats = note_quad.size_x / columns_per_beat;
-    note.note_duration_frames =
-        (uint64_t)(duration_beats * frames_per_beat + 0.5);
-    note.note = note_quad.pos_y;
-    note.layer = note_quad.layer;
-    note.note_attack = atomic_load(&ctx_lua->A_DEFAULT_ATTACK);
-    note.note_sustain = atomic_load(&ctx_lua->A_DEFAULT_SUSTAIN);
-    note.note_release = atomic_load(&ctx_lua->A_DEFAULT_RELEASE);
-    note.note_gain = atomic_load(&ctx_lua->A_DEFAULT_GAIN);
-    note.note_phase_increment = 0;
-    note.id = note_quad.id;
-    note.alive = note_quad.alive;
-    note_quads->alive[delete_idx] = 0;
-    war_undo_node* node = war_pool_alloc(pool_wr, sizeof(war_undo_node));
-    node->id = undo_tree->next_id++;
-    node->seq_num = undo_tree->next_seq_num++;
-    node->command = CMD_DELETE_NOTE;
-    node->payload.add_note.note = note;
-    node->payload.add_note.note_quad = note_quad;
-    node->cursor_pos_x = ctx_wr->cursor_pos_x;
-    node->cursor_pos_y = ctx_wr->cursor_pos_y;
-    node->left_col = ctx_wr->left_col;
-    node->right_col = ctx_wr->right_col;
-    node->top_row = ctx_wr->top_row;
-    node->bottom_row = ctx_wr->bottom_row;
-    node->parent = NULL;
-    node->next = NULL;
-    node->prev = NULL;
-    node->alt_next = NULL;
-    node->alt_prev = NULL;
-    if (!undo_tree->root) {
-        node->branch_id = undo_tree->next_branch_id++;
-        undo_tree->root = node;
-        undo_tree->current = node;
-    } else if (!undo_tree->current) {
-        node->branch_id = undo_tree->next_branch_id++;
-        node->parent = NULL;
-        undo_tree->root = node;
-        undo_tree->current = node;
-    } else {
-        war_undo_node* cur = undo_tree->current;
-        if (cur->next) { cur->next = NULL; }
-        node->parent = cur;
-        node->branch_id = cur->branch_id;
-        cur->next = node;
-        node->prev = cur;
-        undo_tree->current = node;
+    war_note_quads_get(note_quads, delete_idx, &note_quad);
+    war_undo_node* node = war_undo_node_push(env, CMD_DELETE_NOTE);
+    if (!war_undo_node_log_quads(env, node, &note_quad, 1)) {
+        war_undo_node_free(env, node);
+        ctx_wr->numeric_prefix = 0;
+        return;
     }
+    war_note_quads_dirty(note_quads, note_quad.pos_x);
+    note_quads->alive[delete_idx] = 0;
+    note_quads->generation++;
+    war_note_registers_store_notes(env, node);
+    war_undo_node_join(env, node);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_delete_in_view(war_env* env) {
     call_terry_davis("war_roll_note_delete_in_view");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_DELETE, NOTE_SCOPE_IN_VIEW);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_delete_outside_view(war_env* env) {
     call_terry_davis("war_roll_note_delete_outside_view");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_DELETE, NOTE_SCOPE_OUTSIDE_VIEW);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_delete_in_word(war_env* env) {
     call_terry_davis("war_roll_note_delete_in_word");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_DELETE, NOTE_SCOPE_IN_WORD);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_delete_all(war_env* env) {
     call_terry_davis("war_roll_note_delete_all");
     war_window_render_context* ctx_wr = env->ctx_wr;
-    war_note_quads* note_quads = env->note_quads;
-    note_quads->count = 0;
+    war_note_query_scoped(env, NOTE_OP_DELETE, NOTE_SCOPE_ALL);
+    ctx_wr->numeric_prefix = 0;
+}
+
+static inline void war_roll_register(war_env* env) {
+    call_terry_davis("war_roll_register");
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    env->note_registers->pending = 1;
+    ctx_wr->numeric_prefix = 0;
+}
+
+static inline void war_roll_yank(war_env* env) {
+    call_terry_davis("war_roll_yank");
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_swap_fault(env->note_swap,
+                        env->note_quads,
+                        ctx_wr->cursor_pos_x,
+                        ctx_wr->cursor_pos_x + ctx_wr->cursor_size_x);
+    war_note_registers_yank(env, NOTE_SCOPE_CURSOR);
+    ctx_wr->numeric_prefix = 0;
+}
+
+static inline void war_roll_yank_in_view(war_env* env) {
+    call_terry_davis("war_roll_yank_in_view");
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_registers_yank(env, NOTE_SCOPE_IN_VIEW);
+    ctx_wr->numeric_prefix = 0;
+}
+
+static inline void war_roll_yank_in_word(war_env* env) {
+    call_terry_davis("war_roll_yank_in_word");
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_registers_yank(env, NOTE_SCOPE_IN_WORD);
+    ctx_wr->numeric_prefix = 0;
+}
+
+static inline void war_roll_yank_all(war_env* env) {
+    call_terry_davis("war_roll_yank_all");
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_registers_yank(env, NOTE_SCOPE_ALL);
+    ctx_wr->numeric_prefix = 0;
+}
+
+static inline void war_roll_put(war_env* env) {
+    call_terry_davis("war_roll_put");
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_registers_put(env, 0);
+    ctx_wr->numeric_prefix = 0;
+}
+
+static inline void war_roll_put_before(war_env* env) {
+    call_terry_davis("war_roll_put_before");
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_registers_put(env, 1);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_hide_outside_view(war_env* env) {
     call_terry_davis("war_roll_note_hide_outside_view");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_HIDE, NOTE_SCOPE_OUTSIDE_VIEW);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_hide_in_view(war_env* env) {
     call_terry_davis("war_roll_note_hide_in_view");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_HIDE, NOTE_SCOPE_IN_VIEW);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_hide_in_word(war_env* env) {
     call_terry_davis("war_roll_note_hide_in_word");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_HIDE, NOTE_SCOPE_IN_WORD);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_hide_all(war_env* env) {
     call_terry_davis("war_roll_note_hide_all");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_HIDE, NOTE_SCOPE_ALL);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_show_outside_view(war_env* env) {
     call_terry_davis("war_roll_note_show_outside_view");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_SHOW, NOTE_SCOPE_OUTSIDE_VIEW);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_show_in_view(war_env* env) {
     call_terry_davis("war_roll_note_show_in_view");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_SHOW, NOTE_SCOPE_IN_VIEW);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_show_in_word(war_env* env) {
     call_terry_davis("war_roll_note_show_in_word");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_SHOW, NOTE_SCOPE_IN_WORD);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_show_all(war_env* env) {
     call_terry_davis("war_roll_note_show_all");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_SHOW, NOTE_SCOPE_ALL);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_mute(war_env* env) {
     call_terry_davis("war_roll_note_mute");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    // toggle, unmute only when everything under the cursor is muted already
+    if (!war_note_query_scoped(env, NOTE_OP_MUTE, NOTE_SCOPE_CURSOR)) {
+        war_note_query_scoped(env, NOTE_OP_UNMUTE, NOTE_SCOPE_CURSOR);
+    }
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_mute_outside_view(war_env* env) {
     call_terry_davis("war_roll_note_mute_outside_view");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_MUTE, NOTE_SCOPE_OUTSIDE_VIEW);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_mute_in_view(war_env* env) {
     call_terry_davis("war_roll_note_mute_in_view");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_MUTE, NOTE_SCOPE_IN_VIEW);
+    ctx_wr->numeric_prefix = 0;
+}
+
+static inline void war_roll_note_mute_in_word(war_env* env) {
+    call_terry_davis("war_roll_note_mute_in_word");
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_MUTE, NOTE_SCOPE_IN_WORD);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_mute_all(war_env* env) {
     call_terry_davis("war_roll_note_mute_all");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_MUTE, NOTE_SCOPE_ALL);
     ctx_wr->numeric_prefix = 0;
 }
 
@@ -1684,24 +1443,28 @@ static inline void war_midi_mode(war_env* env) {
 static inline void war_roll_note_unmute_outside_view(war_env* env) {
     call_terry_davis("war_roll_note_unmute_outside_view");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_UNMUTE, NOTE_SCOPE_OUTSIDE_VIEW);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_unmute_in_view(war_env* env) {
     call_terry_davis("war_roll_note_unmute_in_view");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_UNMUTE, NOTE_SCOPE_IN_VIEW);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_unmute_in_word(war_env* env) {
     call_terry_davis("war_roll_note_unmute_in_word");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_UNMUTE, NOTE_SCOPE_IN_WORD);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_note_unmute_all(war_env* env) {
     call_terry_davis("war_roll_note_unmute_all");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_query_scoped(env, NOTE_OP_UNMUTE, NOTE_SCOPE_ALL);
     ctx_wr->numeric_prefix = 0;
 }
 
@@ -1725,6 +1488,14 @@ static inline void war_roll_views_save(war_env* env) {
 static inline void war_roll_spacedspacea(war_env* env) {
     call_terry_davis("war_roll_spacedspacea");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    // every note in every layer, hidden or not
+    war_note_query* query = env->note_query;
+    query->flags = NOTE_QUERY_ALL_LAYERS;
+    query->left_col = -DBL_MAX;
+    query->right_col = DBL_MAX;
+    query->bottom_row = -DBL_MAX;
+    query->top_row = DBL_MAX;
+    war_note_query_apply(env, query, NOTE_OP_DELETE);
     ctx_wr->numeric_prefix = 0;
 }
 
@@ -1927,6 +1698,7 @@ static inline void war_roll_play(war_env* env) {
     war_window_render_context* ctx_wr = env->ctx_wr;
     war_play_context* ctx_play = env->ctx_play;
     ctx_play->play = !ctx_play->play;
+    atomic_store(&env->atomics->play, ctx_play->play);
     ctx_wr->numeric_prefix = 0;
 }
 
@@ -2524,12 +2296,37 @@ static inline void war_roll_alt_shift_0(war_env* env) {
 static inline void war_roll_cursor_next_note(war_env* env) {
     call_terry_davis("war_roll_cursor_next_note");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    double col = ctx_wr->cursor_pos_x;
+    war_note_rows* rows = war_note_rows_prepare(
+        env, col, col + env->note_swap->lookahead_cols);
+    uint32_t count = ctx_wr->numeric_prefix ? ctx_wr->numeric_prefix : 1;
+    uint32_t n = rows->notes_count;
+    uint32_t k = war_note_rows_key_upper(
+        rows->starts, n, col, (uint32_t)ctx_wr->cursor_pos_y);
+    if (k < n) {
+        k = (n - k > count - 1) ? k + count - 1 : n - 1;
+        war_cursor_goto_col(ctx_wr, rows->starts[k].pos_x);
+        war_cursor_goto_row(env, rows->starts[k].idx);
+    }
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_cursor_next_note_end(war_env* env) {
     call_terry_davis("war_roll_cursor_next_note_end");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    double col = ctx_wr->cursor_pos_x + ctx_wr->cursor_size_x;
+    war_note_rows* rows = war_note_rows_prepare(
+        env, col, col + env->note_swap->lookahead_cols);
+    uint32_t count = ctx_wr->numeric_prefix ? ctx_wr->numeric_prefix : 1;
+    uint32_t n = rows->notes_count;
+    uint32_t k = war_note_rows_key_upper(
+        rows->ends, n, col, (uint32_t)ctx_wr->cursor_pos_y);
+    if (k < n) {
+        k = (n - k > count - 1) ? k + count - 1 : n - 1;
+        war_cursor_goto_col(ctx_wr,
+                            rows->ends[k].pos_x - ctx_wr->cursor_size_x);
+        war_cursor_goto_row(env, rows->ends[k].idx);
+    }
     ctx_wr->numeric_prefix = 0;
 }
 
@@ -2541,124 +2338,102 @@ static inline void war_roll_cursor_current_note_end(war_env* env) {
 
 static inline void war_roll_spacediv(war_env* env) {
     call_terry_davis("war_roll_spacediv");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_delete_in_view(env);
 }
 
 static inline void war_roll_spacedov(war_env* env) {
     call_terry_davis("war_roll_spacedov");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_delete_outside_view(env);
 }
 
 static inline void war_roll_spacediw(war_env* env) {
     call_terry_davis("war_roll_spacediw");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_delete_in_word(env);
 }
 
 static inline void war_roll_spaceda(war_env* env) {
     call_terry_davis("war_roll_spaceda");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    war_note_quads* note_quads = env->note_quads;
-    note_quads->count = 0;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_delete_all(env);
 }
 
 static inline void war_roll_spacehov(war_env* env) {
     call_terry_davis("war_roll_spacehov");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_hide_outside_view(env);
 }
 
 static inline void war_roll_spacehiv(war_env* env) {
     call_terry_davis("war_roll_spacehiv");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_hide_in_view(env);
 }
 
 static inline void war_roll_spacehiw(war_env* env) {
     call_terry_davis("war_roll_spacehiw");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_hide_in_word(env);
 }
 
 static inline void war_roll_spaceha(war_env* env) {
     call_terry_davis("war_roll_spaceha");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_hide_all(env);
 }
 
 static inline void war_roll_spacesov(war_env* env) {
     call_terry_davis("war_roll_spacesov");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_show_outside_view(env);
 }
 
 static inline void war_roll_spacesiv(war_env* env) {
     call_terry_davis("war_roll_spacesiv");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_show_in_view(env);
 }
 
 static inline void war_roll_spacesiw(war_env* env) {
     call_terry_davis("war_roll_spacesiw");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_show_in_word(env);
 }
 
 static inline void war_roll_spacesa(war_env* env) {
     call_terry_davis("war_roll_spacesa");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_show_all(env);
 }
 
 static inline void war_roll_spacem(war_env* env) {
     call_terry_davis("war_roll_spacem");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_mute(env);
 }
 
 static inline void war_roll_spacemov(war_env* env) {
     call_terry_davis("war_roll_spacemov");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_mute_outside_view(env);
 }
 
 static inline void war_roll_spacemiv(war_env* env) {
     call_terry_davis("war_roll_spacemiv");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_mute_in_view(env);
 }
 
 static inline void war_roll_spacema(war_env* env) {
     call_terry_davis("war_roll_spacema");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_mute_all(env);
 }
 
 static inline void war_roll_spaceumov(war_env* env) {
     call_terry_davis("war_roll_spaceumov");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_unmute_outside_view(env);
 }
 
 static inline void war_roll_spaceumiv(war_env* env) {
     call_terry_davis("war_roll_spaceumiv");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_unmute_in_view(env);
 }
 
 static inline void war_roll_spaceumiw(war_env* env) {
     call_terry_davis("war_roll_spaceumiw");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_unmute_in_word(env);
 }
 
 static inline void war_roll_spaceuma(war_env* env) {
     call_terry_davis("war_roll_spaceuma");
-    war_window_render_context* ctx_wr = env->ctx_wr;
-    ctx_wr->numeric_prefix = 0;
+    war_roll_note_unmute_all(env);
 }
 
 static inline void war_roll_alt_a(war_env* env) {
@@ -2706,36 +2481,42 @@ static inline void war_roll_alt_0(war_env* env) {
 static inline void war_roll_w(war_env* env) {
     call_terry_davis("war_roll_w");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_rows_motion(env, 0, 0, 0);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_W(war_env* env) {
     call_terry_davis("war_roll_W");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_rows_motion(env, 1, 0, 0);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_e(war_env* env) {
     call_terry_davis("war_roll_e");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_rows_motion(env, 0, 1, 0);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_E(war_env* env) {
     call_terry_davis("war_roll_E");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_rows_motion(env, 1, 1, 0);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_b(war_env* env) {
     call_terry_davis("war_roll_b");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_rows_motion(env, 0, 0, 1);
     ctx_wr->numeric_prefix = 0;
 }
 
 static inline void war_roll_B(war_env* env) {
     call_terry_davis("war_roll_B");
     war_window_render_context* ctx_wr = env->ctx_wr;
+    war_note_rows_motion(env, 1, 0, 1);
     ctx_wr->numeric_prefix = 0;
 }
 
@@ -2891,30 +2672,12 @@ static inline void war_roll_u(war_env* env) {
     war_window_render_context* ctx_wr = env->ctx_wr;
     war_undo_tree* undo_tree = env->undo_tree;
     assert(undo_tree != NULL);
-    if (undo_tree->current) {
+    uint32_t count = ctx_wr->numeric_prefix ? ctx_wr->numeric_prefix : 1;
+    for (uint32_t n = 0; n < count && undo_tree->current; n++) {
         war_undo_node* node = undo_tree->current;
-        assert(node != NULL);
-        switch (node->command) {
-        case CMD_ADD_NOTE: {
-            break;
-        }
-        case CMD_DELETE_NOTE: {
-            break;
-        }
-        case CMD_ADD_NOTES: {
-            break;
-        }
-        case CMD_DELETE_NOTES: {
-            break;
-        }
-        case CMD_ADD_NOTES_SAME: {
-            break;
-        }
-        case CMD_DELETE_NOTES_SAME: {
-            break;
-        }
-        }
-        undo_tree->current = node->prev ? node->prev : NULL;
+        war_undo_node_apply(env, node, 0);
+        war_undo_node_restore_view(env, node);
+        undo_tree->current = node->prev;
     }
     ctx_wr->numeric_prefix = 0;
 }
@@ -2924,41 +2687,35 @@ static inline void war_roll_ctrl_r(war_env* env) {
     war_window_render_context* ctx_wr = env->ctx_wr;
     war_undo_tree* undo_tree = env->undo_tree;
     assert(undo_tree != NULL);
-    war_undo_node* next_node = NULL;
-    if (!undo_tree->current) {
-        next_node = undo_tree->root;
-    } else if (undo_tree->current->next) {
-        next_node = undo_tree->current->next;
-    } else if (undo_tree->current->alt_next) {
-        next_node = undo_tree->current->alt_next;
-    }
-    if (next_node) {
-        assert(next_node != NULL);
-        switch (next_node->command) {
-        case CMD_ADD_NOTE: {
-            break;
-        }
-        case CMD_DELETE_NOTE: {
-            break;
-        }
-        case CMD_ADD_NOTES: {
-            break;
-        }
-        case CMD_DELETE_NOTES: {
-            break;
-        }
-        case CMD_ADD_NOTES_SAME: {
-            break;
-        }
-        case CMD_DELETE_NOTES_SAME: {
-            break;
-        }
-        }
+    uint32_t count = ctx_wr->numeric_prefix ? ctx_wr->numeric_prefix : 1;
+    for (uint32_t n = 0; n < count; n++) {
+        war_undo_node* next_node = undo_tree->current ?
+                                       undo_tree->current->next :
+                                       undo_tree->root;
+        if (!next_node) { break; }
+        war_undo_node_apply(env, next_node, 1);
+        war_undo_node_restore_view(env, next_node);
         undo_tree->current = next_node;
     }
     ctx_wr->numeric_prefix = 0;
 }
 
+static inline void war_roll_g_minus(war_env* env) {
+    call_terry_davis("war_roll_g_minus");
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    uint32_t count = ctx_wr->numeric_prefix ? ctx_wr->numeric_prefix : 1;
+    war_undo_step(env, -(int64_t)count);
+    ctx_wr->numeric_prefix = 0;
+}
+
+static inline void war_roll_g_plus(war_env* env) {
+    call_terry_davis("war_roll_g_plus");
+    war_window_render_context* ctx_wr = env->ctx_wr;
+    uint32_t count = ctx_wr->numeric_prefix ? ctx_wr->numeric_prefix : 1;
+    war_undo_step(env, count);
+    ctx_wr->numeric_prefix = 0;
+}
+
 //-----------------------------------------------------------------------------
 // capture mode commands
 //-----------------------------------------------------------------------------
@@ -45,12 +45,24 @@ void war_wayland_wl_surface_damage(int fd,
                                    uint32_t width,
                                    uint32_t height);
 
+void war_wayland_wl_surface_damage_buffer(int fd,
+                                          uint32_t wl_surface_id,
+                                          int32_t x,
+                                          int32_t y,
+                                          int32_t width,
+                                          int32_t height);
+
 void war_wayland_wl_surface_commit(int fd, uint32_t wl_surface_id);
 
 void war_wayland_wl_surface_frame(int fd,
                                   uint32_t wl_surface_id,
                                   uint32_t new_id);
 
+void war_wayland_wp_presentation_feedback(int fd,
+                                          uint32_t wp_presentation_id,
+                                          uint32_t wl_surface_id,
+                                          uint32_t new_id);
+
 void war_wayland_holy_trinity(int fd,
                               uint32_t wl_surface_id,
                               uint32_t wl_buffer_id,
@@ -85,6 +85,20 @@ ctx_lua = {
     WR_KEYSYM_COUNT                     = 512,
     WR_MOD_COUNT                        = 16,
     WR_NOTE_QUADS_MAX                   = 20000,
+    WR_NOTE_MAP_SLOTS                   = 65536,  -- power of 2, >= 2 * WR_NOTE_QUADS_MAX
+    WR_NOTE_SWAP_PAGE_NOTES             = 4096,
+    WR_NOTE_SWAP_PAGES_MAX              = 1024,
+    WR_NOTE_SWAP_MARGIN_COLS            = 64.0,
+    WR_NOTE_SWAP_LOOKAHEAD_COLS         = 256.0,
+    WR_NOTE_CHUNKS_MAX                  = 8192,
+    WR_NOTE_CHUNK_BEATS                 = 4.0,    -- one bar of 4/4
+    WR_NOTE_REGISTER_NOTES_MAX          = 20000,
+    WR_NOTE_BLOCKS_MAX                  = 256,
+    WR_NOTE_SNAPSHOTS_MAX               = 16,
+    WR_NOTE_SNAPSHOT_CHUNKS_MAX         = 32768,
+    WR_NOTE_SNAPSHOT_NOTES_MAX          = 262144,
+    WR_NOTE_SNAPSHOT_NODES              = 256,    -- undo nodes between snapshots
+    WR_NOTE_SNAPSHOT_IDLE_US            = 500000,
     WR_STATUS_BAR_COLS_MAX              = 400,
     WR_TEXT_QUADS_MAX                   = 20000,
     WR_QUADS_MAX                        = 20000,
@@ -98,7 +112,23 @@ ctx_lua = {
     WR_REPEAT_DELAY_US                  = 150000, -- 150000
     WR_REPEAT_RATE_US                   = 40000,  -- 40000
     WR_CURSOR_BLINK_DURATION_US         = 700000, -- 700000
-    WR_UNDO_NOTES_BATCH_MAX             = 100,    -- <= 100
+    WR_TIMING_OVERLAY                   = 0,      -- frame timings top right
+    WR_PRESENT_LEAD_US                  = 2000,   -- commit ahead of vblank
+    WR_RENDER_MARGIN_US                 = 1000,   -- on top of the slowest frame
+    WR_UNDO_PAYLOAD_BYTES               = 67108864, -- 64 MiB, multiple of 64
+    WR_UNDO_CHECKPOINT_NODES            = 64,
+    WR_UNDO_JUMP_NOTES_MAX              = 65536,    -- power of 2
+    WR_UNDO_JOIN_US                     = 200000,   -- above WR_REPEAT_DELAY_US, 0 never joins
+    WR_UNDOFILE_QUEUE_BYTES             = 4194304,  -- 4 MiB
+    WR_UNDOFILE_FLUSH_US                = 200000,
+    WR_PROJECT_PAGES_MAX                = 2048,     -- swap pages plus resident notes
+    WR_PROJECT_AUTOSAVE_US              = 3000000,
+    WR_PROJECT_COMPACT_BYTES            = 8388608,  -- 8 MiB of log
+    WR_PROJECT_QUEUE_BYTES              = 4194304,  -- 4 MiB, multiple of 8
+    WR_NOTE_TEXT_BUFFER_BYTES           = 1048576,  -- longest line that reads
+    WR_NOTE_TEXT_BATCH                  = 4096,
+    WR_NOTE_TEXT_KEYS_MAX               = 262144,
+    WR_NOTE_TEXT_UNDO_NOTES_MAX         = 65536,
     WR_FPS                              = 240.0,
     WR_PLAY_CALLBACK_FPS                = 173.0,
     WR_CAPTURE_CALLBACK_FPS             = 47.0,
@@ -222,13 +252,11 @@ pool_wr = {
     { name = "ctx_fsm.ext",                         type = "char",                count = ctx_lua.A_PATH_LIMIT },
     { name = "ctx_fsm.key_down",                    type = "uint8_t",             count = ctx_lua.WR_KEYSYM_COUNT * ctx_lua.WR_MOD_COUNT },
     { name = "ctx_fsm.key_last_event_us",           type = "uint64_t",            count = ctx_lua.WR_KEYSYM_COUNT * ctx_lua.WR_MOD_COUNT },
-    -- quads vertices
-    { name = "quad_vertices",                       type = "war_quad_vertex",     count = ctx_lua.WR_QUADS_MAX },
-    { name = "quad_indices",                        type = "uint16_t",            count = ctx_lua.WR_QUADS_MAX },
-    { name = "transparent_quad_vertices",           type = "war_quad_vertex",     count = ctx_lua.WR_QUADS_MAX },
-    { name = "transparent_quad_indices",            type = "uint16_t",            count = ctx_lua.WR_QUADS_MAX },
-    { name = "text_vertices",                       type = "war_text_vertex",     count = ctx_lua.WR_TEXT_QUADS_MAX },
-    { name = "text_indices",                        type = "uint16_t",            count = ctx_lua.WR_TEXT_QUADS_MAX },
+    -- quad instances
+    { name = "quad_instances",                      type = "war_quad_instance",   count = ctx_lua.WR_QUADS_MAX },
+    { name = "transparent_quad_instances",          type = "war_quad_instance",   count = ctx_lua.WR_QUADS_MAX },
+    { name = "text_vertices",                       type = "war_text_vertex",     count = ctx_lua.WR_TEXT_QUADS_MAX * 4 },
+    { name = "text_indices",                        type = "uint32_t",            count = ctx_lua.WR_TEXT_QUADS_MAX * 6 },
     -- note quads
     { name = "note_quads.alive",                    type = "uint8_t",             count = ctx_lua.WR_NOTE_QUADS_MAX },
     { name = "note_quads.id",                       type = "uint64_t",            count = ctx_lua.WR_NOTE_QUADS_MAX },
@@ -247,6 +275,78 @@ pool_wr = {
     { name = "note_quads.voice",                    type = "uint32_t",            count = ctx_lua.WR_NOTE_QUADS_MAX },
     { name = "note_quads.hidden",                   type = "uint32_t",            count = ctx_lua.WR_NOTE_QUADS_MAX },
     { name = "note_quads.mute",                     type = "uint32_t",            count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_quads.map",                      type = "uint32_t",            count = ctx_lua.WR_NOTE_MAP_SLOTS },
+    { name = "note_quads.dirty",                    type = "uint64_t",            count = 1024 }, -- WAR_PROJECT_CHUNKS_MAX / 64
+    -- note swap
+    { name = "note_swap",                           type = "war_note_swap",       count = 1 },
+    { name = "note_swap.page_count",                type = "uint32_t",            count = ctx_lua.WR_NOTE_SWAP_PAGES_MAX },
+    { name = "note_swap.page_min_col",              type = "double",              count = ctx_lua.WR_NOTE_SWAP_PAGES_MAX },
+    { name = "note_swap.page_max_col",              type = "double",              count = ctx_lua.WR_NOTE_SWAP_PAGES_MAX },
+    { name = "note_swap.page_checksum",             type = "uint64_t",            count = ctx_lua.WR_NOTE_SWAP_PAGES_MAX },
+    { name = "note_swap.keys",                      type = "war_note_key",        count = ctx_lua.WR_NOTE_QUADS_MAX },
+    -- note chunks
+    { name = "note_chunks",                         type = "war_note_chunks",     count = 1 },
+    { name = "note_chunks.offset",                  type = "uint32_t",            count = ctx_lua.WR_NOTE_CHUNKS_MAX + 1 },
+    { name = "note_chunks.fill",                    type = "uint32_t",            count = ctx_lua.WR_NOTE_CHUNKS_MAX },
+    { name = "note_chunks.min_row",                 type = "uint32_t",            count = ctx_lua.WR_NOTE_CHUNKS_MAX },
+    { name = "note_chunks.max_row",                 type = "uint32_t",            count = ctx_lua.WR_NOTE_CHUNKS_MAX },
+    { name = "note_chunks.hash",                    type = "uint64_t",            count = ctx_lua.WR_NOTE_CHUNKS_MAX },
+    { name = "note_chunks.generation",              type = "uint64_t",            count = ctx_lua.WR_NOTE_CHUNKS_MAX },
+    { name = "note_chunks.idx",                     type = "uint32_t",            count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_chunks.pos_x",                   type = "double",              count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_chunks.end_x",                   type = "double",              count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_chunks.pos_y",                   type = "double",              count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_chunks.keys",                    type = "war_note_key",        count = ctx_lua.WR_NOTE_QUADS_MAX },
+    -- note instances
+    { name = "note_instances",                      type = "war_note_instances",  count = 1 },
+    { name = "note_instances.shadow",               type = "war_quad_instance",   count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_instances.copies",               type = "VkBufferCopy",        count = ctx_lua.WR_NOTE_QUADS_MAX },
+    -- note query
+    { name = "note_query",                          type = "war_note_query",      count = 1 },
+    { name = "note_query.hits",                     type = "uint32_t",            count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_query.keys",                     type = "war_note_key",        count = ctx_lua.WR_NOTE_QUADS_MAX },
+    -- note rows
+    { name = "note_rows",                           type = "war_note_rows",       count = 1 },
+    { name = "note_rows.offset",                    type = "uint32_t",            count = ctx_lua.A_NOTE_COUNT + 1 },
+    { name = "note_rows.fill",                      type = "uint32_t",            count = ctx_lua.A_NOTE_COUNT },
+    { name = "note_rows.start_x",                   type = "double",              count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_rows.end_x",                     type = "double",              count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_rows.word_offset",               type = "uint32_t",            count = ctx_lua.A_NOTE_COUNT + 1 },
+    { name = "note_rows.word_start_x",              type = "double",              count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_rows.word_end_x",                type = "double",              count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_rows.starts",                    type = "war_note_key",        count = ctx_lua.WR_NOTE_QUADS_MAX },
+    { name = "note_rows.ends",                      type = "war_note_key",        count = ctx_lua.WR_NOTE_QUADS_MAX },
+    -- note registers
+    { name = "note_registers",                      type = "war_note_registers",  count = 1 },
+    { name = "note_registers.blocks",               type = "war_note_block",      count = ctx_lua.WR_NOTE_BLOCKS_MAX },
+    { name = "note_registers.slot",                 type = "uint32_t",            count = 37 }, -- NOTE_REGISTER_COUNT
+    -- note registers arena
+    { name = "note_quads",                          type = "war_note_quads",      count = 1 },
+    { name = "note_quads.alive",                    type = "uint8_t",             count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.id",                       type = "uint64_t",            count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.pos_x",                    type = "double",              count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.pos_y",                    type = "double",              count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.layer",                    type = "uint64_t",            count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.size_x",                   type = "double",              count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.navigation_x",             type = "double",              count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.navigation_x_numerator",   type = "uint32_t",            count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.navigation_x_denominator", type = "uint32_t",            count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.size_x_numerator",         type = "uint32_t",            count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.size_x_denominator",       type = "uint32_t",            count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.color",                    type = "uint32_t",            count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.outline_color",            type = "uint32_t",            count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.gain",                     type = "float",               count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.voice",                    type = "uint32_t",            count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.hidden",                   type = "uint32_t",            count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    { name = "note_quads.mute",                     type = "uint32_t",            count = ctx_lua.WR_NOTE_REGISTER_NOTES_MAX },
+    -- note snapshots
+    { name = "note_snapshots",                      type = "war_note_snapshots",  count = 1 },
+    { name = "note_snapshots.records",              type = "war_note_swap_record", count = ctx_lua.WR_NOTE_SNAPSHOT_NOTES_MAX },
+    { name = "note_snapshots.chunks",               type = "war_note_snapshot_chunk", count = ctx_lua.WR_NOTE_SNAPSHOT_CHUNKS_MAX },
+    { name = "note_snapshots.free",                 type = "uint32_t",            count = ctx_lua.WR_NOTE_SNAPSHOT_CHUNKS_MAX },
+    { name = "note_snapshots.keys",                 type = "war_note_key",        count = ctx_lua.WR_NOTE_SNAPSHOT_CHUNKS_MAX },
+    { name = "note_snapshots.snapshots",            type = "war_note_snapshot",   count = ctx_lua.WR_NOTE_SNAPSHOTS_MAX },
+    { name = "note_snapshots.snapshots.chunks",     type = "uint32_t",            count = ctx_lua.WR_NOTE_SNAPSHOTS_MAX * (ctx_lua.WR_NOTE_CHUNKS_MAX + ctx_lua.WR_NOTE_SWAP_PAGES_MAX) },
     -- keydown, keylasteventus, msgbuffer, pc_window_render, payload, input sequence
     { name = "key_down",                            type = "bool",                count = ctx_lua.WR_KEYSYM_COUNT * ctx_lua.WR_MOD_COUNT },
     { name = "key_last_event_us",                   type = "uint64_t",            count = ctx_lua.WR_KEYSYM_COUNT * ctx_lua.WR_MOD_COUNT },
@@ -260,41 +360,34 @@ pool_wr = {
     -- { name = "cwd",                                 type = "char",              count = ctx_lua.A_PATH_LIMIT },
     -- undo tree
     { name = "undo_tree",                           type = "war_undo_tree",       count = 1 },
-    { name = "undo_node.id",                        type = "uint64_t",            count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.seq_num",                   type = "uint64_t",            count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.branch_id",                 type = "uint32_t",            count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.command",                   type = "uint32_t",            count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.payload",                   type = "war_payload_union",   count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.cursor_pos_x",              type = "double",              count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.cursor_pos_y",              type = "double",              count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.left_col",                  type = "uint32_t",            count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.right_col",                 type = "uint32_t",            count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.top_row",                   type = "uint32_t",            count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.bottom_row",                type = "uint32_t",            count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.timestamp",                 type = "char",                count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.parent",                    type = "war_undo_node*",      count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.next",                      type = "war_undo_node*",      count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.prev",                      type = "war_undo_node*",      count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.alt_next",                  type = "war_undo_node*",      count = ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "undo_node.alt_prev",                  type = "war_undo_node*",      count = ctx_lua.WR_UNDO_NODES_MAX },
-    -- undo nodes batch payload
-    { name = "note_quads",                          type = "war_note_quads",      count = 1 },
-    { name = "note_quads.alive",                    type = "uint8_t",             count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.id",                       type = "uint64_t",            count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.pos_x",                    type = "double",              count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.pos_y",                    type = "double",              count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.size_x",                   type = "double",              count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.navigation_x",             type = "double",              count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.navigation_x_numerator",   type = "uint32_t",            count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.navigation_x_denominator", type = "uint32_t",            count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.size_x_numerator",         type = "uint32_t",            count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.size_x_denominator",       type = "uint32_t",            count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.color",                    type = "uint32_t",            count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.outline_color",            type = "uint32_t",            count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.gain",                     type = "float",               count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.voice",                    type = "uint32_t",            count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.hidden",                   type = "uint32_t",            count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
-    { name = "note_quads.mute",                     type = "uint32_t",            count = ctx_lua.WR_UNDO_NOTES_BATCH_MAX * ctx_lua.WR_UNDO_NODES_MAX },
+    { name = "undo_tree.nodes",                     type = "war_undo_node",       count = ctx_lua.WR_UNDO_NODES_MAX },
+    { name = "undo_tree.payload",                   type = "uint8_t",             count = ctx_lua.WR_UNDO_PAYLOAD_BYTES },
+    { name = "undo_tree.seq_index",                 type = "war_undo_node*",      count = ctx_lua.WR_UNDO_NODES_MAX },
+    { name = "undo_tree.seek_path",                 type = "war_undo_node*",      count = ctx_lua.WR_UNDO_NODES_MAX },
+    { name = "undo_tree.jump_notes",                type = "war_undo_jump_note",  count = ctx_lua.WR_UNDO_JUMP_NOTES_MAX },
+    { name = "undo_tree.jump_map",                  type = "uint32_t",            count = ctx_lua.WR_UNDO_JUMP_NOTES_MAX * 2 },
+    { name = "undofile",                            type = "war_undofile",        count = 1 },
+    { name = "undofile.path",                       type = "char",                count = ctx_lua.A_PATH_LIMIT },
+    { name = "undofile.queue",                      type = "uint8_t",             count = ctx_lua.WR_UNDOFILE_QUEUE_BYTES },
+    -- project
+    { name = "project",                             type = "war_project",         count = 1 },
+    { name = "project.tmp_path",                    type = "char",                count = ctx_lua.A_PATH_LIMIT },
+    { name = "project.page_count",                  type = "uint32_t",            count = ctx_lua.WR_PROJECT_PAGES_MAX },
+    { name = "project.page_min_col",                type = "double",              count = ctx_lua.WR_PROJECT_PAGES_MAX },
+    { name = "project.page_max_col",                type = "double",              count = ctx_lua.WR_PROJECT_PAGES_MAX },
+    { name = "project.page_checksum",               type = "uint64_t",            count = ctx_lua.WR_PROJECT_PAGES_MAX },
+    { name = "project.page",                        type = "war_note_swap_record", count = ctx_lua.WR_NOTE_SWAP_PAGE_NOTES },
+    { name = "project.seen",                        type = "uint64_t",            count = 1024 }, -- WAR_PROJECT_CHUNKS_MAX / 64
+    { name = "autosave",                            type = "war_autosave",        count = 1 },
+    { name = "autosave.path",                       type = "char",                count = ctx_lua.A_PATH_LIMIT },
+    { name = "autosave.queue",                      type = "uint8_t",             count = ctx_lua.WR_PROJECT_QUEUE_BYTES },
+    { name = "autosave.seen",                       type = "uint64_t",            count = 1024 }, -- WAR_PROJECT_CHUNKS_MAX / 64
+    { name = "autosave.chunk_at",                   type = "uint32_t",            count = 65536 }, -- WAR_PROJECT_CHUNKS_MAX
+    { name = "note_text",                           type = "war_note_text",       count = 1 },
+    { name = "note_text.buffer",                    type = "char",                count = ctx_lua.WR_NOTE_TEXT_BUFFER_BYTES },
+    { name = "note_text.batch",                     type = "war_note_quad",       count = ctx_lua.WR_NOTE_TEXT_BATCH },
+    { name = "note_text.keys",                      type = "war_note_text_key",   count = ctx_lua.WR_NOTE_TEXT_KEYS_MAX },
+    { name = "note_text.chunk_count",               type = "uint32_t",            count = 65536 }, -- WAR_PROJECT_CHUNKS_MAX
 }
 
 keymap_flags = {
@@ -2136,6 +2229,18 @@ keymap = {
             },
         },
     },
+    {
+        sequences = {
+            "<leader>miw",
+        },
+        commands = {
+            {
+                cmd = "war_roll_note_mute_in_word",
+                mode = war.modes.roll,
+                type = war.function_types.c,
+            },
+        },
+    },
     {
         sequences = {
             "<leader>umiw",
@@ -2376,6 +2481,11 @@ keymap = {
             "p",
         },
         commands = {
+            {
+                cmd = "war_roll_put",
+                mode = war.modes.roll,
+                type = war.function_types.c,
+            },
             {
                 cmd = "war_capture_p",
                 mode = war.modes.capture,
@@ -2389,6 +2499,78 @@ keymap = {
             },
         },
     },
+    {
+        sequences = {
+            "P",
+        },
+        commands = {
+            {
+                cmd = "war_roll_put_before",
+                mode = war.modes.roll,
+                type = war.function_types.c,
+            },
+        },
+    },
+    {
+        sequences = {
+            "\"",
+        },
+        commands = {
+            {
+                cmd = "war_roll_register",
+                mode = war.modes.roll,
+                type = war.function_types.c,
+            },
+        },
+    },
+    {
+        sequences = {
+            "yy",
+        },
+        commands = {
+            {
+                cmd = "war_roll_yank",
+                mode = war.modes.roll,
+                type = war.function_types.c,
+            },
+        },
+    },
+    {
+        sequences = {
+            "<leader>yiv",
+        },
+        commands = {
+            {
+                cmd = "war_roll_yank_in_view",
+                mode = war.modes.roll,
+                type = war.function_types.c,
+            },
+        },
+    },
+    {
+        sequences = {
+            "<leader>yiw",
+        },
+        commands = {
+            {
+                cmd = "war_roll_yank_in_word",
+                mode = war.modes.roll,
+                type = war.function_types.c,
+            },
+        },
+    },
+    {
+        sequences = {
+            "<leader>ya",
+        },
+        commands = {
+            {
+                cmd = "war_roll_yank_all",
+                mode = war.modes.roll,
+                type = war.function_types.c,
+            },
+        },
+    },
     {
         sequences = {
             "[",
@@ -2466,6 +2648,30 @@ keymap = {
             },
         },
     },
+    {
+        sequences = {
+            "g-",
+        },
+        commands = {
+            {
+                cmd = "war_roll_g_minus",
+                mode = war.modes.roll,
+                type = war.function_types.c,
+            },
+        },
+    },
+    {
+        sequences = {
+            "g+",
+        },
+        commands = {
+            {
+                cmd = "war_roll_g_plus",
+                mode = war.modes.roll,
+                type = war.function_types.c,
+            },
+        },
+    },
     {
         sequences = {
             "<Space>",
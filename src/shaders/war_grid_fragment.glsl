@@ -0,0 +1,161 @@
+//-----------------------------------------------------------------------------
+//
+// WAR - make music with vim motions
+// Copyright (C) 2025 Nick Monaco
+// 
+// This file is part of WAR 1.0 software.
+// WAR 1.0 software is licensed under the GNU Affero General Public License
+// version 3, with the following modification: attribution to the original
+// author is waived.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// 
+// For the full license text, see LICENSE-AGPL and LICENSE-CC-BY-SA and LICENSE.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// src/shaders/war_grid_fragment.glsl
+//-----------------------------------------------------------------------------
+
+#version 450
+
+layout(location = 0) out vec4 out_color;
+
+layout(push_constant) uniform PushConstants {
+    layout(offset = 0) vec2 bottom_left;
+    layout(offset = 8) vec2 physical_size;
+    layout(offset = 16) vec2 cell_size;
+    layout(offset = 24) float zoom;
+    layout(offset = 28) uint hud_state;
+    layout(offset = 32) vec2 cell_offsets;
+    layout(offset = 40) vec2 top_right;
+    layout(offset = 48) vec2 viewport;
+    layout(offset = 56) float horizontal_thickness;
+    layout(offset = 60) float vertical_thickness;
+    layout(offset = 64) float gutter_thickness;
+    layout(offset = 68) float max_row;
+    layout(offset = 72) vec2 depth; // gridlines, hud
+    layout(offset = 80) uvec2 splits;
+    layout(offset = 88) float gutter_inset;
+    layout(offset = 96) uint colors[8];
+} pc;
+
+// palette slots, the first four double as the colors of gridline_splits
+const uint GRID_WHITE = 0u;
+const uint GRID_DARKER_LIGHT_GRAY = 1u;
+const uint GRID_RED = 2u;
+const uint GRID_BLACK = 3u;
+const uint GRID_DARK_GRAY = 4u;
+const uint GRID_FULL_WHITE = 5u;
+const uint GRID_SUPER_LIGHT_GRAY = 6u;
+
+const uint HUD_PIANO = 0u;
+const uint HUD_LINE_NUMBERS = 1u;
+
+const float STATUS_BARS = 3.0;
+
+bool inside(vec2 p, vec2 lo, vec2 hi) {
+    return all(greaterThanEqual(p, lo)) && all(lessThanEqual(p, hi));
+}
+
+// the same rows and columns war_quad_vertex.glsl used to get one line quad
+// each for, drawn back to front so whatever would have been drawn last wins
+void main() {
+    vec2 cells = pc.cell_size * pc.zoom;
+    vec2 pos = pc.bottom_left +
+               vec2(gl_FragCoord.x, pc.physical_size.y - gl_FragCoord.y) /
+                   cells;
+    vec2 grid = pos - pc.cell_offsets;
+    float left = pc.bottom_left.x;
+    float bottom = pc.bottom_left.y;
+    float top = pc.top_right.y;
+    float status_rows = pc.cell_offsets.y;
+    float span_y = pc.viewport.y;
+    if (top == pc.max_row) { span_y -= status_rows; }
+    uint color = 0xFFFFFFFFu;
+    float depth = 0.0;
+    // horizontal gridlines
+    float row = floor(grid.y + 0.5);
+    if (abs(grid.y - row) <= pc.horizontal_thickness / pc.zoom &&
+        row >= bottom + 1.0 && row <= top + 1.0 &&
+        grid.x >= left && grid.x <= left + pc.viewport.x) {
+        color = GRID_DARKER_LIGHT_GRAY;
+        depth = pc.depth.x;
+    }
+    // vertical gridlines, the largest split dividing the column picks color
+    float col = floor(grid.x + 0.5);
+    if (abs(grid.x - col) <= pc.vertical_thickness / pc.zoom &&
+        col >= left + 1.0 && col <= pc.top_right.x + 1.0 &&
+        grid.y >= bottom && grid.y <= bottom + span_y) {
+        for (uint i = 0u; i < 4u; i++) {
+            uint split = (pc.splits[i >> 1] >> ((i & 1u) * 16u)) & 0xFFFFu;
+            if (split != 0u && uint(col) % split == 0u) {
+                color = i;
+                depth = pc.depth.x;
+                break;
+            }
+        }
+    }
+    // status bars
+    float bar = floor(pos.y - bottom);
+    if (bar >= 0.0 && bar < STATUS_BARS && pos.x >= left &&
+        pos.x <= left + pc.viewport.x + 1.0) {
+        color = bar == 0.0   ? GRID_RED
+                : bar == 1.0 ? GRID_DARK_GRAY
+                             : GRID_DARKER_LIGHT_GRAY;
+        depth = pc.depth.y;
+    }
+    float gutter_bottom = bottom + status_rows;
+    float gutter_width = 3.0 - pc.gutter_inset;
+    float gutter_line = floor(pos.y - status_rows - 0.5);
+    bool on_gutter_line =
+        abs(pos.y - (gutter_line + status_rows + 1.0)) <=
+            pc.gutter_thickness / pc.zoom &&
+        gutter_line >= bottom && gutter_line <= top &&
+        gutter_line < pc.max_row;
+    // piano
+    if (pc.hud_state != HUD_LINE_NUMBERS) {
+        if (inside(pos,
+                   vec2(left, gutter_bottom),
+                   vec2(left + gutter_width, gutter_bottom + span_y))) {
+            color = GRID_FULL_WHITE;
+            depth = pc.depth.y;
+        }
+        if (on_gutter_line && pos.x >= left && pos.x <= left + gutter_width) {
+            color = GRID_SUPER_LIGHT_GRAY;
+            depth = pc.depth.y;
+        }
+        float key = floor(pos.y - status_rows);
+        uint note = uint(max(key, 0.0)) % 12u;
+        if (key >= bottom && key <= top && pos.x >= left &&
+            pos.x <= left + 2.0 - pc.gutter_inset &&
+            (note == 1u || note == 3u || note == 6u || note == 8u ||
+             note == 10u)) {
+            color = GRID_BLACK;
+            depth = pc.depth.y;
+        }
+    }
+    // line numbers, right of the piano when both are shown
+    if (pc.hud_state != HUD_PIANO) {
+        float ln_left = left + (pc.hud_state == HUD_LINE_NUMBERS ? 0.0 : 3.0);
+        float ln_background = ln_left - pc.vertical_thickness;
+        if (inside(pos,
+                   vec2(ln_background, gutter_bottom),
+                   vec2(ln_background + gutter_width,
+                        gutter_bottom + span_y))) {
+            color = GRID_RED;
+            depth = pc.depth.y;
+        }
+        if (on_gutter_line && pos.x >= ln_left &&
+            pos.x <= ln_left + gutter_width) {
+            color = GRID_FULL_WHITE;
+            depth = pc.depth.y;
+        }
+    }
+    if (color == 0xFFFFFFFFu) { discard; }
+    out_color = unpackUnorm4x8(pc.colors[color]);
+    gl_FragDepth = depth;
+}
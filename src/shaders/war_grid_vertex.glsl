@@ -0,0 +1,30 @@
+//-----------------------------------------------------------------------------
+//
+// WAR - make music with vim motions
+// Copyright (C) 2025 Nick Monaco
+// 
+// This file is part of WAR 1.0 software.
+// WAR 1.0 software is licensed under the GNU Affero General Public License
+// version 3, with the following modification: attribution to the original
+// author is waived.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// 
+// For the full license text, see LICENSE-AGPL and LICENSE-CC-BY-SA and LICENSE.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// src/shaders/war_grid_vertex.glsl
+//-----------------------------------------------------------------------------
+
+#version 450
+
+// one triangle that covers the whole framebuffer, war_grid_fragment.glsl
+// decides per pixel what is there
+void main() {
+    vec2 uv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
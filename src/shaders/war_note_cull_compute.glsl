@@ -0,0 +1,76 @@
+//-----------------------------------------------------------------------------
+//
+// WAR - make music with vim motions
+// Copyright (C) 2025 Nick Monaco
+// 
+// This file is part of WAR 1.0 software.
+// WAR 1.0 software is licensed under the GNU Affero General Public License
+// version 3, with the following modification: attribution to the original
+// author is waived.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// 
+// For the full license text, see LICENSE-AGPL and LICENSE-CC-BY-SA and LICENSE.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// src/shaders/war_note_cull_compute.glsl
+//-----------------------------------------------------------------------------
+
+#version 450
+
+layout(local_size_x = 64) in;
+
+// war_quad_instance, line_thickness is two halves and the last word is the
+// outline thickness half, the depth byte and the flags byte
+struct Instance {
+    vec2 pos;
+    vec2 span;
+    uint color;
+    uint outline_color;
+    uint line_thickness;
+    uint outline_thickness_depth_flags;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Notes {
+    Instance notes[];
+};
+
+layout(std430, set = 0, binding = 1) writeonly buffer Visible {
+    Instance visible[];
+};
+
+// VkDrawIndirectCommand, the cpu resets instance_count before the dispatch
+layout(std430, set = 0, binding = 2) buffer Draw {
+    uint vertex_count;
+    uint instance_count;
+    uint first_vertex;
+    uint first_instance;
+} draw;
+
+layout(push_constant) uniform PushConstants {
+    layout(offset = 0) vec2 bottom_left;
+    layout(offset = 8) vec2 top_right;
+    layout(offset = 16) uint count;
+} pc;
+
+// keeps the notes war_quad_vertex.glsl would not collapse, survivors land in
+// whatever order the atomic hands out slots
+void main() {
+    const uint QUAD_HIDDEN = 1u << 3;
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= pc.count) { return; }
+    Instance note = notes[i];
+    uint flags = note.outline_thickness_depth_flags >> 24;
+    if ((flags & QUAD_HIDDEN) != 0u ||
+        note.pos.x > pc.top_right.x + 1.0 ||
+        note.pos.x + note.span.x < pc.bottom_left.x ||
+        note.pos.y > pc.top_right.y + 1.0 ||
+        note.pos.y + note.span.y < pc.bottom_left.y) {
+        return;
+    }
+    visible[atomicAdd(draw.instance_count, 1u)] = note;
+}
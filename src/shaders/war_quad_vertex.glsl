@@ -22,14 +22,14 @@
 
 #version 450
 
-layout (location = 0) in vec2 in_corner;
-layout (location = 1) in vec3 in_pos;
+layout (location = 0) in vec2 in_pos;
+layout (location = 1) in vec2 in_span;
 layout (location = 2) in vec4 in_color;
-layout (location = 3) in float in_outline_thickness;
-layout (location = 4) in vec4 in_outline_color;
-layout (location = 5) in vec2 in_line_thickness;
-layout (location = 6) in uint in_flags;
-layout (location = 7) in vec2 in_span;
+layout (location = 3) in vec4 in_outline_color;
+layout (location = 4) in vec2 in_line_thickness;
+layout (location = 5) in float in_outline_thickness;
+layout (location = 6) in float in_depth;
+layout (location = 7) in uint in_flags;
 
 layout(location = 0) out vec4 frag_color;
 layout(location = 1) out float frag_outline_thickness;
@@ -42,31 +42,52 @@ layout(push_constant) uniform PushConstants {
     layout(offset = 8) vec2 physical_size;
     layout(offset = 16) vec2 cell_size;
     layout(offset = 24) float zoom;
+    layout(offset = 28) float mute_alpha;
     layout(offset = 32) vec2 cell_offsets;
     layout(offset = 40) vec2 scroll_margin; 
     layout(offset = 48) vec2 anchor_cell;
     layout(offset = 56) vec2 top_right;
 } pc;
 
+// two triangles, bottom left, bottom right, top right, top right, top left,
+// bottom left
+const vec2 corners[6] = vec2[](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+    vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0)
+);
+
 void main() {
     const uint QUAD_LINE = 1u << 0;
     const uint QUAD_OUTLINE = 1u << 1;
     const uint QUAD_GRID = 1u << 2;
+    const uint QUAD_HIDDEN = 1u << 3;
+    const uint QUAD_MUTE = 1u << 4;
     bool quad_grid = (in_flags & QUAD_GRID) != 0u;
     bool quad_line = (in_flags & QUAD_LINE) != 0u;
 
-    vec2 corner_sign = vec2(
-         (in_corner.x == 0u ? -1.0 : 1.0), // left -> -1, right -> +1
-         (in_corner.y == 0u ? -1.0 : 1.0) // bottom -> -1, top -> +1
-    );
+    // grid quads outside the visible cells collapse to a point off screen
+    bool culled = (in_flags & QUAD_HIDDEN) != 0u ||
+        (quad_grid && (in_pos.x > pc.top_right.x + 1.0 ||
+                       in_pos.x + in_span.x < pc.bottom_left.x ||
+                       in_pos.y > pc.top_right.y + 1.0 ||
+                       in_pos.y + in_span.y < pc.bottom_left.y));
+    if (culled) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    vec2 corner = corners[gl_VertexIndex];
+    vec2 corner_sign = corner * 2.0 - 1.0; // left/bottom -> -1, right/top -> +1
+    vec2 pos = in_pos + corner * in_span;
     vec2 offsets = quad_grid ? pc.cell_offsets : vec2(0.0);
     offsets += (quad_line ? vec2(corner_sign * in_line_thickness * (1.0 / pc.zoom)) : vec2(0.0));
-    vec2 ndc = vec2((in_pos.x + offsets.x - pc.bottom_left.x) * pc.cell_size.x * pc.zoom / pc.physical_size.x * 2.0 - 1.0, 
-            1.0 - (in_pos.y + offsets.y - pc.bottom_left.y) * pc.cell_size.y * pc.zoom / pc.physical_size.y * 2.0);
-    gl_Position = vec4(ndc, in_pos.z, 1.0);
-    frag_color = in_color;
+    vec2 ndc = vec2((pos.x + offsets.x - pc.bottom_left.x) * pc.cell_size.x * pc.zoom / pc.physical_size.x * 2.0 - 1.0, 
+            1.0 - (pos.y + offsets.y - pc.bottom_left.y) * pc.cell_size.y * pc.zoom / pc.physical_size.y * 2.0);
+    gl_Position = vec4(ndc, in_depth, 1.0);
+    float alpha = (in_flags & QUAD_MUTE) != 0u ? pc.mute_alpha : 1.0;
+    frag_color = vec4(in_color.rgb, in_color.a * alpha);
     frag_outline_thickness = in_outline_thickness * pc.cell_size.x;
-    frag_outline_color = in_outline_color;
-    frag_uv = in_corner;
+    frag_outline_color = vec4(in_outline_color.rgb, in_outline_color.a * alpha);
+    frag_uv = corner;
     frag_span = in_span * pc.cell_size * pc.zoom;
 }
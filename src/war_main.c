@@ -237,7 +237,9 @@ void* war_window_render(void* args) {
     war_vulkan_context ctx_vk_stack =
         war_vulkan_init(ctx_lua, physical_width, physical_height);
     war_vulkan_context* ctx_vk = &ctx_vk_stack;
-    assert(ctx_vk->dmabuf_fd >= 0);
+    for (uint32_t f = 0; f < max_frames; f++) {
+        assert(ctx_vk->dmabuf_fds[f] >= 0);
+    }
     //-------------------------------------------------------------------------
     // COLOR CONTEXT
     //-------------------------------------------------------------------------
@@ -329,6 +331,119 @@ void* war_window_render(void* args) {
     undo_tree->next_id = 1;
     undo_tree->next_seq_num = 1;
     undo_tree->next_branch_id = 1;
+    undo_tree->nodes_max = atomic_load(&ctx_lua->WR_UNDO_NODES_MAX);
+    undo_tree->nodes = war_pool_alloc(
+        pool_wr, sizeof(war_undo_node) * undo_tree->nodes_max);
+    undo_tree->nodes_used = 0;
+    undo_tree->free = NULL;
+    for (uint32_t i = undo_tree->nodes_max; i-- > 0;) {
+        undo_tree->nodes[i].older = NULL;
+        undo_tree->nodes[i].newer = undo_tree->free;
+        undo_tree->free = &undo_tree->nodes[i];
+    }
+    undo_tree->oldest = NULL;
+    undo_tree->newest = NULL;
+    undo_tree->payload_size = atomic_load(&ctx_lua->WR_UNDO_PAYLOAD_BYTES);
+    assert(undo_tree->nodes_max >= 2 && undo_tree->payload_size % 64 == 0);
+    undo_tree->payload = war_pool_alloc(pool_wr, undo_tree->payload_size);
+    undo_tree->payload_head = 0;
+    undo_tree->payload_tail = 0;
+    undo_tree->seq_index = war_pool_alloc(
+        pool_wr, sizeof(war_undo_node*) * undo_tree->nodes_max);
+    undo_tree->seek_path = war_pool_alloc(
+        pool_wr, sizeof(war_undo_node*) * undo_tree->nodes_max);
+    for (uint32_t i = 0; i < undo_tree->nodes_max; i++) {
+        undo_tree->seq_index[i] = NULL;
+    }
+    undo_tree->checkpoint_nodes =
+        atomic_load(&ctx_lua->WR_UNDO_CHECKPOINT_NODES);
+    undo_tree->jump_notes_max = atomic_load(&ctx_lua->WR_UNDO_JUMP_NOTES_MAX);
+    assert(undo_tree->checkpoint_nodes >= 2 &&
+           (undo_tree->jump_notes_max & (undo_tree->jump_notes_max - 1)) == 0);
+    undo_tree->jump_notes = war_pool_alloc(
+        pool_wr, sizeof(war_undo_jump_note) * undo_tree->jump_notes_max);
+    undo_tree->jump_map_mask = undo_tree->jump_notes_max * 2 - 1;
+    undo_tree->jump_map = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * (undo_tree->jump_map_mask + 1));
+    undo_tree->join_us = atomic_load(&ctx_lua->WR_UNDO_JOIN_US);
+    undo_tree->joined_us = 0;
+    undo_tree->join_prev_id = 0;
+    undo_tree->join_prev_bytes = 0;
+    war_undofile* undofile = war_pool_alloc(pool_wr, sizeof(war_undofile));
+    undofile->fd = -1;
+    undofile->path_limit = atomic_load(&ctx_lua->A_PATH_LIMIT);
+    undofile->path = war_pool_alloc(pool_wr, undofile->path_limit);
+    undofile->queue_size = atomic_load(&ctx_lua->WR_UNDOFILE_QUEUE_BYTES);
+    undofile->queue = war_pool_alloc(pool_wr, undofile->queue_size);
+    atomic_store(&undofile->queue_head, 0);
+    atomic_store(&undofile->queue_tail, 0);
+    undofile->flush_us = atomic_load(&ctx_lua->WR_UNDOFILE_FLUSH_US);
+    undofile->synced_seq_num = 0;
+    undofile->synced_current_id = 0;
+    undofile->synced_node_id = 0;
+    undofile->synced_node_bytes = 0;
+    undofile->synced_node_count = 0;
+    undofile->stream_node = NULL;
+    undofile->stream_done = 0;
+    undofile->stream_bytes = 0;
+    pthread_mutex_init(&undofile->mutex, NULL);
+    pthread_cond_init(&undofile->cond, NULL);
+    war_project* project = war_pool_alloc(pool_wr, sizeof(war_project));
+    project->path_limit = atomic_load(&ctx_lua->A_PATH_LIMIT);
+    project->tmp_path = war_pool_alloc(pool_wr, project->path_limit);
+    project->pages_max = atomic_load(&ctx_lua->WR_PROJECT_PAGES_MAX);
+    project->page_count =
+        war_pool_alloc(pool_wr, sizeof(uint32_t) * project->pages_max);
+    project->page_min_col =
+        war_pool_alloc(pool_wr, sizeof(double) * project->pages_max);
+    project->page_max_col =
+        war_pool_alloc(pool_wr, sizeof(double) * project->pages_max);
+    project->page_checksum =
+        war_pool_alloc(pool_wr, sizeof(uint64_t) * project->pages_max);
+    project->page = war_pool_alloc(
+        pool_wr,
+        sizeof(war_note_swap_record) *
+            atomic_load(&ctx_lua->WR_NOTE_SWAP_PAGE_NOTES));
+    project->mapped_size = 0;
+    project->log_offset = 0;
+    project->log_bytes = 0;
+    project->seen = war_pool_alloc(pool_wr, WAR_PROJECT_CHUNKS_MAX / 8);
+    war_autosave* autosave = war_pool_alloc(pool_wr, sizeof(war_autosave));
+    autosave->fd = -1;
+    autosave->path_limit = atomic_load(&ctx_lua->A_PATH_LIMIT);
+    autosave->path = war_pool_alloc(pool_wr, autosave->path_limit);
+    autosave->queue_size = atomic_load(&ctx_lua->WR_PROJECT_QUEUE_BYTES);
+    assert(autosave->queue_size % 8 == 0);
+    autosave->queue = war_pool_alloc(pool_wr, autosave->queue_size);
+    atomic_store(&autosave->queue_head, 0);
+    atomic_store(&autosave->queue_tail, 0);
+    pthread_mutex_init(&autosave->mutex, NULL);
+    pthread_cond_init(&autosave->cond, NULL);
+    autosave->log_offset = 0;
+    autosave->log_bytes = 0;
+    autosave->compact_bytes = atomic_load(&ctx_lua->WR_PROJECT_COMPACT_BYTES);
+    autosave->seen = war_pool_alloc(pool_wr, WAR_PROJECT_CHUNKS_MAX / 8);
+    autosave->chunk_at =
+        war_pool_alloc(pool_wr, sizeof(uint32_t) * WAR_PROJECT_CHUNKS_MAX);
+    autosave->every_us = atomic_load(&ctx_lua->WR_PROJECT_AUTOSAVE_US);
+    autosave->synced_us = 0;
+    autosave->base = 0;
+    war_note_text* note_text = war_pool_alloc(pool_wr, sizeof(war_note_text));
+    note_text->buffer_size = atomic_load(&ctx_lua->WR_NOTE_TEXT_BUFFER_BYTES);
+    assert(note_text->buffer_size > 256);
+    note_text->buffer = war_pool_alloc(pool_wr, note_text->buffer_size);
+    note_text->batch_max = atomic_load(&ctx_lua->WR_NOTE_TEXT_BATCH);
+    note_text->batch = war_pool_alloc(
+        pool_wr, sizeof(war_note_quad) * note_text->batch_max);
+    note_text->keys_max = atomic_load(&ctx_lua->WR_NOTE_TEXT_KEYS_MAX);
+    note_text->keys = war_pool_alloc(
+        pool_wr, sizeof(war_note_text_key) * note_text->keys_max);
+    note_text->chunk_count =
+        war_pool_alloc(pool_wr, sizeof(uint32_t) * WAR_PROJECT_CHUNKS_MAX);
+    note_text->undo_notes_max =
+        atomic_load(&ctx_lua->WR_NOTE_TEXT_UNDO_NOTES_MAX);
+    atomic_store(&undofile->running, 1);
+    pthread_create(&undofile->thread, NULL, war_undofile_writer, undofile);
     //-------------------------------------------------------------------------
     // COMMAND CONTEXT
     //-------------------------------------------------------------------------
@@ -361,9 +476,17 @@ void* war_window_render(void* args) {
         .capture_octave = 4,
         .gain_increment = 0.05f,
         .trinity = false,
+        .redraw = true,
+        .present = false,
+        .frame_pending = false,
+        .damage = {0.0f, 0.0f, physical_width, physical_height},
+        .present_damage = {0.0f, 0.0f, 0.0f, 0.0f},
         .fullscreen = false,
         .end_window_render = false,
         .FPS = atomic_load(&ctx_lua->WR_FPS),
+        .timing_overlay = atomic_load(&ctx_lua->WR_TIMING_OVERLAY),
+        .present_lead_us = atomic_load(&ctx_lua->WR_PRESENT_LEAD_US),
+        .render_margin_us = atomic_load(&ctx_lua->WR_RENDER_MARGIN_US),
         .now = 0,
         .mode = 0,
         .hud_state = HUD_PIANO,
@@ -653,6 +776,7 @@ void* war_window_render(void* args) {
     ctx_status->bottom =
         war_pool_alloc(pool_wr, sizeof(char) * ctx_status->capacity);
     ctx_status->bottom_size = 0;
+    ctx_status->drawn_hash = 0;
     ctx_status->layers_active_size = atomic_load(&ctx_lua->A_LAYER_COUNT);
     ctx_status->layers_active =
         war_pool_alloc(pool_wr, sizeof(char) * ctx_status->layers_active_size);
@@ -677,7 +801,9 @@ void* war_window_render(void* args) {
     uint32_t zwp_linux_dmabuf_feedback_v1_id = 0;
     uint32_t wl_display_id = 1;
     uint32_t wl_registry_id = 2;
-    uint32_t wl_buffer_id = 0;
+    uint32_t wl_buffer_id[max_frames] = {0};
+    // attached and not released by the compositor yet
+    bool wl_buffer_busy[max_frames] = {0};
     uint32_t wl_callback_id = 0;
     uint32_t wl_compositor_id = 0;
     uint32_t wl_region_id = 0;
@@ -704,6 +830,12 @@ void* war_window_render(void* args) {
     uint32_t zwp_pointer_gestures_v1_id = 0;
     uint32_t xdg_activation_v1_id = 0;
     uint32_t wp_presentation_id = 0;
+    // one feedback in flight at a time, its id is reused after delete_id
+    uint32_t wp_presentation_feedback_id = 0;
+    bool presentation_feedback_free = true;
+    uint64_t presentation_feedback_seq = 0;
+    uint64_t presentation_commit_us = 0;
+    clockid_t presentation_clock = CLOCK_MONOTONIC;
     uint32_t zwlr_layer_shell_v1_id = 0;
     uint32_t ext_foreign_toplevel_list_v1_id = 0;
     uint32_t wp_content_type_manager_v1_id = 0;
@@ -785,26 +917,244 @@ void* war_window_render(void* args) {
     note_quads->mute =
         war_pool_alloc(pool_wr, sizeof(uint32_t) * note_quads->note_quads_max);
     note_quads->count = 0;
+    note_quads->generation = 0;
+    uint32_t map_slots = atomic_load(&ctx_lua->WR_NOTE_MAP_SLOTS);
+    assert((map_slots & (map_slots - 1)) == 0 &&
+           map_slots >= 2 * note_quads->note_quads_max);
+    note_quads->map = war_pool_alloc(pool_wr, sizeof(uint32_t) * map_slots);
+    memset(note_quads->map, 0, sizeof(uint32_t) * map_slots);
+    note_quads->map_mask = map_slots - 1;
+    note_quads->map_used = 0;
+    note_quads->dirty = war_pool_alloc(pool_wr, WAR_PROJECT_CHUNKS_MAX / 8);
+    memset(note_quads->dirty, 0, WAR_PROJECT_CHUNKS_MAX / 8);
+    note_quads->dirty_count = 0;
+    war_note_swap* note_swap = war_pool_alloc(pool_wr, sizeof(war_note_swap));
+    note_swap->page_notes = atomic_load(&ctx_lua->WR_NOTE_SWAP_PAGE_NOTES);
+    note_swap->pages_max = atomic_load(&ctx_lua->WR_NOTE_SWAP_PAGES_MAX);
+    note_swap->margin_cols = atomic_load(&ctx_lua->WR_NOTE_SWAP_MARGIN_COLS);
+    note_swap->lookahead_cols =
+        atomic_load(&ctx_lua->WR_NOTE_SWAP_LOOKAHEAD_COLS);
+    note_swap->page_count =
+        war_pool_alloc(pool_wr, sizeof(uint32_t) * note_swap->pages_max);
+    note_swap->page_min_col =
+        war_pool_alloc(pool_wr, sizeof(double) * note_swap->pages_max);
+    note_swap->page_max_col =
+        war_pool_alloc(pool_wr, sizeof(double) * note_swap->pages_max);
+    note_swap->page_checksum =
+        war_pool_alloc(pool_wr, sizeof(uint64_t) * note_swap->pages_max);
+    note_swap->keys = war_pool_alloc(
+        pool_wr, sizeof(war_note_key) * note_quads->note_quads_max);
+    if (war_note_swap_init(note_swap) == -1) {
+        call_terry_davis("note swap disabled, notes capped at %u",
+                         note_quads->note_quads_max);
+    }
+    war_note_chunks* note_chunks =
+        war_pool_alloc(pool_wr, sizeof(war_note_chunks));
+    note_chunks->chunks_max = atomic_load(&ctx_lua->WR_NOTE_CHUNKS_MAX);
+    note_chunks->chunk_cols = 0.0;
+    note_chunks->chunks_count = 0;
+    note_chunks->span_chunks_max = 0;
+    note_chunks->notes_count = 0;
+    note_chunks->synced_generation = UINT64_MAX;
+    note_chunks->offset = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * (note_chunks->chunks_max + 1));
+    note_chunks->fill =
+        war_pool_alloc(pool_wr, sizeof(uint32_t) * note_chunks->chunks_max);
+    note_chunks->min_row =
+        war_pool_alloc(pool_wr, sizeof(uint32_t) * note_chunks->chunks_max);
+    note_chunks->max_row =
+        war_pool_alloc(pool_wr, sizeof(uint32_t) * note_chunks->chunks_max);
+    note_chunks->hash =
+        war_pool_alloc(pool_wr, sizeof(uint64_t) * note_chunks->chunks_max);
+    note_chunks->generation =
+        war_pool_alloc(pool_wr, sizeof(uint64_t) * note_chunks->chunks_max);
+    memset(note_chunks->offset,
+           0,
+           sizeof(uint32_t) * (note_chunks->chunks_max + 1));
+    memset(note_chunks->hash, 0, sizeof(uint64_t) * note_chunks->chunks_max);
+    memset(note_chunks->generation,
+           0,
+           sizeof(uint64_t) * note_chunks->chunks_max);
+    note_chunks->idx = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * note_quads->note_quads_max);
+    note_chunks->pos_x =
+        war_pool_alloc(pool_wr, sizeof(double) * note_quads->note_quads_max);
+    note_chunks->end_x =
+        war_pool_alloc(pool_wr, sizeof(double) * note_quads->note_quads_max);
+    note_chunks->pos_y =
+        war_pool_alloc(pool_wr, sizeof(double) * note_quads->note_quads_max);
+    note_chunks->keys = war_pool_alloc(
+        pool_wr, sizeof(war_note_key) * note_quads->note_quads_max);
+    war_note_instances* note_instances =
+        war_pool_alloc(pool_wr, sizeof(war_note_instances));
+    note_instances->shadow = war_pool_alloc(
+        pool_wr, sizeof(war_quad_instance) * note_quads->note_quads_max);
+    note_instances->copies = war_pool_alloc(
+        pool_wr, sizeof(VkBufferCopy) * note_quads->note_quads_max);
+    note_instances->copies_count = 0;
+    note_instances->count = 0;
+    note_instances->resident = 0;
+    note_instances->synced_generation = UINT64_MAX;
+    war_note_query* note_query =
+        war_pool_alloc(pool_wr, sizeof(war_note_query));
+    note_query->hits = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * note_quads->note_quads_max);
+    note_query->hits_count = 0;
+    note_query->keys = war_pool_alloc(
+        pool_wr, sizeof(war_note_key) * note_quads->note_quads_max);
+    war_note_rows* note_rows = war_pool_alloc(pool_wr, sizeof(war_note_rows));
+    note_rows->rows_count = atomic_load(&ctx_lua->A_NOTE_COUNT);
+    note_rows->notes_count = 0;
+    note_rows->layer = 0;
+    note_rows->synced_generation = UINT64_MAX;
+    note_rows->offset = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * (note_rows->rows_count + 1));
+    note_rows->fill =
+        war_pool_alloc(pool_wr, sizeof(uint32_t) * note_rows->rows_count);
+    note_rows->start_x =
+        war_pool_alloc(pool_wr, sizeof(double) * note_quads->note_quads_max);
+    note_rows->end_x =
+        war_pool_alloc(pool_wr, sizeof(double) * note_quads->note_quads_max);
+    note_rows->word_offset = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * (note_rows->rows_count + 1));
+    note_rows->word_start_x =
+        war_pool_alloc(pool_wr, sizeof(double) * note_quads->note_quads_max);
+    note_rows->word_end_x =
+        war_pool_alloc(pool_wr, sizeof(double) * note_quads->note_quads_max);
+    note_rows->starts = war_pool_alloc(
+        pool_wr, sizeof(war_note_key) * note_quads->note_quads_max);
+    note_rows->ends = war_pool_alloc(
+        pool_wr, sizeof(war_note_key) * note_quads->note_quads_max);
+    memset(note_rows->offset,
+           0,
+           sizeof(uint32_t) * (note_rows->rows_count + 1));
+    memset(note_rows->word_offset,
+           0,
+           sizeof(uint32_t) * (note_rows->rows_count + 1));
+    war_note_registers* note_registers =
+        war_pool_alloc(pool_wr, sizeof(war_note_registers));
+    war_note_quads* register_notes =
+        war_pool_alloc(pool_wr, sizeof(war_note_quads));
+    register_notes->note_quads_max =
+        atomic_load(&ctx_lua->WR_NOTE_REGISTER_NOTES_MAX);
+    register_notes->alive = war_pool_alloc(
+        pool_wr, sizeof(uint8_t) * register_notes->note_quads_max);
+    register_notes->id = war_pool_alloc(
+        pool_wr, sizeof(uint64_t) * register_notes->note_quads_max);
+    register_notes->pos_x = war_pool_alloc(
+        pool_wr, sizeof(double) * register_notes->note_quads_max);
+    register_notes->pos_y = war_pool_alloc(
+        pool_wr, sizeof(double) * register_notes->note_quads_max);
+    register_notes->layer = war_pool_alloc(
+        pool_wr, sizeof(uint64_t) * register_notes->note_quads_max);
+    register_notes->size_x = war_pool_alloc(
+        pool_wr, sizeof(double) * register_notes->note_quads_max);
+    register_notes->navigation_x = war_pool_alloc(
+        pool_wr, sizeof(double) * register_notes->note_quads_max);
+    register_notes->navigation_x_numerator = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * register_notes->note_quads_max);
+    register_notes->navigation_x_denominator = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * register_notes->note_quads_max);
+    register_notes->size_x_numerator = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * register_notes->note_quads_max);
+    register_notes->size_x_denominator = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * register_notes->note_quads_max);
+    register_notes->color = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * register_notes->note_quads_max);
+    register_notes->outline_color = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * register_notes->note_quads_max);
+    register_notes->gain =
+        war_pool_alloc(pool_wr, sizeof(float) * register_notes->note_quads_max);
+    register_notes->voice = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * register_notes->note_quads_max);
+    register_notes->hidden = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * register_notes->note_quads_max);
+    register_notes->mute = war_pool_alloc(
+        pool_wr, sizeof(uint32_t) * register_notes->note_quads_max);
+    register_notes->count = 0;
+    register_notes->generation = 0;
+    register_notes->map = NULL;
+    register_notes->map_mask = 0;
+    register_notes->map_used = 0;
+    register_notes->dirty = NULL;
+    register_notes->dirty_count = 0;
+    note_registers->notes = register_notes;
+    note_registers->notes_used = 0;
+    note_registers->blocks_max = atomic_load(&ctx_lua->WR_NOTE_BLOCKS_MAX);
+    note_registers->blocks = war_pool_alloc(
+        pool_wr, sizeof(war_note_block) * note_registers->blocks_max);
+    memset(note_registers->blocks,
+           0,
+           sizeof(war_note_block) * note_registers->blocks_max);
+    note_registers->slot =
+        war_pool_alloc(pool_wr, sizeof(uint32_t) * NOTE_REGISTER_COUNT);
+    memset(note_registers->slot, 0, sizeof(uint32_t) * NOTE_REGISTER_COUNT);
+    note_registers->selected = NOTE_REGISTER_UNNAMED;
+    note_registers->pending = 0;
+    war_note_snapshots* note_snapshots =
+        war_pool_alloc(pool_wr, sizeof(war_note_snapshots));
+    note_snapshots->records_max =
+        atomic_load(&ctx_lua->WR_NOTE_SNAPSHOT_NOTES_MAX);
+    note_snapshots->records = war_pool_alloc(
+        pool_wr, sizeof(war_note_swap_record) * note_snapshots->records_max);
+    note_snapshots->records_used = 0;
+    note_snapshots->chunks_max =
+        atomic_load(&ctx_lua->WR_NOTE_SNAPSHOT_CHUNKS_MAX);
+    note_snapshots->chunks = war_pool_alloc(
+        pool_wr, sizeof(war_note_snapshot_chunk) * note_snapshots->chunks_max);
+    memset(note_snapshots->chunks,
+           0,
+           sizeof(war_note_snapshot_chunk) * note_snapshots->chunks_max);
+    note_snapshots->free =
+        war_pool_alloc(pool_wr, sizeof(uint32_t) * note_snapshots->chunks_max);
+    note_snapshots->free_count = note_snapshots->chunks_max;
+    for (uint32_t i = 0; i < note_snapshots->chunks_max; i++) {
+        note_snapshots->free[i] = note_snapshots->chunks_max - 1 - i;
+    }
+    note_snapshots->keys = war_pool_alloc(
+        pool_wr, sizeof(war_note_key) * note_snapshots->chunks_max);
+    note_snapshots->snapshots_max =
+        atomic_load(&ctx_lua->WR_NOTE_SNAPSHOTS_MAX);
+    assert(note_snapshots->snapshots_max >= 1);
+    note_snapshots->snapshots = war_pool_alloc(
+        pool_wr, sizeof(war_note_snapshot) * note_snapshots->snapshots_max);
+    uint32_t snapshot_chunks_max =
+        note_chunks->chunks_max + note_swap->pages_max;
+    uint32_t* snapshot_chunks = war_pool_alloc(
+        pool_wr,
+        sizeof(uint32_t) * snapshot_chunks_max * note_snapshots->snapshots_max);
+    for (uint32_t i = 0; i < note_snapshots->snapshots_max; i++) {
+        note_snapshots->snapshots[i] = (war_note_snapshot){
+            .chunks = snapshot_chunks + (size_t)i * snapshot_chunks_max,
+        };
+    }
+    note_snapshots->next = 0;
+    note_snapshots->newest = 0;
+    note_snapshots->every_nodes = atomic_load(&ctx_lua->WR_NOTE_SNAPSHOT_NODES);
+    note_snapshots->idle_us = atomic_load(&ctx_lua->WR_NOTE_SNAPSHOT_IDLE_US);
+    note_snapshots->watched_id = 0;
+    note_snapshots->watched_since = 0;
     uint32_t quads_max = atomic_load(&ctx_lua->WR_QUADS_MAX);
     uint32_t text_quads_max = atomic_load(&ctx_lua->WR_TEXT_QUADS_MAX);
-    war_quad_vertex* quad_vertices =
-        war_pool_alloc(pool_wr, sizeof(war_quad_vertex) * quads_max);
-    uint32_t quad_vertices_count = 0;
-    uint16_t* quad_indices =
-        war_pool_alloc(pool_wr, sizeof(uint16_t) * quads_max);
-    uint32_t quad_indices_count = 0;
-    war_quad_vertex* transparent_quad_vertices =
-        war_pool_alloc(pool_wr, sizeof(war_quad_vertex) * quads_max);
-    uint32_t transparent_quad_vertices_count = 0;
-    uint16_t* transparent_quad_indices =
-        war_pool_alloc(pool_wr, sizeof(uint16_t) * quads_max);
-    uint32_t transparent_quad_indices_count = 0;
+    war_quad_instance* quad_instances =
+        war_pool_alloc(pool_wr, sizeof(war_quad_instance) * quads_max);
+    uint32_t quad_instances_count = 0;
+    war_quad_instance* transparent_quad_instances =
+        war_pool_alloc(pool_wr, sizeof(war_quad_instance) * quads_max);
+    uint32_t transparent_quad_instances_count = 0;
     war_text_vertex* text_vertices =
-        war_pool_alloc(pool_wr, sizeof(war_text_vertex) * text_quads_max);
+        war_pool_alloc(pool_wr, sizeof(war_text_vertex) * text_quads_max * 4);
     uint32_t text_vertices_count = 0;
-    uint16_t* text_indices =
-        war_pool_alloc(pool_wr, sizeof(uint16_t) * text_quads_max);
+    uint32_t* text_indices =
+        war_pool_alloc(pool_wr, sizeof(uint32_t) * text_quads_max * 6);
     uint32_t text_indices_count = 0;
+    // parsing time of the last wayland batch, goes into the next frame stats
+    float wayland_last_us = 0.0f;
+    // the end of each frame's text region belongs to the hud text
+    uint32_t text_quads_budget = max_text_quads - max_hud_text_quads;
+    if (text_quads_max < text_quads_budget) {
+        text_quads_budget = text_quads_max;
+    }
     //-------------------------------------------------------------------------
     // RENDERING FPS
     //-------------------------------------------------------------------------
@@ -997,13 +1347,26 @@ void* war_window_render(void* args) {
     env->ctx_command = ctx_command;
     env->ctx_status = ctx_status;
     env->undo_tree = undo_tree;
+    env->undofile = undofile;
     env->note_quads = note_quads;
+    env->note_swap = note_swap;
+    env->note_chunks = note_chunks;
+    env->note_query = note_query;
+    env->note_rows = note_rows;
+    env->note_registers = note_registers;
+    env->note_snapshots = note_snapshots;
+    env->project = project;
+    env->autosave = autosave;
+    env->note_text = note_text;
+    env->map_wav = map_wav;
     env->pool_wr = pool_wr;
     env->ctx_vk = ctx_vk;
     env->capture_wav = capture_wav;
     env->ctx_fsm = ctx_fsm;
     env->cache = cache;
     env->pc_capture = pc_capture;
+    atomic_store(&autosave->running, 1);
+    pthread_create(&autosave->thread, NULL, war_autosave_writer, env);
 wr: {
     if (war_pc_from_a(pc_control, &header, &size, control_payload)) {
         goto* pc_control_cmd[header];
@@ -1128,18 +1491,41 @@ skip_capture:
     //-------------------------------------------------------------------------
     // FPS
     //-------------------------------------------------------------------------
-    if (ctx_wr->now - last_frame_time >= ctx_wr->frame_duration_us) {
+    bool fps_tick = ctx_wr->now - last_frame_time >= ctx_wr->frame_duration_us;
+    if (fps_tick) {
         last_frame_time += ctx_wr->frame_duration_us;
-        if (ctx_wr->trinity) {
-            war_wayland_holy_trinity(fd,
-                                     wl_surface_id,
-                                     wl_buffer_id,
-                                     0,
-                                     0,
-                                     0,
-                                     0,
-                                     physical_width,
-                                     physical_height);
+        war_note_swap_sync(env);
+        war_undofile_sync(env);
+        war_autosave_sync(env, 0);
+        war_note_snapshot_sync(env);
+        //---------------------------------------------------------------------
+        // DAMAGE
+        //---------------------------------------------------------------------
+        // what changes without a key or configure event behind it. a paced
+        // frame moves the playback bar itself once it knows its vblank
+        if (ctx_wr->present_at_us && atomic_load(&atomics->play)) {
+            ctx_wr->redraw = 1;
+        } else {
+            war_playback_bar_update(ctx_wr, ctx_lua, atomics, 0);
+        }
+        if (note_quads->generation != note_instances->synced_generation) {
+            war_damage_full(ctx_wr);
+        }
+        war_damage_status(ctx_wr, ctx_status);
+        if (ctx_wr->timing_overlay &&
+            ctx_wr->now - ctx_wr->timing_text_time >= 250000) {
+            ctx_wr->timing_text_time = ctx_wr->now;
+            char timing_text[sizeof(ctx_wr->timing_text)];
+            war_frame_stats_text(ctx_wr, timing_text, sizeof(timing_text));
+            if (strcmp(timing_text, ctx_wr->timing_text) != 0) {
+                memcpy(ctx_wr->timing_text, timing_text, sizeof(timing_text));
+                war_damage_rect(ctx_wr,
+                                0.0f,
+                                0.0f,
+                                ctx_wr->physical_width,
+                                ctx_wr->cell_height *
+                                    fmaxf(ctx_wr->zoom_scale, 1.0f));
+            }
         }
         // update roll position status text
         ctx_status->roll_position_index =
@@ -1201,6 +1587,67 @@ skip_capture:
         }
     }
     //-------------------------------------------------------------------------
+    // PRESENT
+    //-------------------------------------------------------------------------
+    // a recorded frame goes out with its damage on the fps tick, or with
+    // presentation feedback just before the compositor latches the vblank it
+    // was recorded for. a pending redraw with nothing recorded yet only needs
+    // a commit to get the frame callback
+    bool present_due =
+        ctx_wr->present_at_us ?
+            ctx_wr->now + ctx_wr->present_lead_us >= ctx_wr->present_at_us :
+            fps_tick;
+    if (ctx_wr->trinity && ctx_wr->present && present_due) {
+        int32_t damage_x = (int32_t)floorf(ctx_wr->present_damage[0]);
+        int32_t damage_y = (int32_t)floorf(ctx_wr->present_damage[1]);
+        war_wayland_wl_surface_attach(fd,
+                                      wl_surface_id,
+                                      wl_buffer_id[ctx_vk->current_frame],
+                                      0,
+                                      0);
+        wl_buffer_busy[ctx_vk->current_frame] = 1;
+        war_wayland_wl_surface_damage_buffer(
+            fd,
+            wl_surface_id,
+            damage_x,
+            damage_y,
+            (int32_t)ceilf(ctx_wr->present_damage[2]) - damage_x,
+            (int32_t)ceilf(ctx_wr->present_damage[3]) - damage_y);
+        if (wp_presentation_id && presentation_feedback_free) {
+            if (!wp_presentation_feedback_id) {
+                wp_presentation_feedback_id = new_id;
+                size_t feedback_ops =
+                    wp_presentation_feedback_id *
+                    atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES);
+                obj_op[feedback_ops + 0] =
+                    &&wp_presentation_feedback_sync_output;
+                obj_op[feedback_ops + 1] =
+                    &&wp_presentation_feedback_presented;
+                obj_op[feedback_ops + 2] =
+                    &&wp_presentation_feedback_discarded;
+                new_id++;
+            }
+            war_wayland_wp_presentation_feedback(
+                fd,
+                wp_presentation_id,
+                wl_surface_id,
+                wp_presentation_feedback_id);
+            presentation_feedback_free = false;
+            presentation_feedback_seq =
+                ctx_vk->frame_seq[ctx_vk->current_frame];
+            presentation_commit_us =
+                war_get_clock_time_us(presentation_clock);
+        }
+        war_wayland_wl_surface_commit(fd, wl_surface_id);
+        memset(ctx_wr->present_damage, 0, sizeof(ctx_wr->present_damage));
+        ctx_wr->present = 0;
+        ctx_wr->frame_pending = 1;
+    } else if (fps_tick && ctx_wr->trinity && ctx_wr->redraw &&
+               !ctx_wr->frame_pending && !ctx_wr->frame_callback) {
+        war_wayland_wl_surface_commit(fd, wl_surface_id);
+        ctx_wr->frame_pending = 1;
+    }
+    //-------------------------------------------------------------------------
     // COMMAND MODE HANDLING
     //-------------------------------------------------------------------------
     if (ctx_fsm->current_mode == ctx_fsm->MODE_COMMAND) {
@@ -1209,6 +1656,7 @@ skip_capture:
             ctx_command->input_read_index >= ctx_command->input_write_index) {
             goto skip_command;
         }
+        war_damage_full(ctx_wr);
         int input = ctx_command->input[ctx_command->input_read_index];
         if (input == '\b') { // ASCII backspace
             if (ctx_command->text_write_index > 0) {
@@ -1339,13 +1787,80 @@ skip_capture:
                 memcpy(ctx_fsm->cwd, ctx_command->text, len);
                 ctx_fsm->cwd_size = len;
                 goto war_label_command_processed;
+            } else if (strncmp(ctx_command->text, "earlier", 7) == 0 ||
+                       strncmp(ctx_command->text, "later", 5) == 0) {
+                int8_t direction = ctx_command->text[0] == 'l' ? 1 : -1;
+                char* arg = ctx_command->text + (direction > 0 ? 5 : 7);
+                if (*arg != ' ' && *arg != '\0') {
+                    goto war_label_command_processed;
+                }
+                while (*arg == ' ') { arg++; }
+                war_undo_travel_command(env, arg, direction);
+            } else if (strncmp(ctx_command->text, "w", 1) == 0) {
+                if (ctx_command->text[1] != ' ' &&
+                    ctx_command->text[1] != '\0') {
+                    goto war_label_command_processed;
+                }
+                ctx_command->text[0] = ' ';
+                len = war_trim_whitespace(ctx_command->text);
+                // like vim, a name only sticks when there isn't one yet
+                if (len == 0) {
+                    if (ctx_fsm->current_file_path_size == 0 ||
+                        ctx_fsm->current_file_type != FILE_WAR) {
+                        call_terry_davis("no project file name");
+                        goto war_label_command_processed;
+                    }
+                    war_project_commit(env, ctx_fsm->current_file_path, 1);
+                    goto war_label_command_processed;
+                }
+                ctx_fsm->ext_size = war_get_ext(
+                    ctx_command->text, ctx_fsm->ext, ctx_fsm->name_limit);
+                // a .txt copy is an export, the project keeps its own name
+                if (strcmp(ctx_fsm->ext, "txt") == 0) {
+                    war_note_text_export(env, ctx_command->text);
+                    goto war_label_command_processed;
+                }
+                if (strcmp(ctx_fsm->ext, "war") != 0) {
+                    goto war_label_command_processed;
+                }
+                if (ctx_fsm->current_file_path_size > 0 &&
+                    ctx_fsm->current_file_type == FILE_WAR) {
+                    war_project_commit(env, ctx_command->text, 0);
+                    goto war_label_command_processed;
+                }
+                memset(ctx_fsm->current_file_path, 0, ctx_fsm->name_limit);
+                ctx_fsm->current_file_path_size =
+                    snprintf(ctx_fsm->current_file_path,
+                             len + ctx_fsm->cwd_size + 2,
+                             "%s/%s",
+                             ctx_fsm->cwd,
+                             ctx_command->text);
+                ctx_fsm->current_file_type = FILE_WAR;
+                if (war_project_commit(env, ctx_fsm->current_file_path, 1) ==
+                    0) {
+                    war_undofile_open(env, ctx_fsm->current_file_path);
+                }
+            } else if (strncmp(ctx_command->text, "r", 1) == 0) {
+                if (ctx_command->text[1] != ' ') {
+                    goto war_label_command_processed;
+                }
+                ctx_command->text[0] = ' ';
+                len = war_trim_whitespace(ctx_command->text);
+                if (len == 0) {
+                    call_terry_davis("no file name");
+                    goto war_label_command_processed;
+                }
+                war_note_text_import(env, ctx_command->text);
             } else if (strncmp(ctx_command->text, "e", 1) == 0) {
                 if (ctx_command->text[1] != ' ' &&
                     ctx_command->text[1] != '\0') {
                     goto war_label_command_processed;
                 }
                 if (ctx_command->text[1] == '\0') {
-                    // reload project?
+                    if (ctx_fsm->current_file_path_size > 0 &&
+                        ctx_fsm->current_file_type == FILE_WAR) {
+                        war_project_open(env, ctx_fsm->current_file_path);
+                    }
                     goto war_label_command_processed;
                 }
                 ctx_command->text[0] = ' ';
@@ -1365,6 +1880,7 @@ skip_capture:
                 } else if (strcmp(ctx_fsm->ext, "war") == 0) {
                     ctx_fsm->current_file_type = FILE_WAR;
                     war_roll_mode(env);
+                    war_project_open(env, ctx_fsm->current_file_path);
                 } else {
                     switch (ctx_fsm->current_file_type) {
                     case FILE_WAR:
@@ -1432,6 +1948,14 @@ skip_command:
         ;
         ctx_wr->cursor_blink_previous_us += ctx_wr->cursor_blink_duration_us;
         ctx_wr->cursor_blinking = !ctx_wr->cursor_blinking;
+        war_damage_cells(ctx_wr,
+                         ctx_wr->cursor_pos_x +
+                             (float)ctx_wr->sub_col /
+                                 ctx_wr->navigation_sub_cells_col,
+                         ctx_wr->cursor_pos_y,
+                         ctx_wr->cursor_size_x,
+                         1,
+                         ctx_wr->outline_thickness + 1.0f);
     }
     //---------------------------------------------------------------------
     // KEY REPEATS
@@ -1542,177 +2066,1203 @@ cmd_repeat_done:
     }
 cmd_timeout_done:
     //---------------------------------------------------------------------
-    // WAYLAND MESSAGE PARSING
+    // RENDERING WITH VULKAN
     //---------------------------------------------------------------------
-    int ret = poll(&pfd, 1, 0);
-    assert(ret >= 0);
-    // if (ret == 0) { call_terry_davis("timeout"); }
-    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
-        call_terry_davis("wayland socket error or hangup: %s", strerror(errno));
-        goto end_wr;
+    // a frame callback arms it, with presentation feedback it starts as
+    // late as the slowest recent frame still makes the predicted vblank
+    if (!ctx_wr->frame_callback ||
+        war_get_monotonic_time_us() < ctx_wr->record_at_us) {
+        goto render_done;
     }
-    if (pfd.revents & POLLIN) {
-        struct msghdr poll_msg_hdr = {0};
-        struct iovec poll_iov;
-        poll_iov.iov_base = msg_buffer + msg_buffer_size;
-        poll_iov.iov_len =
-            atomic_load(&ctx_lua->WR_WAYLAND_MSG_BUFFER_SIZE) - msg_buffer_size;
-        poll_msg_hdr.msg_iov = &poll_iov;
-        poll_msg_hdr.msg_iovlen = 1;
-        char poll_ctrl_buf[CMSG_SPACE(sizeof(int) * 4)];
-        poll_msg_hdr.msg_control = poll_ctrl_buf;
-        poll_msg_hdr.msg_controllen = sizeof(poll_ctrl_buf);
-        ssize_t size_read = recvmsg(fd, &poll_msg_hdr, 0);
-        assert(size_read > 0);
-        msg_buffer_size += size_read;
-        size_t msg_buffer_offset = 0;
-        while (msg_buffer_size - msg_buffer_offset >= 8) {
-            uint16_t size = war_read_le16(msg_buffer + msg_buffer_offset + 6);
-            if ((size < 8) || (size > (msg_buffer_size - msg_buffer_offset))) {
-                break;
+    ctx_wr->frame_callback = 0;
+    {
+        // nothing visible changed, the next damage commits again
+        if (!ctx_wr->redraw) { goto render_done; }
+        // record into the next frame whose wl_buffer the compositor
+        // released, its fence is max_frames renders old and rarely waits
+        uint32_t frame = ctx_vk->current_frame;
+        for (uint32_t i = 1; i <= max_frames; i++) {
+            frame = (ctx_vk->current_frame + i) % max_frames;
+            if (!wl_buffer_busy[frame]) { break; }
+        }
+        // all held, the next tick commits for another callback
+        if (wl_buffer_busy[frame]) { goto render_done; }
+        ctx_vk->current_frame = frame;
+        // show the play head where the audio is once this frame is presented
+        if (ctx_wr->present_at_us) {
+            uint64_t record_now_us = war_get_monotonic_time_us();
+            war_playback_bar_update(ctx_wr,
+                                    ctx_lua,
+                                    atomics,
+                                    ctx_wr->present_at_us > record_now_us ?
+                                        ctx_wr->present_at_us - record_now_us :
+                                        0);
+        }
+        war_damage_record(ctx_wr);
+        uint64_t record_start_us = war_get_monotonic_time_us();
+        vkWaitForFences(ctx_vk->device,
+                        1,
+                        &ctx_vk->in_flight_fences[frame],
+                        VK_TRUE,
+                        UINT64_MAX);
+        vkResetFences(ctx_vk->device, 1, &ctx_vk->in_flight_fences[frame]);
+        // the fence covers the timestamps this frame wrote last time
+        war_frame_stats* last_stats =
+            war_frame_stats_find(ctx_wr, ctx_vk->frame_seq[frame]);
+        if (ctx_vk->timestamp_query_pool && last_stats) {
+            uint64_t ticks[TIMESTAMP_COUNT];
+            if (vkGetQueryPoolResults(ctx_vk->device,
+                                      ctx_vk->timestamp_query_pool,
+                                      TIMESTAMP_COUNT * frame,
+                                      TIMESTAMP_COUNT,
+                                      sizeof(ticks),
+                                      ticks,
+                                      sizeof(uint64_t),
+                                      VK_QUERY_RESULT_64_BIT) ==
+                VK_SUCCESS) {
+                war_frame_stats_gpu(
+                    last_stats, ticks, ctx_vk->timestamp_period);
+            }
+        }
+        war_frame_stats* stats = war_frame_stats_begin(ctx_wr);
+        ctx_vk->frame_seq[frame] = stats->seq;
+        uint64_t record_fenced_us = war_get_monotonic_time_us();
+        stats->fence_us = (float)(record_fenced_us - record_start_us);
+        stats->wayland_us = wayland_last_us;
+        VkCommandBuffer cmd_buffer = ctx_vk->cmd_buffers[frame];
+        VkCommandBufferBeginInfo begin_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+        VkResult result =
+            vkBeginCommandBuffer(cmd_buffer, &begin_info);
+        assert(result == VK_SUCCESS);
+        if (ctx_vk->timestamp_query_pool) {
+            vkCmdResetQueryPool(cmd_buffer,
+                                ctx_vk->timestamp_query_pool,
+                                TIMESTAMP_COUNT * frame,
+                                TIMESTAMP_COUNT);
+        }
+        war_frame_timestamp(ctx_vk, cmd_buffer, frame, TIMESTAMP_BEGIN);
+        // the note buffers are shared by every frame in flight, the
+        // copy and cull below wait for earlier frames to be done with
+        // them
+        VkMemoryBarrier frame_barrier = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask =
+                VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask =
+                VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        };
+        vkCmdPipelineBarrier(cmd_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT |
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                                 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                                 VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                                 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT |
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             1,
+                             &frame_barrier,
+                             0,
+                             NULL,
+                             0,
+                             NULL);
+        // notes only go over when they changed since the last frame,
+        // the fence above means this frame's staging region is free
+        VkDeviceSize note_staging_offset =
+            ctx_vk->note_staging_frame_size * frame;
+        war_quad_instance* note_staging =
+            (war_quad_instance*)((uint8_t*)
+                                     ctx_vk->note_staging_buffer_mapped +
+                                 note_staging_offset);
+        if (war_note_instances_sync(note_instances,
+                                    note_quads,
+                                    note_staging,
+                                    note_staging_offset,
+                                    ctx_wr->layers[LAYER_NOTES],
+                                    default_outline_thickness)) {
+            VkMappedMemoryRange note_flush_range = {
+                .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                .memory = ctx_vk->note_staging_buffer_memory,
+                .offset = note_staging_offset,
+                .size = ctx_vk->note_staging_frame_size,
             };
-            uint32_t object_id = war_read_le32(msg_buffer + msg_buffer_offset);
-            uint16_t opcode = war_read_le16(msg_buffer + msg_buffer_offset + 4);
-            if (object_id >=
-                    (uint32_t)atomic_load(&ctx_lua->WR_WAYLAND_MAX_OBJECTS) ||
-                opcode >=
-                    (uint16_t)atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES)) {
-                // COMMENT CONCERN: INVALID OBJECT/OP 27 TIMES!
-                // call_terry_davis(
-                //    "invalid object/op: id=%u, op=%u", object_id,
-                //    opcode);
-                goto wayland_done;
+            vkFlushMappedMemoryRanges(
+                ctx_vk->device, 1, &note_flush_range);
+            vkCmdCopyBuffer(cmd_buffer,
+                            ctx_vk->note_staging_buffer,
+                            ctx_vk->note_instance_buffer,
+                            note_instances->copies_count,
+                            note_instances->copies);
+            VkBufferMemoryBarrier note_barrier = {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer = ctx_vk->note_instance_buffer,
+                .offset = 0,
+                .size = VK_WHOLE_SIZE,
+            };
+            vkCmdPipelineBarrier(cmd_buffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0,
+                                 0,
+                                 NULL,
+                                 1,
+                                 &note_barrier,
+                                 0,
+                                 NULL);
+        }
+        // the notes in view get compacted into note_visible_buffer on
+        // the gpu, the draw reads how many from note_draw_buffer
+        VkDrawIndirectCommand note_draw = {
+            .vertexCount = 6,
+            .instanceCount = 0,
+            .firstVertex = 0,
+            .firstInstance = 0,
+        };
+        vkCmdUpdateBuffer(cmd_buffer,
+                          ctx_vk->note_draw_buffer,
+                          0,
+                          sizeof(VkDrawIndirectCommand),
+                          &note_draw);
+        VkMemoryBarrier note_draw_reset_barrier = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask =
+                VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        };
+        vkCmdPipelineBarrier(cmd_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             1,
+                             &note_draw_reset_barrier,
+                             0,
+                             NULL,
+                             0,
+                             NULL);
+        if (note_instances->count) {
+            vkCmdBindPipeline(cmd_buffer,
+                              VK_PIPELINE_BIND_POINT_COMPUTE,
+                              ctx_vk->note_cull_pipeline);
+            vkCmdBindDescriptorSets(cmd_buffer,
+                                    VK_PIPELINE_BIND_POINT_COMPUTE,
+                                    ctx_vk->note_cull_pipeline_layout,
+                                    0,
+                                    1,
+                                    &ctx_vk->note_cull_descriptor_set,
+                                    0,
+                                    NULL);
+            war_note_cull_push_constants note_cull_push_constants = {
+                .bottom_left = {ctx_wr->left_col, ctx_wr->bottom_row},
+                .top_right = {ctx_wr->right_col, ctx_wr->top_row},
+                .count = note_instances->count,
+            };
+            vkCmdPushConstants(cmd_buffer,
+                               ctx_vk->note_cull_pipeline_layout,
+                               VK_SHADER_STAGE_COMPUTE_BIT,
+                               0,
+                               sizeof(war_note_cull_push_constants),
+                               &note_cull_push_constants);
+            vkCmdDispatch(cmd_buffer,
+                          (note_instances->count + 63) / 64,
+                          1,
+                          1);
+        }
+        VkMemoryBarrier note_cull_barrier = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+                             VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+        };
+        vkCmdPipelineBarrier(cmd_buffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                                 VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             0,
+                             1,
+                             &note_cull_barrier,
+                             0,
+                             NULL,
+                             0,
+                             NULL);
+        war_frame_timestamp(ctx_vk, cmd_buffer, frame, TIMESTAMP_CULL);
+        uint64_t record_uploaded_us = war_get_monotonic_time_us();
+        stats->upload_us = (float)(record_uploaded_us - record_fenced_us);
+        VkClearValue clear_values[2];
+        clear_values[0].color =
+            (VkClearColorValue){{0.1569f, 0.1569f, 0.1569f, 1.0f}};
+        clear_values[1].depthStencil = (VkClearDepthStencilValue){
+            ctx_wr->layers[LAYER_OPAQUE_REGION], 0.0f};
+        VkRenderPassBeginInfo render_pass_info = {
+            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+            .renderPass = ctx_vk->render_pass,
+            .framebuffer = ctx_vk->frame_buffers[frame],
+            .renderArea =
+                {
+                    .offset = {0, 0},
+                    .extent = {physical_width, physical_height},
+                },
+            .clearValueCount = 2,
+            .pClearValues = clear_values,
+        };
+        vkCmdBeginRenderPass(cmd_buffer,
+                             &render_pass_info,
+                             VK_SUBPASS_CONTENTS_INLINE);
+        quad_instances_count = 0;
+        transparent_quad_instances_count = 0;
+        text_vertices_count = 0;
+        text_indices_count = 0;
+        //---------------------------------------------------------
+        // GRID PIPELINE
+        //---------------------------------------------------------
+        vkCmdBindPipeline(cmd_buffer,
+                          VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          ctx_vk->grid_pipeline);
+        war_grid_push_constants grid_push_constants = {
+            .bottom_left = {ctx_wr->left_col, ctx_wr->bottom_row},
+            .physical_size = {physical_width, physical_height},
+            .cell_size = {ctx_wr->cell_width, ctx_wr->cell_height},
+            .zoom = ctx_wr->zoom_scale,
+            .hud_state = ctx_wr->hud_state,
+            .cell_offsets = {ctx_wr->num_cols_for_line_numbers,
+                             ctx_wr->num_rows_for_status_bars},
+            .top_right = {ctx_wr->right_col, ctx_wr->top_row},
+            .viewport = {ctx_wr->viewport_cols, ctx_wr->viewport_rows},
+            .horizontal_thickness = default_horizontal_line_thickness,
+            .vertical_thickness = default_vertical_line_thickness,
+            .gutter_thickness = piano_horizontal_line_thickness,
+            .max_row = ctx_wr->max_row,
+            .depth = {ctx_wr->layers[LAYER_GRIDLINES],
+                      ctx_wr->layers[LAYER_HUD]},
+            .splits = {ctx_wr->gridline_splits[0] |
+                           ctx_wr->gridline_splits[1] << 16,
+                       ctx_wr->gridline_splits[2] |
+                           ctx_wr->gridline_splits[3] << 16},
+            .gutter_inset = 5 * default_vertical_line_thickness,
+            .colors =
+                {
+                    [GRID_WHITE] = ctx_wr->white_hex,
+                    [GRID_DARKER_LIGHT_GRAY] =
+                        ctx_wr->darker_light_gray_hex,
+                    [GRID_RED] = ctx_wr->red_hex,
+                    [GRID_BLACK] = ctx_wr->black_hex,
+                    [GRID_DARK_GRAY] = ctx_wr->dark_gray_hex,
+                    [GRID_FULL_WHITE] = ctx_wr->full_white_hex,
+                    [GRID_SUPER_LIGHT_GRAY] = super_light_gray_hex,
+                },
+        };
+        vkCmdPushConstants(cmd_buffer,
+                           ctx_vk->grid_pipeline_layout,
+                           VK_SHADER_STAGE_FRAGMENT_BIT,
+                           0,
+                           sizeof(war_grid_push_constants),
+                           &grid_push_constants);
+        vkCmdDraw(cmd_buffer, 3, 1, 0, 0);
+        war_frame_timestamp(ctx_vk, cmd_buffer, frame, TIMESTAMP_GRID);
+        //---------------------------------------------------------
+        // QUAD PIPELINE
+        //---------------------------------------------------------
+        vkCmdBindPipeline(cmd_buffer,
+                          VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          ctx_vk->quad_pipeline);
+        uint32_t cursor_color = ctx_wr->color_cursor;
+        float alpha_factor = ctx_wr->alpha_scale_cursor;
+        uint8_t color_alpha =
+            (ctx_wr->color_cursor_transparent >> 24) & 0xFF;
+        uint32_t cursor_color_transparent =
+            ((uint8_t)(color_alpha * alpha_factor) << 24) |
+            (ctx_wr->color_cursor_transparent & 0x00FFFFFF);
+        // notes draw from note_instances, here they only decide if the
+        // cursor is over one and goes transparent
+        double chunk_cols =
+            atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT) *
+            atomic_load(&ctx_lua->WR_NOTE_CHUNK_BEATS);
+        war_note_chunks_sync(note_chunks, note_quads, chunk_cols);
+        double cursor_pos_x = ctx_wr->cursor_pos_x;
+        double cursor_pos_y = ctx_wr->cursor_pos_y;
+        double cursor_end_x = cursor_pos_x + ctx_wr->cursor_size_x;
+        uint32_t chunk_begin;
+        uint32_t chunk_end;
+        war_note_chunks_range(note_chunks,
+                              cursor_pos_x,
+                              cursor_end_x,
+                              &chunk_begin,
+                              &chunk_end);
+        for (uint32_t k = chunk_begin; k < chunk_end; k++) {
+            uint32_t i = note_chunks->idx[k];
+            if (note_quads->hidden[i] ||
+                note_chunks->pos_y[k] != cursor_pos_y ||
+                cursor_pos_x >= note_chunks->end_x[k] ||
+                cursor_end_x <= note_chunks->pos_x[k]) {
+                continue;
             }
-            size_t idx =
-                object_id * atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                opcode;
-            if (obj_op[idx]) { goto* obj_op[idx]; }
-            goto wayland_default;
-        wl_registry_global:
-            dump_bytes("global event", msg_buffer + msg_buffer_offset, size);
-            call_terry_davis("iname: %s",
-                             (const char*)msg_buffer + msg_buffer_offset + 16);
-
-            const char* iname = (const char*)msg_buffer + msg_buffer_offset +
-                                16; // COMMENT OPTIMIZE: perfect hash
-            if (strcmp(iname, "wl_compositor") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                wl_compositor_id = new_id;
-                obj_op[wl_compositor_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&wl_compositor_jump;
-                new_id++;
-            } else if (strcmp(iname, "wl_output") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                wl_output_id = new_id;
-                obj_op[wl_output_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&wl_output_geometry;
-                obj_op[wl_output_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       1] = &&wl_output_mode;
-                obj_op[wl_output_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       2] = &&wl_output_done;
-                obj_op[wl_output_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       3] = &&wl_output_scale;
-                obj_op[wl_output_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       4] = &&wl_output_name;
-                obj_op[wl_output_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       5] = &&wl_output_description;
-                new_id++;
-            } else if (strcmp(iname, "wl_seat") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                wl_seat_id = new_id;
-                obj_op[wl_seat_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&wl_seat_capabilities;
-                obj_op[wl_seat_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       1] = &&wl_seat_name;
-                new_id++;
-            } else if (strcmp(iname, "zwp_linux_dmabuf_v1") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                zwp_linux_dmabuf_v1_id = new_id;
-                obj_op[zwp_linux_dmabuf_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&zwp_linux_dmabuf_v1_format;
-                obj_op[zwp_linux_dmabuf_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       1] = &&zwp_linux_dmabuf_v1_modifier;
-                new_id++;
-            } else if (strcmp(iname, "xdg_wm_base") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                xdg_wm_base_id = new_id;
-                obj_op[xdg_wm_base_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&xdg_wm_base_ping;
-                new_id++;
-            } else if (strcmp(iname, "wp_linux_drm_syncobj_manager_v1") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                wp_linux_drm_syncobj_manager_v1_id = new_id;
-                obj_op[wp_linux_drm_syncobj_manager_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&wp_linux_drm_syncobj_manager_v1_jump;
-                new_id++;
-            } else if (strcmp(iname, "zwp_idle_inhibit_manager_v1") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                zwp_idle_inhibit_manager_v1_id = new_id;
-                obj_op[zwp_idle_inhibit_manager_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&zwp_idle_inhibit_manager_v1_jump;
-                new_id++;
-            } else if (strcmp(iname, "zxdg_decoration_manager_v1") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                zxdg_decoration_manager_v1_id = new_id;
-                obj_op[zxdg_decoration_manager_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&zxdg_decoration_manager_v1_jump;
-                new_id++;
-            } else if (strcmp(iname, "zwp_relative_pointer_manager_v1") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                zwp_relative_pointer_manager_v1_id = new_id;
-                obj_op[zwp_relative_pointer_manager_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&zwp_relative_pointer_manager_v1_jump;
-                new_id++;
-            } else if (strcmp(iname, "zwp_pointer_constraints_v1") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                zwp_pointer_constraints_v1_id = new_id;
-                obj_op[zwp_pointer_constraints_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&zwp_pointer_constraints_v1_jump;
-                new_id++;
-            } else if (strcmp(iname, "zwlr_output_manager_v1") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                zwlr_output_manager_v1_id = new_id;
-                obj_op[zwlr_output_manager_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&zwlr_output_manager_v1_head;
-                obj_op[zwlr_output_manager_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       1] = &&zwlr_output_manager_v1_done;
-                new_id++;
-            } else if (strcmp(iname, "zwlr_data_control_manager_v1") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                zwlr_data_control_manager_v1_id = new_id;
-                obj_op[zwlr_data_control_manager_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+            cursor_color = cursor_color_transparent;
+            break;
+        }
+        if (ctx_fsm->current_mode == ctx_fsm->MODE_ROLL &&
+            ctx_fsm->current_mode != ctx_fsm->MODE_COMMAND &&
+            !ctx_wr->cursor_blinking) {
+            war_make_quad(
+                transparent_quad_instances,
+                &transparent_quad_instances_count,
+                quads_max,
+                (float[3]){ctx_wr->cursor_pos_x +
+                               (float)ctx_wr->sub_col /
+                                   ctx_wr->navigation_sub_cells_col,
+                           ctx_wr->cursor_pos_y,
+                           ctx_wr->layers[LAYER_CURSOR]},
+                (float[2]){(float)ctx_wr->cursor_size_x, 1},
+                cursor_color,
+                0,
+                0,
+                (float[2]){0.0f, 0.0f},
+                QUAD_GRID);
+        } else if (ctx_fsm->current_mode == ctx_fsm->MODE_VIEWS) {
+            // draw views
+            uint32_t offset_col = ctx_wr->left_col +
+                                  ((ctx_wr->viewport_cols +
+                                    ctx_wr->num_cols_for_line_numbers - 1) /
+                                       2 -
+                                   views->warpoon_viewport_cols / 2);
+            uint32_t offset_row = ctx_wr->bottom_row +
+                                  ((ctx_wr->viewport_rows +
+                                    ctx_wr->num_rows_for_status_bars - 1) /
+                                       2 -
+                                   views->warpoon_viewport_rows / 2);
+            // draw views background
+            war_make_quad(
+                quad_instances,
+                &quad_instances_count,
+                quads_max,
+                (float[3]){offset_col,
+                           offset_row,
+                           ctx_wr->layers[LAYER_POPUP_BACKGROUND]},
+                (float[2]){views->warpoon_viewport_cols,
+                           views->warpoon_viewport_rows},
+                views->warpoon_color_bg,
+                ctx_wr->outline_thickness,
+                views->warpoon_color_outline,
+                (float[2]){0.0f, 0.0f},
+                QUAD_OUTLINE);
+            // draw views gutter
+            war_make_quad(quad_instances,
+                          &quad_instances_count,
+                          quads_max,
+                          (float[3]){offset_col,
+                                     offset_row,
+                                     ctx_wr->layers[LAYER_POPUP_HUD]},
+                          (float[2]){views->warpoon_hud_cols,
+                                     views->warpoon_viewport_rows},
+                          views->warpoon_color_hud,
+                          ctx_wr->outline_thickness,
+                          views->warpoon_color_outline,
+                          (float[2]){0.0f, 0.0f},
+                          QUAD_OUTLINE);
+            // draw views cursor
+            if (!ctx_wr->cursor_blinking &&
+                ctx_fsm->current_mode != ctx_fsm->MODE_COMMAND) {
+                uint32_t cursor_span_x = 1;
+                uint32_t cursor_pos_x = views->warpoon_col;
+                if (views->warpoon_state == WARPOON_STATE_VISUAL_LINE) {
+                    cursor_span_x = views->warpoon_viewport_cols -
+                                    views->warpoon_hud_cols;
+                    cursor_pos_x = 0;
+                }
+                float alpha_factor = ctx_wr->alpha_scale;
+                uint8_t color_alpha = (cursor_color >> 24) & 0xFF;
+                cursor_color =
+                    ((uint8_t)(color_alpha * alpha_factor) << 24) |
+                    (cursor_color & 0x00FFFFFF);
+                war_make_quad(
+                    quad_instances,
+                    &quad_instances_count,
+                    quads_max,
+                    (float[3]){offset_col + views->warpoon_hud_cols +
+                                   cursor_pos_x - views->warpoon_left_col,
+                               offset_row + views->warpoon_hud_rows +
+                                   views->warpoon_row -
+                                   views->warpoon_bottom_row,
+                               ctx_wr->layers[LAYER_POPUP_CURSOR]},
+                    (float[2]){cursor_span_x, 1},
+                    cursor_color_transparent,
+                    0,
+                    0,
+                    (float[2]){0.0f, 0.0f},
+                    0);
+            }
+            // draw views line numbers text
+            int number = views->warpoon_max_row - views->warpoon_top_row +
+                         views->warpoon_viewport_rows;
+            for (uint32_t row = views->warpoon_bottom_row;
+                 row <= views->warpoon_top_row;
+                 row++, number--) {
+                uint32_t digits[2];
+                digits[0] = (number / 10) % 10;
+                digits[1] = number % 10;
+                int digit_count = 2;
+                if (digits[0] == 0) { digit_count--; }
+                for (int col = 2; col > 2 - digit_count; col--) {
+                    war_make_text_quad(
+                        text_vertices,
+                        text_indices,
+                        &text_vertices_count,
+                        &text_indices_count,
+                        text_quads_budget,
+                        (float[3]){offset_col + col - 1,
+                                   offset_row + row -
+                                       views->warpoon_bottom_row +
+                                       views->warpoon_hud_rows,
+                                   ctx_wr->layers[LAYER_POPUP_HUD_TEXT]},
+                        (float[2]){1, 1},
+                        views->warpoon_color_hud_text,
+                        &ctx_vk->glyphs['0' + digits[col - 1]],
+                        ctx_wr->text_thickness,
+                        ctx_wr->text_feather,
+                        0);
+                }
+            }
+            // draw views text
+            war_get_warpoon_text(views);
+            uint32_t row = views->warpoon_max_row;
+            for (uint32_t i_views = 0; i_views < views->views_count;
+                 i_views++, row--) {
+                if (row > views->warpoon_top_row ||
+                    row < views->warpoon_bottom_row) {
+                    continue;
+                }
+                for (uint32_t col = 0;
+                     col <= views->warpoon_right_col &&
+                     views->warpoon_text[i_views][col] != '\0';
+                     col++) {
+                    war_make_text_quad(
+                        text_vertices,
+                        text_indices,
+                        &text_vertices_count,
+                        &text_indices_count,
+                        text_quads_budget,
+                        (float[3]){offset_col + views->warpoon_hud_cols +
+                                       col,
+                                   offset_row + views->warpoon_hud_rows +
+                                       row - views->warpoon_bottom_row,
+                                   ctx_wr->layers[LAYER_POPUP_CURSOR]},
+                        (float[2]){1, 1},
+                        views->warpoon_color_text,
+                        &ctx_vk->glyphs[(int)views
+                                            ->warpoon_text[i_views][col]],
+                        ctx_wr->text_thickness,
+                        ctx_wr->text_feather,
+                        0);
+                }
+            }
+        }
+        if (ctx_fsm->current_mode == ctx_fsm->MODE_COMMAND) {
+            war_make_quad(
+                transparent_quad_instances,
+                &transparent_quad_instances_count,
+                quads_max,
+                (float[3]){ctx_wr->left_col +
+                               ctx_command->text_write_index +
+                               ctx_command->prompt_text_size + 1,
+                           ctx_wr->bottom_row + 1,
+                           ctx_wr->layers[LAYER_CURSOR]},
+                (float[2]){(float)ctx_wr->cursor_size_x, 1},
+                cursor_color,
+                0,
+                0,
+                (float[2]){0.0f, 0.0f},
+                0);
+        }
+        // draw frame timings background, right aligned on the top row
+        uint32_t timing_cols = 0;
+        if (ctx_wr->timing_overlay) {
+            timing_cols = strlen(ctx_wr->timing_text);
+            if (timing_cols > ctx_wr->viewport_cols) {
+                timing_cols = ctx_wr->viewport_cols;
+            }
+        }
+        uint32_t timing_col = ctx_wr->viewport_cols - timing_cols;
+        if (timing_cols) {
+            war_make_quad(
+                quad_instances,
+                &quad_instances_count,
+                quads_max,
+                (float[3]){ctx_wr->left_col + timing_col,
+                           ctx_wr->top_row +
+                               ctx_wr->num_rows_for_status_bars,
+                           ctx_wr->layers[LAYER_POPUP_BACKGROUND]},
+                (float[2]){timing_cols, 1},
+                ctx_wr->black_hex,
+                0,
+                0,
+                (float[2]){0.0f, 0.0f},
+                0);
+        }
+        // draw playback bar
+        uint32_t playback_bar_color = ctx_wr->red_hex;
+        float span_y = ctx_wr->viewport_rows;
+        if (ctx_wr->top_row == atomic_load(&ctx_lua->A_NOTE_COUNT) - 1) {
+            span_y -= ctx_wr->num_rows_for_status_bars;
+        }
+        war_make_quad(
+            quad_instances,
+            &quad_instances_count,
+            quads_max,
+            (float[3]){ctx_wr->playback_bar_pos_x,
+                       ctx_wr->bottom_row,
+                       ctx_wr->layers[LAYER_PLAYBACK_BAR]},
+            (float[2]){0, span_y},
+            playback_bar_color,
+            0,
+            0,
+            (float[2]){default_playback_bar_thickness, 0.0f},
+            QUAD_LINE | QUAD_GRID);
+        // opaque instances then transparent ones, one upload for both
+        // into this frame's region
+        if (quad_instances_count + transparent_quad_instances_count >
+            max_quads) {
+            transparent_quad_instances_count =
+                quad_instances_count < max_quads ?
+                    max_quads - quad_instances_count :
+                    0;
+            if (quad_instances_count > max_quads) {
+                quad_instances_count = max_quads;
+            }
+        }
+        VkDeviceSize quad_instances_offset =
+            sizeof(war_quad_instance) * max_quads * frame;
+        war_quad_instance* mapped_instances =
+            (war_quad_instance*)ctx_vk->quads_instance_buffer_mapped +
+            max_quads * frame;
+        memcpy(mapped_instances,
+               quad_instances,
+               sizeof(war_quad_instance) * quad_instances_count);
+        memcpy(mapped_instances + quad_instances_count,
+               transparent_quad_instances,
+               sizeof(war_quad_instance) *
+                   transparent_quad_instances_count);
+        VkMappedMemoryRange quad_flush_range = {
+            .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+            .memory = ctx_vk->quads_instance_buffer_memory,
+            .offset = quad_instances_offset,
+            .size = war_align64(
+                sizeof(war_quad_instance) *
+                (quad_instances_count + transparent_quad_instances_count)),
+        };
+        vkFlushMappedMemoryRanges(ctx_vk->device, 1, &quad_flush_range);
+        war_quad_push_constants quad_push_constants = {
+            .bottom_left = {ctx_wr->left_col, ctx_wr->bottom_row},
+            .physical_size = {physical_width, physical_height},
+            .cell_size = {ctx_wr->cell_width, ctx_wr->cell_height},
+            .zoom = ctx_wr->zoom_scale,
+            .mute_alpha = ctx_wr->alpha_scale,
+            .cell_offsets = {ctx_wr->num_cols_for_line_numbers,
+                             ctx_wr->num_rows_for_status_bars},
+            .scroll_margin = {ctx_wr->scroll_margin_cols,
+                              ctx_wr->scroll_margin_rows},
+            .anchor_cell = {ctx_wr->cursor_pos_x, ctx_wr->cursor_pos_y},
+            .top_right = {ctx_wr->right_col, ctx_wr->top_row},
+        };
+        vkCmdPushConstants(cmd_buffer,
+                           ctx_vk->pipeline_layout,
+                           VK_SHADER_STAGE_VERTEX_BIT,
+                           0,
+                           sizeof(war_quad_push_constants),
+                           &quad_push_constants);
+        // the notes that survived culling first
+        VkDeviceSize note_instances_offset = 0;
+        vkCmdBindVertexBuffers(cmd_buffer,
+                               0,
+                               1,
+                               &ctx_vk->note_visible_buffer,
+                               &note_instances_offset);
+        vkCmdDrawIndirect(cmd_buffer,
+                          ctx_vk->note_draw_buffer,
+                          0,
+                          1,
+                          sizeof(VkDrawIndirectCommand));
+        vkCmdBindVertexBuffers(cmd_buffer,
+                               0,
+                               1,
+                               &ctx_vk->quads_instance_buffer,
+                               &quad_instances_offset);
+        vkCmdDraw(cmd_buffer, 6, quad_instances_count, 0, 0);
+        // draw transparent quads
+        vkCmdBindPipeline(cmd_buffer,
+                          VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          ctx_vk->transparent_quad_pipeline);
+        vkCmdDraw(cmd_buffer,
+                  6,
+                  transparent_quad_instances_count,
+                  0,
+                  quad_instances_count);
+        war_frame_timestamp(ctx_vk, cmd_buffer, frame, TIMESTAMP_QUADS);
+        //---------------------------------------------------------
+        // TEXT PIPELINE
+        //---------------------------------------------------------
+        vkCmdBindPipeline(cmd_buffer,
+                          VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          ctx_vk->text_pipeline);
+        vkCmdBindDescriptorSets(cmd_buffer,
+                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                ctx_vk->text_pipeline_layout,
+                                0,
+                                1,
+                                &ctx_vk->font_descriptor_set,
+                                0,
+                                NULL);
+        //---------------------------------------------------------
+        // HUD TEXT
+        //---------------------------------------------------------
+        // status, piano and line number text only moves with the
+        // viewport, so each frame keeps what it built last time
+        uint32_t status_cols = (uint32_t)fminf(ctx_wr->viewport_cols,
+                                               (float)ctx_status->capacity);
+        if (status_cols > max_hud_text_quads / (2 * NUM_STATUS_BARS)) {
+            status_cols = max_hud_text_quads / (2 * NUM_STATUS_BARS);
+        }
+        uint32_t hud_top_row = ctx_wr->top_row;
+        uint32_t hud_rows_max =
+            (max_hud_text_quads - NUM_STATUS_BARS * status_cols) / 3;
+        if (hud_top_row >= ctx_wr->bottom_row + hud_rows_max) {
+            hud_top_row = ctx_wr->bottom_row + hud_rows_max - 1;
+        }
+        war_hud_key hud_key;
+        memset(&hud_key, 0, sizeof(war_hud_key));
+        hud_key.left_col = ctx_wr->left_col;
+        hud_key.bottom_row = ctx_wr->bottom_row;
+        hud_key.top_row = hud_top_row;
+        hud_key.status_cols = status_cols;
+        hud_key.num_rows_for_status_bars = ctx_wr->num_rows_for_status_bars;
+        hud_key.hud_state = ctx_wr->hud_state;
+        hud_key.status_hash = war_status_hash(ctx_wr, ctx_status);
+        hud_key.text_thickness = ctx_wr->text_thickness;
+        hud_key.text_feather = ctx_wr->text_feather;
+        hud_key.text_thickness_bold = ctx_wr->text_thickness_bold;
+        hud_key.text_feather_bold = ctx_wr->text_feather_bold;
+        hud_key.built = 1;
+        uint32_t hud_first_quad = max_text_quads - max_hud_text_quads;
+        if (memcmp(&hud_key,
+                   &ctx_vk->hud_text_keys[frame],
+                   sizeof(war_hud_key)) != 0) {
+            VkDeviceSize hud_vertices_offset =
+                sizeof(war_text_vertex) * 4 *
+                (max_text_quads * frame + hud_first_quad);
+            VkDeviceSize hud_indices_offset =
+                sizeof(uint32_t) * 6 *
+                (max_text_quads * frame + hud_first_quad);
+            uint8_t* hud_vertices_mapped =
+                (uint8_t*)ctx_vk->text_vertex_buffer_mapped;
+            uint8_t* hud_indices_mapped =
+                (uint8_t*)ctx_vk->text_index_buffer_mapped;
+            war_text_vertex* hud_vertices =
+                (war_text_vertex*)(hud_vertices_mapped +
+                                   hud_vertices_offset);
+            uint32_t* hud_indices =
+                (uint32_t*)(hud_indices_mapped + hud_indices_offset);
+            uint32_t hud_vertices_count = 0;
+            uint32_t hud_indices_count = 0;
+            for (uint32_t col = 0; col < status_cols; col++) {
+                if (ctx_status->top[(int)col] != 0) {
+                    war_make_text_quad(
+                        hud_vertices,
+                        hud_indices,
+                        &hud_vertices_count,
+                        &hud_indices_count,
+                        max_hud_text_quads,
+                        (float[3]){col + ctx_wr->left_col,
+                                   2 + ctx_wr->bottom_row,
+                                   ctx_wr->layers[LAYER_HUD_TEXT]},
+                        (float[2]){1, 1},
+                        ctx_wr->white_hex,
+                        &ctx_vk->glyphs[(int)ctx_status->top[(int)col]],
+                        ctx_wr->text_thickness,
+                        ctx_wr->text_feather,
+                        0);
+                }
+                if (ctx_status->middle[(int)col] != 0) {
+                    war_make_text_quad(
+                        hud_vertices,
+                        hud_indices,
+                        &hud_vertices_count,
+                        &hud_indices_count,
+                        max_hud_text_quads,
+                        (float[3]){col + ctx_wr->left_col,
+                                   1 + ctx_wr->bottom_row,
+                                   ctx_wr->layers[LAYER_HUD_TEXT]},
+                        (float[2]){1, 1},
+                        ctx_wr->red_hex,
+                        &ctx_vk->glyphs[(int)ctx_status->middle[(int)col]],
+                        ctx_wr->text_thickness_bold,
+                        ctx_wr->text_feather_bold,
+                        0);
+                }
+                if (ctx_status->bottom[(int)col] != 0) {
+                    war_make_text_quad(
+                        hud_vertices,
+                        hud_indices,
+                        &hud_vertices_count,
+                        &hud_indices_count,
+                        max_hud_text_quads,
+                        (float[3]){col + ctx_wr->left_col,
+                                   ctx_wr->bottom_row,
+                                   ctx_wr->layers[LAYER_HUD_TEXT]},
+                        (float[2]){1, 1},
+                        ctx_wr->full_white_hex,
+                        &ctx_vk->glyphs[(int)ctx_status->bottom[(int)col]],
+                        ctx_wr->text_thickness,
+                        ctx_wr->text_feather,
+                        0);
+                }
+            }
+            // draw piano text
+            char* piano_notes[12] = {"C",
+                                     "C#",
+                                     "D",
+                                     "D#",
+                                     "E",
+                                     "F",
+                                     "F#",
+                                     "G",
+                                     "G#",
+                                     "A",
+                                     "A#",
+                                     "B"};
+            for (uint32_t row = ctx_wr->bottom_row;
+                 row <= hud_top_row &&
+                 ctx_wr->hud_state != HUD_LINE_NUMBERS;
+                 row++) {
+                uint32_t i_piano_notes = row % 12;
+                if (i_piano_notes == 1 || i_piano_notes == 3 ||
+                    i_piano_notes == 6 || i_piano_notes == 8 ||
+                    i_piano_notes == 10) {
+                    continue;
+                }
+                int octave = row / 12 - 1;
+                if (octave < 0) { octave = '-' - '0'; }
+                war_make_text_quad(
+                    hud_vertices,
+                    hud_indices,
+                    &hud_vertices_count,
+                    &hud_indices_count,
+                    max_hud_text_quads,
+                    (float[3]){1 + ctx_wr->left_col,
+                               row + ctx_wr->num_rows_for_status_bars,
+                               ctx_wr->layers[LAYER_HUD_TEXT]},
+                    (float[2]){1, 1},
+                    ctx_wr->black_hex,
+                    &ctx_vk->glyphs[piano_notes[i_piano_notes][0]],
+                    ctx_wr->text_thickness,
+                    ctx_wr->text_feather,
+                    0);
+                war_make_text_quad(
+                    hud_vertices,
+                    hud_indices,
+                    &hud_vertices_count,
+                    &hud_indices_count,
+                    max_hud_text_quads,
+                    (float[3]){2 + ctx_wr->left_col,
+                               row + ctx_wr->num_rows_for_status_bars,
+                               ctx_wr->layers[LAYER_HUD_TEXT]},
+                    (float[2]){1, 1},
+                    ctx_wr->black_hex,
+                    &ctx_vk->glyphs['0' + octave],
+                    ctx_wr->text_thickness,
+                    ctx_wr->text_feather,
+                    0);
+            }
+            // draw line number text
+            int ln_offset =
+                (ctx_wr->hud_state == HUD_LINE_NUMBERS) ? 0 : 3;
+            for (uint32_t row = ctx_wr->bottom_row;
+                 row <= hud_top_row && ctx_wr->hud_state != HUD_PIANO;
+                 row++) {
+                uint32_t digits[3];
+                digits[0] = (row / 100) % 10;
+                digits[1] = (row / 10) % 10;
+                digits[2] = row % 10;
+                int digit_count = 3;
+                if (digits[0] == 0) {
+                    digit_count = (digits[1] == 0) ? (digit_count - 2) :
+                                                     (digit_count - 1);
+                }
+                for (int col = ln_offset + 2;
+                     col > (ln_offset + 2) - digit_count;
+                     col--) {
+                    war_make_text_quad(
+                        hud_vertices,
+                        hud_indices,
+                        &hud_vertices_count,
+                        &hud_indices_count,
+                        max_hud_text_quads,
+                        (float[3]){ctx_wr->left_col + col,
+                                   row + ctx_wr->num_rows_for_status_bars,
+                                   ctx_wr->layers[LAYER_HUD_TEXT]},
+                        (float[2]){1, 1},
+                        ctx_wr->full_white_hex,
+                        &ctx_vk->glyphs['0' + digits[col - ln_offset]],
+                        ctx_wr->text_thickness,
+                        ctx_wr->text_feather,
+                        0);
+                }
+            }
+            // flush ranges must start and end on nonCoherentAtomSize
+            VkDeviceSize hud_vertices_flush_offset =
+                war_align_down64(hud_vertices_offset);
+            VkDeviceSize hud_indices_flush_offset =
+                war_align_down64(hud_indices_offset);
+            VkMappedMemoryRange hud_flush_ranges[2] = {
+                {.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                 .memory = ctx_vk->text_vertex_buffer_memory,
+                 .offset = hud_vertices_flush_offset,
+                 .size = war_align64(hud_vertices_offset +
+                                     sizeof(war_text_vertex) *
+                                         hud_vertices_count) -
+                         hud_vertices_flush_offset},
+                {.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                 .memory = ctx_vk->text_index_buffer_memory,
+                 .offset = hud_indices_flush_offset,
+                 .size = war_align64(hud_indices_offset +
+                                     sizeof(uint32_t) * hud_indices_count) -
+                         hud_indices_flush_offset}};
+            vkFlushMappedMemoryRanges(
+                ctx_vk->device, 2, hud_flush_ranges);
+            memcpy(&ctx_vk->hud_text_keys[frame],
+                   &hud_key,
+                   sizeof(war_hud_key));
+            ctx_vk->hud_text_indices_count[frame] = hud_indices_count;
+        }
+        // draw frame timings text
+        for (uint32_t i = 0;
+             i < timing_cols && ctx_wr->timing_text[i] != '\0';
+             i++) {
+            war_make_text_quad(
+                text_vertices,
+                text_indices,
+                &text_vertices_count,
+                &text_indices_count,
+                text_quads_budget,
+                (float[3]){ctx_wr->left_col + timing_col + i,
+                           ctx_wr->top_row +
+                               ctx_wr->num_rows_for_status_bars,
+                           ctx_wr->layers[LAYER_POPUP_HUD_TEXT]},
+                (float[2]){1, 1},
+                ctx_wr->full_white_hex,
+                &ctx_vk->glyphs[(int)ctx_wr->timing_text[i]],
+                ctx_wr->text_thickness,
+                ctx_wr->text_feather,
+                0);
+        }
+        VkDeviceSize text_vertices_offset =
+            sizeof(war_text_vertex) * max_text_quads * 4 * frame;
+        VkDeviceSize text_indices_offset =
+            sizeof(uint32_t) * max_text_quads * 6 * frame;
+        memcpy((uint8_t*)ctx_vk->text_vertex_buffer_mapped +
+                   text_vertices_offset,
+               text_vertices,
+               sizeof(war_text_vertex) * text_vertices_count);
+        memcpy((uint8_t*)ctx_vk->text_index_buffer_mapped +
+                   text_indices_offset,
+               text_indices,
+               sizeof(uint32_t) * text_indices_count);
+        VkMappedMemoryRange text_flush_ranges[2] = {
+            {.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+             .memory = ctx_vk->text_vertex_buffer_memory,
+             .offset = text_vertices_offset,
+             .size = war_align64(sizeof(war_text_vertex) *
+                                 text_vertices_count)},
+            {.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+             .memory = ctx_vk->text_index_buffer_memory,
+             .offset = text_indices_offset,
+             .size = war_align64(sizeof(uint32_t) * text_indices_count)}};
+        vkFlushMappedMemoryRanges(ctx_vk->device, 2, text_flush_ranges);
+        VkDeviceSize text_vertices_offsets[2] = {text_vertices_offset};
+        vkCmdBindVertexBuffers(cmd_buffer,
+                               0,
+                               1,
+                               &ctx_vk->text_vertex_buffer,
+                               text_vertices_offsets);
+        VkDeviceSize text_instances_offsets[2] = {0};
+        vkCmdBindVertexBuffers(cmd_buffer,
+                               1,
+                               1,
+                               &ctx_vk->text_instance_buffer,
+                               text_instances_offsets);
+        vkCmdBindIndexBuffer(cmd_buffer,
+                             ctx_vk->text_index_buffer,
+                             text_indices_offset,
+                             VK_INDEX_TYPE_UINT32);
+        war_text_push_constants text_push_constants = {
+            .bottom_left = {ctx_wr->left_col, ctx_wr->bottom_row},
+            .physical_size = {physical_width, physical_height},
+            .cell_size = {ctx_wr->cell_width, ctx_wr->cell_height},
+            .zoom = ctx_wr->zoom_scale,
+            .cell_offsets = {ctx_wr->num_cols_for_line_numbers,
+                             ctx_wr->num_rows_for_status_bars},
+            .scroll_margin = {ctx_wr->scroll_margin_cols,
+                              ctx_wr->scroll_margin_rows},
+            .anchor_cell = {ctx_wr->cursor_pos_x, ctx_wr->cursor_pos_y},
+            .top_right = {ctx_wr->right_col, ctx_wr->top_row},
+            .ascent = ctx_vk->ascent,
+            .descent = ctx_vk->descent,
+            .line_gap = ctx_vk->line_gap,
+            .baseline = ctx_vk->baseline,
+            .font_height = ctx_vk->font_height,
+        };
+        vkCmdPushConstants(cmd_buffer,
+                           ctx_vk->text_pipeline_layout,
+                           VK_SHADER_STAGE_VERTEX_BIT,
+                           0,
+                           sizeof(war_text_push_constants),
+                           &text_push_constants);
+        vkCmdDrawIndexed(
+            cmd_buffer, text_indices_count, 1, 0, 0, 0);
+        if (ctx_vk->hud_text_indices_count[frame]) {
+            vkCmdDrawIndexed(cmd_buffer,
+                             ctx_vk->hud_text_indices_count[frame],
+                             1,
+                             hud_first_quad * 6,
+                             hud_first_quad * 4,
+                             0);
+        }
+        war_frame_timestamp(ctx_vk, cmd_buffer, frame, TIMESTAMP_TEXT);
+        //---------------------------------------------------------
+        //   END RENDER PASS
+        //---------------------------------------------------------
+        vkCmdEndRenderPass(cmd_buffer);
+        result = vkEndCommandBuffer(cmd_buffer);
+        assert(result == VK_SUCCESS);
+        VkSubmitInfo submit_info = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &cmd_buffer,
+            .waitSemaphoreCount = 0,
+            .pWaitSemaphores = NULL,
+            .signalSemaphoreCount = 0,
+            .pSignalSemaphores = NULL,
+        };
+        result = vkQueueSubmit(ctx_vk->queue,
+                               1,
+                               &submit_info,
+                               ctx_vk->in_flight_fences[frame]);
+        assert(result == VK_SUCCESS);
+        uint64_t record_end_us = war_get_monotonic_time_us();
+        stats->build_us = (float)(record_end_us - record_uploaded_us);
+        ctx_wr->present = 1;
+        // war_wayland_holy_trinity(fd,
+        //                          wl_surface_id,
+        //                          wl_buffer_id,
+        //                          0,
+        //                          0,
+        //                          0,
+        //                          0,
+        //                          physical_width,
+        //                          physical_height);
+    }
+render_done:
+    //---------------------------------------------------------------------
+    // WAYLAND MESSAGE PARSING
+    //---------------------------------------------------------------------
+    // sleep until the play writer, capture reader, frame tick, paced record
+    // or paced commit is due instead of spinning, wayland events still wake
+    // it right away
+    uint64_t wake_us = last_frame_time + ctx_wr->frame_duration_us;
+    if (ctx_play->last_frame_time + ctx_play->rate_us < wake_us) {
+        wake_us = ctx_play->last_frame_time + ctx_play->rate_us;
+    }
+    if (ctx_capture->last_frame_time + ctx_capture->rate_us < wake_us) {
+        wake_us = ctx_capture->last_frame_time + ctx_capture->rate_us;
+    }
+    if (ctx_wr->frame_callback && ctx_wr->record_at_us < wake_us) {
+        wake_us = ctx_wr->record_at_us;
+    }
+    if (ctx_wr->present && ctx_wr->present_at_us &&
+        ctx_wr->present_at_us - ctx_wr->present_lead_us < wake_us) {
+        wake_us = ctx_wr->present_at_us - ctx_wr->present_lead_us;
+    }
+    uint64_t poll_now_us = war_get_monotonic_time_us();
+    uint64_t poll_timeout_us =
+        wake_us > poll_now_us ? wake_us - poll_now_us : 0;
+    // microseconds, poll's milliseconds would miss a paced deadline
+    struct timespec poll_timeout = {
+        .tv_sec = poll_timeout_us / 1000000,
+        .tv_nsec = (poll_timeout_us % 1000000) * 1000,
+    };
+    int ret = ppoll(&pfd, 1, &poll_timeout, NULL);
+    assert(ret >= 0);
+    // if (ret == 0) { call_terry_davis("timeout"); }
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        call_terry_davis("wayland socket error or hangup: %s", strerror(errno));
+        goto end_wr;
+    }
+    if (pfd.revents & POLLIN) {
+        uint64_t wayland_start_us = war_get_monotonic_time_us();
+        struct msghdr poll_msg_hdr = {0};
+        struct iovec poll_iov;
+        poll_iov.iov_base = msg_buffer + msg_buffer_size;
+        poll_iov.iov_len =
+            atomic_load(&ctx_lua->WR_WAYLAND_MSG_BUFFER_SIZE) - msg_buffer_size;
+        poll_msg_hdr.msg_iov = &poll_iov;
+        poll_msg_hdr.msg_iovlen = 1;
+        char poll_ctrl_buf[CMSG_SPACE(sizeof(int) * 4)];
+        poll_msg_hdr.msg_control = poll_ctrl_buf;
+        poll_msg_hdr.msg_controllen = sizeof(poll_ctrl_buf);
+        ssize_t size_read = recvmsg(fd, &poll_msg_hdr, 0);
+        assert(size_read > 0);
+        msg_buffer_size += size_read;
+        size_t msg_buffer_offset = 0;
+        while (msg_buffer_size - msg_buffer_offset >= 8) {
+            uint16_t size = war_read_le16(msg_buffer + msg_buffer_offset + 6);
+            if ((size < 8) || (size > (msg_buffer_size - msg_buffer_offset))) {
+                break;
+            };
+            uint32_t object_id = war_read_le32(msg_buffer + msg_buffer_offset);
+            uint16_t opcode = war_read_le16(msg_buffer + msg_buffer_offset + 4);
+            if (object_id >=
+                    (uint32_t)atomic_load(&ctx_lua->WR_WAYLAND_MAX_OBJECTS) ||
+                opcode >=
+                    (uint16_t)atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES)) {
+                // COMMENT CONCERN: INVALID OBJECT/OP 27 TIMES!
+                // call_terry_davis(
+                //    "invalid object/op: id=%u, op=%u", object_id,
+                //    opcode);
+                goto wayland_done;
+            }
+            size_t idx =
+                object_id * atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                opcode;
+            if (obj_op[idx]) { goto* obj_op[idx]; }
+            goto wayland_default;
+        wl_registry_global:
+            dump_bytes("global event", msg_buffer + msg_buffer_offset, size);
+            call_terry_davis("iname: %s",
+                             (const char*)msg_buffer + msg_buffer_offset + 16);
+
+            const char* iname = (const char*)msg_buffer + msg_buffer_offset +
+                                16; // COMMENT OPTIMIZE: perfect hash
+            if (strcmp(iname, "wl_compositor") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                wl_compositor_id = new_id;
+                obj_op[wl_compositor_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&wl_compositor_jump;
+                new_id++;
+            } else if (strcmp(iname, "wl_output") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                wl_output_id = new_id;
+                obj_op[wl_output_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&wl_output_geometry;
+                obj_op[wl_output_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       1] = &&wl_output_mode;
+                obj_op[wl_output_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       2] = &&wl_output_done;
+                obj_op[wl_output_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       3] = &&wl_output_scale;
+                obj_op[wl_output_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       4] = &&wl_output_name;
+                obj_op[wl_output_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       5] = &&wl_output_description;
+                new_id++;
+            } else if (strcmp(iname, "wl_seat") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                wl_seat_id = new_id;
+                obj_op[wl_seat_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&wl_seat_capabilities;
+                obj_op[wl_seat_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       1] = &&wl_seat_name;
+                new_id++;
+            } else if (strcmp(iname, "zwp_linux_dmabuf_v1") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                zwp_linux_dmabuf_v1_id = new_id;
+                obj_op[zwp_linux_dmabuf_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&zwp_linux_dmabuf_v1_format;
+                obj_op[zwp_linux_dmabuf_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       1] = &&zwp_linux_dmabuf_v1_modifier;
+                new_id++;
+            } else if (strcmp(iname, "xdg_wm_base") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                xdg_wm_base_id = new_id;
+                obj_op[xdg_wm_base_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&xdg_wm_base_ping;
+                new_id++;
+            } else if (strcmp(iname, "wp_linux_drm_syncobj_manager_v1") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                wp_linux_drm_syncobj_manager_v1_id = new_id;
+                obj_op[wp_linux_drm_syncobj_manager_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&wp_linux_drm_syncobj_manager_v1_jump;
+                new_id++;
+            } else if (strcmp(iname, "zwp_idle_inhibit_manager_v1") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                zwp_idle_inhibit_manager_v1_id = new_id;
+                obj_op[zwp_idle_inhibit_manager_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&zwp_idle_inhibit_manager_v1_jump;
+                new_id++;
+            } else if (strcmp(iname, "zxdg_decoration_manager_v1") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                zxdg_decoration_manager_v1_id = new_id;
+                obj_op[zxdg_decoration_manager_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&zxdg_decoration_manager_v1_jump;
+                new_id++;
+            } else if (strcmp(iname, "zwp_relative_pointer_manager_v1") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                zwp_relative_pointer_manager_v1_id = new_id;
+                obj_op[zwp_relative_pointer_manager_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&zwp_relative_pointer_manager_v1_jump;
+                new_id++;
+            } else if (strcmp(iname, "zwp_pointer_constraints_v1") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                zwp_pointer_constraints_v1_id = new_id;
+                obj_op[zwp_pointer_constraints_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&zwp_pointer_constraints_v1_jump;
+                new_id++;
+            } else if (strcmp(iname, "zwlr_output_manager_v1") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                zwlr_output_manager_v1_id = new_id;
+                obj_op[zwlr_output_manager_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&zwlr_output_manager_v1_head;
+                obj_op[zwlr_output_manager_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       1] = &&zwlr_output_manager_v1_done;
+                new_id++;
+            } else if (strcmp(iname, "zwlr_data_control_manager_v1") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                zwlr_data_control_manager_v1_id = new_id;
+                obj_op[zwlr_data_control_manager_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
                        0] = &&zwlr_data_control_manager_v1_jump;
                 new_id++;
             } else if (strcmp(iname, "zwp_virtual_keyboard_manager_v1") == 0) {
@@ -1761,1091 +3311,207 @@ cmd_timeout_done:
                 wp_presentation_id = new_id;
                 obj_op[wp_presentation_id *
                            atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&wp_presentation_clock_id;
-                new_id++;
-            } else if (strcmp(iname, "zwlr_layer_shell_v1") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                zwlr_layer_shell_v1_id = new_id;
-                obj_op[zwlr_layer_shell_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&zwlr_layer_shell_v1_jump;
-                new_id++;
-            } else if (strcmp(iname, "ext_foreign_toplevel_list_v1") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                ext_foreign_toplevel_list_v1_id = new_id;
-                obj_op[ext_foreign_toplevel_list_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&ext_foreign_toplevel_list_v1_toplevel;
-                new_id++;
-            } else if (strcmp(iname, "wp_content_type_manager_v1") == 0) {
-                war_wayland_registry_bind(
-                    fd, msg_buffer, msg_buffer_offset, size, new_id);
-                wp_content_type_manager_v1_id = new_id;
-                obj_op[wp_content_type_manager_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&wp_content_type_manager_v1_jump;
-                new_id++;
-            }
-            if (!wl_surface_id && wl_compositor_id) {
-                uint8_t create_surface[12];
-                war_write_le32(create_surface, wl_compositor_id);
-                war_write_le16(create_surface + 4, 0);
-                war_write_le16(create_surface + 6, 12);
-                war_write_le32(create_surface + 8, new_id);
-                dump_bytes("create_surface request", create_surface, 12);
-                call_terry_davis("bound: wl_surface");
-                ssize_t create_surface_written = write(fd, create_surface, 12);
-                assert(create_surface_written == 12);
-                wl_surface_id = new_id;
-                obj_op[wl_surface_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&wl_surface_enter;
-                obj_op[wl_surface_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       1] = &&wl_surface_leave;
-                obj_op[wl_surface_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       2] = &&wl_surface_preferred_buffer_scale;
-                obj_op[wl_surface_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       3] = &&wl_surface_preferred_buffer_transform;
-                new_id++;
-            }
-            if (!wl_region_id && wl_surface_id && wl_compositor_id) {
-                uint8_t create_region[12];
-                war_write_le32(create_region, wl_compositor_id);
-                war_write_le16(create_region + 4, 1);
-                war_write_le16(create_region + 6, 12);
-                war_write_le32(create_region + 8, new_id);
-                dump_bytes("create_region request", create_region, 12);
-                call_terry_davis("bound: wl_region");
-                ssize_t create_region_written = write(fd, create_region, 12);
-                assert(create_region_written == 12);
-                wl_region_id = new_id;
-                new_id++;
-
-                uint8_t region_add[24];
-                war_write_le32(region_add, wl_region_id);
-                war_write_le16(region_add + 4, 1);
-                war_write_le16(region_add + 6, 24);
-                war_write_le32(region_add + 8, 0);
-                war_write_le32(region_add + 12, 0);
-                war_write_le32(region_add + 16, physical_width);
-                war_write_le32(region_add + 20, physical_height);
-                dump_bytes("wl_region::add request", region_add, 24);
-                ssize_t region_add_written = write(fd, region_add, 24);
-                assert(region_add_written == 24);
-
-                war_wl_surface_set_opaque_region(
-                    fd, wl_surface_id, wl_region_id);
-            }
-            if (!zwp_linux_dmabuf_feedback_v1_id && zwp_linux_dmabuf_v1_id &&
-                wl_surface_id) {
-                uint8_t get_surface_feedback[16];
-                war_write_le32(get_surface_feedback, zwp_linux_dmabuf_v1_id);
-                war_write_le16(get_surface_feedback + 4, 3);
-                war_write_le16(get_surface_feedback + 6, 16);
-                war_write_le32(get_surface_feedback + 8, new_id);
-                war_write_le32(get_surface_feedback + 12, wl_surface_id);
-                dump_bytes("zwp_linux_dmabuf_v1::get_surface_feedback request",
-                           get_surface_feedback,
-                           16);
-                call_terry_davis("bound: xdg_surface");
-                ssize_t get_surface_feedback_written =
-                    write(fd, get_surface_feedback, 16);
-                assert(get_surface_feedback_written == 16);
-                zwp_linux_dmabuf_feedback_v1_id = new_id;
-                obj_op[zwp_linux_dmabuf_feedback_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&zwp_linux_dmabuf_feedback_v1_done;
-                obj_op[zwp_linux_dmabuf_feedback_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       1] = &&zwp_linux_dmabuf_feedback_v1_format_table;
-                obj_op[zwp_linux_dmabuf_feedback_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       2] = &&zwp_linux_dmabuf_feedback_v1_main_device;
-                obj_op[zwp_linux_dmabuf_feedback_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       3] = &&zwp_linux_dmabuf_feedback_v1_tranche_done;
-                obj_op[zwp_linux_dmabuf_feedback_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       4] =
-                    &&zwp_linux_dmabuf_feedback_v1_tranche_target_device;
-                obj_op[zwp_linux_dmabuf_feedback_v1_id *
-                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       5] = &&zwp_linux_dmabuf_feedback_v1_tranche_formats;
-                obj_op[zwp_linux_dmabuf_feedback_v1_id *
+                       0] = &&wp_presentation_clock_id;
+                new_id++;
+            } else if (strcmp(iname, "zwlr_layer_shell_v1") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                zwlr_layer_shell_v1_id = new_id;
+                obj_op[zwlr_layer_shell_v1_id *
                            atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       6] = &&zwp_linux_dmabuf_feedback_v1_tranche_flags;
+                       0] = &&zwlr_layer_shell_v1_jump;
                 new_id++;
-            }
-            if (!xdg_surface_id && xdg_wm_base_id && wl_surface_id) {
-                uint8_t get_xdg_surface[16];
-                war_write_le32(get_xdg_surface, xdg_wm_base_id);
-                war_write_le16(get_xdg_surface + 4, 2);
-                war_write_le16(get_xdg_surface + 6, 16);
-                war_write_le32(get_xdg_surface + 8, new_id);
-                war_write_le32(get_xdg_surface + 12, wl_surface_id);
-                dump_bytes("get_xdg_surface request", get_xdg_surface, 16);
-                call_terry_davis("bound: xdg_surface");
-                ssize_t get_xdg_surface_written =
-                    write(fd, get_xdg_surface, 16);
-                assert(get_xdg_surface_written == 16);
-                xdg_surface_id = new_id;
-                obj_op[xdg_surface_id *
+            } else if (strcmp(iname, "ext_foreign_toplevel_list_v1") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                ext_foreign_toplevel_list_v1_id = new_id;
+                obj_op[ext_foreign_toplevel_list_v1_id *
                            atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&xdg_surface_configure;
+                       0] = &&ext_foreign_toplevel_list_v1_toplevel;
                 new_id++;
-                uint8_t get_toplevel[12];
-                war_write_le32(get_toplevel, xdg_surface_id);
-                war_write_le16(get_toplevel + 4, 1);
-                war_write_le16(get_toplevel + 6, 12);
-                war_write_le32(get_toplevel + 8, new_id);
-                dump_bytes("get_xdg_toplevel request", get_toplevel, 12);
-                call_terry_davis("bound: xdg_toplevel");
-                ssize_t get_toplevel_written = write(fd, get_toplevel, 12);
-                assert(get_toplevel_written == 12);
-                xdg_toplevel_id = new_id;
-                obj_op[xdg_toplevel_id *
+            } else if (strcmp(iname, "wp_content_type_manager_v1") == 0) {
+                war_wayland_registry_bind(
+                    fd, msg_buffer, msg_buffer_offset, size, new_id);
+                wp_content_type_manager_v1_id = new_id;
+                obj_op[wp_content_type_manager_v1_id *
                            atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&xdg_toplevel_configure;
-                obj_op[xdg_toplevel_id *
+                       0] = &&wp_content_type_manager_v1_jump;
+                new_id++;
+            }
+            if (!wl_surface_id && wl_compositor_id) {
+                uint8_t create_surface[12];
+                war_write_le32(create_surface, wl_compositor_id);
+                war_write_le16(create_surface + 4, 0);
+                war_write_le16(create_surface + 6, 12);
+                war_write_le32(create_surface + 8, new_id);
+                dump_bytes("create_surface request", create_surface, 12);
+                call_terry_davis("bound: wl_surface");
+                ssize_t create_surface_written = write(fd, create_surface, 12);
+                assert(create_surface_written == 12);
+                wl_surface_id = new_id;
+                obj_op[wl_surface_id *
                            atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       1] = &&xdg_toplevel_close;
-                obj_op[xdg_toplevel_id *
+                       0] = &&wl_surface_enter;
+                obj_op[wl_surface_id *
                            atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       2] = &&xdg_toplevel_configure_bounds;
-                obj_op[xdg_toplevel_id *
+                       1] = &&wl_surface_leave;
+                obj_op[wl_surface_id *
                            atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       3] = &&xdg_toplevel_wm_capabilities;
-                new_id++;
-            }
-            if (!zxdg_toplevel_decoration_v1_id && xdg_toplevel_id &&
-                zxdg_decoration_manager_v1_id) {
-                uint8_t get_toplevel_decoration[16];
-                war_write_le32(get_toplevel_decoration,
-                               zxdg_decoration_manager_v1_id);
-                war_write_le16(get_toplevel_decoration + 4, 1);
-                war_write_le16(get_toplevel_decoration + 6, 16);
-                war_write_le32(get_toplevel_decoration + 8, new_id);
-                war_write_le32(get_toplevel_decoration + 12, xdg_toplevel_id);
-                dump_bytes("get_toplevel_decoration request",
-                           get_toplevel_decoration,
-                           16);
-                call_terry_davis("bound: zxdg_toplevel_decoration_v1");
-                ssize_t get_toplevel_decoration_written =
-                    write(fd, get_toplevel_decoration, 16);
-                assert(get_toplevel_decoration_written == 16);
-                zxdg_toplevel_decoration_v1_id = new_id;
-                obj_op[zxdg_toplevel_decoration_v1_id *
+                       2] = &&wl_surface_preferred_buffer_scale;
+                obj_op[wl_surface_id *
                            atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                       0] = &&zxdg_toplevel_decoration_v1_configure;
+                       3] = &&wl_surface_preferred_buffer_transform;
                 new_id++;
-
-                //---------------------------------------------------------
-                // initial commit
-                //---------------------------------------------------------
-                war_wayland_wl_surface_commit(fd, wl_surface_id);
-            }
-            goto wayland_done;
-        wl_registry_global_remove:
-            dump_bytes("global_rm event", msg_buffer + msg_buffer_offset, size);
-            goto wayland_done;
-        wl_callback_done: {
-            //-------------------------------------------------------------
-            // RENDERING WITH VULKAN
-            //-------------------------------------------------------------
-            // dump_bytes("wl_callback::wayland_done event",
-            //           msg_buffer + msg_buffer_offset,
-            //           size);
-            assert(ctx_vk->current_frame == 0);
-            vkWaitForFences(ctx_vk->device,
-                            1,
-                            &ctx_vk->in_flight_fences[ctx_vk->current_frame],
-                            VK_TRUE,
-                            UINT64_MAX);
-            vkResetFences(ctx_vk->device,
-                          1,
-                          &ctx_vk->in_flight_fences[ctx_vk->current_frame]);
-            VkCommandBufferBeginInfo begin_info = {
-                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-            };
-            VkResult result =
-                vkBeginCommandBuffer(ctx_vk->cmd_buffer, &begin_info);
-            assert(result == VK_SUCCESS);
-            VkClearValue clear_values[2];
-            clear_values[0].color =
-                (VkClearColorValue){{0.1569f, 0.1569f, 0.1569f, 1.0f}};
-            clear_values[1].depthStencil = (VkClearDepthStencilValue){
-                ctx_wr->layers[LAYER_OPAQUE_REGION], 0.0f};
-            VkRenderPassBeginInfo render_pass_info = {
-                .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-                .renderPass = ctx_vk->render_pass,
-                .framebuffer = ctx_vk->frame_buffer,
-                .renderArea =
-                    {
-                        .offset = {0, 0},
-                        .extent = {physical_width, physical_height},
-                    },
-                .clearValueCount = 2,
-                .pClearValues = clear_values,
-            };
-            vkCmdBeginRenderPass(ctx_vk->cmd_buffer,
-                                 &render_pass_info,
-                                 VK_SUBPASS_CONTENTS_INLINE);
-            quad_vertices_count = 0;
-            quad_indices_count = 0;
-            transparent_quad_vertices_count = 0;
-            transparent_quad_indices_count = 0;
-            text_vertices_count = 0;
-            text_indices_count = 0;
-            //---------------------------------------------------------
-            // QUAD PIPELINE
-            //---------------------------------------------------------
-            vkCmdBindPipeline(ctx_vk->cmd_buffer,
-                              VK_PIPELINE_BIND_POINT_GRAPHICS,
-                              ctx_vk->quad_pipeline);
-            uint32_t cursor_color = ctx_wr->color_cursor;
-            float alpha_factor = ctx_wr->alpha_scale_cursor;
-            uint8_t color_alpha =
-                (ctx_wr->color_cursor_transparent >> 24) & 0xFF;
-            uint32_t cursor_color_transparent =
-                ((uint8_t)(color_alpha * alpha_factor) << 24) |
-                (ctx_wr->color_cursor_transparent & 0x00FFFFFF);
-            // draw note quads and figure out if cursor should be
-            // transparent
-            // TODO: spillover
-            for (uint32_t i = 0; i < note_quads->count; i++) {
-                if (note_quads->alive[i] == 0 || note_quads->hidden[i]) {
-                    continue;
-                }
-                double cursor_pos_x = ctx_wr->cursor_pos_x;
-                double cursor_pos_y = ctx_wr->cursor_pos_y;
-                double cursor_end_x = cursor_pos_x + ctx_wr->cursor_size_x;
-                double pos_x = note_quads->pos_x[i];
-                double pos_y = note_quads->pos_y[i];
-                double size_x = note_quads->size_x[i];
-                double end_x = pos_x + size_x;
-                double left_bound = ctx_wr->left_col;
-                double right_bound = ctx_wr->right_col + 1;
-                double top_bound = ctx_wr->top_row + 1;
-                double bottom_bound = ctx_wr->bottom_row;
-                if (pos_y > top_bound || pos_y < bottom_bound ||
-                    pos_x > right_bound || end_x < left_bound) {
-                    continue;
-                }
-                uint32_t color = note_quads->color[i];
-                uint32_t outline_color = note_quads->outline_color[i];
-                if (note_quads->mute[i]) {
-                    float alpha_factor = ctx_wr->alpha_scale;
-                    uint8_t color_alpha = (color >> 24) & 0xFF;
-                    uint8_t outline_color_alpha = (outline_color >> 24) & 0xFF;
-                    color = ((uint8_t)(color_alpha * alpha_factor) << 24) |
-                            (color & 0x00FFFFFF);
-                    outline_color =
-                        ((uint8_t)(outline_color_alpha * alpha_factor) << 24) |
-                        (outline_color & 0x00FFFFFF);
-                }
-                war_make_quad(quad_vertices,
-                              quad_indices,
-                              &quad_vertices_count,
-                              &quad_indices_count,
-                              (float[3]){(float)pos_x,
-                                         (float)note_quads->pos_y[i],
-                                         ctx_wr->layers[LAYER_NOTES]},
-                              (float[2]){(float)size_x, 1},
-                              color,
-                              default_outline_thickness,
-                              outline_color,
-                              (float[2]){0.0f, 0.0f},
-                              QUAD_GRID);
-                if (cursor_pos_y != pos_y || cursor_pos_x >= end_x ||
-                    cursor_end_x <= pos_x) {
-                    continue;
-                }
-                cursor_color = cursor_color_transparent;
-            }
-            if (ctx_fsm->current_mode == ctx_fsm->MODE_ROLL &&
-                ctx_fsm->current_mode != ctx_fsm->MODE_COMMAND &&
-                !ctx_wr->cursor_blinking) {
-                war_make_transparent_quad(
-                    transparent_quad_vertices,
-                    transparent_quad_indices,
-                    &transparent_quad_vertices_count,
-                    &transparent_quad_indices_count,
-                    (float[3]){ctx_wr->cursor_pos_x +
-                                   (float)ctx_wr->sub_col /
-                                       ctx_wr->navigation_sub_cells_col,
-                               ctx_wr->cursor_pos_y,
-                               ctx_wr->layers[LAYER_CURSOR]},
-                    (float[2]){(float)ctx_wr->cursor_size_x, 1},
-                    cursor_color,
-                    0,
-                    0,
-                    (float[2]){0.0f, 0.0f},
-                    QUAD_GRID);
-            } else if (ctx_fsm->current_mode == ctx_fsm->MODE_VIEWS) {
-                // draw views
-                uint32_t offset_col = ctx_wr->left_col +
-                                      ((ctx_wr->viewport_cols +
-                                        ctx_wr->num_cols_for_line_numbers - 1) /
-                                           2 -
-                                       views->warpoon_viewport_cols / 2);
-                uint32_t offset_row = ctx_wr->bottom_row +
-                                      ((ctx_wr->viewport_rows +
-                                        ctx_wr->num_rows_for_status_bars - 1) /
-                                           2 -
-                                       views->warpoon_viewport_rows / 2);
-                // draw views background
-                war_make_quad(
-                    quad_vertices,
-                    quad_indices,
-                    &quad_vertices_count,
-                    &quad_indices_count,
-                    (float[3]){offset_col,
-                               offset_row,
-                               ctx_wr->layers[LAYER_POPUP_BACKGROUND]},
-                    (float[2]){views->warpoon_viewport_cols,
-                               views->warpoon_viewport_rows},
-                    views->warpoon_color_bg,
-                    ctx_wr->outline_thickness,
-                    views->warpoon_color_outline,
-                    (float[2]){0.0f, 0.0f},
-                    QUAD_OUTLINE);
-                // draw views gutter
-                war_make_quad(quad_vertices,
-                              quad_indices,
-                              &quad_vertices_count,
-                              &quad_indices_count,
-                              (float[3]){offset_col,
-                                         offset_row,
-                                         ctx_wr->layers[LAYER_POPUP_HUD]},
-                              (float[2]){views->warpoon_hud_cols,
-                                         views->warpoon_viewport_rows},
-                              views->warpoon_color_hud,
-                              ctx_wr->outline_thickness,
-                              views->warpoon_color_outline,
-                              (float[2]){0.0f, 0.0f},
-                              QUAD_OUTLINE);
-                // draw views cursor
-                if (!ctx_wr->cursor_blinking &&
-                    ctx_fsm->current_mode != ctx_fsm->MODE_COMMAND) {
-                    uint32_t cursor_span_x = 1;
-                    uint32_t cursor_pos_x = views->warpoon_col;
-                    if (views->warpoon_state == WARPOON_STATE_VISUAL_LINE) {
-                        cursor_span_x = views->warpoon_viewport_cols -
-                                        views->warpoon_hud_cols;
-                        cursor_pos_x = 0;
-                    }
-                    float alpha_factor = ctx_wr->alpha_scale;
-                    uint8_t color_alpha = (cursor_color >> 24) & 0xFF;
-                    cursor_color =
-                        ((uint8_t)(color_alpha * alpha_factor) << 24) |
-                        (cursor_color & 0x00FFFFFF);
-                    war_make_quad(
-                        quad_vertices,
-                        quad_indices,
-                        &quad_vertices_count,
-                        &quad_indices_count,
-                        (float[3]){offset_col + views->warpoon_hud_cols +
-                                       cursor_pos_x - views->warpoon_left_col,
-                                   offset_row + views->warpoon_hud_rows +
-                                       views->warpoon_row -
-                                       views->warpoon_bottom_row,
-                                   ctx_wr->layers[LAYER_POPUP_CURSOR]},
-                        (float[2]){cursor_span_x, 1},
-                        cursor_color_transparent,
-                        0,
-                        0,
-                        (float[2]){0.0f, 0.0f},
-                        0);
-                }
-                // draw views line numbers text
-                int number = views->warpoon_max_row - views->warpoon_top_row +
-                             views->warpoon_viewport_rows;
-                for (uint32_t row = views->warpoon_bottom_row;
-                     row <= views->warpoon_top_row;
-                     row++, number--) {
-                    uint32_t digits[2];
-                    digits[0] = (number / 10) % 10;
-                    digits[1] = number % 10;
-                    int digit_count = 2;
-                    if (digits[0] == 0) { digit_count--; }
-                    for (int col = 2; col > 2 - digit_count; col--) {
-                        war_make_text_quad(
-                            text_vertices,
-                            text_indices,
-                            &text_vertices_count,
-                            &text_indices_count,
-                            (float[3]){offset_col + col - 1,
-                                       offset_row + row -
-                                           views->warpoon_bottom_row +
-                                           views->warpoon_hud_rows,
-                                       ctx_wr->layers[LAYER_POPUP_HUD_TEXT]},
-                            (float[2]){1, 1},
-                            views->warpoon_color_hud_text,
-                            &ctx_vk->glyphs['0' + digits[col - 1]],
-                            ctx_wr->text_thickness,
-                            ctx_wr->text_feather,
-                            0);
-                    }
-                }
-                // draw views text
-                war_get_warpoon_text(views);
-                uint32_t row = views->warpoon_max_row;
-                for (uint32_t i_views = 0; i_views < views->views_count;
-                     i_views++, row--) {
-                    if (row > views->warpoon_top_row ||
-                        row < views->warpoon_bottom_row) {
-                        continue;
-                    }
-                    for (uint32_t col = 0;
-                         col <= views->warpoon_right_col &&
-                         views->warpoon_text[i_views][col] != '\0';
-                         col++) {
-                        war_make_text_quad(
-                            text_vertices,
-                            text_indices,
-                            &text_vertices_count,
-                            &text_indices_count,
-                            (float[3]){offset_col + views->warpoon_hud_cols +
-                                           col,
-                                       offset_row + views->warpoon_hud_rows +
-                                           row - views->warpoon_bottom_row,
-                                       ctx_wr->layers[LAYER_POPUP_CURSOR]},
-                            (float[2]){1, 1},
-                            views->warpoon_color_text,
-                            &ctx_vk->glyphs[(int)views
-                                                ->warpoon_text[i_views][col]],
-                            ctx_wr->text_thickness,
-                            ctx_wr->text_feather,
-                            0);
-                    }
-                }
-            }
-            if (ctx_fsm->current_mode == ctx_fsm->MODE_COMMAND) {
-                war_make_transparent_quad(
-                    transparent_quad_vertices,
-                    transparent_quad_indices,
-                    &transparent_quad_vertices_count,
-                    &transparent_quad_indices_count,
-                    (float[3]){ctx_wr->left_col +
-                                   ctx_command->text_write_index +
-                                   ctx_command->prompt_text_size + 1,
-                               ctx_wr->bottom_row + 1,
-                               ctx_wr->layers[LAYER_CURSOR]},
-                    (float[2]){(float)ctx_wr->cursor_size_x, 1},
-                    cursor_color,
-                    0,
-                    0,
-                    (float[2]){0.0f, 0.0f},
-                    0);
-            }
-            // draw playback bar
-            uint32_t playback_bar_color = ctx_wr->red_hex;
-            float span_y = ctx_wr->viewport_rows;
-            if (ctx_wr->top_row == atomic_load(&ctx_lua->A_NOTE_COUNT) - 1) {
-                span_y -= ctx_wr->num_rows_for_status_bars;
-            }
-            war_make_quad(
-                quad_vertices,
-                quad_indices,
-                &quad_vertices_count,
-                &quad_indices_count,
-                (float[3]){
-                    ((float)atomic_load(&atomics->play_frames) /
-                     atomic_load(&ctx_lua->A_SAMPLE_RATE)) /
-                        ((60.0f / atomic_load(&ctx_lua->A_BPM)) /
-                         atomic_load(&ctx_lua->A_DEFAULT_COLUMNS_PER_BEAT)),
-                    ctx_wr->bottom_row,
-                    ctx_wr->layers[LAYER_PLAYBACK_BAR]},
-                (float[2]){0, span_y},
-                playback_bar_color,
-                0,
-                0,
-                (float[2]){default_playback_bar_thickness, 0.0f},
-                QUAD_LINE | QUAD_GRID);
-            // draw status bar quads
-            war_make_quad(quad_vertices,
-                          quad_indices,
-                          &quad_vertices_count,
-                          &quad_indices_count,
-                          (float[3]){ctx_wr->left_col,
-                                     ctx_wr->bottom_row,
-                                     ctx_wr->layers[LAYER_HUD]},
-                          (float[2]){ctx_wr->viewport_cols + 1, 1},
-                          ctx_wr->red_hex,
-                          0,
-                          0,
-                          (float[2]){0.0f, 0.0f},
-                          0);
-            war_make_quad(quad_vertices,
-                          quad_indices,
-                          &quad_vertices_count,
-                          &quad_indices_count,
-                          (float[3]){ctx_wr->left_col,
-                                     ctx_wr->bottom_row + 1,
-                                     ctx_wr->layers[LAYER_HUD]},
-                          (float[2]){ctx_wr->viewport_cols + 1, 1},
-                          ctx_wr->dark_gray_hex,
-                          0,
-                          0,
-                          (float[2]){0.0f, 0.0f},
-                          0);
-            war_make_quad(quad_vertices,
-                          quad_indices,
-                          &quad_vertices_count,
-                          &quad_indices_count,
-                          (float[3]){ctx_wr->left_col,
-                                     ctx_wr->bottom_row + 2,
-                                     ctx_wr->layers[LAYER_HUD]},
-                          (float[2]){ctx_wr->viewport_cols + 1, 1},
-                          ctx_wr->darker_light_gray_hex,
-                          0,
-                          0,
-                          (float[2]){0.0f, 0.0f},
-                          0);
-            // draw piano quads
-            float gutter_end_span_inset = 5 * default_vertical_line_thickness;
-            switch (ctx_wr->hud_state) {
-            case HUD_PIANO_AND_LINE_NUMBERS:
-            case HUD_PIANO:
-                float span_y = ctx_wr->viewport_rows;
-                if (ctx_wr->top_row == ctx_wr->max_row) {
-                    span_y -= ctx_wr->num_rows_for_status_bars;
-                }
-                war_make_quad(quad_vertices,
-                              quad_indices,
-                              &quad_vertices_count,
-                              &quad_indices_count,
-                              (float[3]){ctx_wr->left_col,
-                                         ctx_wr->bottom_row +
-                                             ctx_wr->num_rows_for_status_bars,
-                                         ctx_wr->layers[LAYER_HUD]},
-                              (float[2]){3 - gutter_end_span_inset, span_y},
-                              ctx_wr->full_white_hex,
-                              0,
-                              0,
-                              (float[2]){0.0f, 0.0f},
-                              0);
-                for (uint32_t row = ctx_wr->bottom_row; row <= ctx_wr->top_row;
-                     row++) {
-                    if (row < ctx_wr->max_row) {
-                        war_make_quad(
-                            quad_vertices,
-                            quad_indices,
-                            &quad_vertices_count,
-                            &quad_indices_count,
-                            (float[3]){ctx_wr->left_col,
-                                       row + ctx_wr->num_rows_for_status_bars +
-                                           1,
-                                       ctx_wr->layers[LAYER_HUD]},
-                            (float[2]){3 - gutter_end_span_inset, 0},
-                            super_light_gray_hex,
-                            0,
-                            0,
-                            (float[2]){0.0f, piano_horizontal_line_thickness},
-                            QUAD_LINE);
-                    }
-                    uint32_t note = row % 12;
-                    if (note == 1 || note == 3 || note == 6 || note == 8 ||
-                        note == 10) {
-                        war_make_quad(
-                            quad_vertices,
-                            quad_indices,
-                            &quad_vertices_count,
-                            &quad_indices_count,
-                            (float[3]){ctx_wr->left_col,
-                                       row + ctx_wr->num_rows_for_status_bars,
-                                       ctx_wr->layers[LAYER_HUD]},
-                            (float[2]){2 - gutter_end_span_inset, 1},
-                            ctx_wr->black_hex,
-                            0,
-                            0,
-                            (float[2]){0.0f, 0.0f},
-                            0);
-                    }
-                }
-                break;
-            }
-            // draw line number quad
-            int ln_offset = (ctx_wr->hud_state == HUD_LINE_NUMBERS) ? 0 : 3;
-            if (ctx_wr->hud_state != HUD_PIANO) {
-                uint32_t span_y = ctx_wr->viewport_rows;
-                if (ctx_wr->top_row ==
-                    atomic_load(&ctx_lua->A_NOTE_COUNT) - 1) {
-                    span_y -= ctx_wr->num_rows_for_status_bars;
-                }
-                war_make_quad(quad_vertices,
-                              quad_indices,
-                              &quad_vertices_count,
-                              &quad_indices_count,
-                              (float[3]){ctx_wr->left_col + ln_offset -
-                                             default_vertical_line_thickness,
-                                         ctx_wr->bottom_row +
-                                             ctx_wr->num_rows_for_status_bars,
-                                         ctx_wr->layers[LAYER_HUD]},
-                              (float[2]){3 - gutter_end_span_inset, span_y},
-                              ctx_wr->red_hex,
-                              0,
-                              0,
-                              (float[2]){0.0f, 0.0f},
-                              0);
-                for (uint32_t row = ctx_wr->bottom_row; row <= ctx_wr->top_row;
-                     row++) {
-                    if (row >= ctx_wr->max_row) { continue; }
-                    war_make_quad(
-                        quad_vertices,
-                        quad_indices,
-                        &quad_vertices_count,
-                        &quad_indices_count,
-                        (float[3]){ctx_wr->left_col + ln_offset,
-                                   row + ctx_wr->num_rows_for_status_bars + 1,
-                                   ctx_wr->layers[LAYER_HUD]},
-                        (float[2]){3 - gutter_end_span_inset, 0},
-                        ctx_wr->full_white_hex,
-                        0,
-                        0,
-                        (float[2]){0.0f, piano_horizontal_line_thickness},
-                        QUAD_LINE);
-                }
-            }
-            // draw gridline quads
-            for (uint32_t row = ctx_wr->bottom_row + 1;
-                 row <= ctx_wr->top_row + 1;
-                 row++) {
-                war_make_quad(
-                    quad_vertices,
-                    quad_indices,
-                    &quad_vertices_count,
-                    &quad_indices_count,
-                    (float[3]){
-                        ctx_wr->left_col, row, ctx_wr->layers[LAYER_GRIDLINES]},
-                    (float[2]){ctx_wr->viewport_cols, 0},
-                    ctx_wr->darker_light_gray_hex,
-                    0,
-                    0,
-                    (float[2]){0.0f, default_horizontal_line_thickness},
-                    QUAD_LINE | QUAD_GRID);
-            }
-            qsort(ctx_wr->gridline_splits,
-                  MAX_GRIDLINE_SPLITS,
-                  sizeof(uint32_t),
-                  war_compare_desc_uint32);
-            for (uint32_t col = ctx_wr->left_col + 1;
-                 col <= ctx_wr->right_col + 1;
-                 col++) {
-                bool draw_vertical_line = false;
-                uint32_t color;
-                for (uint32_t i = 0; i < MAX_GRIDLINE_SPLITS; i++) {
-                    draw_vertical_line =
-                        (col % ctx_wr->gridline_splits[i]) == 0;
-                    if (draw_vertical_line) {
-                        switch (i) {
-                        case 0:
-                            color = ctx_wr->white_hex;
-                            break;
-                        case 1:
-                            color = ctx_wr->darker_light_gray_hex;
-                            break;
-                        case 2:
-                            color = ctx_wr->red_hex;
-                            break;
-                        case 3:
-                            color = ctx_wr->black_hex;
-                            break;
-                        }
-                        break;
-                    }
-                }
-                if (!draw_vertical_line) { continue; }
-                uint32_t span_y = ctx_wr->viewport_rows;
-                if (ctx_wr->top_row ==
-                    atomic_load(&ctx_lua->A_NOTE_COUNT) - 1) {
-                    span_y -= ctx_wr->num_rows_for_status_bars;
-                }
-                war_make_quad(quad_vertices,
-                              quad_indices,
-                              &quad_vertices_count,
-                              &quad_indices_count,
-                              (float[3]){col,
-                                         ctx_wr->bottom_row,
-                                         ctx_wr->layers[LAYER_GRIDLINES]},
-                              (float[2]){0, span_y},
-                              color,
-                              0,
-                              0,
-                              (float[2]){default_vertical_line_thickness, 0},
-                              QUAD_LINE | QUAD_GRID);
             }
-            memcpy(ctx_vk->quads_vertex_buffer_mapped,
-                   quad_vertices,
-                   sizeof(war_quad_vertex) * quad_vertices_count);
-            memcpy(ctx_vk->quads_index_buffer_mapped,
-                   quad_indices,
-                   sizeof(uint16_t) * quad_indices_count);
-            VkMappedMemoryRange quad_flush_ranges[2] = {
-                {.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-                 .memory = ctx_vk->quads_vertex_buffer_memory,
-                 .offset = 0,
-                 .size = war_align64(sizeof(war_quad_vertex) *
-                                     quad_vertices_count)},
-                {.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-                 .memory = ctx_vk->quads_index_buffer_memory,
-                 .offset = 0,
-                 .size = war_align64(sizeof(uint16_t) * quad_indices_count)}};
-            vkFlushMappedMemoryRanges(ctx_vk->device, 2, quad_flush_ranges);
-            VkDeviceSize quad_vertices_offsets[2] = {0};
-            vkCmdBindVertexBuffers(ctx_vk->cmd_buffer,
-                                   0,
-                                   1,
-                                   &ctx_vk->quads_vertex_buffer,
-                                   quad_vertices_offsets);
-            VkDeviceSize quad_instances_offsets[2] = {0};
-            vkCmdBindVertexBuffers(ctx_vk->cmd_buffer,
-                                   1,
-                                   1,
-                                   &ctx_vk->quads_instance_buffer,
-                                   quad_instances_offsets);
-            VkDeviceSize quad_indices_offset = 0;
-            vkCmdBindIndexBuffer(ctx_vk->cmd_buffer,
-                                 ctx_vk->quads_index_buffer,
-                                 quad_indices_offset,
-                                 VK_INDEX_TYPE_UINT16);
-            war_quad_push_constants quad_push_constants = {
-                .bottom_left = {ctx_wr->left_col, ctx_wr->bottom_row},
-                .physical_size = {physical_width, physical_height},
-                .cell_size = {ctx_wr->cell_width, ctx_wr->cell_height},
-                .zoom = ctx_wr->zoom_scale,
-                .cell_offsets = {ctx_wr->num_cols_for_line_numbers,
-                                 ctx_wr->num_rows_for_status_bars},
-                .scroll_margin = {ctx_wr->scroll_margin_cols,
-                                  ctx_wr->scroll_margin_rows},
-                .anchor_cell = {ctx_wr->cursor_pos_x, ctx_wr->cursor_pos_y},
-                .top_right = {ctx_wr->right_col, ctx_wr->top_row},
-            };
-            vkCmdPushConstants(ctx_vk->cmd_buffer,
-                               ctx_vk->pipeline_layout,
-                               VK_SHADER_STAGE_VERTEX_BIT,
-                               0,
-                               sizeof(war_quad_push_constants),
-                               &quad_push_constants);
-            vkCmdDrawIndexed(
-                ctx_vk->cmd_buffer, quad_indices_count, 1, 0, 0, 0);
-            // draw transparent quads
-            vkCmdBindPipeline(ctx_vk->cmd_buffer,
-                              VK_PIPELINE_BIND_POINT_GRAPHICS,
-                              ctx_vk->transparent_quad_pipeline);
-            memcpy(ctx_vk->quads_vertex_buffer_mapped +
-                       quad_vertices_count * sizeof(war_quad_vertex),
-                   transparent_quad_vertices,
-                   sizeof(war_quad_vertex) * transparent_quad_vertices_count);
-            memcpy(ctx_vk->quads_index_buffer_mapped +
-                       quad_indices_count * sizeof(uint16_t),
-                   transparent_quad_indices,
-                   sizeof(uint16_t) * transparent_quad_indices_count);
-            VkMappedMemoryRange transparent_quad_flush_ranges[2] = {
-                {.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-                 .memory = ctx_vk->quads_vertex_buffer_memory,
-                 .offset =
-                     war_align64(sizeof(war_quad_vertex) * quad_vertices_count),
-                 .size = war_align64(sizeof(war_quad_vertex) *
-                                     transparent_quad_vertices_count)},
-                {.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-                 .memory = ctx_vk->quads_index_buffer_memory,
-                 .offset = war_align64(sizeof(uint16_t) * quad_indices_count),
-                 .size = war_align64(sizeof(uint16_t) *
-                                     transparent_quad_indices_count)}};
-            vkFlushMappedMemoryRanges(
-                ctx_vk->device, 2, transparent_quad_flush_ranges);
-            VkDeviceSize transparent_quad_vertices_offsets[2] = {
-                quad_vertices_count * sizeof(war_quad_vertex)};
-            vkCmdBindVertexBuffers(ctx_vk->cmd_buffer,
-                                   0,
-                                   1,
-                                   &ctx_vk->quads_vertex_buffer,
-                                   transparent_quad_vertices_offsets);
-            VkDeviceSize transparent_quad_instances_offsets[2] = {0};
-            vkCmdBindVertexBuffers(ctx_vk->cmd_buffer,
-                                   1,
-                                   1,
-                                   &ctx_vk->quads_instance_buffer,
-                                   transparent_quad_instances_offsets);
-            VkDeviceSize transparent_quad_indices_offset =
-                quad_indices_count * sizeof(uint16_t);
-            vkCmdBindIndexBuffer(ctx_vk->cmd_buffer,
-                                 ctx_vk->quads_index_buffer,
-                                 transparent_quad_indices_offset,
-                                 VK_INDEX_TYPE_UINT16);
-            war_quad_push_constants transparent_quad_push_constants = {
-                .bottom_left = {ctx_wr->left_col, ctx_wr->bottom_row},
-                .physical_size = {physical_width, physical_height},
-                .cell_size = {ctx_wr->cell_width, ctx_wr->cell_height},
-                .zoom = ctx_wr->zoom_scale,
-                .cell_offsets = {ctx_wr->num_cols_for_line_numbers,
-                                 ctx_wr->num_rows_for_status_bars},
-                .scroll_margin = {ctx_wr->scroll_margin_cols,
-                                  ctx_wr->scroll_margin_rows},
-                .anchor_cell = {ctx_wr->cursor_pos_x, ctx_wr->cursor_pos_y},
-                .top_right = {ctx_wr->right_col, ctx_wr->top_row},
-            };
-            vkCmdPushConstants(ctx_vk->cmd_buffer,
-                               ctx_vk->pipeline_layout,
-                               VK_SHADER_STAGE_VERTEX_BIT,
-                               0,
-                               sizeof(war_quad_push_constants),
-                               &transparent_quad_push_constants);
-            vkCmdDrawIndexed(
-                ctx_vk->cmd_buffer, transparent_quad_indices_count, 1, 0, 0, 0);
-            //---------------------------------------------------------
-            // TEXT PIPELINE
-            //---------------------------------------------------------
-            vkCmdBindPipeline(ctx_vk->cmd_buffer,
-                              VK_PIPELINE_BIND_POINT_GRAPHICS,
-                              ctx_vk->text_pipeline);
-            vkCmdBindDescriptorSets(ctx_vk->cmd_buffer,
-                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                    ctx_vk->text_pipeline_layout,
-                                    0,
-                                    1,
-                                    &ctx_vk->font_descriptor_set,
-                                    0,
-                                    NULL);
-            //---------------------------------------------------------
-            // DRAW STATUS BAR TEXT
-            //---------------------------------------------------------
-            uint32_t status_cols = (uint32_t)fminf(ctx_wr->viewport_cols,
-                                                   (float)ctx_status->capacity);
-            for (uint32_t col = 0; col < status_cols; col++) {
-                if (ctx_status->top[(int)col] != 0) {
-                    war_make_text_quad(
-                        text_vertices,
-                        text_indices,
-                        &text_vertices_count,
-                        &text_indices_count,
-                        (float[3]){col + ctx_wr->left_col,
-                                   2 + ctx_wr->bottom_row,
-                                   ctx_wr->layers[LAYER_HUD_TEXT]},
-                        (float[2]){1, 1},
-                        ctx_wr->white_hex,
-                        &ctx_vk->glyphs[(int)ctx_status->top[(int)col]],
-                        ctx_wr->text_thickness,
-                        ctx_wr->text_feather,
-                        0);
-                }
-                if (ctx_status->middle[(int)col] != 0) {
-                    war_make_text_quad(
-                        text_vertices,
-                        text_indices,
-                        &text_vertices_count,
-                        &text_indices_count,
-                        (float[3]){col + ctx_wr->left_col,
-                                   1 + ctx_wr->bottom_row,
-                                   ctx_wr->layers[LAYER_HUD_TEXT]},
-                        (float[2]){1, 1},
-                        ctx_wr->red_hex,
-                        &ctx_vk->glyphs[(int)ctx_status->middle[(int)col]],
-                        ctx_wr->text_thickness_bold,
-                        ctx_wr->text_feather_bold,
-                        0);
-                }
-                if (ctx_status->bottom[(int)col] != 0) {
-                    war_make_text_quad(
-                        text_vertices,
-                        text_indices,
-                        &text_vertices_count,
-                        &text_indices_count,
-                        (float[3]){col + ctx_wr->left_col,
-                                   ctx_wr->bottom_row,
-                                   ctx_wr->layers[LAYER_HUD_TEXT]},
-                        (float[2]){1, 1},
-                        ctx_wr->full_white_hex,
-                        &ctx_vk->glyphs[(int)ctx_status->bottom[(int)col]],
-                        ctx_wr->text_thickness,
-                        ctx_wr->text_feather,
-                        0);
-                }
+            if (!wl_region_id && wl_surface_id && wl_compositor_id) {
+                uint8_t create_region[12];
+                war_write_le32(create_region, wl_compositor_id);
+                war_write_le16(create_region + 4, 1);
+                war_write_le16(create_region + 6, 12);
+                war_write_le32(create_region + 8, new_id);
+                dump_bytes("create_region request", create_region, 12);
+                call_terry_davis("bound: wl_region");
+                ssize_t create_region_written = write(fd, create_region, 12);
+                assert(create_region_written == 12);
+                wl_region_id = new_id;
+                new_id++;
+
+                uint8_t region_add[24];
+                war_write_le32(region_add, wl_region_id);
+                war_write_le16(region_add + 4, 1);
+                war_write_le16(region_add + 6, 24);
+                war_write_le32(region_add + 8, 0);
+                war_write_le32(region_add + 12, 0);
+                war_write_le32(region_add + 16, physical_width);
+                war_write_le32(region_add + 20, physical_height);
+                dump_bytes("wl_region::add request", region_add, 24);
+                ssize_t region_add_written = write(fd, region_add, 24);
+                assert(region_add_written == 24);
+
+                war_wl_surface_set_opaque_region(
+                    fd, wl_surface_id, wl_region_id);
             }
-            // draw piano text
-            char* piano_notes[12] = {"C",
-                                     "C#",
-                                     "D",
-                                     "D#",
-                                     "E",
-                                     "F",
-                                     "F#",
-                                     "G",
-                                     "G#",
-                                     "A",
-                                     "A#",
-                                     "B"};
-            for (uint32_t row = ctx_wr->bottom_row;
-                 row <= ctx_wr->top_row &&
-                 ctx_wr->hud_state != HUD_LINE_NUMBERS;
-                 row++) {
-                uint32_t i_piano_notes = row % 12;
-                if (i_piano_notes == 1 || i_piano_notes == 3 ||
-                    i_piano_notes == 6 || i_piano_notes == 8 ||
-                    i_piano_notes == 10) {
-                    continue;
-                }
-                int octave = row / 12 - 1;
-                if (octave < 0) { octave = '-' - '0'; }
-                war_make_text_quad(
-                    text_vertices,
-                    text_indices,
-                    &text_vertices_count,
-                    &text_indices_count,
-                    (float[3]){1 + ctx_wr->left_col,
-                               row + ctx_wr->num_rows_for_status_bars,
-                               ctx_wr->layers[LAYER_HUD_TEXT]},
-                    (float[2]){1, 1},
-                    ctx_wr->black_hex,
-                    &ctx_vk->glyphs[piano_notes[i_piano_notes][0]],
-                    ctx_wr->text_thickness,
-                    ctx_wr->text_feather,
-                    0);
-                war_make_text_quad(
-                    text_vertices,
-                    text_indices,
-                    &text_vertices_count,
-                    &text_indices_count,
-                    (float[3]){2 + ctx_wr->left_col,
-                               row + ctx_wr->num_rows_for_status_bars,
-                               ctx_wr->layers[LAYER_HUD_TEXT]},
-                    (float[2]){1, 1},
-                    ctx_wr->black_hex,
-                    &ctx_vk->glyphs['0' + octave],
-                    ctx_wr->text_thickness,
-                    ctx_wr->text_feather,
-                    0);
+            if (!zwp_linux_dmabuf_feedback_v1_id && zwp_linux_dmabuf_v1_id &&
+                wl_surface_id) {
+                uint8_t get_surface_feedback[16];
+                war_write_le32(get_surface_feedback, zwp_linux_dmabuf_v1_id);
+                war_write_le16(get_surface_feedback + 4, 3);
+                war_write_le16(get_surface_feedback + 6, 16);
+                war_write_le32(get_surface_feedback + 8, new_id);
+                war_write_le32(get_surface_feedback + 12, wl_surface_id);
+                dump_bytes("zwp_linux_dmabuf_v1::get_surface_feedback request",
+                           get_surface_feedback,
+                           16);
+                call_terry_davis("bound: xdg_surface");
+                ssize_t get_surface_feedback_written =
+                    write(fd, get_surface_feedback, 16);
+                assert(get_surface_feedback_written == 16);
+                zwp_linux_dmabuf_feedback_v1_id = new_id;
+                obj_op[zwp_linux_dmabuf_feedback_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&zwp_linux_dmabuf_feedback_v1_done;
+                obj_op[zwp_linux_dmabuf_feedback_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       1] = &&zwp_linux_dmabuf_feedback_v1_format_table;
+                obj_op[zwp_linux_dmabuf_feedback_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       2] = &&zwp_linux_dmabuf_feedback_v1_main_device;
+                obj_op[zwp_linux_dmabuf_feedback_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       3] = &&zwp_linux_dmabuf_feedback_v1_tranche_done;
+                obj_op[zwp_linux_dmabuf_feedback_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       4] =
+                    &&zwp_linux_dmabuf_feedback_v1_tranche_target_device;
+                obj_op[zwp_linux_dmabuf_feedback_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       5] = &&zwp_linux_dmabuf_feedback_v1_tranche_formats;
+                obj_op[zwp_linux_dmabuf_feedback_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       6] = &&zwp_linux_dmabuf_feedback_v1_tranche_flags;
+                new_id++;
             }
-            // draw line number text
-            for (uint32_t row = ctx_wr->bottom_row;
-                 row <= ctx_wr->top_row && ctx_wr->hud_state != HUD_PIANO;
-                 row++) {
-                uint32_t digits[3];
-                digits[0] = (row / 100) % 10;
-                digits[1] = (row / 10) % 10;
-                digits[2] = row % 10;
-                int digit_count = 3;
-                if (digits[0] == 0) {
-                    digit_count = (digits[1] == 0) ? (digit_count - 2) :
-                                                     (digit_count - 1);
-                }
-                for (int col = ln_offset + 2;
-                     col > (ln_offset + 2) - digit_count;
-                     col--) {
-                    war_make_text_quad(
-                        text_vertices,
-                        text_indices,
-                        &text_vertices_count,
-                        &text_indices_count,
-                        (float[3]){ctx_wr->left_col + col,
-                                   row + ctx_wr->num_rows_for_status_bars,
-                                   ctx_wr->layers[LAYER_HUD_TEXT]},
-                        (float[2]){1, 1},
-                        ctx_wr->full_white_hex,
-                        &ctx_vk->glyphs['0' + digits[col - ln_offset]],
-                        ctx_wr->text_thickness,
-                        ctx_wr->text_feather,
-                        0);
-                }
+            if (!xdg_surface_id && xdg_wm_base_id && wl_surface_id) {
+                uint8_t get_xdg_surface[16];
+                war_write_le32(get_xdg_surface, xdg_wm_base_id);
+                war_write_le16(get_xdg_surface + 4, 2);
+                war_write_le16(get_xdg_surface + 6, 16);
+                war_write_le32(get_xdg_surface + 8, new_id);
+                war_write_le32(get_xdg_surface + 12, wl_surface_id);
+                dump_bytes("get_xdg_surface request", get_xdg_surface, 16);
+                call_terry_davis("bound: xdg_surface");
+                ssize_t get_xdg_surface_written =
+                    write(fd, get_xdg_surface, 16);
+                assert(get_xdg_surface_written == 16);
+                xdg_surface_id = new_id;
+                obj_op[xdg_surface_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&xdg_surface_configure;
+                new_id++;
+                uint8_t get_toplevel[12];
+                war_write_le32(get_toplevel, xdg_surface_id);
+                war_write_le16(get_toplevel + 4, 1);
+                war_write_le16(get_toplevel + 6, 12);
+                war_write_le32(get_toplevel + 8, new_id);
+                dump_bytes("get_xdg_toplevel request", get_toplevel, 12);
+                call_terry_davis("bound: xdg_toplevel");
+                ssize_t get_toplevel_written = write(fd, get_toplevel, 12);
+                assert(get_toplevel_written == 12);
+                xdg_toplevel_id = new_id;
+                obj_op[xdg_toplevel_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&xdg_toplevel_configure;
+                obj_op[xdg_toplevel_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       1] = &&xdg_toplevel_close;
+                obj_op[xdg_toplevel_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       2] = &&xdg_toplevel_configure_bounds;
+                obj_op[xdg_toplevel_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       3] = &&xdg_toplevel_wm_capabilities;
+                new_id++;
+            }
+            if (!zxdg_toplevel_decoration_v1_id && xdg_toplevel_id &&
+                zxdg_decoration_manager_v1_id) {
+                uint8_t get_toplevel_decoration[16];
+                war_write_le32(get_toplevel_decoration,
+                               zxdg_decoration_manager_v1_id);
+                war_write_le16(get_toplevel_decoration + 4, 1);
+                war_write_le16(get_toplevel_decoration + 6, 16);
+                war_write_le32(get_toplevel_decoration + 8, new_id);
+                war_write_le32(get_toplevel_decoration + 12, xdg_toplevel_id);
+                dump_bytes("get_toplevel_decoration request",
+                           get_toplevel_decoration,
+                           16);
+                call_terry_davis("bound: zxdg_toplevel_decoration_v1");
+                ssize_t get_toplevel_decoration_written =
+                    write(fd, get_toplevel_decoration, 16);
+                assert(get_toplevel_decoration_written == 16);
+                zxdg_toplevel_decoration_v1_id = new_id;
+                obj_op[zxdg_toplevel_decoration_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&zxdg_toplevel_decoration_v1_configure;
+                new_id++;
+
+                //---------------------------------------------------------
+                // initial commit
+                //---------------------------------------------------------
+                war_wayland_wl_surface_commit(fd, wl_surface_id);
             }
-            memcpy(ctx_vk->text_vertex_buffer_mapped,
-                   text_vertices,
-                   sizeof(war_text_vertex) * text_vertices_count);
-            memcpy(ctx_vk->text_index_buffer_mapped,
-                   text_indices,
-                   sizeof(uint16_t) * text_indices_count);
-            VkMappedMemoryRange text_flush_ranges[2] = {
-                {.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-                 .memory = ctx_vk->text_vertex_buffer_memory,
-                 .offset = 0,
-                 .size = war_align64(sizeof(war_text_vertex) *
-                                     text_vertices_count)},
-                {.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-                 .memory = ctx_vk->text_index_buffer_memory,
-                 .offset = 0,
-                 .size = war_align64(sizeof(uint16_t) * text_indices_count)}};
-            vkFlushMappedMemoryRanges(ctx_vk->device, 2, text_flush_ranges);
-            VkDeviceSize text_vertices_offsets[2] = {0};
-            vkCmdBindVertexBuffers(ctx_vk->cmd_buffer,
-                                   0,
-                                   1,
-                                   &ctx_vk->text_vertex_buffer,
-                                   text_vertices_offsets);
-            VkDeviceSize text_instances_offsets[2] = {0};
-            vkCmdBindVertexBuffers(ctx_vk->cmd_buffer,
-                                   1,
-                                   1,
-                                   &ctx_vk->text_instance_buffer,
-                                   text_instances_offsets);
-            VkDeviceSize text_indices_offset = 0;
-            vkCmdBindIndexBuffer(ctx_vk->cmd_buffer,
-                                 ctx_vk->text_index_buffer,
-                                 text_indices_offset,
-                                 VK_INDEX_TYPE_UINT16);
-            war_text_push_constants text_push_constants = {
-                .bottom_left = {ctx_wr->left_col, ctx_wr->bottom_row},
-                .physical_size = {physical_width, physical_height},
-                .cell_size = {ctx_wr->cell_width, ctx_wr->cell_height},
-                .zoom = ctx_wr->zoom_scale,
-                .cell_offsets = {ctx_wr->num_cols_for_line_numbers,
-                                 ctx_wr->num_rows_for_status_bars},
-                .scroll_margin = {ctx_wr->scroll_margin_cols,
-                                  ctx_wr->scroll_margin_rows},
-                .anchor_cell = {ctx_wr->cursor_pos_x, ctx_wr->cursor_pos_y},
-                .top_right = {ctx_wr->right_col, ctx_wr->top_row},
-                .ascent = ctx_vk->ascent,
-                .descent = ctx_vk->descent,
-                .line_gap = ctx_vk->line_gap,
-                .baseline = ctx_vk->baseline,
-                .font_height = ctx_vk->font_height,
-            };
-            vkCmdPushConstants(ctx_vk->cmd_buffer,
-                               ctx_vk->text_pipeline_layout,
-                               VK_SHADER_STAGE_VERTEX_BIT,
-                               0,
-                               sizeof(war_text_push_constants),
-                               &text_push_constants);
-            vkCmdDrawIndexed(
-                ctx_vk->cmd_buffer, text_indices_count, 1, 0, 0, 0);
-            //---------------------------------------------------------
-            //   END RENDER PASS
-            //---------------------------------------------------------
-            vkCmdEndRenderPass(ctx_vk->cmd_buffer);
-            result = vkEndCommandBuffer(ctx_vk->cmd_buffer);
-            assert(result == VK_SUCCESS);
-            VkSubmitInfo submit_info = {
-                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                .commandBufferCount = 1,
-                .pCommandBuffers = &ctx_vk->cmd_buffer,
-                .waitSemaphoreCount = 0,
-                .pWaitSemaphores = NULL,
-                .signalSemaphoreCount = 0,
-                .pSignalSemaphores = NULL,
-            };
-            result =
-                vkQueueSubmit(ctx_vk->queue,
-                              1,
-                              &submit_info,
-                              ctx_vk->in_flight_fences[ctx_vk->current_frame]);
-            assert(result == VK_SUCCESS);
-            // war_wayland_holy_trinity(fd,
-            //                          wl_surface_id,
-            //                          wl_buffer_id,
-            //                          0,
-            //                          0,
-            //                          0,
-            //                          0,
-            //                          physical_width,
-            //                          physical_height);
             goto wayland_done;
-        }
+        wl_registry_global_remove:
+            dump_bytes("global_rm event", msg_buffer + msg_buffer_offset, size);
+            goto wayland_done;
+        wl_callback_done:
+            // dump_bytes("wl_callback::wayland_done event",
+            //           msg_buffer + msg_buffer_offset,
+            //           size);
+            ctx_wr->frame_pending = 0;
+            ctx_wr->frame_callback = 1;
+            ctx_wr->record_at_us =
+                war_present_schedule(ctx_wr, war_get_monotonic_time_us());
+            goto wayland_done;
         wl_display_error:
             dump_bytes("wl_display::error event",
                        msg_buffer + msg_buffer_offset,
@@ -2860,11 +3526,18 @@ cmd_timeout_done:
                 wl_callback_id) {
                 war_wayland_wl_surface_frame(fd, wl_surface_id, wl_callback_id);
             }
+            if (war_read_le32(msg_buffer + msg_buffer_offset + 8) ==
+                wp_presentation_feedback_id) {
+                presentation_feedback_free = true;
+            }
             goto wayland_done;
         wl_buffer_release:
             // dump_bytes("wl_buffer_release event",
             //            msg_buffer + msg_buffer_offset,
             //            size);
+            for (uint32_t f = 0; f < max_frames; f++) {
+                if (wl_buffer_id[f] == object_id) { wl_buffer_busy[f] = 0; }
+            }
             goto wayland_done;
         xdg_wm_base_ping:
             dump_bytes(
@@ -2943,8 +3616,12 @@ cmd_timeout_done:
             //-------------------------------------------------------------
             // initial attach, initial frame, commit
             //-------------------------------------------------------------
-            war_wayland_wl_surface_attach(
-                fd, wl_surface_id, wl_buffer_id, 0, 0);
+            war_wayland_wl_surface_attach(fd,
+                                          wl_surface_id,
+                                          wl_buffer_id[ctx_vk->current_frame],
+                                          0,
+                                          0);
+            wl_buffer_busy[ctx_vk->current_frame] = 1;
             if (!wl_callback_id) {
                 war_wayland_wl_surface_frame(fd, wl_surface_id, new_id);
                 wl_callback_id = new_id;
@@ -2959,6 +3636,7 @@ cmd_timeout_done:
             // dump_bytes("xdg_toplevel_configure event",
             //            msg_buffer + msg_buffer_offset,
             //            size);
+            war_damage_full(ctx_wr);
             uint32_t width = *(uint32_t*)(msg_buffer + msg_buffer_offset + 0);
             uint32_t height = *(uint32_t*)(msg_buffer + msg_buffer_offset + 4);
             // States array starts at offset 8
@@ -3013,14 +3691,17 @@ cmd_timeout_done:
             // xdg_surface_destroy, 8);
             assert(xdg_surface_destroy_written == 8);
 
-            uint8_t wl_buffer_destroy[8];
-            war_write_le32(wl_buffer_destroy, wl_buffer_id);
-            war_write_le16(wl_buffer_destroy + 4, 0);
-            war_write_le16(wl_buffer_destroy + 6, 8);
-            ssize_t wl_buffer_destroy_written = write(fd, wl_buffer_destroy, 8);
-            // dump_bytes("wl_buffer::destroy request", wl_buffer_destroy,
-            // 8);
-            assert(wl_buffer_destroy_written == 8);
+            for (uint32_t f = 0; f < max_frames; f++) {
+                uint8_t wl_buffer_destroy[8];
+                war_write_le32(wl_buffer_destroy, wl_buffer_id[f]);
+                war_write_le16(wl_buffer_destroy + 4, 0);
+                war_write_le16(wl_buffer_destroy + 6, 8);
+                ssize_t wl_buffer_destroy_written =
+                    write(fd, wl_buffer_destroy, 8);
+                // dump_bytes("wl_buffer::destroy request", wl_buffer_destroy,
+                // 8);
+                assert(wl_buffer_destroy_written == 8);
+            }
 
             uint8_t wl_region_destroy[8];
             war_write_le32(wl_region_destroy, wl_region_id);
@@ -3079,98 +3760,104 @@ cmd_timeout_done:
             dump_bytes("zwp_linux_dmabuf_feedback_v1_done event",
                        msg_buffer + msg_buffer_offset,
                        size);
-            uint8_t create_params[12]; // REFACTOR: zero initialize
-            war_write_le32(create_params, zwp_linux_dmabuf_v1_id);
-            war_write_le16(create_params + 4, 1);
-            war_write_le16(create_params + 6, 12);
-            war_write_le32(create_params + 8, new_id);
-            dump_bytes(
-                "zwp_linux_dmabuf_v1_create_params request", create_params, 12);
-            call_terry_davis("bound: zwp_linux_buffer_params_v1");
-            ssize_t create_params_written = write(fd, create_params, 12);
-            assert(create_params_written == 12);
-            zwp_linux_buffer_params_v1_id = new_id;
-            obj_op[zwp_linux_buffer_params_v1_id *
-                       atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                   0] = &&zwp_linux_buffer_params_v1_created;
-            obj_op[zwp_linux_buffer_params_v1_id *
-                       atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                   1] = &&zwp_linux_buffer_params_v1_failed;
-            new_id++; // COMMENT REFACTOR: move increment to declaration
-                      // (one line it)
+            // one wl_buffer per frame in flight, each over its own dmabuf
+            for (uint32_t f = 0; f < max_frames; f++) {
+                uint8_t create_params[12]; // REFACTOR: zero initialize
+                war_write_le32(create_params, zwp_linux_dmabuf_v1_id);
+                war_write_le16(create_params + 4, 1);
+                war_write_le16(create_params + 6, 12);
+                war_write_le32(create_params + 8, new_id);
+                dump_bytes("zwp_linux_dmabuf_v1_create_params request",
+                           create_params,
+                           12);
+                call_terry_davis("bound: zwp_linux_buffer_params_v1");
+                ssize_t create_params_written = write(fd, create_params, 12);
+                assert(create_params_written == 12);
+                zwp_linux_buffer_params_v1_id = new_id;
+                obj_op[zwp_linux_buffer_params_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&zwp_linux_buffer_params_v1_created;
+                obj_op[zwp_linux_buffer_params_v1_id *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       1] = &&zwp_linux_buffer_params_v1_failed;
+                new_id++; // COMMENT REFACTOR: move increment to declaration
+                          // (one line it)
 
-            uint8_t header[8];
-            war_write_le32(header, zwp_linux_buffer_params_v1_id);
-            war_write_le16(header + 4, 1);
-            war_write_le16(header + 6, 28);
-            uint8_t tail[20];
-            war_write_le32(tail, 0);
-            war_write_le32(tail + 4, 0);
-            war_write_le32(tail + 8, stride);
-            war_write_le32(tail + 12, 0);
-            war_write_le32(tail + 16, 0);
-            struct iovec iov[2] = {
-                {.iov_base = header, .iov_len = 8},
-                {.iov_base = tail, .iov_len = 20},
-            };
-            char cmsgbuf[CMSG_SPACE(sizeof(int))] = {0};
-            struct msghdr msg = {0};
-            msg.msg_iov = iov;
-            msg.msg_iovlen = 2;
-            msg.msg_control = cmsgbuf;
-            msg.msg_controllen = sizeof(cmsgbuf);
-            struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
-            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
-            cmsg->cmsg_level = SOL_SOCKET;
-            cmsg->cmsg_type = SCM_RIGHTS;
-            *((int*)CMSG_DATA(cmsg)) = ctx_vk->dmabuf_fd;
-            ssize_t dmabuf_sent = sendmsg(fd, &msg, 0);
-            if (dmabuf_sent < 0) perror("sendmsg");
-            assert(dmabuf_sent == 28);
+                uint8_t header[8];
+                war_write_le32(header, zwp_linux_buffer_params_v1_id);
+                war_write_le16(header + 4, 1);
+                war_write_le16(header + 6, 28);
+                uint8_t tail[20];
+                war_write_le32(tail, 0);
+                war_write_le32(tail + 4, 0);
+                war_write_le32(tail + 8, stride);
+                war_write_le32(tail + 12, 0);
+                war_write_le32(tail + 16, 0);
+                struct iovec iov[2] = {
+                    {.iov_base = header, .iov_len = 8},
+                    {.iov_base = tail, .iov_len = 20},
+                };
+                char cmsgbuf[CMSG_SPACE(sizeof(int))] = {0};
+                struct msghdr msg = {0};
+                msg.msg_iov = iov;
+                msg.msg_iovlen = 2;
+                msg.msg_control = cmsgbuf;
+                msg.msg_controllen = sizeof(cmsgbuf);
+                struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+                cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+                cmsg->cmsg_level = SOL_SOCKET;
+                cmsg->cmsg_type = SCM_RIGHTS;
+                *((int*)CMSG_DATA(cmsg)) = ctx_vk->dmabuf_fds[f];
+                ssize_t dmabuf_sent = sendmsg(fd, &msg, 0);
+                if (dmabuf_sent < 0) perror("sendmsg");
+                assert(dmabuf_sent == 28);
 #if DEBUG
-            uint8_t full_msg[32] = {0};
-            memcpy(full_msg, header, 8);
-            memcpy(full_msg + 8, tail, 20);
+                uint8_t full_msg[32] = {0};
+                memcpy(full_msg, header, 8);
+                memcpy(full_msg + 8, tail, 20);
 #endif
-            dump_bytes("zwp_linux_buffer_params_v1::add request", full_msg, 28);
+                dump_bytes(
+                    "zwp_linux_buffer_params_v1::add request", full_msg, 28);
 
-            uint8_t create_immed[28]; // REFACTOR: maybe 0 initialize
-            war_write_le32(
-                create_immed,
-                zwp_linux_buffer_params_v1_id); // COMMENT REFACTOR: is
-                                                // it faster to copy the
-                                                // incoming message
-                                                // header and increment
-                                                // accordingly?
-            war_write_le16(create_immed + 4,
-                           3); // COMMENT REFACTOR CONCERN: check for
-                               // duplicate variables names
-            war_write_le16(create_immed + 6, 28);
-            war_write_le32(create_immed + 8, new_id);
-            war_write_le32(create_immed + 12, physical_width);
-            war_write_le32(create_immed + 16, physical_height);
-            war_write_le32(create_immed + 20, DRM_FORMAT_ARGB8888);
-            war_write_le32(create_immed + 24, 0);
-            dump_bytes("zwp_linux_buffer_params_v1::create_immed request",
-                       create_immed,
-                       28);
-            call_terry_davis("bound: wl_buffer");
-            ssize_t create_immed_written = write(fd, create_immed, 28);
-            assert(create_immed_written == 28);
-            wl_buffer_id = new_id;
-            obj_op[wl_buffer_id *
-                       atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
-                   0] = &&wl_buffer_release;
-            new_id++;
+                uint8_t create_immed[28]; // REFACTOR: maybe 0 initialize
+                war_write_le32(
+                    create_immed,
+                    zwp_linux_buffer_params_v1_id); // COMMENT REFACTOR: is
+                                                    // it faster to copy the
+                                                    // incoming message
+                                                    // header and increment
+                                                    // accordingly?
+                war_write_le16(create_immed + 4,
+                               3); // COMMENT REFACTOR CONCERN: check for
+                                   // duplicate variables names
+                war_write_le16(create_immed + 6, 28);
+                war_write_le32(create_immed + 8, new_id);
+                war_write_le32(create_immed + 12, physical_width);
+                war_write_le32(create_immed + 16, physical_height);
+                war_write_le32(create_immed + 20, DRM_FORMAT_ARGB8888);
+                war_write_le32(create_immed + 24, 0);
+                dump_bytes("zwp_linux_buffer_params_v1::create_immed request",
+                           create_immed,
+                           28);
+                call_terry_davis("bound: wl_buffer");
+                ssize_t create_immed_written = write(fd, create_immed, 28);
+                assert(create_immed_written == 28);
+                wl_buffer_id[f] = new_id;
+                obj_op[wl_buffer_id[f] *
+                           atomic_load(&ctx_lua->WR_WAYLAND_MAX_OP_CODES) +
+                       0] = &&wl_buffer_release;
+                new_id++;
 
-            uint8_t destroy[8];
-            war_write_le32(destroy, zwp_linux_buffer_params_v1_id);
-            war_write_le16(destroy + 4, 0);
-            war_write_le16(destroy + 6, 8);
-            ssize_t destroy_written = write(fd, destroy, 8);
-            assert(destroy_written == 8);
-            dump_bytes(
-                "zwp_linux_buffer_params_v1_id::destroy request", destroy, 8);
+                uint8_t destroy[8];
+                war_write_le32(destroy, zwp_linux_buffer_params_v1_id);
+                war_write_le16(destroy + 4, 0);
+                war_write_le16(destroy + 6, 8);
+                ssize_t destroy_written = write(fd, destroy, 8);
+                assert(destroy_written == 8);
+                dump_bytes("zwp_linux_buffer_params_v1_id::destroy request",
+                           destroy,
+                           8);
+            }
             goto wayland_done;
         zwp_linux_dmabuf_feedback_v1_format_table:
             dump_bytes("zwp_linux_dmabuf_feedback_v1_format_table event",
@@ -3226,6 +3913,7 @@ cmd_timeout_done:
                        msg_buffer + msg_buffer_offset,
                        size);
             assert(size == 12);
+            war_damage_full(ctx_wr);
 
             uint8_t set_buffer_scale[12];
             war_write_le32(set_buffer_scale, wl_surface_id);
@@ -3324,6 +4012,38 @@ cmd_timeout_done:
             dump_bytes("wp_presentation_clock_id event",
                        msg_buffer + msg_buffer_offset,
                        size);
+            presentation_clock =
+                (clockid_t)war_read_le32(msg_buffer + msg_buffer_offset + 8);
+            goto wayland_done;
+        wp_presentation_feedback_sync_output:
+            goto wayland_done;
+        wp_presentation_feedback_presented: {
+            // dump_bytes("wp_presentation_feedback::presented event",
+            //            msg_buffer + msg_buffer_offset,
+            //            size);
+            uint8_t* presented = msg_buffer + msg_buffer_offset + 8;
+            uint64_t tv_sec = ((uint64_t)war_read_le32(presented) << 32) |
+                              war_read_le32(presented + 4);
+            uint64_t present_us =
+                tv_sec * 1000000 + war_read_le32(presented + 8) / 1000;
+            war_frame_stats* stats =
+                war_frame_stats_find(ctx_wr, presentation_feedback_seq);
+            if (stats && present_us > presentation_commit_us) {
+                stats->latency_us =
+                    (float)(present_us - presentation_commit_us);
+                stats->refresh_us =
+                    (float)war_read_le32(presented + 12) / 1000.0f;
+            }
+            // frame pacing predicts vblanks from here on the monotonic clock
+            int64_t clock_offset_us =
+                (int64_t)war_get_clock_time_us(presentation_clock) -
+                (int64_t)war_get_monotonic_time_us();
+            ctx_wr->vblank_us =
+                (uint64_t)((int64_t)present_us - clock_offset_us);
+            ctx_wr->refresh_us = war_read_le32(presented + 12) / 1000;
+            goto wayland_done;
+        }
+        wp_presentation_feedback_discarded:
             goto wayland_done;
         zwlr_output_manager_v1_head:
             dump_bytes("zwlr_output_manager_v1_head event",
@@ -3890,6 +4610,17 @@ cmd_timeout_done:
                 }
                 goto cmd_done;
             }
+            //-----------------------------------------------------------------
+            // REGISTER INPUT
+            //-----------------------------------------------------------------
+            if (note_registers->pending && pressed) {
+                uint32_t slot = war_note_register_of(war_to_ascii(keysym, mod));
+                if (slot < NOTE_REGISTER_COUNT) {
+                    note_registers->selected = slot;
+                }
+                note_registers->pending = 0;
+                goto cmd_done;
+            }
             if (!pressed) {
                 ctx_fsm->key_down[FSM_3D_INDEX(
                     ctx_fsm->current_state, keysym, mod)] = false;
@@ -4003,6 +4734,7 @@ cmd_timeout_done:
             goto cmd_done;
         }
         cmd_done: {
+            war_damage_full(ctx_wr);
             ctx_wr->cursor_blink_previous_us = ctx_wr->now;
             ctx_wr->cursor_blinking = 0;
             ctx_wr->trinity = 1;
@@ -4060,6 +4792,7 @@ cmd_timeout_done:
             // dump_bytes("wl_pointer_button event",
             //            msg_buffer + msg_buffer_offset,
             //            size);
+            war_damage_full(ctx_wr);
             switch (war_read_le32(msg_buffer + msg_buffer_offset + 8 + 12)) {
             case 1:
                 if (war_read_le32(msg_buffer + msg_buffer_offset + 8 + 8) ==
@@ -4213,6 +4946,8 @@ cmd_timeout_done:
             msg_buffer_offset += size;
             continue;
         }
+        wayland_last_us =
+            (float)(war_get_monotonic_time_us() - wayland_start_us);
         if (msg_buffer_offset > 0) {
             memmove(msg_buffer,
                     msg_buffer + msg_buffer_offset,
@@ -4223,8 +4958,26 @@ cmd_timeout_done:
     goto wr;
 }
 end_wr:
-    close(ctx_vk->dmabuf_fd);
-    ctx_vk->dmabuf_fd = -1;
+    war_undofile_sync(env);
+    war_undofile_close(env);
+    atomic_store(&undofile->running, 0);
+    pthread_cond_signal(&undofile->cond);
+    pthread_join(undofile->thread, NULL);
+    war_autosave_sync(env, 1);
+    war_autosave_close(env);
+    atomic_store(&autosave->running, 0);
+    pthread_cond_signal(&autosave->cond);
+    pthread_join(autosave->thread, NULL);
+    for (uint32_t f = 0; f < max_frames; f++) {
+        close(ctx_vk->dmabuf_fds[f]);
+        ctx_vk->dmabuf_fds[f] = -1;
+    }
+    if (note_swap->records) {
+        munmap(note_swap->records, note_swap->mapped_size);
+        close(note_swap->fd);
+        note_swap->records = NULL;
+        note_swap->fd = -1;
+    }
     xkb_state_unref(ctx_fsm->xkb_state);
     xkb_context_unref(ctx_fsm->xkb_context);
     end("war_window_render");
@@ -217,13 +217,19 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
         .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
     };
-    VkImage quad_depth_image;
-    VkResult r =
-        vkCreateImage(device, &quad_depth_image_info, NULL, &quad_depth_image);
-    assert(r == VK_SUCCESS);
+    // every frame in flight gets its own depth and color attachment
+    VkImage quad_depth_images[max_frames];
+    VkDeviceMemory quad_depth_image_memories[max_frames];
+    VkImageView quad_depth_image_views[max_frames];
+    VkResult r;
+    for (uint32_t f = 0; f < max_frames; f++) {
+        r = vkCreateImage(
+            device, &quad_depth_image_info, NULL, &quad_depth_images[f]);
+        assert(r == VK_SUCCESS);
+    }
     VkMemoryRequirements quad_depth_mem_reqs;
     vkGetImageMemoryRequirements(
-        device, quad_depth_image, &quad_depth_mem_reqs);
+        device, quad_depth_images[0], &quad_depth_mem_reqs);
     VkPhysicalDeviceMemoryProperties quad_depth_mem_props;
     vkGetPhysicalDeviceMemoryProperties(physical_device, &quad_depth_mem_props);
     int quad_depth_memory_type_index = -1;
@@ -242,31 +248,34 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
         .allocationSize = quad_depth_mem_reqs.size,
         .memoryTypeIndex = quad_depth_memory_type_index,
     };
-    VkDeviceMemory quad_depth_image_memory;
-    r = vkAllocateMemory(
-        device, &quad_depth_alloc_info, NULL, &quad_depth_image_memory);
-    assert(r == VK_SUCCESS);
-    r = vkBindImageMemory(device, quad_depth_image, quad_depth_image_memory, 0);
-    assert(r == VK_SUCCESS);
-    // --- create image view ---
-    VkImageViewCreateInfo quad_depth_view_info = {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .image = quad_depth_image,
-        .viewType = VK_IMAGE_VIEW_TYPE_2D,
-        .format = quad_depth_format,
-        .subresourceRange =
-            {
-                .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-                .baseMipLevel = 0,
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = 1,
-            },
-    };
-    VkImageView quad_depth_image_view;
-    r = vkCreateImageView(
-        device, &quad_depth_view_info, NULL, &quad_depth_image_view);
-    assert(r == VK_SUCCESS);
+    for (uint32_t f = 0; f < max_frames; f++) {
+        r = vkAllocateMemory(device,
+                             &quad_depth_alloc_info,
+                             NULL,
+                             &quad_depth_image_memories[f]);
+        assert(r == VK_SUCCESS);
+        r = vkBindImageMemory(
+            device, quad_depth_images[f], quad_depth_image_memories[f], 0);
+        assert(r == VK_SUCCESS);
+        // --- create image view ---
+        VkImageViewCreateInfo quad_depth_view_info = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = quad_depth_images[f],
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = quad_depth_format,
+            .subresourceRange =
+                {
+                    .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+        };
+        r = vkCreateImageView(
+            device, &quad_depth_view_info, NULL, &quad_depth_image_views[f]);
+        assert(r == VK_SUCCESS);
+    }
     VkAttachmentDescription quad_depth_attachment = {
         .format = quad_depth_format,
         .samples = VK_SAMPLE_COUNT_1_BIT,
@@ -288,15 +297,31 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
     };
     result = vkCreateCommandPool(device, &pool_info, NULL, &cmd_pool);
     assert(result == VK_SUCCESS);
-    VkCommandBuffer cmd_buffer;
+    VkCommandBuffer cmd_buffers[max_frames];
     VkCommandBufferAllocateInfo cmd_buf_info = {
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
         .commandPool = cmd_pool,
         .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = 1,
+        .commandBufferCount = max_frames,
     };
-    result = vkAllocateCommandBuffers(device, &cmd_buf_info, &cmd_buffer);
+    result = vkAllocateCommandBuffers(device, &cmd_buf_info, cmd_buffers);
     assert(result == VK_SUCCESS);
+    // one-off setup work borrows the first frame's
+    VkCommandBuffer cmd_buffer = cmd_buffers[0];
+    // gpu timings for the frame stats, each frame resets its own range of
+    // TIMESTAMP_COUNT queries before writing them
+    VkQueryPool timestamp_query_pool = VK_NULL_HANDLE;
+    if (queue_families[queue_family_index].timestampValidBits &&
+        device_props.limits.timestampPeriod > 0.0f) {
+        VkQueryPoolCreateInfo query_pool_info = {
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .queryType = VK_QUERY_TYPE_TIMESTAMP,
+            .queryCount = TIMESTAMP_COUNT * max_frames,
+        };
+        result = vkCreateQueryPool(
+            device, &query_pool_info, NULL, &timestamp_query_pool);
+        assert(result == VK_SUCCESS);
+    }
     VkExternalMemoryImageCreateInfo ext_mem_image_info = {
         .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
         .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT,
@@ -316,11 +341,13 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
         .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
     };
-    VkImage image;
-    result = vkCreateImage(device, &image_create_info, NULL, &image);
-    assert(result == VK_SUCCESS);
+    VkImage images[max_frames];
+    for (uint32_t f = 0; f < max_frames; f++) {
+        result = vkCreateImage(device, &image_create_info, NULL, &images[f]);
+        assert(result == VK_SUCCESS);
+    }
     VkMemoryRequirements mem_reqs;
-    vkGetImageMemoryRequirements(device, image, &mem_reqs);
+    vkGetImageMemoryRequirements(device, images[0], &mem_reqs);
     VkExportMemoryAllocateInfo export_alloc_info = {
         .sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO,
         .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT,
@@ -353,24 +380,26 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
         .allocationSize = mem_reqs.size,
         .memoryTypeIndex = memory_type,
     };
-    VkDeviceMemory memory;
-    result = vkAllocateMemory(device, &mem_alloc_info, NULL, &memory);
-    assert(result == VK_SUCCESS);
-    result = vkBindImageMemory(device, image, memory, 0);
-    assert(result == VK_SUCCESS);
-    VkMemoryGetFdInfoKHR get_fd_info = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR,
-        .memory = memory,
-        .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT,
-    };
-    int dmabuf_fd;
+    VkDeviceMemory memories[max_frames];
+    int dmabuf_fds[max_frames];
     PFN_vkGetMemoryFdKHR vkGetMemoryFdKHR =
         (PFN_vkGetMemoryFdKHR)vkGetDeviceProcAddr(device, "vkGetMemoryFdKHR");
-    result = vkGetMemoryFdKHR(device, &get_fd_info, &dmabuf_fd);
-    assert(result == VK_SUCCESS);
-    assert(dmabuf_fd > 0);
-    int flags = fcntl(dmabuf_fd, F_GETFD);
-    assert(flags != -1);
+    for (uint32_t f = 0; f < max_frames; f++) {
+        result = vkAllocateMemory(device, &mem_alloc_info, NULL, &memories[f]);
+        assert(result == VK_SUCCESS);
+        result = vkBindImageMemory(device, images[f], memories[f], 0);
+        assert(result == VK_SUCCESS);
+        VkMemoryGetFdInfoKHR get_fd_info = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR,
+            .memory = memories[f],
+            .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT,
+        };
+        result = vkGetMemoryFdKHR(device, &get_fd_info, &dmabuf_fds[f]);
+        assert(result == VK_SUCCESS);
+        assert(dmabuf_fds[f] > 0);
+        int flags = fcntl(dmabuf_fds[f], F_GETFD);
+        assert(flags != -1);
+    }
     VkAttachmentDescription color_attachment = {
         .flags = 0,
         .format = VK_FORMAT_B8G8R8A8_UNORM,
@@ -408,37 +437,41 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
     VkRenderPass render_pass;
     result = vkCreateRenderPass(device, &render_pass_info, NULL, &render_pass);
     assert(result == VK_SUCCESS);
-    VkImageViewCreateInfo image_view_info = {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .image = image,
-        .viewType = VK_IMAGE_VIEW_TYPE_2D,
-        .format = VK_FORMAT_B8G8R8A8_UNORM,
-        .subresourceRange =
-            {
-                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                .baseMipLevel = 0,
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = 1,
-            },
-    };
-    VkImageView image_view;
-    result = vkCreateImageView(device, &image_view_info, NULL, &image_view);
-    assert(result == VK_SUCCESS);
-    VkImageView quad_fb_attachments[2] = {image_view, quad_depth_image_view};
-    VkFramebufferCreateInfo frame_buffer_info = {
-        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-        .renderPass = render_pass,
-        .attachmentCount = 2,
-        .pAttachments = quad_fb_attachments,
-        .width = width,
-        .height = height,
-        .layers = 1,
-    };
-    VkFramebuffer frame_buffer;
-    result =
-        vkCreateFramebuffer(device, &frame_buffer_info, NULL, &frame_buffer);
-    assert(result == VK_SUCCESS);
+    VkImageView image_views[max_frames];
+    VkFramebuffer frame_buffers[max_frames];
+    for (uint32_t f = 0; f < max_frames; f++) {
+        VkImageViewCreateInfo image_view_info = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = images[f],
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = VK_FORMAT_B8G8R8A8_UNORM,
+            .subresourceRange =
+                {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+        };
+        result = vkCreateImageView(
+            device, &image_view_info, NULL, &image_views[f]);
+        assert(result == VK_SUCCESS);
+        VkImageView quad_fb_attachments[2] = {image_views[f],
+                                              quad_depth_image_views[f]};
+        VkFramebufferCreateInfo frame_buffer_info = {
+            .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+            .renderPass = render_pass,
+            .attachmentCount = 2,
+            .pAttachments = quad_fb_attachments,
+            .width = width,
+            .height = height,
+            .layers = 1,
+        };
+        result = vkCreateFramebuffer(
+            device, &frame_buffer_info, NULL, &frame_buffers[f]);
+        assert(result == VK_SUCCESS);
+    }
 
     uint32_t* vertex_code;
     const char* vertex_path = "build/shaders/war_quad_vertex.spv";
@@ -533,108 +566,68 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
     result =
         vkCreatePipelineLayout(device, &layout_info, NULL, &pipeline_layout);
     assert(result == VK_SUCCESS);
-    VkVertexInputBindingDescription quad_vertex_binding = {
-        .binding = 0,
-        .stride = sizeof(war_quad_vertex),
-        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
-    };
+    // one instance per quad, the vertex shader makes the six corners
     VkVertexInputBindingDescription quad_instance_binding = {
-        .binding = 1,
+        .binding = 0,
         .stride = sizeof(war_quad_instance),
         .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE,
     };
-    VkVertexInputAttributeDescription quad_vertex_attrs[] = {
+    VkVertexInputAttributeDescription quad_instance_attrs[] = {
         (VkVertexInputAttributeDescription){
             .location = 0,
             .binding = 0,
-            .offset = offsetof(war_quad_vertex, corner),
+            .offset = offsetof(war_quad_instance, pos),
             .format = VK_FORMAT_R32G32_SFLOAT,
         },
         (VkVertexInputAttributeDescription){
             .location = 1,
             .binding = 0,
-            .offset = offsetof(war_quad_vertex, pos),
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
+            .offset = offsetof(war_quad_instance, span),
+            .format = VK_FORMAT_R32G32_SFLOAT,
         },
         (VkVertexInputAttributeDescription){
             .location = 2,
             .binding = 0,
-            .offset = offsetof(war_quad_vertex, color),
+            .offset = offsetof(war_quad_instance, color),
             .format = VK_FORMAT_R8G8B8A8_UNORM,
         },
         (VkVertexInputAttributeDescription){
             .location = 3,
             .binding = 0,
-            .offset = offsetof(war_quad_vertex, outline_thickness),
-            .format = VK_FORMAT_R32_SFLOAT,
+            .offset = offsetof(war_quad_instance, outline_color),
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
         },
         (VkVertexInputAttributeDescription){
             .location = 4,
             .binding = 0,
-            .offset = offsetof(war_quad_vertex, outline_color),
-            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .offset = offsetof(war_quad_instance, line_thickness),
+            .format = VK_FORMAT_R16G16_SFLOAT,
         },
         (VkVertexInputAttributeDescription){
             .location = 5,
             .binding = 0,
-            .offset = offsetof(war_quad_vertex, line_thickness),
-            .format = VK_FORMAT_R32G32_SFLOAT,
+            .offset = offsetof(war_quad_instance, outline_thickness),
+            .format = VK_FORMAT_R16_SFLOAT,
         },
         (VkVertexInputAttributeDescription){
             .location = 6,
             .binding = 0,
-            .offset = offsetof(war_quad_vertex, flags),
-            .format = VK_FORMAT_R32_UINT,
+            .offset = offsetof(war_quad_instance, depth),
+            .format = VK_FORMAT_R8_UNORM,
         },
         (VkVertexInputAttributeDescription){
             .location = 7,
             .binding = 0,
-            .offset = offsetof(war_quad_vertex, span),
-            .format = VK_FORMAT_R32G32_SFLOAT,
+            .offset = offsetof(war_quad_instance, flags),
+            .format = VK_FORMAT_R8_UINT,
         },
     };
-    uint32_t num_quad_vertex_attrs = 8;
-    VkVertexInputAttributeDescription quad_instance_attrs[] = {
-        (VkVertexInputAttributeDescription){.location = num_quad_vertex_attrs,
-                                            .binding = 1,
-                                            .format = VK_FORMAT_R32_UINT,
-                                            .offset =
-                                                offsetof(war_quad_instance, x)},
-        (VkVertexInputAttributeDescription){
-            .location = num_quad_vertex_attrs + 1,
-            .binding = 1,
-            .format = VK_FORMAT_R32_UINT,
-            .offset = offsetof(war_quad_instance, y)},
-        (VkVertexInputAttributeDescription){
-            .location = num_quad_vertex_attrs + 2,
-            .binding = 1,
-            .format = VK_FORMAT_R32_UINT,
-            .offset = offsetof(war_quad_instance, color)},
-        (VkVertexInputAttributeDescription){
-            .location = num_quad_vertex_attrs + 3,
-            .binding = 1,
-            .format = VK_FORMAT_R32_UINT,
-            .offset = offsetof(war_quad_instance, flags)},
-    };
-    uint32_t num_quad_instance_attrs = 4;
-    VkVertexInputAttributeDescription* all_attrs =
-        malloc(sizeof(VkVertexInputAttributeDescription) *
-               (num_quad_vertex_attrs + num_quad_instance_attrs));
-    memcpy(all_attrs,
-           quad_vertex_attrs,
-           sizeof(VkVertexInputAttributeDescription) * num_quad_vertex_attrs);
-    memcpy(all_attrs + num_quad_vertex_attrs,
-           quad_instance_attrs,
-           sizeof(VkVertexInputAttributeDescription) * num_quad_instance_attrs);
-    VkVertexInputBindingDescription all_bindings[] = {quad_vertex_binding,
-                                                      quad_instance_binding};
     VkPipelineVertexInputStateCreateInfo quad_vertex_input = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-        .vertexBindingDescriptionCount = 2,
-        .pVertexBindingDescriptions = all_bindings,
-        .vertexAttributeDescriptionCount =
-            num_quad_instance_attrs + num_quad_vertex_attrs,
-        .pVertexAttributeDescriptions = all_attrs,
+        .vertexBindingDescriptionCount = 1,
+        .pVertexBindingDescriptions = &quad_instance_binding,
+        .vertexAttributeDescriptionCount = 8,
+        .pVertexAttributeDescriptions = quad_instance_attrs,
     };
     VkViewport viewport = {
         .x = 0.0f,
@@ -728,46 +721,46 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
     result = vkCreateGraphicsPipelines(
         device, VK_NULL_HANDLE, 1, &pipeline_info, NULL, &pipeline);
     assert(result == VK_SUCCESS);
-    VkImageMemoryBarrier barrier = {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .image = image,
-        .subresourceRange =
-            {
-                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                .baseMipLevel = 0,
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = 1,
-            },
-        .srcAccessMask = 0,
-        .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-    };
-    VkImageMemoryBarrier quad_depth_barrier = {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .image = quad_depth_image, // <-- the depth VkImage you created
-        .subresourceRange =
-            {
-                .aspectMask =
-                    VK_IMAGE_ASPECT_DEPTH_BIT, // use DEPTH_BIT, add STENCIL_BIT
-                                               // if format has stencil
-                .baseMipLevel = 0,
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = 1,
-            },
-        .srcAccessMask = 0,
-        .dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
-                         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-    };
-    VkImageMemoryBarrier quad_barriers[2] = {barrier, quad_depth_barrier};
+    VkImageMemoryBarrier quad_barriers[max_frames * 2];
+    for (uint32_t f = 0; f < max_frames; f++) {
+        quad_barriers[f * 2] = (VkImageMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = images[f],
+            .subresourceRange =
+                {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        };
+        quad_barriers[f * 2 + 1] = (VkImageMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = quad_depth_images[f],
+            .subresourceRange =
+                {
+                    .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                             VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        };
+    }
     vkBeginCommandBuffer(
         cmd_buffer,
         &(VkCommandBufferBeginInfo){
@@ -782,7 +775,7 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
                          NULL,
                          0,
                          NULL,
-                         2,
+                         max_frames * 2,
                          quad_barriers);
     vkEndCommandBuffer(cmd_buffer);
     VkSubmitInfo submit = {
@@ -813,30 +806,9 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
         result = vkCreateFence(device, &fence_info, NULL, &in_flight_fences[i]);
         assert(result == VK_SUCCESS);
     }
-    VkBufferCreateInfo quads_vertex_buffer_info = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size = max_quads * sizeof(war_quad_vertex) * 4 * max_frames,
-        .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-    };
-    VkBuffer quads_vertex_buffer;
-    result = vkCreateBuffer(
-        device, &quads_vertex_buffer_info, NULL, &quads_vertex_buffer);
-    assert(result == VK_SUCCESS);
-    VkBufferCreateInfo quads_index_buffer_info = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size = max_quads * 6 * sizeof(uint16_t) * max_frames,
-        .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-    };
-    VkBuffer quads_index_buffer;
-    result = vkCreateBuffer(
-        device, &quads_index_buffer_info, NULL, &quads_index_buffer);
-    assert(result == VK_SUCCESS);
     VkBufferCreateInfo quads_instance_buffer_info = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size = max_quads * max_instances_per_quad * sizeof(war_quad_instance) *
-                max_frames,
+        .size = max_quads * sizeof(war_quad_instance) * max_frames,
         .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
     };
@@ -844,93 +816,127 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
     result = vkCreateBuffer(
         device, &quads_instance_buffer_info, NULL, &quads_instance_buffer);
     assert(result == VK_SUCCESS);
-    VkMemoryRequirements quads_vertex_mem_reqs;
+    VkMemoryRequirements quads_instance_mem_reqs;
     vkGetBufferMemoryRequirements(
-        device, quads_vertex_buffer, &quads_vertex_mem_reqs);
-    uint32_t quads_vertex_memory_type_index = UINT32_MAX;
-    VkPhysicalDeviceMemoryProperties quads_vertex_mem_properties;
+        device, quads_instance_buffer, &quads_instance_mem_reqs);
+    uint32_t quads_instance_memory_type_index = UINT32_MAX;
+    VkPhysicalDeviceMemoryProperties quads_instance_mem_properties;
     vkGetPhysicalDeviceMemoryProperties(physical_device,
-                                        &quads_vertex_mem_properties);
-    for (uint32_t i = 0; i < quads_vertex_mem_properties.memoryTypeCount; i++) {
-        if ((quads_vertex_mem_reqs.memoryTypeBits & (1 << i)) &&
-            (quads_vertex_mem_properties.memoryTypes[i].propertyFlags &
+                                        &quads_instance_mem_properties);
+    for (uint32_t i = 0; i < quads_instance_mem_properties.memoryTypeCount;
+         i++) {
+        if ((quads_instance_mem_reqs.memoryTypeBits & (1 << i)) &&
+            (quads_instance_mem_properties.memoryTypes[i].propertyFlags &
              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
-            quads_vertex_memory_type_index = i;
+            quads_instance_memory_type_index = i;
             break;
         }
     }
-    assert(quads_vertex_memory_type_index != UINT32_MAX);
-    VkMemoryAllocateInfo quads_vertex_alloc_info = {
+    assert(quads_instance_memory_type_index != UINT32_MAX);
+    VkMemoryAllocateInfo quads_instance_alloc_info = {
         .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = quads_vertex_mem_reqs.size,
-        .memoryTypeIndex = quads_vertex_memory_type_index,
+        .allocationSize = quads_instance_mem_reqs.size,
+        .memoryTypeIndex = quads_instance_memory_type_index,
     };
-    VkDeviceMemory quads_vertex_buffer_memory;
-    result = vkAllocateMemory(
-        device, &quads_vertex_alloc_info, NULL, &quads_vertex_buffer_memory);
+    VkDeviceMemory quads_instance_buffer_memory;
+    result = vkAllocateMemory(device,
+                              &quads_instance_alloc_info,
+                              NULL,
+                              &quads_instance_buffer_memory);
     assert(result == VK_SUCCESS);
     result = vkBindBufferMemory(
-        device, quads_vertex_buffer, quads_vertex_buffer_memory, 0);
+        device, quads_instance_buffer, quads_instance_buffer_memory, 0);
+    assert(result == VK_SUCCESS);
+    // resident notes live device local and only change by copies out of a
+    // host visible staging buffer, one region of the same size per frame
+    VkDeviceSize note_instance_buffer_size =
+        sizeof(war_quad_instance) * atomic_load(&ctx_lua->WR_NOTE_QUADS_MAX);
+    VkDeviceSize note_staging_frame_size =
+        war_align64(note_instance_buffer_size);
+    VkBufferCreateInfo note_instance_buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = note_instance_buffer_size,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    VkBuffer note_instance_buffer;
+    result = vkCreateBuffer(
+        device, &note_instance_buffer_info, NULL, &note_instance_buffer);
     assert(result == VK_SUCCESS);
-    VkMemoryRequirements quads_index_mem_reqs;
+    VkMemoryRequirements note_instance_mem_reqs;
     vkGetBufferMemoryRequirements(
-        device, quads_index_buffer, &quads_index_mem_reqs);
-    uint32_t quads_index_memory_type_index = UINT32_MAX;
-    VkPhysicalDeviceMemoryProperties quads_index_mem_properties;
-    vkGetPhysicalDeviceMemoryProperties(physical_device,
-                                        &quads_index_mem_properties);
-    for (uint32_t i = 0; i < quads_index_mem_properties.memoryTypeCount; i++) {
-        if ((quads_index_mem_reqs.memoryTypeBits & (1 << i)) &&
-            (quads_index_mem_properties.memoryTypes[i].propertyFlags &
-             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
-            quads_index_memory_type_index = i;
+        device, note_instance_buffer, &note_instance_mem_reqs);
+    uint32_t note_instance_memory_type_index = UINT32_MAX;
+    for (uint32_t i = 0; i < quads_instance_mem_properties.memoryTypeCount;
+         i++) {
+        if ((note_instance_mem_reqs.memoryTypeBits & (1 << i)) &&
+            (quads_instance_mem_properties.memoryTypes[i].propertyFlags &
+             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+            note_instance_memory_type_index = i;
             break;
         }
     }
-    assert(quads_index_memory_type_index != UINT32_MAX);
-    VkMemoryAllocateInfo quads_index_alloc_info = {
+    assert(note_instance_memory_type_index != UINT32_MAX);
+    VkMemoryAllocateInfo note_instance_alloc_info = {
         .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = quads_index_mem_reqs.size,
-        .memoryTypeIndex = quads_index_memory_type_index,
+        .allocationSize = note_instance_mem_reqs.size,
+        .memoryTypeIndex = note_instance_memory_type_index,
     };
-    VkDeviceMemory quads_index_buffer_memory;
-    result = vkAllocateMemory(
-        device, &quads_index_alloc_info, NULL, &quads_index_buffer_memory);
+    VkDeviceMemory note_instance_buffer_memory;
+    result = vkAllocateMemory(device,
+                              &note_instance_alloc_info,
+                              NULL,
+                              &note_instance_buffer_memory);
     assert(result == VK_SUCCESS);
     result = vkBindBufferMemory(
-        device, quads_index_buffer, quads_index_buffer_memory, 0);
+        device, note_instance_buffer, note_instance_buffer_memory, 0);
     assert(result == VK_SUCCESS);
-    VkMemoryRequirements quads_instance_mem_reqs;
+    VkBufferCreateInfo note_staging_buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = note_staging_frame_size * max_frames,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    VkBuffer note_staging_buffer;
+    result = vkCreateBuffer(
+        device, &note_staging_buffer_info, NULL, &note_staging_buffer);
+    assert(result == VK_SUCCESS);
+    VkMemoryRequirements note_staging_mem_reqs;
     vkGetBufferMemoryRequirements(
-        device, quads_instance_buffer, &quads_instance_mem_reqs);
-    uint32_t quads_instance_memory_type_index = UINT32_MAX;
-    VkPhysicalDeviceMemoryProperties quads_instance_mem_properties;
-    vkGetPhysicalDeviceMemoryProperties(physical_device,
-                                        &quads_instance_mem_properties);
+        device, note_staging_buffer, &note_staging_mem_reqs);
+    uint32_t note_staging_memory_type_index = UINT32_MAX;
     for (uint32_t i = 0; i < quads_instance_mem_properties.memoryTypeCount;
          i++) {
-        if ((quads_instance_mem_reqs.memoryTypeBits & (1 << i)) &&
+        if ((note_staging_mem_reqs.memoryTypeBits & (1 << i)) &&
             (quads_instance_mem_properties.memoryTypes[i].propertyFlags &
              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
-            quads_instance_memory_type_index = i;
+            note_staging_memory_type_index = i;
             break;
         }
     }
-    assert(quads_instance_memory_type_index != UINT32_MAX);
-    VkMemoryAllocateInfo quads_instance_alloc_info = {
+    assert(note_staging_memory_type_index != UINT32_MAX);
+    VkMemoryAllocateInfo note_staging_alloc_info = {
         .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = quads_instance_mem_reqs.size,
-        .memoryTypeIndex = quads_instance_memory_type_index,
+        .allocationSize = note_staging_mem_reqs.size,
+        .memoryTypeIndex = note_staging_memory_type_index,
     };
-    VkDeviceMemory quads_instance_buffer_memory;
+    VkDeviceMemory note_staging_buffer_memory;
     result = vkAllocateMemory(device,
-                              &quads_instance_alloc_info,
+                              &note_staging_alloc_info,
                               NULL,
-                              &quads_instance_buffer_memory);
+                              &note_staging_buffer_memory);
     assert(result == VK_SUCCESS);
     result = vkBindBufferMemory(
-        device, quads_instance_buffer, quads_instance_buffer_memory, 0);
+        device, note_staging_buffer, note_staging_buffer_memory, 0);
     assert(result == VK_SUCCESS);
+    void* note_staging_buffer_mapped;
+    vkMapMemory(device,
+                note_staging_buffer_memory,
+                0,
+                note_staging_frame_size * max_frames,
+                0,
+                &note_staging_buffer_mapped);
     VkImageCreateInfo texture_image_info = {
         .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
         .imageType = VK_IMAGE_TYPE_2D,
@@ -1046,26 +1052,11 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
         .pImageInfo = &descriptor_image_info,
     };
     vkUpdateDescriptorSets(device, 1, &descriptor_write, 0, NULL);
-    void* quads_vertex_buffer_mapped;
-    vkMapMemory(device,
-                quads_vertex_buffer_memory,
-                0,
-                sizeof(war_quad_vertex) * max_quads * 4 * max_frames,
-                0,
-                &quads_vertex_buffer_mapped);
-    void* quads_index_buffer_mapped;
-    vkMapMemory(device,
-                quads_index_buffer_memory,
-                0,
-                sizeof(uint16_t) * max_quads * 6 * max_frames,
-                0,
-                &quads_index_buffer_mapped);
     void* quads_instance_buffer_mapped;
     vkMapMemory(device,
                 quads_instance_buffer_memory,
                 0,
-                sizeof(war_quad_instance) * max_quads * max_instances_per_quad *
-                    max_frames,
+                sizeof(war_quad_instance) * max_quads * max_frames,
                 0,
                 &quads_instance_buffer_mapped);
 
@@ -1535,7 +1526,7 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
         device, text_vertex_buffer, text_vertex_buffer_memory, 0);
     assert(result == VK_SUCCESS);
     VkDeviceSize sdf_index_buffer_size =
-        sizeof(uint16_t) * max_text_quads * 6 * max_frames;
+        sizeof(uint32_t) * max_text_quads * 6 * max_frames;
     VkBufferCreateInfo sdf_index_buffer_info = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .size = sdf_index_buffer_size,
@@ -1846,7 +1837,7 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
     vkMapMemory(device,
                 text_index_buffer_memory,
                 0,
-                sizeof(uint16_t) * max_text_quads * 6 * max_frames,
+                sizeof(uint32_t) * max_text_quads * 6 * max_frames,
                 0,
                 &text_index_buffer_mapped);
     void* text_instance_buffer_mapped;
@@ -1943,32 +1934,367 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
                                        &transparent_quad_pipeline);
     assert(result == VK_SUCCESS);
 
-    return (war_vulkan_context){
+    //-------------------------------------------------------------------------
+    // GRID PIPELINE
+    //-------------------------------------------------------------------------
+    uint32_t* grid_vertex_code;
+    const char* grid_vertex_path = "build/shaders/war_grid_vertex.spv";
+    FILE* grid_vertex_spv = fopen(grid_vertex_path, "rb");
+    assert(grid_vertex_spv);
+    fseek(grid_vertex_spv, 0, SEEK_END);
+    long grid_vertex_size = ftell(grid_vertex_spv);
+    fseek(grid_vertex_spv, 0, SEEK_SET);
+    assert(grid_vertex_size > 0 && (grid_vertex_size % 4 == 0));
+    grid_vertex_code = malloc(grid_vertex_size);
+    assert(grid_vertex_code);
+    size_t grid_vertex_spv_read =
+        fread(grid_vertex_code, 1, grid_vertex_size, grid_vertex_spv);
+    assert(grid_vertex_spv_read == (size_t)grid_vertex_size);
+    fclose(grid_vertex_spv);
+    VkShaderModuleCreateInfo grid_vertex_shader_info = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = grid_vertex_size,
+        .pCode = grid_vertex_code};
+    VkShaderModule grid_vertex_shader;
+    result = vkCreateShaderModule(
+        device, &grid_vertex_shader_info, NULL, &grid_vertex_shader);
+    assert(result == VK_SUCCESS);
+    free(grid_vertex_code);
+    uint32_t* grid_fragment_code;
+    const char* grid_fragment_path = "build/shaders/war_grid_fragment.spv";
+    FILE* grid_fragment_spv = fopen(grid_fragment_path, "rb");
+    assert(grid_fragment_spv);
+    fseek(grid_fragment_spv, 0, SEEK_END);
+    long grid_fragment_size = ftell(grid_fragment_spv);
+    fseek(grid_fragment_spv, 0, SEEK_SET);
+    assert(grid_fragment_size > 0 && (grid_fragment_size % 4 == 0));
+    grid_fragment_code = malloc(grid_fragment_size);
+    assert(grid_fragment_code);
+    size_t grid_fragment_spv_read =
+        fread(grid_fragment_code, 1, grid_fragment_size, grid_fragment_spv);
+    assert(grid_fragment_spv_read == (size_t)grid_fragment_size);
+    fclose(grid_fragment_spv);
+    VkShaderModuleCreateInfo grid_fragment_shader_info = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = grid_fragment_size,
+        .pCode = grid_fragment_code};
+    VkShaderModule grid_fragment_shader;
+    result = vkCreateShaderModule(
+        device, &grid_fragment_shader_info, NULL, &grid_fragment_shader);
+    assert(result == VK_SUCCESS);
+    free(grid_fragment_code);
+    VkPipelineShaderStageCreateInfo grid_shader_stages[2] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_VERTEX_BIT,
+            .module = grid_vertex_shader,
+            .pName = "main",
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module = grid_fragment_shader,
+            .pName = "main",
+        }};
+    VkPushConstantRange grid_push_constant_range = {
+        .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+        .offset = 0,
+        .size = sizeof(war_grid_push_constants),
+    };
+    VkPipelineLayoutCreateInfo grid_layout_info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 0,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &grid_push_constant_range,
+    };
+    VkPipelineLayout grid_pipeline_layout;
+    result = vkCreatePipelineLayout(
+        device, &grid_layout_info, NULL, &grid_pipeline_layout);
+    assert(result == VK_SUCCESS);
+    // no vertex input, the vertex shader makes one full screen triangle and
+    // the fragment shader writes the depth of whatever it draws
+    VkGraphicsPipelineCreateInfo grid_pipeline_info = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .stageCount = 2,
+        .pStages = grid_shader_stages,
+        .pVertexInputState =
+            &(VkPipelineVertexInputStateCreateInfo){
+                .sType =
+                    VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+            },
+        .pInputAssemblyState =
+            &(VkPipelineInputAssemblyStateCreateInfo){
+                .sType =
+                    VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+                .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+            },
+        .pViewportState =
+            &(VkPipelineViewportStateCreateInfo){
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+                .viewportCount = 1,
+                .pViewports = &viewport,
+                .scissorCount = 1,
+                .pScissors = &scissor,
+            },
+        .pDepthStencilState = &depth_stencil,
+        .pRasterizationState =
+            &(VkPipelineRasterizationStateCreateInfo){
+                .sType =
+                    VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+                .polygonMode = VK_POLYGON_MODE_FILL,
+                .cullMode = VK_CULL_MODE_NONE,
+                .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                .lineWidth = 1.0f,
+            },
+        .pMultisampleState =
+            &(VkPipelineMultisampleStateCreateInfo){
+                .sType =
+                    VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+                .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+            },
+        .pColorBlendState =
+            &(VkPipelineColorBlendStateCreateInfo){
+                .sType =
+                    VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+                .attachmentCount = 1,
+                .pAttachments =
+                    (VkPipelineColorBlendAttachmentState[]){
+                        {
+                            .blendEnable = VK_FALSE,
+                            .colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
+                                              VK_COLOR_COMPONENT_G_BIT |
+                                              VK_COLOR_COMPONENT_B_BIT |
+                                              VK_COLOR_COMPONENT_A_BIT,
+                        },
+                    },
+            },
+        .layout = grid_pipeline_layout,
+        .renderPass = render_pass,
+        .subpass = 0,
+        .pDynamicState = NULL,
+    };
+    VkPipeline grid_pipeline;
+    result = vkCreateGraphicsPipelines(
+        device, VK_NULL_HANDLE, 1, &grid_pipeline_info, NULL, &grid_pipeline);
+    assert(result == VK_SUCCESS);
+
+    //-------------------------------------------------------------------------
+    // NOTE CULL PIPELINE
+    //-------------------------------------------------------------------------
+    // the compute pass copies the notes in view out of the note buffer into
+    // note_visible_buffer and counts them into a VkDrawIndirectCommand
+    VkPhysicalDeviceMemoryProperties note_cull_mem_properties;
+    vkGetPhysicalDeviceMemoryProperties(physical_device,
+                                        &note_cull_mem_properties);
+    VkBufferCreateInfo note_visible_buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = note_instance_buffer_size,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    VkBuffer note_visible_buffer;
+    result = vkCreateBuffer(
+        device, &note_visible_buffer_info, NULL, &note_visible_buffer);
+    assert(result == VK_SUCCESS);
+    VkMemoryRequirements note_visible_mem_reqs;
+    vkGetBufferMemoryRequirements(
+        device, note_visible_buffer, &note_visible_mem_reqs);
+    uint32_t note_visible_memory_type_index = UINT32_MAX;
+    for (uint32_t i = 0; i < note_cull_mem_properties.memoryTypeCount; i++) {
+        if ((note_visible_mem_reqs.memoryTypeBits & (1 << i)) &&
+            (note_cull_mem_properties.memoryTypes[i].propertyFlags &
+             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+            note_visible_memory_type_index = i;
+            break;
+        }
+    }
+    assert(note_visible_memory_type_index != UINT32_MAX);
+    VkMemoryAllocateInfo note_visible_alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = note_visible_mem_reqs.size,
+        .memoryTypeIndex = note_visible_memory_type_index,
+    };
+    VkDeviceMemory note_visible_buffer_memory;
+    result = vkAllocateMemory(
+        device, &note_visible_alloc_info, NULL, &note_visible_buffer_memory);
+    assert(result == VK_SUCCESS);
+    result = vkBindBufferMemory(
+        device, note_visible_buffer, note_visible_buffer_memory, 0);
+    assert(result == VK_SUCCESS);
+    VkBufferCreateInfo note_draw_buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = sizeof(VkDrawIndirectCommand),
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                 VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    VkBuffer note_draw_buffer;
+    result =
+        vkCreateBuffer(device, &note_draw_buffer_info, NULL, &note_draw_buffer);
+    assert(result == VK_SUCCESS);
+    VkMemoryRequirements note_draw_mem_reqs;
+    vkGetBufferMemoryRequirements(
+        device, note_draw_buffer, &note_draw_mem_reqs);
+    uint32_t note_draw_memory_type_index = UINT32_MAX;
+    for (uint32_t i = 0; i < note_cull_mem_properties.memoryTypeCount; i++) {
+        if ((note_draw_mem_reqs.memoryTypeBits & (1 << i)) &&
+            (note_cull_mem_properties.memoryTypes[i].propertyFlags &
+             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+            note_draw_memory_type_index = i;
+            break;
+        }
+    }
+    assert(note_draw_memory_type_index != UINT32_MAX);
+    VkMemoryAllocateInfo note_draw_alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = note_draw_mem_reqs.size,
+        .memoryTypeIndex = note_draw_memory_type_index,
+    };
+    VkDeviceMemory note_draw_buffer_memory;
+    result = vkAllocateMemory(
+        device, &note_draw_alloc_info, NULL, &note_draw_buffer_memory);
+    assert(result == VK_SUCCESS);
+    result = vkBindBufferMemory(
+        device, note_draw_buffer, note_draw_buffer_memory, 0);
+    assert(result == VK_SUCCESS);
+    VkDescriptorSetLayoutBinding note_cull_bindings[3];
+    for (uint32_t i = 0; i < 3; i++) {
+        note_cull_bindings[i] = (VkDescriptorSetLayoutBinding){
+            .binding = i,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        };
+    }
+    VkDescriptorSetLayoutCreateInfo note_cull_set_layout_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = 3,
+        .pBindings = note_cull_bindings,
+    };
+    VkDescriptorSetLayout note_cull_descriptor_set_layout;
+    result = vkCreateDescriptorSetLayout(device,
+                                         &note_cull_set_layout_info,
+                                         NULL,
+                                         &note_cull_descriptor_set_layout);
+    assert(result == VK_SUCCESS);
+    VkDescriptorPoolSize note_cull_pool_size = {
+        .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 3,
+    };
+    VkDescriptorPoolCreateInfo note_cull_pool_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .poolSizeCount = 1,
+        .pPoolSizes = &note_cull_pool_size,
+        .maxSets = 1,
+    };
+    VkDescriptorPool note_cull_descriptor_pool;
+    result = vkCreateDescriptorPool(
+        device, &note_cull_pool_info, NULL, &note_cull_descriptor_pool);
+    assert(result == VK_SUCCESS);
+    VkDescriptorSetAllocateInfo note_cull_set_alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = note_cull_descriptor_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &note_cull_descriptor_set_layout,
+    };
+    VkDescriptorSet note_cull_descriptor_set;
+    result = vkAllocateDescriptorSets(
+        device, &note_cull_set_alloc_info, &note_cull_descriptor_set);
+    assert(result == VK_SUCCESS);
+    VkDescriptorBufferInfo note_cull_buffer_infos[3] = {
+        {.buffer = note_instance_buffer, .offset = 0, .range = VK_WHOLE_SIZE},
+        {.buffer = note_visible_buffer, .offset = 0, .range = VK_WHOLE_SIZE},
+        {.buffer = note_draw_buffer, .offset = 0, .range = VK_WHOLE_SIZE},
+    };
+    VkWriteDescriptorSet note_cull_writes[3];
+    for (uint32_t i = 0; i < 3; i++) {
+        note_cull_writes[i] = (VkWriteDescriptorSet){
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = note_cull_descriptor_set,
+            .dstBinding = i,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &note_cull_buffer_infos[i],
+        };
+    }
+    vkUpdateDescriptorSets(device, 3, note_cull_writes, 0, NULL);
+    uint32_t* note_cull_code;
+    const char* note_cull_path = "build/shaders/war_note_cull_compute.spv";
+    FILE* note_cull_spv = fopen(note_cull_path, "rb");
+    assert(note_cull_spv);
+    fseek(note_cull_spv, 0, SEEK_END);
+    long note_cull_size = ftell(note_cull_spv);
+    fseek(note_cull_spv, 0, SEEK_SET);
+    assert(note_cull_size > 0 && (note_cull_size % 4 == 0));
+    note_cull_code = malloc(note_cull_size);
+    assert(note_cull_code);
+    size_t note_cull_spv_read =
+        fread(note_cull_code, 1, note_cull_size, note_cull_spv);
+    assert(note_cull_spv_read == (size_t)note_cull_size);
+    fclose(note_cull_spv);
+    VkShaderModuleCreateInfo note_cull_shader_info = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = note_cull_size,
+        .pCode = note_cull_code};
+    VkShaderModule note_cull_shader;
+    result = vkCreateShaderModule(
+        device, &note_cull_shader_info, NULL, &note_cull_shader);
+    assert(result == VK_SUCCESS);
+    free(note_cull_code);
+    VkPushConstantRange note_cull_push_constant_range = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(war_note_cull_push_constants),
+    };
+    VkPipelineLayoutCreateInfo note_cull_layout_info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &note_cull_descriptor_set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &note_cull_push_constant_range,
+    };
+    VkPipelineLayout note_cull_pipeline_layout;
+    result = vkCreatePipelineLayout(
+        device, &note_cull_layout_info, NULL, &note_cull_pipeline_layout);
+    assert(result == VK_SUCCESS);
+    VkComputePipelineCreateInfo note_cull_pipeline_info = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage =
+            {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = note_cull_shader,
+                .pName = "main",
+            },
+        .layout = note_cull_pipeline_layout,
+    };
+    VkPipeline note_cull_pipeline;
+    result = vkCreateComputePipelines(device,
+                                      VK_NULL_HANDLE,
+                                      1,
+                                      &note_cull_pipeline_info,
+                                      NULL,
+                                      &note_cull_pipeline);
+    assert(result == VK_SUCCESS);
+
+    war_vulkan_context ctx_vk = {
         //----------------------------------------------------------------------
         // QUAD PIPELINE
         //----------------------------------------------------------------------
-        .dmabuf_fd = dmabuf_fd,
         .instance = instance,
         .physical_device = physical_device,
         .device = device,
         .queue = queue,
         .queue_family_index = queue_family_index,
-        .image = image,
-        .memory = memory,
         .cmd_pool = cmd_pool,
-        .cmd_buffer = cmd_buffer,
         .render_pass = render_pass,
-        .frame_buffer = frame_buffer,
         .quad_pipeline = pipeline,
         .transparent_quad_pipeline = transparent_quad_pipeline,
         .pipeline_layout = pipeline_layout,
-        .image_view = image_view,
         .image_available_semaphore = image_available_semaphore,
         .render_finished_semaphore = render_finished_semaphore,
-        .quads_index_buffer = quads_index_buffer,
-        .quads_index_buffer_memory = quads_index_buffer_memory,
-        .quads_vertex_buffer = quads_vertex_buffer,
-        .quads_vertex_buffer_memory = quads_vertex_buffer_memory,
         .quads_instance_buffer = quads_instance_buffer,
         .quads_instance_buffer_memory = quads_instance_buffer_memory,
         .texture_image = texture_image,
@@ -1977,11 +2303,25 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
         .texture_sampler = texture_sampler,
         .texture_descriptor_set = descriptor_set,
         .texture_descriptor_pool = descriptor_pool,
-        .in_flight_fences = in_flight_fences,
-        .quads_vertex_buffer_mapped = quads_vertex_buffer_mapped,
-        .quads_index_buffer_mapped = quads_index_buffer_mapped,
         .quads_instance_buffer_mapped = quads_instance_buffer_mapped,
         .current_frame = 0,
+        .grid_pipeline = grid_pipeline,
+        .grid_pipeline_layout = grid_pipeline_layout,
+        .note_instance_buffer = note_instance_buffer,
+        .note_instance_buffer_memory = note_instance_buffer_memory,
+        .note_staging_buffer = note_staging_buffer,
+        .note_staging_buffer_memory = note_staging_buffer_memory,
+        .note_staging_buffer_mapped = note_staging_buffer_mapped,
+        .note_staging_frame_size = note_staging_frame_size,
+        .note_visible_buffer = note_visible_buffer,
+        .note_visible_buffer_memory = note_visible_buffer_memory,
+        .note_draw_buffer = note_draw_buffer,
+        .note_draw_buffer_memory = note_draw_buffer_memory,
+        .note_cull_descriptor_set_layout = note_cull_descriptor_set_layout,
+        .note_cull_descriptor_pool = note_cull_descriptor_pool,
+        .note_cull_descriptor_set = note_cull_descriptor_set,
+        .note_cull_pipeline_layout = note_cull_pipeline_layout,
+        .note_cull_pipeline = note_cull_pipeline,
 
         //---------------------------------------------------------------------
         // SDF TEXT PIPELINE
@@ -2018,5 +2358,22 @@ war_vulkan_init(war_lua_context* ctx_lua, uint32_t width, uint32_t height) {
         .text_vertex_buffer_mapped = text_vertex_buffer_mapped,
         .text_index_buffer_mapped = text_index_buffer_mapped,
         .text_instance_buffer_mapped = text_instance_buffer_mapped,
-    };
+        .timestamp_query_pool = timestamp_query_pool,
+        .timestamp_period = device_props.limits.timestampPeriod,
+    };
+    memcpy(ctx_vk.dmabuf_fds, dmabuf_fds, sizeof(dmabuf_fds));
+    memcpy(ctx_vk.images, images, sizeof(images));
+    memcpy(ctx_vk.memories, memories, sizeof(memories));
+    memcpy(ctx_vk.image_views, image_views, sizeof(image_views));
+    memcpy(ctx_vk.depth_images, quad_depth_images, sizeof(quad_depth_images));
+    memcpy(ctx_vk.depth_image_memories,
+           quad_depth_image_memories,
+           sizeof(quad_depth_image_memories));
+    memcpy(ctx_vk.depth_image_views,
+           quad_depth_image_views,
+           sizeof(quad_depth_image_views));
+    memcpy(ctx_vk.frame_buffers, frame_buffers, sizeof(frame_buffers));
+    memcpy(ctx_vk.cmd_buffers, cmd_buffers, sizeof(cmd_buffers));
+    memcpy(ctx_vk.in_flight_fences, in_flight_fences, sizeof(in_flight_fences));
+    return ctx_vk;
 }
@@ -109,6 +109,26 @@ void war_wayland_wl_surface_damage(int fd,
     assert(damage_written == 24);
 }
 
+// buffer pixels rather than surface coordinates, wl_surface since version 4
+void war_wayland_wl_surface_damage_buffer(int fd,
+                                          uint32_t wl_surface_id,
+                                          int32_t x,
+                                          int32_t y,
+                                          int32_t width,
+                                          int32_t height) {
+    uint8_t damage_buffer[24];
+    war_write_le32(damage_buffer, wl_surface_id);
+    war_write_le16(damage_buffer + 4, 9);
+    war_write_le16(damage_buffer + 6, 24);
+    war_write_le32(damage_buffer + 8, x);
+    war_write_le32(damage_buffer + 12, y);
+    war_write_le32(damage_buffer + 16, width);
+    war_write_le32(damage_buffer + 20, height);
+    // dump_bytes("wl_surface_damage_buffer request", damage_buffer, 24);
+    ssize_t damage_buffer_written = write(fd, damage_buffer, 24);
+    assert(damage_buffer_written == 24);
+}
+
 void war_wayland_wl_surface_commit(int fd, uint32_t wl_surface_id) {
     uint8_t commit[8];
     war_write_le32(commit, wl_surface_id);
@@ -134,6 +154,21 @@ void war_wayland_wl_surface_frame(int fd,
     assert(frame_written == 12);
 }
 
+void war_wayland_wp_presentation_feedback(int fd,
+                                          uint32_t wp_presentation_id,
+                                          uint32_t wl_surface_id,
+                                          uint32_t new_id) {
+    uint8_t feedback[16];
+    war_write_le32(feedback, wp_presentation_id);
+    war_write_le16(feedback + 4, 1);
+    war_write_le16(feedback + 6, 16);
+    war_write_le32(feedback + 8, wl_surface_id);
+    war_write_le32(feedback + 12, new_id);
+    // dump_bytes("wp_presentation::feedback request", feedback, 16);
+    ssize_t feedback_written = write(fd, feedback, 16);
+    assert(feedback_written == 16);
+}
+
 void war_wayland_registry_bind(int fd,
                                uint8_t* msg_buffer,
                                size_t msg_buffer_offset,